@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.5 (2019/03/19)
+// File Version: 3.0.12 (2019/09/14)
 
 #pragma once
 
@@ -19,6 +19,8 @@
 #include <Imagics/GteSurfaceExtractorTetrahedra.h>
 
 // Images
+#include <Imagics/GteBrickedImage3.h>
+#include <Imagics/GteBrickFile.h>
 #include <Imagics/GteImage.h>
 #include <Imagics/GteImage2.h>
 #include <Imagics/GteImage3.h>
@@ -36,14 +38,21 @@
 #include <Imagics/GtePdeFilter1.h>
 #include <Imagics/GtePdeFilter2.h>
 #include <Imagics/GtePdeFilter3.h>
+#include <Imagics/GteRankFilter.h>
 
 // Utilities
+#include <Imagics/GteBinaryMorphology.h>
+#include <Imagics/GteComponentLabeler.h>
+#include <Imagics/GteDistanceTransform.h>
 #include <Imagics/GteHistogram.h>
 #include <Imagics/GteImageUtility2.h>
 #include <Imagics/GteImageUtility3.h>
+#include <Imagics/GteJointHistogram.h>
 
 // Segmenters
 #include <Imagics/GteAdaptiveSkeletonClimbing2.h>
 #include <Imagics/GteAdaptiveSkeletonClimbing3.h>
 #include <Imagics/GteFastMarch2.h>
 #include <Imagics/GteFastMarch3.h>
+#include <Imagics/GteFastMarchBucketed.h>
+#include <Imagics/GteFastSweep.h>
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.3 (2019/07/30)
+// File Version: 3.0.8 (2019/09/24)
 
 #pragma once
 
@@ -11,12 +11,18 @@
 #include <LowLevel/GteArray2.h>
 #include <LowLevel/GteArray3.h>
 #include <LowLevel/GteArray4.h>
+#include <LowLevel/GteArrayStorage.h>
 #include <LowLevel/GteAtomicMinMax.h>
 #include <LowLevel/GteComputeModel.h>
+#include <LowLevel/GteConcurrentHashMap.h>
 #include <LowLevel/GteLexicoArray2.h>
+#include <LowLevel/GteMemoryMappedFile.h>
 #include <LowLevel/GteMinHeap.h>
+#include <LowLevel/GteMPMCQueue.h>
+#include <LowLevel/GteParallelFor.h>
 #include <LowLevel/GteRangeIteration.h>
 #include <LowLevel/GteSharedPtrCompare.h>
+#include <LowLevel/GteSPSCQueue.h>
 #include <LowLevel/GteStringUtility.h>
 #include <LowLevel/GteThreadSafeMap.h>
 #include <LowLevel/GteThreadSafeQueue.h>
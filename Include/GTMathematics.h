@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.40 (2019/07/10)
+// File Version: 3.0.47 (2019/09/26)
 
 #pragma once
 
@@ -26,6 +26,8 @@
 // Algebra
 #include <Mathematics/GteAxisAngle.h>
 #include <Mathematics/GteBandedMatrix.h>
+#include <Mathematics/GteBlockedMatrixProduct.h>
+#include <Mathematics/GteBlockReflector.h>
 #include <Mathematics/GteConvertCoordinates.h>
 #include <Mathematics/GteEulerAngles.h>
 #include <Mathematics/GteGMatrix.h>
@@ -37,6 +39,7 @@
 #include <Mathematics/GtePolynomial1.h>
 #include <Mathematics/GteQuaternion.h>
 #include <Mathematics/GteRotation.h>
+#include <Mathematics/GteSIMD4.h>
 #include <Mathematics/GteVector.h>
 #include <Mathematics/GteVector2.h>
 #include <Mathematics/GteVector3.h>
@@ -72,6 +75,7 @@
 
 // ComputationalGeometry
 #include <Mathematics/GteBSPPolygon2.h>
+#include <Mathematics/GteBSPrimalQuery3.h>
 #include <Mathematics/GteCLODPolyline.h>
 #include <Mathematics/GteConformalMapGenus0.h>
 #include <Mathematics/GteConstrainedDelaunay2.h>
@@ -219,6 +223,7 @@
 #include <Mathematics/GteACosEstimate.h>
 #include <Mathematics/GteASinEstimate.h>
 #include <Mathematics/GteATanEstimate.h>
+#include <Mathematics/GteArrayEstimate.h>
 #include <Mathematics/GteChebyshevRatio.h>
 #include <Mathematics/GteCosEstimate.h>
 #include <Mathematics/GteExp2Estimate.h>
@@ -374,6 +379,8 @@
 #include <Mathematics/GteIntrSphere3Sphere3.h>
 #include <Mathematics/GteIntrSphere3Triangle3.h>
 #include <Mathematics/GteIntrTriangle3OrientedBox3.h>
+#include <Mathematics/GteIntrTriangle3Triangle3.h>
+#include <Mathematics/GteTriangleMeshIntersection3.h>
 #include <Mathematics/GteIntrTriangle2Triangle2.h>
 #include <Mathematics/GteTIQuery.h>
 
@@ -384,6 +391,7 @@
 #include <Mathematics/GteGaussianElimination.h>
 #include <Mathematics/GteIntegration.h>
 #include <Mathematics/GteLCPSolver.h>
+#include <Mathematics/GteLCPSolverPGS.h>
 #include <Mathematics/GteLevenbergMarquardtMinimizer.h>
 #include <Mathematics/GteLinearSystem.h>
 #include <Mathematics/GteMinimize1.h>
@@ -398,9 +406,11 @@
 #include <Mathematics/GteRootsBrentsMethod.h>
 #include <Mathematics/GteRootsPolynomial.h>
 #include <Mathematics/GteSingularValueDecomposition.h>
+#include <Mathematics/GteSparseNormalEquations.h>
 #include <Mathematics/GteSymmetricEigensolver.h>
 #include <Mathematics/GteSymmetricEigensolver2x2.h>
 #include <Mathematics/GteSymmetricEigensolver3x3.h>
+#include <Mathematics/GteBatchSymmetricEigensolver3x3.h>
 #include <Mathematics/GteUnsymmetricEigenvalues.h>
 
 // Projection
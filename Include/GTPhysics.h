@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2019/03/06)
+// File Version: 3.0.2 (2019/09/05)
 
 #pragma once
 
@@ -46,3 +46,4 @@
 // RigidBody
 #include <Physics/GtePolyhedralMassProperties.h>
 #include <Physics/GteRigidBody.h>
+#include <Physics/GteRigidBodyWorld.h>
@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/16)
 
 #pragma once
 
-#include <LowLevel/GteThreadSafeMap.h>
+#include <LowLevel/GteConcurrentHashMap.h>
 #include <Graphics/GteBaseEngine.h>
 #include <Graphics/GteBlendState.h>
 #include <Graphics/GteDepthStencilState.h>
@@ -182,9 +182,10 @@ protected:
 
     // Bridge pattern to create graphics API-specific objects that correspond
     // to front-end objects.  The Bind, Get, and Unbind operations act on
-    // these maps.
-    ThreadSafeMap<GraphicsObject const*, std::shared_ptr<GEObject>> mGOMap;
-    ThreadSafeMap<DrawTarget const*, std::shared_ptr<GEDrawTarget>> mDTMap;
+    // these maps.  The maps are hash tables with per-shard reader-writer
+    // locks, so the lookups during draw submission do not serialize.
+    ConcurrentHashMap<GraphicsObject const*, std::shared_ptr<GEObject>> mGOMap;
+    ConcurrentHashMap<DrawTarget const*, std::shared_ptr<GEDrawTarget>> mDTMap;
     std::unique_ptr<GEInputLayoutManager> mILMap;
 
     // Creation functions for adding objects to the bridges.  The function
@@ -0,0 +1,117 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/10)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Dilation and erosion of binary 2D and 3D images that are packed 64 pixels
+// per word.  A structuring element B is a set of offsets d = (dx,dy,dz) and
+//   dilate(A,B)(q) = OR{ A(q-d) : d in B }
+//   erode(A,B)(p) = AND{ A(p+d) : d in B }
+// Erosion is computed as the complement of the dilation of the complement
+// of A by the reflection of B.
+//
+// A box structuring element is the product of three line segments, so the
+// dilation is computed one axis at a time.  Along the x-axis, the OR of a
+// window of length L is computed with O(log L) shifts of the packed words.
+// Along the y-axis and z-axis, the OR of a window of L rows is computed by
+// the van Herk/Gil-Werman algorithm: the rows are partitioned into blocks
+// of L rows, the prefix and suffix ORs of the blocks are computed, and each
+// output row is the OR of one suffix and one prefix.  The cost per word is
+// independent of L.  An arbitrary structuring element is decomposed into
+// maximal runs of consecutive dx for each (dy,dz).  The image is dilated
+// along the x-axis once per distinct run and the output rows are ORs of the
+// shifted rows of those images.
+//
+// The word loops are simple loops over arrays of 64-bit integers that the
+// compiler can vectorize.  The rows (or groups of words of the columns) are
+// distributed over the threads.
+
+namespace gte
+{
+
+class GTE_IMPEXP BinaryMorphology
+{
+public:
+    // Row r = y + dim1*z of the image consists of the words
+    // words[r*wordsPerRow+k] for 0 <= k < wordsPerRow, where wordsPerRow is
+    // (dim0+63)/64.  Pixel x of the row is bit (x % 64) of word x/64.  The
+    // bits of the last word of a row that are not pixels are zero.
+    struct PackedImage
+    {
+        int dim0, dim1, dim2, wordsPerRow;
+        std::vector<uint64_t> words;
+    };
+
+    BinaryMorphology(unsigned int numThreads = 1);
+
+    // Conversion between images with int-valued pixels and packed images.
+    // The nonzero pixels are the foreground.  Unpacking writes 0 and 1.
+    void Pack(int dim0, int dim1, int dim2, int const* image,
+        PackedImage& packed);
+    void Unpack(PackedImage const& packed, int* image);
+
+    // Pack the input image, apply the operation to the packed image and
+    // unpack the result to the output image.  Both images have
+    // dim0*dim1*dim2 pixels and must be different arrays.
+    void Apply(int dim0, int dim1, int dim2, int const* input,
+        std::function<void(PackedImage const&, PackedImage&)> const& operation,
+        int* output);
+
+    // The box structuring element consists of the offsets d with
+    // boxMin[i] <= d[i] <= boxMax[i].  The structuring element specified by
+    // offsets always contains (0,0,0) in addition to the offsets.  Use
+    // dz = 0 for 2D images.  The image exterior is 0 for dilation.  For
+    // erosion, the image exterior is 0 when zeroExterior is true, in which
+    // case foreground pixels are eroded by the image boundary; otherwise,
+    // the exterior is 1.  The output must be an object different from the
+    // input.  An empty input (no words) produces an empty output.
+    void Dilate(PackedImage const& input, std::array<int, 3> const& boxMin,
+        std::array<int, 3> const& boxMax, PackedImage& output);
+
+    void Erode(PackedImage const& input, bool zeroExterior,
+        std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+        PackedImage& output);
+
+    void Dilate(PackedImage const& input, int numOffsets,
+        std::array<int, 3> const* offsets, PackedImage& output);
+
+    void Erode(PackedImage const& input, bool zeroExterior, int numOffsets,
+        std::array<int, 3> const* offsets, PackedImage& output);
+
+private:
+    // Dilation with the specified value of the image exterior.
+    void DilateBox(PackedImage const& input, std::array<int, 3> const& boxMin,
+        std::array<int, 3> const& boxMax, bool exterior, PackedImage& output);
+
+    void DilateOffsets(PackedImage const& input, int numOffsets,
+        std::array<int, 3> const* offsets, bool exterior, PackedImage& output);
+
+    // Dilation by the line segment of offsets lo <= dx <= hi along the
+    // x-axis.
+    void DilateX(PackedImage const& input, int lo, int hi, bool exterior,
+        PackedImage& output);
+
+    // Dilation by the line segment of offsets lo <= d <= hi along the
+    // y-axis (axis 1) or z-axis (axis 2).
+    void DilateYZ(int axis, PackedImage const& input, int lo, int hi,
+        bool exterior, PackedImage& output);
+
+    void Complement(PackedImage& image);
+
+    template <typename Function>
+    void Execute(int numItems, Function const& function);
+
+    unsigned int mNumThreads;
+};
+
+}
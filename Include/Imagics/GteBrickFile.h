@@ -0,0 +1,160 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/12)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// A file that stores a 3D image as bricks, which are subimages of size
+// brickDim[0]-by-brickDim[1]-by-brickDim[2] that are read and written
+// independently.  Brick (b0,b1,b2) contains the voxels (x,y,z) with
+// b[i]*brickDim[i] <= x[i] < (b[i]+1)*brickDim[i], stored in lexicographical
+// order, and its index is b0 + numBricks[0]*(b1 + numBricks[1]*b2).  The
+// bricks on the upper boundary of the image are padded to full size.  The
+// bricks are optionally compressed with the LZ4 block format, which
+// decompresses at several GB/s and is effective for the large constant
+// regions of CT and microscopy volumes.  A brick that was never written
+// consists of zeros and occupies no space in the file.
+//
+// The layout of the file is
+//   header:  "GTEBRICK", version, dims[3], brickDims[3], pixelSize,
+//            compressed, tableOffset (64 bytes total)
+//   bricks:  the brick data in the order they were written
+//   table:   numBricks pairs (offset, size) of uint64_t
+// A brick whose size is the uncompressed size of a brick is stored without
+// compression.  A compressed brick that is written again and no longer fits
+// in its extent of the file is moved to an extent of the uncompressed size,
+// so the file is at most twice the size of the uncompressed bricks.  All
+// values are stored in the byte order of the machine.
+// The table is written by Close(), so a file that is not closed after it
+// is modified is invalid.
+
+namespace gte
+{
+
+class GTE_IMPEXP BrickFile
+{
+public:
+    // Construction and destruction.  The destructor calls Close().
+    ~BrickFile();
+    BrickFile();
+
+    // Object copies are not allowed.
+    BrickFile(BrickFile const&) = delete;
+    BrickFile& operator=(BrickFile const&) = delete;
+
+    // Create a file whose bricks are all zero.  An existing file is
+    // overwritten.
+    bool Create(std::string const& filename, std::array<int, 3> const& dims,
+        std::array<int, 3> const& brickDims, int pixelSize, bool compressed);
+
+    // Open an existing file for reading or for reading and writing.
+    bool Open(std::string const& filename, bool writable);
+
+    // Write the brick table and close the file.
+    bool Close();
+
+    // Member access.
+    inline bool IsOpen() const;
+    inline bool IsWritable() const;
+    inline bool IsCompressed() const;
+    inline std::array<int, 3> const& GetDimensions() const;
+    inline std::array<int, 3> const& GetBrickDimensions() const;
+    inline std::array<int, 3> const& GetNumBricks() const;
+    inline size_t GetNumBricksTotal() const;
+    inline int GetPixelSize() const;
+    inline size_t GetBrickBytes() const;
+
+    // Read or write the GetBrickBytes() bytes of a brick.
+    bool ReadBrick(size_t brick, void* data);
+    bool WriteBrick(size_t brick, void const* data);
+
+    // The LZ4 block format.  Compress() returns the number of bytes of the
+    // compressed data.  Decompress() returns 'false' when the input is not
+    // valid or does not decompress to exactly numOutputBytes bytes.
+    static size_t Compress(uint8_t const* input, size_t numInputBytes,
+        std::vector<uint8_t>& output);
+
+    static bool Decompress(uint8_t const* input, size_t numInputBytes,
+        uint8_t* output, size_t numOutputBytes);
+
+private:
+    struct Entry
+    {
+        uint64_t offset, size;
+    };
+
+    void Initialize(std::array<int, 3> const& dims,
+        std::array<int, 3> const& brickDims, int pixelSize, bool compressed);
+
+    // Management of the space of the bricks.  The extents of the file that
+    // are released are reused by Allocate() in first-fit order.
+    void Release(size_t brick);
+    uint64_t Allocate(uint64_t size);
+
+    std::fstream mStream;
+    bool mWritable, mCompressed, mModified;
+    std::array<int, 3> mDims, mBrickDims, mNumBricks;
+    int mPixelSize;
+    size_t mBrickBytes;
+    std::vector<Entry> mTable, mFree;
+    std::vector<uint64_t> mCapacity;
+    uint64_t mEnd;
+    std::vector<uint8_t> mBuffer;
+};
+
+inline bool BrickFile::IsOpen() const
+{
+    return mStream.is_open();
+}
+
+inline bool BrickFile::IsWritable() const
+{
+    return mWritable;
+}
+
+inline bool BrickFile::IsCompressed() const
+{
+    return mCompressed;
+}
+
+inline std::array<int, 3> const& BrickFile::GetDimensions() const
+{
+    return mDims;
+}
+
+inline std::array<int, 3> const& BrickFile::GetBrickDimensions() const
+{
+    return mBrickDims;
+}
+
+inline std::array<int, 3> const& BrickFile::GetNumBricks() const
+{
+    return mNumBricks;
+}
+
+inline size_t BrickFile::GetNumBricksTotal() const
+{
+    return mTable.size();
+}
+
+inline int BrickFile::GetPixelSize() const
+{
+    return mPixelSize;
+}
+
+inline size_t BrickFile::GetBrickBytes() const
+{
+    return mBrickBytes;
+}
+
+}
@@ -0,0 +1,532 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/12)
+
+#pragma once
+
+#include <Imagics/GteBrickFile.h>
+#include <Imagics/GteImage3.h>
+#include <LowLevel/GteMemoryMappedFile.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <type_traits>
+
+// A 3D image whose voxels are stored in a file rather than in memory, for
+// volumes that are too large to be loaded.  There are two storage types.
+//
+// 1. A raw file, which has the voxels in lexicographical order, optionally
+//    after a header.  The file is memory mapped and the operating system
+//    pages the data in and out.  This is the fastest storage for volumes
+//    that are accessed mostly along the x-axis.
+//
+// 2. A BrickFile, which has the voxels in bricks that are optionally
+//    compressed.  The bricks are read on demand into a cache whose size is
+//    specified in bytes.  When the cache is full, the least recently used
+//    brick is removed from the cache and written to the file when it was
+//    modified.  The brick dimensions must be powers of two.  Bricks of
+//    32^3 or 64^3 voxels are appropriate for access by neighborhoods.
+//
+// The voxel access functions and the neighborhood functions of Image3 are
+// available.  The neighborhood functions depend only on the dimensions, so
+// they can be used with operator[] as for Image3.  The references returned
+// by the access functions for brick storage are valid until the brick is
+// removed from the cache; the last N distinct bricks that were accessed are
+// in the cache when the cache has N bricks.  The cache is modified by all
+// accesses, including those of const objects, so an object must not be
+// accessed by multiple threads.  A non-const access marks the brick as
+// modified.  Use a const reference to read a file that is opened without
+// write access.
+//
+// Filters process the image in slabs of consecutive z-slices that are
+// copied to or from an Image3 by GetSlab and SetSlab.  See
+// SurfaceExtractorMC::ExtractStreamed and PdeFilter3::UpdateStreamed.
+
+namespace gte
+{
+    template <typename PixelType>
+    class BrickedImage3 : private Image3<PixelType>
+    {
+    public:
+        static_assert(std::is_trivially_copyable<PixelType>::value,
+            "The pixel type must be trivially copyable.");
+
+        // Construction and destruction.  The destructor calls Close().
+        virtual ~BrickedImage3()
+        {
+            Close();
+        }
+
+        BrickedImage3()
+            :
+            mMapped(nullptr),
+            mWritable(false),
+            mLastBrick(std::numeric_limits<size_t>::max()),
+            mLastSlot(0),
+            mLastData(nullptr)
+        {
+        }
+
+        // Object copies are not allowed.
+        BrickedImage3(BrickedImage3 const&) = delete;
+        BrickedImage3& operator=(BrickedImage3 const&) = delete;
+
+        // Map an existing raw file.  The file must have at least
+        // headerBytes + dim0*dim1*dim2*sizeof(PixelType) bytes, and
+        // headerBytes must be a multiple of the alignment of PixelType.
+        bool OpenRaw(std::string const& filename, int dimension0, int dimension1,
+            int dimension2, bool writable, uint64_t headerBytes = 0)
+        {
+            Close();
+            if (!SetDimensions(dimension0, dimension1, dimension2)
+                || headerBytes % alignof(PixelType) != 0
+                || !mMappedFile.Open(filename, writable))
+            {
+                return false;
+            }
+
+            if (mMappedFile.GetSize() < headerBytes + GetNumPixels() * sizeof(PixelType))
+            {
+                Close();
+                return false;
+            }
+
+            mMapped = reinterpret_cast<PixelType*>(mMappedFile.GetData() + headerBytes);
+            mWritable = writable;
+            return true;
+        }
+
+        // Create a raw file with all voxels zero and map it.
+        bool CreateRaw(std::string const& filename, int dimension0, int dimension1,
+            int dimension2)
+        {
+            Close();
+            if (!SetDimensions(dimension0, dimension1, dimension2)
+                || !mMappedFile.Create(filename, GetNumPixels() * sizeof(PixelType)))
+            {
+                return false;
+            }
+
+            mMapped = reinterpret_cast<PixelType*>(mMappedFile.GetData());
+            mWritable = true;
+            return true;
+        }
+
+        // Create a brick file with all voxels zero.
+        bool CreateBricked(std::string const& filename, int dimension0, int dimension1,
+            int dimension2, std::array<int, 3> const& brickDims, bool compressed,
+            size_t cacheBytes)
+        {
+            Close();
+            if (!SetDimensions(dimension0, dimension1, dimension2)
+                || !mBrickFile.Create(filename, { { dimension0, dimension1, dimension2 } },
+                    brickDims, static_cast<int>(sizeof(PixelType)), compressed))
+            {
+                return false;
+            }
+
+            mWritable = true;
+            return InitializeCache(cacheBytes);
+        }
+
+        // Open an existing brick file whose pixel size is sizeof(PixelType).
+        bool OpenBricked(std::string const& filename, bool writable, size_t cacheBytes)
+        {
+            Close();
+            if (!mBrickFile.Open(filename, writable))
+            {
+                return false;
+            }
+
+            std::array<int, 3> const& dims = mBrickFile.GetDimensions();
+            if (mBrickFile.GetPixelSize() != static_cast<int>(sizeof(PixelType))
+                || !SetDimensions(dims[0], dims[1], dims[2]))
+            {
+                Close();
+                return false;
+            }
+
+            mWritable = writable;
+            return InitializeCache(cacheBytes);
+        }
+
+        // Write the modified bricks in the cache to the file.  For a raw
+        // file, the operating system writes the modified pages.
+        bool Flush()
+        {
+            bool success = true;
+            for (auto& slot : mSlots)
+            {
+                if (slot.modified)
+                {
+                    success = mBrickFile.WriteBrick(slot.brick, slot.data.data()) && success;
+                    slot.modified = false;
+                }
+            }
+            return success;
+        }
+
+        // Flush the cache and close the file.
+        bool Close()
+        {
+            bool success = true;
+            if (mBrickFile.IsOpen())
+            {
+                success = Flush();
+                success = mBrickFile.Close() && success;
+            }
+            mMappedFile.Close();
+            mMapped = nullptr;
+            mWritable = false;
+            mSlots.clear();
+            mSlotOfBrick.clear();
+            mLRU.clear();
+            mLRUPosition.clear();
+            mLastBrick = std::numeric_limits<size_t>::max();
+            mLastData = nullptr;
+            this->mDimensions.clear();
+            this->mOffsets.clear();
+            return success;
+        }
+
+        inline bool IsOpen() const
+        {
+            return mMapped != nullptr || mBrickFile.IsOpen();
+        }
+
+        inline bool IsMapped() const
+        {
+            return mMapped != nullptr;
+        }
+
+        inline bool IsWritable() const
+        {
+            return mWritable;
+        }
+
+        // The number of bricks in the cache, which is 0 for a raw file.
+        inline size_t GetCacheSize() const
+        {
+            return mSlots.size();
+        }
+
+        // Access to the image dimensions and the neighborhoods of Image3.
+        using Image<PixelType>::GetDimensions;
+        using Image<PixelType>::GetNumDimensions;
+        using Image<PixelType>::GetDimension;
+        using Image<PixelType>::GetOffsets;
+        using Image<PixelType>::GetOffset;
+        using Image3<PixelType>::GetIndex;
+        using Image3<PixelType>::GetCoordinates;
+        using Image3<PixelType>::GetNeighborhood;
+        using Image3<PixelType>::GetCorners;
+        using Image3<PixelType>::GetFull;
+
+        inline size_t GetNumPixels() const
+        {
+            return this->mDimensions.size() == 3 ?
+                this->mOffsets[2] * static_cast<size_t>(this->mDimensions[2]) : 0;
+        }
+
+        // Access the data as a 1-dimensional array.  The Get() functions
+        // clamp invalid i.
+        inline PixelType& operator[] (size_t i)
+        {
+            return mMapped ? mMapped[i] : Modify(i % this->mOffsets[1],
+                (i % this->mOffsets[2]) / this->mOffsets[1], i / this->mOffsets[2]);
+        }
+
+        inline PixelType const& operator[] (size_t i) const
+        {
+            return mMapped ? mMapped[i] : Voxel(i % this->mOffsets[1],
+                (i % this->mOffsets[2]) / this->mOffsets[1], i / this->mOffsets[2]);
+        }
+
+        inline PixelType& Get(size_t i)
+        {
+            return (*this)[i < GetNumPixels() ? i : 0];
+        }
+
+        inline PixelType const& Get(size_t i) const
+        {
+            return (*this)[i < GetNumPixels() ? i : 0];
+        }
+
+        // Access the data as a 3-dimensional array.  The Get() functions
+        // clamp invalid (x,y,z).
+        inline PixelType& operator() (int x, int y, int z)
+        {
+            return Modify(static_cast<size_t>(x), static_cast<size_t>(y), static_cast<size_t>(z));
+        }
+
+        inline PixelType const& operator() (int x, int y, int z) const
+        {
+            return Voxel(static_cast<size_t>(x), static_cast<size_t>(y), static_cast<size_t>(z));
+        }
+
+        inline PixelType& operator() (std::array<int, 3> const& coord)
+        {
+            return (*this)(coord[0], coord[1], coord[2]);
+        }
+
+        inline PixelType const& operator() (std::array<int, 3> const& coord) const
+        {
+            return (*this)(coord[0], coord[1], coord[2]);
+        }
+
+        inline PixelType& Get(int x, int y, int z)
+        {
+            Clamp(x, y, z);
+            return (*this)(x, y, z);
+        }
+
+        inline PixelType const& Get(int x, int y, int z) const
+        {
+            Clamp(x, y, z);
+            return (*this)(x, y, z);
+        }
+
+        inline PixelType& Get(std::array<int, 3> coord)
+        {
+            return Get(coord[0], coord[1], coord[2]);
+        }
+
+        inline PixelType const& Get(std::array<int, 3> coord) const
+        {
+            return Get(coord[0], coord[1], coord[2]);
+        }
+
+        // Copy the z-slices zmin <= z < zmax to an image of dimensions
+        // dim0-by-dim1-by-(zmax-zmin), or copy such an image to the z-slices
+        // starting at zmin.  The brick storage is accessed one brick at a
+        // time, so the cache needs only one brick.
+        bool GetSlab(int zmin, int zmax, Image3<PixelType>& slab) const
+        {
+            if (!IsOpen() || zmin < 0 || zmax > this->mDimensions[2] || zmin >= zmax)
+            {
+                return false;
+            }
+
+            int const dim0 = this->mDimensions[0], dim1 = this->mDimensions[1];
+            if (slab.GetNumDimensions() != 3 || slab.GetDimension(0) != dim0
+                || slab.GetDimension(1) != dim1 || slab.GetDimension(2) != zmax - zmin)
+            {
+                slab.Reconstruct(dim0, dim1, zmax - zmin);
+            }
+
+            PixelType* pixels = slab.GetPixels().data();
+            if (mMapped)
+            {
+                std::memcpy(pixels, mMapped + this->mOffsets[2] * zmin,
+                    slab.GetNumPixels() * sizeof(PixelType));
+                return true;
+            }
+
+            CopyBricks(zmin, zmax, [pixels](PixelType* brickRow, size_t slabIndex, size_t width)
+            {
+                std::memcpy(pixels + slabIndex, brickRow, width * sizeof(PixelType));
+            });
+            return true;
+        }
+
+        bool SetSlab(int zmin, Image3<PixelType> const& slab)
+        {
+            int const zmax = zmin + (slab.GetNumDimensions() == 3 ? slab.GetDimension(2) : 0);
+            if (!IsOpen() || !mWritable || zmin < 0 || zmax > this->mDimensions[2] || zmin >= zmax
+                || slab.GetDimension(0) != this->mDimensions[0]
+                || slab.GetDimension(1) != this->mDimensions[1])
+            {
+                return false;
+            }
+
+            PixelType const* pixels = slab.GetPixels().data();
+            if (mMapped)
+            {
+                std::memcpy(mMapped + this->mOffsets[2] * zmin, pixels,
+                    slab.GetNumPixels() * sizeof(PixelType));
+                return true;
+            }
+
+            CopyBricks(zmin, zmax, [this, pixels](PixelType* brickRow, size_t slabIndex, size_t width)
+            {
+                std::memcpy(brickRow, pixels + slabIndex, width * sizeof(PixelType));
+                mSlots[mLastSlot].modified = true;
+            });
+            return true;
+        }
+
+    private:
+        struct Slot
+        {
+            size_t brick;
+            bool modified;
+            std::vector<PixelType> data;
+        };
+
+        bool SetDimensions(int dimension0, int dimension1, int dimension2)
+        {
+            if (dimension0 <= 0 || dimension1 <= 0 || dimension2 <= 0)
+            {
+                return false;
+            }
+
+            this->mDimensions = { dimension0, dimension1, dimension2 };
+            size_t dim0 = static_cast<size_t>(dimension0);
+            this->mOffsets = { 1, dim0, dim0 * static_cast<size_t>(dimension1) };
+            return true;
+        }
+
+        bool InitializeCache(size_t cacheBytes)
+        {
+            std::array<int, 3> const& brickDims = mBrickFile.GetBrickDimensions();
+            for (int i = 0; i < 3; ++i)
+            {
+                if ((brickDims[i] & (brickDims[i] - 1)) != 0)
+                {
+                    Close();
+                    return false;
+                }
+
+                mBrickDims[i] = static_cast<size_t>(brickDims[i]);
+                mNumBricks[i] = static_cast<size_t>(mBrickFile.GetNumBricks()[i]);
+                mMask[i] = mBrickDims[i] - 1;
+                for (mShift[i] = 0; (static_cast<size_t>(1) << mShift[i]) < mBrickDims[i]; ++mShift[i])
+                {
+                }
+            }
+
+            // The slots are allocated when they are first used.  All slots
+            // are in the least-recently-used list, with the unused slots at
+            // the end.
+            size_t numSlots = std::max(cacheBytes / mBrickFile.GetBrickBytes(), static_cast<size_t>(1));
+            numSlots = std::min(numSlots, mBrickFile.GetNumBricksTotal());
+            mSlots.resize(numSlots);
+            mLRUPosition.resize(numSlots);
+            for (size_t s = 0; s < numSlots; ++s)
+            {
+                mSlots[s].brick = std::numeric_limits<size_t>::max();
+                mSlots[s].modified = false;
+                mLRUPosition[s] = mLRU.insert(mLRU.end(), s);
+            }
+            mSlotOfBrick.assign(mBrickFile.GetNumBricksTotal(), std::numeric_limits<size_t>::max());
+            return true;
+        }
+
+        inline void Clamp(int& x, int& y, int& z) const
+        {
+            x = std::min(std::max(x, 0), this->mDimensions[0] - 1);
+            y = std::min(std::max(y, 0), this->mDimensions[1] - 1);
+            z = std::min(std::max(z, 0), this->mDimensions[2] - 1);
+        }
+
+        inline PixelType& Voxel(size_t x, size_t y, size_t z) const
+        {
+            if (mMapped)
+            {
+                return mMapped[x + this->mOffsets[1] * y + this->mOffsets[2] * z];
+            }
+
+            size_t brick = (x >> mShift[0]) + mNumBricks[0] * ((y >> mShift[1]) + mNumBricks[1] * (z >> mShift[2]));
+            PixelType* data = (brick == mLastBrick ? mLastData : LoadBrick(brick));
+            return data[(x & mMask[0]) + mBrickDims[0] * ((y & mMask[1]) + mBrickDims[1] * (z & mMask[2]))];
+        }
+
+        inline PixelType& Modify(size_t x, size_t y, size_t z)
+        {
+            PixelType& voxel = Voxel(x, y, z);
+            if (!mMapped && mWritable)
+            {
+                mSlots[mLastSlot].modified = true;
+            }
+            return voxel;
+        }
+
+        PixelType* LoadBrick(size_t brick) const
+        {
+            size_t slot = mSlotOfBrick[brick];
+            if (slot == std::numeric_limits<size_t>::max())
+            {
+                slot = mLRU.back();
+                Slot& entry = mSlots[slot];
+                if (entry.brick != std::numeric_limits<size_t>::max())
+                {
+                    if (entry.modified && !mBrickFile.WriteBrick(entry.brick, entry.data.data()))
+                    {
+                        LogError("Failed to write brick " + std::to_string(entry.brick) + ".");
+                    }
+                    mSlotOfBrick[entry.brick] = std::numeric_limits<size_t>::max();
+                }
+
+                entry.data.resize(mBrickFile.GetBrickBytes() / sizeof(PixelType));
+                if (!mBrickFile.ReadBrick(brick, entry.data.data()))
+                {
+                    LogError("Failed to read brick " + std::to_string(brick) + ".");
+                    std::fill(entry.data.begin(), entry.data.end(), PixelType());
+                }
+                entry.brick = brick;
+                entry.modified = false;
+                mSlotOfBrick[brick] = slot;
+            }
+
+            mLRU.splice(mLRU.begin(), mLRU, mLRUPosition[slot]);
+            mLastBrick = brick;
+            mLastSlot = slot;
+            mLastData = mSlots[slot].data.data();
+            return mLastData;
+        }
+
+        // Call copy(brickRow, slabIndex, width) for the intersections of the
+        // rows of the bricks with the z-slices zmin <= z < zmax.
+        template <typename CopyRow>
+        void CopyBricks(int zmin, int zmax, CopyRow const& copy) const
+        {
+            size_t const dim0 = static_cast<size_t>(this->mDimensions[0]);
+            size_t const dim1 = static_cast<size_t>(this->mDimensions[1]);
+            size_t const z0 = static_cast<size_t>(zmin), z1 = static_cast<size_t>(zmax);
+            for (size_t bz = z0 >> mShift[2]; bz <= (z1 - 1) >> mShift[2]; ++bz)
+            {
+                size_t zBegin = std::max(z0, bz << mShift[2]);
+                size_t zEnd = std::min(z1, (bz + 1) << mShift[2]);
+                for (size_t by = 0; by < mNumBricks[1]; ++by)
+                {
+                    size_t yBegin = by << mShift[1];
+                    size_t yEnd = std::min(dim1, yBegin + mBrickDims[1]);
+                    for (size_t bx = 0; bx < mNumBricks[0]; ++bx)
+                    {
+                        size_t xBegin = bx << mShift[0];
+                        size_t width = std::min(dim0, xBegin + mBrickDims[0]) - xBegin;
+                        PixelType* data = LoadBrick(bx + mNumBricks[0] * (by + mNumBricks[1] * bz));
+                        for (size_t z = zBegin; z < zEnd; ++z)
+                        {
+                            for (size_t y = yBegin; y < yEnd; ++y)
+                            {
+                                size_t brickIndex = mBrickDims[0] * ((y & mMask[1]) + mBrickDims[1] * (z & mMask[2]));
+                                size_t slabIndex = xBegin + dim0 * (y + dim1 * (z - z0));
+                                copy(data + brickIndex, slabIndex, width);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Raw storage.
+        MemoryMappedFile mMappedFile;
+        PixelType* mMapped;
+        bool mWritable;
+
+        // Brick storage.  The cache is modified by const accesses.
+        mutable BrickFile mBrickFile;
+        std::array<size_t, 3> mBrickDims, mNumBricks, mMask, mShift;
+        mutable std::vector<Slot> mSlots;
+        mutable std::vector<size_t> mSlotOfBrick;
+        mutable std::list<size_t> mLRU;
+        std::vector<std::list<size_t>::iterator> mLRUPosition;
+        mutable size_t mLastBrick, mLastSlot;
+        mutable PixelType* mLastData;
+    };
+}
@@ -0,0 +1,94 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/08)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Connected component labeling of binary 2D and 3D images using run-length
+// encoding and union-find.  The image is processed as a sequence of rows,
+// row r = y + dim1*z containing the pixels (x,y,z) for 0 <= x < dim0.
+//   1. The maximal spans of nonzero pixels of each row are stored as runs.
+//      The rows are partitioned into blocks that are processed in parallel.
+//   2. The runs of each row are merged with the runs of the adjacent rows
+//      that precede it (y-1 in 2D; y-1 and z-1 in 3D) by union-find.  The
+//      pairs of rows in the same block are processed in parallel; the pairs
+//      crossing block boundaries are processed afterwards.
+//   3. The roots are the first runs of the components in raster order, so
+//      the labels 1, 2, ... are assigned in the order of the first pixels
+//      of the components, the same order as a raster-scan flood fill.
+// The cost is proportional to the number of pixels for step 1 and to the
+// number of runs for the other steps, and no per-pixel stack is required.
+//
+// The connectivity is 4 or 8 for 2D images (dim2 = 1) and 6, 18 or 26 for
+// 3D images.  Unlike the depth-first search used previously by
+// ImageUtility2 and ImageUtility3, the image boundary need not be zero.
+
+namespace gte
+{
+
+class GTE_IMPEXP ComponentLabeler
+{
+public:
+    // The number of pixels and the axis-aligned bounding box of a component.
+    // For 2D images, minimum[2] = maximum[2] = 0.
+    struct Component
+    {
+        size_t numElements;
+        std::array<int, 3> minimum, maximum;
+    };
+
+    ComponentLabeler(unsigned int numThreads = 1);
+
+    // The input mask has dim0*dim1*dim2 pixels, where the nonzero pixels are
+    // foreground.  On output, labels[i] is 0 for background pixels and k in
+    // {1,...,numComponents} for the pixels of component k.  The labels and
+    // mask arrays may be the same array.  The return value is the number of
+    // components.  The function returns 0 and does not modify 'labels' when
+    // the connectivity is not valid for the dimensions.
+    int Execute(int dim0, int dim1, int dim2, int connectivity,
+        int const* mask, int* labels);
+
+    // Access to the results of the last call to Execute.  The component
+    // statistics are computed from the runs, not from the label image.  The
+    // arrays have numComponents+1 elements; element 0 is unused so that the
+    // arrays are indexed by label.
+    void GetComponents(std::vector<Component>& components) const;
+    void GetComponents(std::vector<std::vector<size_t>>& components) const;
+
+private:
+    // Step 1.  Compute the runs of the rows.
+    void CreateRuns(int const* mask);
+
+    // Step 2.  Merge the runs of row r = y + dim1*z with the runs of the
+    // row (y-dy,z-dz) when their x-intervals overlap after being expanded
+    // by 'slack' (0 or 1).  The function does nothing when the adjacent row
+    // is not in the image or not in the range [rowMin,rowMax).
+    void MergeRows(int r, int dy, int dz, int slack, int rowMin, int rowMax);
+    int Find(int run);
+    void Union(int run0, int run1);
+
+    // Step 3.  Assign the labels of the runs.
+    int AssignLabels();
+
+    template <typename Function>
+    void Execute(int numItems, Function const& function);
+
+    unsigned int mNumThreads;
+    int mDim0, mDim1, mDim2, mNumRows, mConnectivity;
+
+    // The runs of row r are mRunStart[r] <= k < mRunStart[r+1] and consist
+    // of the pixels mRunX0[k] <= x <= mRunX1[k].  The mRunParent array is
+    // used by union-find and then stores the labels of the runs.
+    std::vector<int> mRunStart, mRunX0, mRunX1, mRunParent;
+    int mNumComponents;
+};
+
+}
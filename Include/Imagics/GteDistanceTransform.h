@@ -0,0 +1,88 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/09)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Exact Euclidean distance transform of binary 2D and 3D images.  The
+// transform is separable: the squared distance to the nearest feature pixel
+// is computed along the x-axis, then along the y-axis from the x-results,
+// then along the z-axis from the y-results.  Each 1D transform is the lower
+// envelope of the parabolas (u-i)^2 + f(i), which is computed in linear time
+// as described in
+//   P. F. Felzenszwalb and D. P. Huttenlocher, "Distance Transforms of
+//   Sampled Functions," Theory of Computing, 8(19), pp. 415-428, 2012
+//   A. Meijster, J. B. T. M. Roerdink and W. H. Hesselink, "A General
+//   Algorithm for Computing Distance Transforms in Linear Time,"
+//   Mathematical Morphology and its Applications to Image and Signal
+//   Processing, pp. 331-340, 2000
+// All arithmetic is integer arithmetic, so the distances are exact.  The
+// lines of each pass are independent and are distributed over the threads.
+// When several feature pixels are at the same distance, the one with the
+// smallest index is chosen, so the output does not depend on the number of
+// threads.
+
+namespace gte
+{
+
+class GTE_IMPEXP DistanceTransform
+{
+public:
+    DistanceTransform(unsigned int numThreads = 1);
+
+    // The mask has dim0*dim1*dim2 pixels, where the nonzero pixels are the
+    // object and the zero pixels are the background; use dim2 = 1 for 2D
+    // images.  For an object pixel, sqrDistance[i] is the squared distance
+    // to the nearest background pixel and nearest[i] is the index of that
+    // pixel.  For a background pixel, sqrDistance[i] is 0 and nearest[i] is
+    // i when 'isSigned' is false.  When 'isSigned' is true, sqrDistance[i]
+    // is the negative of the squared distance to the nearest object pixel
+    // and nearest[i] is the index of that pixel.  If the image has no pixels
+    // of the other type, sqrDistance[i] is +-std::numeric_limits<int>::max()
+    // and nearest[i] is -1.  The 'nearest' array may be null.  The squared
+    // diagonal length dim0^2+dim1^2+dim2^2 must be smaller than 2^31.  The
+    // function returns false when the inputs are not valid.
+    bool Execute(int dim0, int dim1, int dim2, int const* mask,
+        bool isSigned, int* sqrDistance, int* nearest);
+
+private:
+    // Compute the unsigned transform for the feature pixels with
+    // (mask[i] != 0) equal to 'featureValue'.
+    void Transform(int const* mask, bool featureValue, int* sqrDistance,
+        int* nearest);
+
+    // Scratch arrays for the 1D transforms, one set per thread.  The block
+    // arrays store groups of lines that are not contiguous in the image.
+    struct Scratch
+    {
+        std::vector<int64_t> f;
+        std::vector<int> index, site, start;
+        std::vector<int> blockSqrDistance, blockNearest;
+    };
+
+    // Compute the 1D transforms of the lines along the specified axis.
+    void TransformLines(int axis, int* sqrDistance, int* nearest);
+
+    // Compute the 1D transform of the line with n elements sqrDistance[i]
+    // and nearest[i] for i = stride*u, 0 <= u < n.
+    static void TransformLine(int n, size_t stride, int* sqrDistance,
+        int* nearest, Scratch& scratch);
+
+    template <typename Function>
+    void Execute(int numItems, Function const& function);
+
+    unsigned int mNumThreads;
+    int mDim[3];
+    std::vector<Scratch> mScratch;
+    std::vector<int> mOtherSqrDistance, mOtherNearest, mNearest;
+};
+
+}
@@ -0,0 +1,284 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/11)
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Base class for solvers of the eikonal equation |grad(T)| = 1/F on 2D and
+// 3D grids, where F > 0 is the speed and T is the crossing time of a front
+// that starts at the seed points.  The seeds, speeds and the classification
+// of the grid points are the same as for FastMarch2 and FastMarch3: the
+// seed points have time 0, points with zero speed have time -maxReal and
+// are never visited, and points not yet reached have time maxReal, where
+// maxReal is std::numeric_limits<Real>::max().  The points on the grid
+// boundary are marked as zero speed so that neighbors are never out of
+// range.  For 2D grids, zBound is 1.
+
+namespace gte
+{
+    template <typename Real>
+    class EikonalGrid
+    {
+    public:
+        virtual ~EikonalGrid()
+        {
+        }
+
+        // Member access.
+        inline size_t GetQuantity() const
+        {
+            return mQuantity;
+        }
+
+        inline size_t GetXBound() const
+        {
+            return mXBound;
+        }
+
+        inline size_t GetYBound() const
+        {
+            return mYBound;
+        }
+
+        inline size_t GetZBound() const
+        {
+            return mZBound;
+        }
+
+        inline Real GetXSpacing() const
+        {
+            return mSpacing[0];
+        }
+
+        inline Real GetYSpacing() const
+        {
+            return mSpacing[1];
+        }
+
+        inline Real GetZSpacing() const
+        {
+            return mSpacing[2];
+        }
+
+        inline size_t Index(size_t x, size_t y, size_t z = 0) const
+        {
+            return x + mXBound * (y + mYBound * z);
+        }
+
+        inline Real GetTime(size_t i) const
+        {
+            return mTimes[i];
+        }
+
+        inline std::vector<Real> const& GetTimes() const
+        {
+            return mTimes;
+        }
+
+        void GetTimeExtremes(Real& minValue, Real& maxValue) const
+        {
+            minValue = std::numeric_limits<Real>::max();
+            maxValue = -std::numeric_limits<Real>::max();
+            for (size_t i = 0; i < mQuantity; ++i)
+            {
+                if (IsValid(i))
+                {
+                    minValue = std::min(minValue, mTimes[i]);
+                    maxValue = std::max(maxValue, mTimes[i]);
+                }
+            }
+        }
+
+        // Grid point classification.
+        inline bool IsValid(size_t i) const
+        {
+            return (Real)0 <= mTimes[i] && mTimes[i] < std::numeric_limits<Real>::max();
+        }
+
+        inline bool IsFar(size_t i) const
+        {
+            return mTimes[i] == std::numeric_limits<Real>::max();
+        }
+
+        inline bool IsZeroSpeed(size_t i) const
+        {
+            return mTimes[i] == -std::numeric_limits<Real>::max();
+        }
+
+        // Compute the crossing times of all grid points that can be reached
+        // from the seeds.
+        virtual void Execute() = 0;
+
+    protected:
+        // Construction for 2D grids.
+        EikonalGrid(size_t xBound, size_t yBound, Real xSpacing, Real ySpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const& speeds)
+        {
+            Initialize(xBound, yBound, 1, xSpacing, ySpacing, (Real)1, seeds, &speeds, (Real)1);
+        }
+
+        EikonalGrid(size_t xBound, size_t yBound, Real xSpacing, Real ySpacing,
+            std::vector<size_t> const& seeds, Real speed)
+        {
+            Initialize(xBound, yBound, 1, xSpacing, ySpacing, (Real)1, seeds, nullptr, speed);
+        }
+
+        // Construction for 3D grids.
+        EikonalGrid(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const& speeds)
+        {
+            Initialize(xBound, yBound, zBound, xSpacing, ySpacing, zSpacing, seeds, &speeds, (Real)1);
+        }
+
+        EikonalGrid(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, Real speed)
+        {
+            Initialize(xBound, yBound, zBound, xSpacing, ySpacing, zSpacing, seeds, nullptr, speed);
+        }
+
+        void Initialize(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const* speeds,
+            Real speed)
+        {
+            Real const maxReal = std::numeric_limits<Real>::max();
+            mXBound = xBound;
+            mYBound = yBound;
+            mZBound = zBound;
+            mQuantity = xBound * yBound * zBound;
+            mNumAxes = (zBound > 1 ? 3 : 2);
+            mSpacing[0] = xSpacing;
+            mSpacing[1] = ySpacing;
+            mSpacing[2] = zSpacing;
+            mOffset[0] = 1;
+            mOffset[1] = xBound;
+            mOffset[2] = xBound * yBound;
+            for (int j = 0; j < 3; ++j)
+            {
+                mInvSpacingSqr[j] = (Real)1 / (mSpacing[j] * mSpacing[j]);
+            }
+
+            mTimes.assign(mQuantity, maxReal);
+            mInvSpeeds.resize(mQuantity);
+            for (auto seed : seeds)
+            {
+                mTimes[seed] = (Real)0;
+            }
+
+            for (size_t i = 0; i < mQuantity; ++i)
+            {
+                Real s = (speeds ? (*speeds)[i] : speed);
+                if (s > (Real)0)
+                {
+                    mInvSpeeds[i] = (Real)1 / s;
+                }
+                else
+                {
+                    mInvSpeeds[i] = maxReal;
+                    mTimes[i] = -maxReal;
+                }
+            }
+
+            // Boundary points are marked as zero speed to avoid having to
+            // process them separately.
+            size_t const lastX = xBound - 1, lastY = yBound - 1, lastZ = zBound - 1;
+            for (size_t z = 0; z < zBound; ++z)
+            {
+                bool zBoundary = (mNumAxes == 3 && (z == 0 || z == lastZ));
+                for (size_t y = 0; y < yBound; ++y)
+                {
+                    bool yzBoundary = (zBoundary || y == 0 || y == lastY);
+                    for (size_t x = 0; x < xBound; ++x)
+                    {
+                        if (yzBoundary || x == 0 || x == lastX)
+                        {
+                            size_t i = Index(x, y, z);
+                            mInvSpeeds[i] = maxReal;
+                            mTimes[i] = -maxReal;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Solve the upwind discretization of the eikonal equation at grid
+        // point i using the neighbors j for which usable(j) is true,
+        //   sum_{axes} ((T - a[k]) / h[k])^2 = (1/F)^2
+        // where a[k] is the minimum time of the usable neighbors along axis
+        // k.  The axes are included in increasing order of a[k] as long as
+        // the solution is larger than a[k].  The function returns maxReal
+        // when no neighbor is usable.
+        template <typename Usable>
+        Real Solve(size_t i, Usable const& usable) const
+        {
+            Real const maxReal = std::numeric_limits<Real>::max();
+            Real a[3], w[3];
+            int numTerms = 0;
+            for (int j = 0; j < mNumAxes; ++j)
+            {
+                size_t iM = i - mOffset[j], iP = i + mOffset[j];
+                Real t = maxReal;
+                if (usable(iM))
+                {
+                    t = mTimes[iM];
+                }
+                if (usable(iP) && mTimes[iP] < t)
+                {
+                    t = mTimes[iP];
+                }
+
+                if (t < maxReal)
+                {
+                    // Insertion sort by time.
+                    int k = numTerms++;
+                    for (; k > 0 && a[k - 1] > t; --k)
+                    {
+                        a[k] = a[k - 1];
+                        w[k] = w[k - 1];
+                    }
+                    a[k] = t;
+                    w[k] = mInvSpacingSqr[j];
+                }
+            }
+
+            Real const invSpeed = mInvSpeeds[i];
+            Real sumW = (Real)0, sumWA = (Real)0, sumWAA = -invSpeed * invSpeed;
+            Real time = maxReal;
+            for (int k = 0; k < numTerms; ++k)
+            {
+                sumW += w[k];
+                sumWA += w[k] * a[k];
+                sumWAA += w[k] * a[k] * a[k];
+                Real discr = sumWA * sumWA - sumW * sumWAA;
+                if (discr < (Real)0)
+                {
+                    break;
+                }
+
+                time = (sumWA + std::sqrt(discr)) / sumW;
+                if (k + 1 < numTerms && time <= a[k + 1])
+                {
+                    break;
+                }
+            }
+            return time;
+        }
+
+        size_t mXBound, mYBound, mZBound, mQuantity;
+        int mNumAxes;
+        Real mSpacing[3], mInvSpacingSqr[3];
+        size_t mOffset[3];
+        std::vector<Real> mTimes;
+        std::vector<Real> mInvSpeeds;
+    };
+}
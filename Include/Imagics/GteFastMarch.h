@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.23.0 (2019/03/18)
+// File Version: 3.23.1 (2019/09/11)
 
 #pragma once
 
@@ -184,6 +184,12 @@ namespace gte
         // Run one step of the fast marching algorithm.
         virtual void Iterate() = 0;
 
+        // The algorithm is finished when there are no trial pixels.
+        inline int GetNumTrials() const
+        {
+            return mHeap.GetNumElements();
+        }
+
     protected:
         size_t mQuantity;
         std::vector<Real> mTimes;
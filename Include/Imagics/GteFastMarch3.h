@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.23.0 (2019/03/18)
+// File Version: 3.23.1 (2019/09/11)
 
 #pragma once
 
@@ -337,6 +337,48 @@ namespace gte
                 this->mTimes[i] = -std::numeric_limits<Real>::max();
             }
 
+            // faces (x,y,0) and (x,y,zmax)
+            for (y = 1; y < mYBoundM1; ++y)
+            {
+                for (x = 1; x < mXBoundM1; ++x)
+                {
+                    i = Index(x, y, 0);
+                    this->mInvSpeeds[i] = std::numeric_limits<Real>::max();
+                    this->mTimes[i] = -std::numeric_limits<Real>::max();
+                    i = Index(x, y, mZBoundM1);
+                    this->mInvSpeeds[i] = std::numeric_limits<Real>::max();
+                    this->mTimes[i] = -std::numeric_limits<Real>::max();
+                }
+            }
+
+            // faces (x,0,z) and (x,ymax,z)
+            for (z = 1; z < mZBoundM1; ++z)
+            {
+                for (x = 1; x < mXBoundM1; ++x)
+                {
+                    i = Index(x, 0, z);
+                    this->mInvSpeeds[i] = std::numeric_limits<Real>::max();
+                    this->mTimes[i] = -std::numeric_limits<Real>::max();
+                    i = Index(x, mYBoundM1, z);
+                    this->mInvSpeeds[i] = std::numeric_limits<Real>::max();
+                    this->mTimes[i] = -std::numeric_limits<Real>::max();
+                }
+            }
+
+            // faces (0,y,z) and (xmax,y,z)
+            for (z = 1; z < mZBoundM1; ++z)
+            {
+                for (y = 1; y < mYBoundM1; ++y)
+                {
+                    i = Index(0, y, z);
+                    this->mInvSpeeds[i] = std::numeric_limits<Real>::max();
+                    this->mTimes[i] = -std::numeric_limits<Real>::max();
+                    i = Index(mXBoundM1, y, z);
+                    this->mInvSpeeds[i] = std::numeric_limits<Real>::max();
+                    this->mTimes[i] = -std::numeric_limits<Real>::max();
+                }
+            }
+
             // Compute the first batch of trial pixels.  These are pixels a grid
             // distance of one away from the seed pixels.
             for (z = 1; z < mZBoundM1; ++z)
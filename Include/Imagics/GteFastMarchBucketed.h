@@ -0,0 +1,196 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/11)
+
+#pragma once
+
+#include <Imagics/GteEikonalGrid.h>
+#include <cstdint>
+
+// Fast marching with an untidy priority queue instead of the min-heap of
+// FastMarch2 and FastMarch3.  The trial points are stored in buckets of
+// times [k*delta,(k+1)*delta), and the buckets form a circular array that
+// covers the range of times of the trial points.  The points of a bucket
+// are accepted in first-in-first-out order, so insertions and removals
+// cost O(1) and the algorithm is O(n).  A point whose time decreases is
+// inserted again; its older entry is detected and skipped when it is
+// removed.  The points accepted in the same bucket are not sorted, which
+// introduces an error of the order of delta.  The default delta is 1/8 of
+// the smallest time increment between neighbors, min(h)/max(F), for which
+// the error is smaller than that of the min-heap version.  Larger values
+// of delta are not faster, because more points are inserted again.  See
+//   L. Yatziv, A. Bartesaghi and G. Sapiro, "O(N) implementation of the
+//   fast marching algorithm," Journal of Computational Physics, 212(2),
+//   pp. 393-399, 2006.
+
+namespace gte
+{
+    template <typename Real>
+    class FastMarchBucketed : public EikonalGrid<Real>
+    {
+    public:
+        // Construction and destruction.  The inputs are the same as for
+        // FastMarch2 and FastMarch3.
+        FastMarchBucketed(size_t xBound, size_t yBound, Real xSpacing, Real ySpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const& speeds)
+            :
+            EikonalGrid<Real>(xBound, yBound, xSpacing, ySpacing, seeds, speeds),
+            mBucketWidth((Real)0)
+        {
+        }
+
+        FastMarchBucketed(size_t xBound, size_t yBound, Real xSpacing, Real ySpacing,
+            std::vector<size_t> const& seeds, Real speed)
+            :
+            EikonalGrid<Real>(xBound, yBound, xSpacing, ySpacing, seeds, speed),
+            mBucketWidth((Real)0)
+        {
+        }
+
+        FastMarchBucketed(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const& speeds)
+            :
+            EikonalGrid<Real>(xBound, yBound, zBound, xSpacing, ySpacing, zSpacing, seeds, speeds),
+            mBucketWidth((Real)0)
+        {
+        }
+
+        FastMarchBucketed(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, Real speed)
+            :
+            EikonalGrid<Real>(xBound, yBound, zBound, xSpacing, ySpacing, zSpacing, seeds, speed),
+            mBucketWidth((Real)0)
+        {
+        }
+
+        virtual ~FastMarchBucketed()
+        {
+        }
+
+        // The width delta of the buckets.  A width of 0 selects the default
+        // width.  The number of buckets is at most 65536, so the width is
+        // increased when necessary to cover the largest time increment.
+        inline void SetBucketWidth(Real width)
+        {
+            mBucketWidth = width;
+        }
+
+        inline Real GetBucketWidth() const
+        {
+            return mBucketWidth;
+        }
+
+        virtual void Execute() override
+        {
+            size_t const quantity = this->mQuantity;
+            std::vector<Real>& times = this->mTimes;
+
+            // The seeds are the accepted points.  The time increment between
+            // a point and an accepted neighbor is at most h*(1/F).
+            Real minSpacing = std::min(this->mSpacing[0], this->mSpacing[1]);
+            Real maxSpacing = std::max(this->mSpacing[0], this->mSpacing[1]);
+            if (this->mNumAxes == 3)
+            {
+                minSpacing = std::min(minSpacing, this->mSpacing[2]);
+                maxSpacing = std::max(maxSpacing, this->mSpacing[2]);
+            }
+
+            std::vector<uint8_t> accepted(quantity, 0);
+            Real minInvSpeed = std::numeric_limits<Real>::max(), maxInvSpeed = (Real)0;
+            for (size_t i = 0; i < quantity; ++i)
+            {
+                if (!this->IsZeroSpeed(i))
+                {
+                    accepted[i] = (times[i] == (Real)0 ? 1 : 0);
+                    minInvSpeed = std::min(minInvSpeed, this->mInvSpeeds[i]);
+                    maxInvSpeed = std::max(maxInvSpeed, this->mInvSpeeds[i]);
+                }
+            }
+            if (maxInvSpeed == (Real)0)
+            {
+                return;
+            }
+
+            size_t const maxBuckets = 65536;
+            Real const maxIncrement = maxSpacing * maxInvSpeed;
+            Real delta = (mBucketWidth > (Real)0 ? mBucketWidth : minSpacing * minInvSpeed / (Real)8);
+            if (maxIncrement / delta > static_cast<Real>(maxBuckets - 2))
+            {
+                delta = maxIncrement / static_cast<Real>(maxBuckets - 2);
+            }
+            mBucketWidth = delta;
+            size_t const numBuckets = static_cast<size_t>(std::ceil(maxIncrement / delta)) + 2;
+
+            struct Entry
+            {
+                size_t index;
+                Real time;
+            };
+            std::vector<std::vector<Entry>> buckets(numBuckets);
+            size_t current = 0, numPending = 0;
+
+            auto usable = [&accepted](size_t j)
+            {
+                return accepted[j] != 0;
+            };
+
+            auto visit = [this, &times, &accepted, &buckets, &current, &numPending,
+                numBuckets, delta, &usable](size_t i)
+            {
+                for (int j = 0; j < this->mNumAxes; ++j)
+                {
+                    size_t neighbor[2] = { i - this->mOffset[j], i + this->mOffset[j] };
+                    for (auto n : neighbor)
+                    {
+                        if (!accepted[n] && !this->IsZeroSpeed(n))
+                        {
+                            Real t = this->Solve(n, usable);
+                            if (t < times[n])
+                            {
+                                times[n] = t;
+                                size_t k = std::max(current, static_cast<size_t>(t / delta));
+                                buckets[k % numBuckets].push_back({ n, t });
+                                ++numPending;
+                            }
+                        }
+                    }
+                }
+            };
+
+            for (size_t i = 0; i < quantity; ++i)
+            {
+                if (accepted[i])
+                {
+                    visit(i);
+                }
+            }
+
+            while (numPending > 0)
+            {
+                // The points inserted while the bucket is processed are
+                // appended to it, so the loop uses indices.
+                std::vector<Entry>& bucket = buckets[current % numBuckets];
+                for (size_t e = 0; e < bucket.size(); ++e)
+                {
+                    Entry entry = bucket[e];
+                    --numPending;
+                    if (!accepted[entry.index] && entry.time == times[entry.index])
+                    {
+                        accepted[entry.index] = 1;
+                        visit(entry.index);
+                    }
+                }
+                bucket.clear();
+                ++current;
+            }
+        }
+
+    private:
+        Real mBucketWidth;
+    };
+}
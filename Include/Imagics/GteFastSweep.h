@@ -0,0 +1,242 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/11)
+
+#pragma once
+
+#include <Imagics/GteEikonalGrid.h>
+#include <thread>
+
+// Fast sweeping solver of the eikonal equation.  The grid points are updated
+// by Gauss-Seidel iterations with the upwind discretization of FastMarch2
+// and FastMarch3, alternating the 2^d orderings of the grid (increasing or
+// decreasing along each axis).  Each characteristic direction of the
+// solution is handled by one of the orderings, so for constant speed a few
+// iterations are sufficient.  An iteration consists of all the orderings
+// and the iterations stop when the largest change of a time is at most the
+// tolerance.  There is no priority queue, so the cost per point and per
+// iteration is small and the memory accesses are sequential.  See
+//   H. Zhao, "A fast sweeping method for eikonal equations," Mathematics of
+//   Computation, 74(250), pp. 603-627, 2005.
+//
+// For multithreading, the grid is partitioned into slabs along the last
+// axis and each slab is swept independently, using the values of its
+// neighboring slabs as boundary values.  The even-numbered slabs are
+// processed concurrently, followed by the odd-numbered slabs, so that two
+// slabs that share a face are never processed at the same time.  The
+// information crosses the slab faces once per iteration, so more
+// iterations are needed than for a single slab.  See
+//   H. Zhao, "Parallel implementations of the fast sweeping method,"
+//   Journal of Computational Mathematics, 25(4), pp. 421-429, 2007.
+
+namespace gte
+{
+    template <typename Real>
+    class FastSweep : public EikonalGrid<Real>
+    {
+    public:
+        // Construction and destruction.  The inputs are the same as for
+        // FastMarch2 and FastMarch3, plus the number of threads.
+        FastSweep(size_t xBound, size_t yBound, Real xSpacing, Real ySpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const& speeds,
+            unsigned int numThreads = 1)
+            :
+            EikonalGrid<Real>(xBound, yBound, xSpacing, ySpacing, seeds, speeds)
+        {
+            Initialize(numThreads);
+        }
+
+        FastSweep(size_t xBound, size_t yBound, Real xSpacing, Real ySpacing,
+            std::vector<size_t> const& seeds, Real speed,
+            unsigned int numThreads = 1)
+            :
+            EikonalGrid<Real>(xBound, yBound, xSpacing, ySpacing, seeds, speed)
+        {
+            Initialize(numThreads);
+        }
+
+        FastSweep(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, std::vector<Real> const& speeds,
+            unsigned int numThreads = 1)
+            :
+            EikonalGrid<Real>(xBound, yBound, zBound, xSpacing, ySpacing, zSpacing, seeds, speeds)
+        {
+            Initialize(numThreads);
+        }
+
+        FastSweep(size_t xBound, size_t yBound, size_t zBound,
+            Real xSpacing, Real ySpacing, Real zSpacing,
+            std::vector<size_t> const& seeds, Real speed,
+            unsigned int numThreads = 1)
+            :
+            EikonalGrid<Real>(xBound, yBound, zBound, xSpacing, ySpacing, zSpacing, seeds, speed)
+        {
+            Initialize(numThreads);
+        }
+
+        virtual ~FastSweep()
+        {
+        }
+
+        // The iterations stop when the largest change of a time is at most
+        // the tolerance or when the maximum number of iterations is reached.
+        // The defaults are 0 and 1000.  A tolerance of 0 computes the fixed
+        // point of the Gauss-Seidel iterations.
+        inline void SetTolerance(Real tolerance)
+        {
+            mTolerance = tolerance;
+        }
+
+        inline Real GetTolerance() const
+        {
+            return mTolerance;
+        }
+
+        inline void SetMaxIterations(int maxIterations)
+        {
+            mMaxIterations = maxIterations;
+        }
+
+        inline int GetMaxIterations() const
+        {
+            return mMaxIterations;
+        }
+
+        // The number of iterations of the last call to Execute().
+        inline int GetNumIterations() const
+        {
+            return mNumIterations;
+        }
+
+        virtual void Execute() override
+        {
+            // The interior grid points along the last axis are partitioned
+            // into an even number of slabs, two per thread.
+            size_t const numLayers = (this->mNumAxes == 3 ? this->mZBound : this->mYBound) - 2;
+            size_t numSlabs = 2 * static_cast<size_t>(mNumThreads);
+            if (numSlabs > numLayers)
+            {
+                numSlabs = 1;
+            }
+
+            std::vector<Real> maxChange(numSlabs);
+            for (mNumIterations = 0; mNumIterations < mMaxIterations; )
+            {
+                ++mNumIterations;
+                for (size_t parity = 0; parity < 2; ++parity)
+                {
+                    size_t numActive = (numSlabs - parity + 1) / 2;
+                    auto sweepSlab = [this, numLayers, numSlabs, parity, &maxChange](size_t k)
+                    {
+                        size_t s = 2 * k + parity;
+                        size_t lmin = 1 + (s * numLayers) / numSlabs;
+                        size_t lmax = 1 + ((s + 1) * numLayers) / numSlabs;
+                        maxChange[s] = SweepSlab(lmin, lmax);
+                    };
+
+                    if (numActive > 1)
+                    {
+                        std::vector<std::thread> process(numActive);
+                        for (size_t k = 0; k < numActive; ++k)
+                        {
+                            process[k] = std::thread([&sweepSlab, k]()
+                            {
+                                sweepSlab(k);
+                            });
+                        }
+
+                        for (auto& p : process)
+                        {
+                            p.join();
+                        }
+                    }
+                    else if (numActive == 1)
+                    {
+                        sweepSlab(0);
+                    }
+                }
+
+                if (*std::max_element(maxChange.begin(), maxChange.end()) <= mTolerance)
+                {
+                    break;
+                }
+            }
+        }
+
+    private:
+        void Initialize(unsigned int numThreads)
+        {
+            mNumThreads = (numThreads > 0 ? numThreads : 1);
+            mTolerance = (Real)0;
+            mMaxIterations = 1000;
+            mNumIterations = 0;
+        }
+
+        // Apply the 2^d sweeps to the grid points with last coordinate in
+        // [lmin,lmax) and return the largest change of a time.
+        Real SweepSlab(size_t lmin, size_t lmax)
+        {
+            size_t const xMax = this->mXBound - 1;
+            size_t const yMax = (this->mNumAxes == 3 ? this->mYBound - 1 : lmax);
+            size_t const yMin = (this->mNumAxes == 3 ? 1 : lmin);
+            size_t const zMin = (this->mNumAxes == 3 ? lmin : 0);
+            size_t const zMax = (this->mNumAxes == 3 ? lmax : 1);
+            int const numSweeps = (this->mNumAxes == 3 ? 8 : 4);
+
+            auto usable = [this](size_t j)
+            {
+                return this->IsValid(j);
+            };
+
+            Real maxChange = (Real)0;
+            for (int sweep = 0; sweep < numSweeps; ++sweep)
+            {
+                bool xDecreasing = ((sweep & 1) != 0);
+                bool yDecreasing = ((sweep & 2) != 0);
+                bool zDecreasing = ((sweep & 4) != 0);
+                for (size_t zs = zMin; zs < zMax; ++zs)
+                {
+                    size_t z = (zDecreasing ? zMax - 1 - (zs - zMin) : zs);
+                    for (size_t ys = yMin; ys < yMax; ++ys)
+                    {
+                        size_t y = (yDecreasing ? yMax - 1 - (ys - yMin) : ys);
+                        size_t const rowBase = this->Index(0, y, z);
+                        for (size_t xs = 1; xs < xMax; ++xs)
+                        {
+                            size_t i = rowBase + (xDecreasing ? xMax - xs : xs);
+                            Real& time = this->mTimes[i];
+                            if (time <= (Real)0)
+                            {
+                                // Seed or zero speed.
+                                continue;
+                            }
+
+                            Real t = this->Solve(i, usable);
+                            if (t < time)
+                            {
+                                if (time < std::numeric_limits<Real>::max())
+                                {
+                                    maxChange = std::max(maxChange, time - t);
+                                }
+                                else
+                                {
+                                    maxChange = std::numeric_limits<Real>::max();
+                                }
+                                time = t;
+                            }
+                        }
+                    }
+                }
+            }
+            return maxChange;
+        }
+
+        unsigned int mNumThreads;
+        Real mTolerance;
+        int mMaxIterations, mNumIterations;
+    };
+}
@@ -3,13 +3,21 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.2 (2019/09/14)
 
 #pragma once
 
 #include <GTEngineDEF.h>
 #include <vector>
 
+// The histogram is computed in parallel when numThreads > 1.  Each thread
+// counts a contiguous range of the samples in its own subhistogram and the
+// subhistograms are added.  The samples are processed in blocks; the bucket
+// indices of a block are computed by a loop without branches, which the
+// compiler vectorizes, and then the buckets are incremented.  Consecutive
+// samples increment different copies of the buckets, so that runs of equal
+// samples do not serialize on the same counter.
+
 namespace gte
 {
 
@@ -22,9 +30,23 @@ public:
     // {0,1,...,numBuckets-1}, but in the event of out-of-range values, the
     // histogram stores a count for those numbers smaller than 0 and those
     // numbers larger or equal to numBuckets.
-    Histogram(int numBuckets, int numSamples, int const* samples, bool noRescaling);
-    Histogram(int numBuckets, int numSamples, float const* samples);
-    Histogram(int numBuckets, int numSamples, double const* samples);
+    Histogram(int numBuckets, int numSamples, int const* samples, bool noRescaling,
+        unsigned int numThreads = 1);
+    Histogram(int numBuckets, int numSamples, float const* samples,
+        unsigned int numThreads = 1);
+    Histogram(int numBuckets, int numSamples, double const* samples,
+        unsigned int numThreads = 1);
+
+    // Construction of an empty histogram for the samples in the window
+    // [minValue,maxValue], which requires minValue < maxValue.  The samples
+    // are added by Insert(numSamples,samples).  Bucket i contains the
+    // samples v in the window with
+    // i <= (v-minValue)*(numBuckets-1)/(maxValue-minValue) < i+1, which is
+    // the mapping used by the constructors with rescaling where the window
+    // is the range of the samples.  The samples outside the window are
+    // counted by the excess counts.
+    Histogram(int numBuckets, double minValue, double maxValue,
+        unsigned int numThreads = 1);
 
     // Construction where you plan on updating the histogram incrementally.
     // The incremental update is implemented only for integer samples and
@@ -40,6 +62,19 @@ public:
     // constructor.  Bounds checking is used.
     void InsertCheck(int value);
 
+    // Insert or remove samples using the mapping of the samples to the
+    // buckets that was established by the constructor.  When a subrange of
+    // an image changes, the histogram is updated by removing the old
+    // samples of the subrange and inserting the new ones.  Samples that
+    // are outside the range of the samples passed to the constructor are
+    // counted by the excess counts.
+    void Insert(int numSamples, int const* samples);
+    void Insert(int numSamples, float const* samples);
+    void Insert(int numSamples, double const* samples);
+    void Remove(int numSamples, int const* samples);
+    void Remove(int numSamples, float const* samples);
+    void Remove(int numSamples, double const* samples);
+
     // Member access.
     inline std::vector<int> const& GetBuckets() const;
     inline int GetExcessLess() const;
@@ -64,8 +99,21 @@ public:
     void GetTails(double tailAmount, int& lower, int& upper);
 
 private:
+    // Compute the range of the samples, which determines the mapping to
+    // the buckets, and insert the samples.
+    template <typename Real>
+    void Initialize(int numSamples, Real const* samples);
+
+    // Add sign*1 to the bucket of each sample, where sign is +1 or -1.
+    template <typename Real>
+    void Count(int numSamples, Real const* samples, int sign);
+
+    // Sample v in [mMinValue,mMaxValue] is in bucket
+    // floor((v - mMinValue) * mMultiplier).
     std::vector<int> mBuckets;
     int mExcessLess, mExcessGreater;
+    double mMinValue, mMaxValue, mMultiplier;
+    unsigned int mNumThreads;
 };
 
 
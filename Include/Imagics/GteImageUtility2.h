@@ -3,10 +3,13 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2017/02/05)
+// File Version: 3.0.5 (2019/09/10)
 
 #pragma once
 
+#include <Imagics/GteBinaryMorphology.h>
+#include <Imagics/GteComponentLabeler.h>
+#include <Imagics/GteDistanceTransform.h>
 #include <Imagics/GteImage2.h>
 #include <functional>
 
@@ -25,41 +28,79 @@ public:
     // to preserve the input image, make a copy of it before calling these
     // functions.
     //
-    // Dilation and erosion functions do not have the requirement that the
-    // boundary pixels of the binary image inputs be zero.
+    // Dilation and erosion functions and the GetComponents* functions do not
+    // have the requirement that the boundary pixels of the binary image
+    // inputs be zero.
 
     // Compute the 4-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  The labeling is
+    // performed by ComponentLabeler, which uses numThreads threads.
     static void GetComponents4(Image2<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        unsigned int numThreads = 1);
+
+    // Compute the 4-connected components of a binary image without
+    // building the lists of indices.  On output, 'labels' has the
+    // dimensions of 'image' and its values are the labels for the
+    // components.  The array components[k], k >= 1, contains the number of
+    // pixels and the bounding box of the k-th component.  The return value
+    // is the number of components.
+    static int GetComponents4(Image2<int> const& image, Image2<int>& labels,
+        std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads = 1);
 
     // Compute the 8-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  The labeling is
+    // performed by ComponentLabeler, which uses numThreads threads.
     static void GetComponents8(Image2<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        unsigned int numThreads = 1);
+
+    // Compute the 8-connected components of a binary image without
+    // building the lists of indices.  On output, 'labels' has the
+    // dimensions of 'image' and its values are the labels for the
+    // components.  The array components[k], k >= 1, contains the number of
+    // pixels and the bounding box of the k-th component.  The return value
+    // is the number of components.
+    static int GetComponents8(Image2<int> const& image, Image2<int>& labels,
+        std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads = 1);
 
     // Compute a dilation with a structuring element consisting of the
     // 4-connected neighbors of each pixel.  The input image is binary with 0
     // for background and 1 for foreground.  The output image must be an
-    // object different from the input image.
-    static void Dilate4(Image2<int> const& input, Image2<int>& output);
+    // object different from the input image.  The morphological operations
+    // are performed by BinaryMorphology, which uses numThreads threads.
+    static void Dilate4(Image2<int> const& input, Image2<int>& output,
+        unsigned int numThreads = 1);
 
     // Compute a dilation with a structuring element consisting of the
     // 8-connected neighbors of each pixel.  The input image is binary with 0
     // for background and 1 for foreground.  The output image must be an
     // object different from the input image.
-    static void Dilate8(Image2<int> const& input, Image2<int>& output);
+    static void Dilate8(Image2<int> const& input, Image2<int>& output,
+        unsigned int numThreads = 1);
 
     // Compute a dilation with a structing element consisting of neighbors
     // specified by offsets relative to the pixel.  The input image is binary
     // with 0 for background and 1 for foreground.  The output image must be
     // an object different from the input image.
     static void Dilate(Image2<int> const& input, int numNeighbors,
-        std::array<int, 2> const* neighbors, Image2<int>& output);
+        std::array<int, 2> const* neighbors, Image2<int>& output,
+        unsigned int numThreads = 1);
+
+    // Compute a dilation with the box structuring element consisting of the
+    // offsets (dx,dy) with boxMin[i] <= d[i] <= boxMax[i].  The input image
+    // is binary with 0 for background and 1 for foreground.  The output
+    // image must be an object different from the input image.  The cost per
+    // pixel is independent of the size of the box; see BinaryMorphology.
+    static void DilateBox(Image2<int> const& input,
+        std::array<int, 2> const& boxMin, std::array<int, 2> const& boxMax,
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute an erosion with a structuring element consisting of the
     // 4-connected neighbors of each pixel.  The input image is binary with 0
@@ -69,7 +110,7 @@ public:
     // to 0; otherwise, boundary pixels are set to 0 only when they have
     // neighboring image pixels that are 0.
     static void Erode4(Image2<int> const& input, bool zeroExterior,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute an erosion with a structuring element consisting of the
     // 8-connected neighbors of each pixel.  The input image is binary with 0
@@ -79,7 +120,7 @@ public:
     // set to 0; otherwise, boundary pixels are set to 0 only when they have
     // neighboring image pixels that are 0.
     static void Erode8(Image2<int> const& input, bool zeroExterior,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute an erosion with a structuring element consisting of neighbors
     // specified by offsets relative to the pixel.  The input image is binary
@@ -90,7 +131,16 @@ public:
     // neighboring image pixels that are 0.
     static void Erode(Image2<int> const& input, bool zeroExterior,
         int numNeighbors, std::array<int, 2> const* neighbors,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
+
+    // Compute an erosion with the box structuring element consisting of the
+    // offsets (dx,dy) with boxMin[i] <= d[i] <= boxMax[i].  The input image
+    // is binary with 0 for background and 1 for foreground.  The output
+    // image must be an object different from the input image.  The meaning
+    // of zeroExterior is the same as for Erode.
+    static void ErodeBox(Image2<int> const& input, bool zeroExterior,
+        std::array<int, 2> const& boxMin, std::array<int, 2> const& boxMax,
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute an opening with a structuring element consisting of the
     // 4-connected neighbors of each pixel.  The input image is binary with 0
@@ -99,7 +149,7 @@ public:
     // image exterior is assumed to consist of 0-valued pixels; otherwise,
     // the image exterior is assumed to consist of 1-valued pixels.
     static void Open4(Image2<int> const& input, bool zeroExterior,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute an opening with a structuring element consisting of the
     // 8-connected neighbors of each pixel.  The input image is binary with 0
@@ -108,7 +158,7 @@ public:
     // image exterior is assumed to consist of 0-valued pixels; otherwise,
     // the image exterior is assumed to consist of 1-valued pixels.
     static void Open8(Image2<int> const& input, bool zeroExterior,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute an opening with a structuring element consisting of neighbors
     // specified by offsets relative to the pixel.  The input image is binary
@@ -118,7 +168,7 @@ public:
     // the image exterior is assumed to consist of 1-valued pixels.
     static void Open(Image2<int> const& input, bool zeroExterior,
         int numNeighbors, std::array<int, 2> const* neighbors,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute a closing with a structuring element consisting of the
     // 4-connected neighbors of each pixel.  The input image is binary with 0
@@ -127,7 +177,7 @@ public:
     // image exterior is assumed to consist of 0-valued pixels; otherwise,
     // the image exterior is assumed to consist of 1-valued pixels.
     static void Close4(Image2<int> const& input, bool zeroExterior,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute a closing with a structuring element consisting of the
     // 8-connected neighbors of each pixel.  The input image is binary with 0
@@ -136,7 +186,7 @@ public:
     // image exterior is assumed to consist of 0-valued pixels; otherwise,
     // the image exterior is assumed to consist of 1-valued pixels.
     static void Close8(Image2<int> const& input, bool zeroExterior,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Compute a closing with a structuring element consisting of neighbors
     // specified by offsets relative to the pixel.  The input image is binary
@@ -146,7 +196,7 @@ public:
     // the image exterior is assumed to consist of 1-valued pixels.
     static void Close(Image2<int> const& input, bool zeroExterior,
         int numNeighbors, std::array<int, 2> const* neighbors,
-        Image2<int>& output);
+        Image2<int>& output, unsigned int numThreads = 1);
 
     // Locate a pixel and walk around the edge of a component.  The input
     // (x,y) is where the search starts for a nonzero pixel.  If (x,y) is
@@ -171,13 +221,24 @@ public:
     static void GetL1Distance(Image2<int>& image, int& maxDistance,
         int& xMax, int& yMax);
 
-    // Compute the L2-distance transform of the binary image.  The maximum
-    // distance should not be larger than 100, so you have to ensure this is
-    // the case for the input image.  The function returns the maximum
-    // distance and a point at which the maximum distance is attained.
-    // Comments about the algorithm are in the source file.
+    // Compute the L2-distance transform of the binary image.  The distances
+    // are exact and are computed by DistanceTransform, which uses numThreads
+    // threads.  The function returns the maximum distance and a point at
+    // which the maximum distance is attained.
     static void GetL2Distance(Image2<int> const& image, float& maxDistance,
-        int& xMax, int& yMax, Image2<float>& transform);
+        int& xMax, int& yMax, Image2<float>& transform,
+        unsigned int numThreads = 1);
+
+    // Compute the squared L2-distance transform of the binary image.  For a
+    // 1-valued pixel, sqrDistance is the squared distance to the nearest
+    // 0-valued pixel and nearest is the index of that pixel.  For a 0-valued
+    // pixel, sqrDistance is 0 and nearest is the index of the pixel when
+    // 'isSigned' is false; otherwise, sqrDistance is the negative of the
+    // squared distance to the nearest 1-valued pixel and nearest is the
+    // index of that pixel.  See DistanceTransform for the details.
+    static void GetSquaredL2Distance(Image2<int> const& image, bool isSigned,
+        Image2<int>& sqrDistance, Image2<int>& nearest,
+        unsigned int numThreads = 1);
 
     // Compute a skeleton of a binary image.  Boundary pixels are trimmed from
     // the object one layer at a time based on their adjacency to interior
@@ -225,13 +286,12 @@ public:
         std::function<PixelType(int, int)> const& getCallback);
 
 private:
-    // Connected component labeling using depth-first search.
-    static void GetComponents(int numNeighbors, int const* delta,
-        Image2<int>& image, std::vector<std::vector<size_t>>& components);
-
-    // Support for GetL2Distance.
-    static void L2Check(int x, int y, int dx, int dy, Image2<int>& xNear,
-        Image2<int>& yNear, Image2<int>& dist);
+    // Connected component labeling using ComponentLabeler.
+    static void GetComponents(int connectivity, Image2<int>& image,
+        std::vector<std::vector<size_t>>& components, unsigned int numThreads);
+    static int GetComponents(int connectivity, Image2<int> const& image,
+        Image2<int>& labels, std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads);
 
     // Support for GetSkeleton.
     static bool Interior2 (Image2<int>& image, int x, int y);
@@ -3,10 +3,13 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2017/02/05)
+// File Version: 3.0.5 (2019/09/10)
 
 #pragma once
 
+#include <Imagics/GteBinaryMorphology.h>
+#include <Imagics/GteComponentLabeler.h>
+#include <Imagics/GteDistanceTransform.h>
 #include <Imagics/GteImage3.h>
 #include <functional>
 
@@ -24,39 +27,101 @@ public:
     // operations, to save memory and time the input image is modified by the
     // algorithms.  If you need to preserve the input image, make a copy of it
     // before calling these functions.
+    //
+    // The GetComponents*, Dilate* and ErodeBox functions do not have the
+    // requirement that the boundary voxels of the binary image inputs be
+    // zero.
 
     // Compute the 6-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  The labeling is
+    // performed by ComponentLabeler, which uses numThreads threads.
     static void GetComponents6(Image3<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        unsigned int numThreads = 1);
+
+    // Compute the 6-connected components of a binary image without
+    // building the lists of indices.  On output, 'labels' has the
+    // dimensions of 'image' and its values are the labels for the
+    // components.  The array components[k], k >= 1, contains the number of
+    // voxels and the bounding box of the k-th component.  The return value
+    // is the number of components.
+    static int GetComponents6(Image3<int> const& image, Image3<int>& labels,
+        std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads = 1);
 
     // Compute the 18-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  The labeling is
+    // performed by ComponentLabeler, which uses numThreads threads.
     static void GetComponents18(Image3<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        unsigned int numThreads = 1);
+
+    // Compute the 18-connected components of a binary image without
+    // building the lists of indices.  On output, 'labels' has the
+    // dimensions of 'image' and its values are the labels for the
+    // components.  The array components[k], k >= 1, contains the number of
+    // voxels and the bounding box of the k-th component.  The return value
+    // is the number of components.
+    static int GetComponents18(Image3<int> const& image, Image3<int>& labels,
+        std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads = 1);
 
     // Compute the 26-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  The labeling is
+    // performed by ComponentLabeler, which uses numThreads threads.
     static void GetComponents26(Image3<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        unsigned int numThreads = 1);
+
+    // Compute the 26-connected components of a binary image without
+    // building the lists of indices.  On output, 'labels' has the
+    // dimensions of 'image' and its values are the labels for the
+    // components.  The array components[k], k >= 1, contains the number of
+    // voxels and the bounding box of the k-th component.  The return value
+    // is the number of components.
+    static int GetComponents26(Image3<int> const& image, Image3<int>& labels,
+        std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads = 1);
 
     // Dilate the image using a structuring element that contains the
-    // 6-connected neighbors.
-    static void Dilate6(Image3<int> const& inImage, Image3<int>& outImage);
+    // 6-connected neighbors.  The dilations are performed by
+    // BinaryMorphology, which uses numThreads threads.
+    static void Dilate6(Image3<int> const& inImage, Image3<int>& outImage,
+        unsigned int numThreads = 1);
 
     // Dilate the image using a structuring element that contains the
     // 18-connected neighbors.
-    static void Dilate18(Image3<int> const& inImage, Image3<int>& outImage);
+    static void Dilate18(Image3<int> const& inImage, Image3<int>& outImage,
+        unsigned int numThreads = 1);
 
     // Dilate the image using a structuring element that contains the
     // 26-connected neighbors.
-    static void Dilate26(Image3<int> const& inImage, Image3<int>& outImage);
+    static void Dilate26(Image3<int> const& inImage, Image3<int>& outImage,
+        unsigned int numThreads = 1);
+
+    // Dilate the image using the box structuring element consisting of the
+    // offsets (dx,dy,dz) with boxMin[i] <= d[i] <= boxMax[i].  The output
+    // image must be an object different from the input image.  The cost per
+    // voxel is independent of the size of the box; see BinaryMorphology.
+    static void DilateBox(Image3<int> const& inImage,
+        std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+        Image3<int>& outImage, unsigned int numThreads = 1);
+
+    // Erode the image using the box structuring element consisting of the
+    // offsets (dx,dy,dz) with boxMin[i] <= d[i] <= boxMax[i].  The output
+    // image must be an object different from the input image.  If
+    // zeroExterior is true, the image exterior is assumed to be 0, so
+    // 1-valued boundary voxels are set to 0; otherwise, boundary voxels are
+    // set to 0 only when they have neighboring image voxels that are 0.
+    static void ErodeBox(Image3<int> const& inImage, bool zeroExterior,
+        std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+        Image3<int>& outImage, unsigned int numThreads = 1);
 
     // Compute coordinate-directional convex set.  For a given coordinate
     // direction (x, y, or z), identify the first and last 1-valued voxels
@@ -65,6 +130,18 @@ public:
     // coordinate directions.
     static void ComputeCDConvex(Image3<int>& image);
 
+    // Compute the squared L2-distance transform of the binary image.  For a
+    // 1-valued voxel, sqrDistance is the squared distance to the nearest
+    // 0-valued voxel and nearest is the index of that voxel.  For a 0-valued
+    // voxel, sqrDistance is 0 and nearest is the index of the voxel when
+    // 'isSigned' is false; otherwise, sqrDistance is the negative of the
+    // squared distance to the nearest 1-valued voxel and nearest is the
+    // index of that voxel.  The distances are exact and are computed by
+    // DistanceTransform, which uses numThreads threads.
+    static void GetSquaredL2Distance(Image3<int> const& image, bool isSigned,
+        Image3<int>& sqrDistance, Image3<int>& nearest,
+        unsigned int numThreads = 1);
+
     // Use a depth-first search for filling a 6-connected region.  This is
     // nonrecursive, simulated by using a heap-allocated "stack".  The input
     // (x,y,z) is the seed point that starts the fill.
@@ -80,11 +157,15 @@ public:
 private:
     // Dilation using the specified structuring element.
     static void Dilate(int numNeighbors, std::array<int, 3> const* delta,
-        Image3<int> const& inImage, Image3<int>& outImage);
+        Image3<int> const& inImage, Image3<int>& outImage,
+        unsigned int numThreads);
 
-    // Connected component labeling using depth-first search.
-    static void GetComponents(int numNeighbors, int const* delta,
-        Image3<int>& image, std::vector<std::vector<size_t>>& components);
+    // Connected component labeling using ComponentLabeler.
+    static void GetComponents(int connectivity, Image3<int>& image,
+        std::vector<std::vector<size_t>>& components, unsigned int numThreads);
+    static int GetComponents(int connectivity, Image3<int> const& image,
+        Image3<int>& labels, std::vector<ComponentLabeler::Component>& components,
+        unsigned int numThreads);
 };
 
 
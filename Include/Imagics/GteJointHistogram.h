@@ -0,0 +1,86 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/14)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <array>
+#include <vector>
+
+// The joint histogram of two images (or two channels of an image) with the
+// same number of pixels, which counts the pairs of values of corresponding
+// pixels.  It is used for mutual information in registration and for
+// scatter plots of channels.  The value v of image j is mapped to bucket i
+// when i <= (v-minValue[j])*(numBuckets[j]-1)/(maxValue[j]-minValue[j])
+// < i+1, which is the mapping of Histogram.  A pair with a value outside
+// [minValue[j],maxValue[j]] is counted by the excess count.  The samples are counted in
+// parallel with the same blocking as Histogram.
+
+namespace gte
+{
+
+class GTE_IMPEXP JointHistogram
+{
+public:
+    // Construction of an empty histogram, which requires
+    // minValue[j] < maxValue[j].
+    JointHistogram(std::array<int, 2> const& numBuckets,
+        std::array<double, 2> const& minValue,
+        std::array<double, 2> const& maxValue,
+        unsigned int numThreads = 1);
+
+    // Insert or remove the pairs (samples0[i],samples1[i]).  When a
+    // subrange of the images changes, the histogram is updated by removing
+    // the old samples of the subrange and inserting the new ones.
+    void Insert(int numSamples, int const* samples0, int const* samples1);
+    void Insert(int numSamples, float const* samples0, float const* samples1);
+    void Insert(int numSamples, double const* samples0, double const* samples1);
+    void Remove(int numSamples, int const* samples0, int const* samples1);
+    void Remove(int numSamples, float const* samples0, float const* samples1);
+    void Remove(int numSamples, double const* samples0, double const* samples1);
+
+    // Member access.  The count of bucket (i0,i1) is stored in element
+    // i0 + numBuckets[0]*i1 of the buckets.
+    inline std::array<int, 2> const& GetNumBuckets() const;
+    inline std::vector<int> const& GetBuckets() const;
+    inline int GetBucket(int i0, int i1) const;
+    inline int GetExcess() const;
+
+private:
+    // Add sign*1 to the bucket of each pair, where sign is +1 or -1.
+    template <typename Real>
+    void Count(int numSamples, Real const* samples0, Real const* samples1,
+        int sign);
+
+    std::array<int, 2> mNumBuckets;
+    std::vector<int> mBuckets;
+    int mExcess;
+    std::array<double, 2> mMinValue, mMaxValue, mMultiplier;
+    unsigned int mNumThreads;
+};
+
+inline std::array<int, 2> const& JointHistogram::GetNumBuckets() const
+{
+    return mNumBuckets;
+}
+
+inline std::vector<int> const& JointHistogram::GetBuckets() const
+{
+    return mBuckets;
+}
+
+inline int JointHistogram::GetBucket(int i0, int i1) const
+{
+    return mBuckets[i0 + mNumBuckets[0] * i1];
+}
+
+inline int JointHistogram::GetExcess() const
+{
+    return mExcess;
+}
+
+}
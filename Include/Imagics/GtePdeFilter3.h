@@ -3,12 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.23.0 (2019/03/12)
+// File Version: 3.23.1 (2019/09/12)
 
 #pragma once
 
+#include <Imagics/GteBrickedImage3.h>
 #include <Imagics/GtePdeFilter.h>
 #include <LowLevel/GteArray3.h>
+#include <algorithm>
 #include <array>
 #include <limits>
 #include <utility>
@@ -223,6 +225,70 @@ namespace gte
             return mMask[zp1][yp1][xp1];
         }
 
+        // Apply numIterations updates of a filter to a 3D image that is
+        // stored in a file and write the result to another file of the same
+        // dimensions.  The image is processed in slabs of numSlices
+        // z-slices.  An update of a voxel depends on its 3x3x3 neighborhood,
+        // so each slab is loaded with numIterations additional z-slices on
+        // each side.  The functor create(xBound, yBound, zBound, data)
+        // returns a std::unique_ptr (or other pointer) to a filter for the
+        // slab data.  The data of each slab is translated by the minimum of
+        // the slab, so the result is the same as that of the filter applied
+        // to the image in memory when the filter has no mask, uses ST_NONE,
+        // depends only on differences of the data (for example,
+        // CurvatureFlow3 and GradientAnisotropic3) and uses Neumann boundary
+        // conditions (borderValue = std::numeric_limits<Real>::max()).
+        template <typename CreateFilter>
+        static bool UpdateStreamed(BrickedImage3<Real> const& input, int numSlices,
+            int numIterations, CreateFilter const& create, BrickedImage3<Real>& output)
+        {
+            if (numSlices <= 0 || numIterations < 0 || !output.IsWritable()
+                || input.GetDimensions() != output.GetDimensions())
+            {
+                return false;
+            }
+
+            int const xBound = input.GetDimension(0);
+            int const yBound = input.GetDimension(1);
+            int const zBound = input.GetDimension(2);
+            Image3<Real> slab, result;
+            for (int zmin = 0; zmin < zBound; zmin += numSlices)
+            {
+                int zmax = std::min(zmin + numSlices, zBound);
+                int z0 = std::max(zmin - numIterations, 0);
+                int z1 = std::min(zmax + numIterations, zBound);
+                input.GetSlab(z0, z1, slab);
+
+                auto filter = create(xBound, yBound, z1 - z0, slab.GetPixels().data());
+                PdeFilter3 const& pdeFilter = *filter;
+                for (int i = 0; i < numIterations; ++i)
+                {
+                    filter->Update();
+                }
+
+                // Undo the scaling of the data by the constructor.
+                result.Reconstruct(xBound, yBound, zmax - zmin);
+                for (int z = zmin; z < zmax; ++z)
+                {
+                    for (int y = 0; y < yBound; ++y)
+                    {
+                        for (int x = 0; x < xBound; ++x)
+                        {
+                            Real u = pdeFilter.GetU(x, y, z - z0);
+                            result(x, y, z - zmin) = pdeFilter.mMin +
+                                (u - pdeFilter.mOffset) / pdeFilter.mScale;
+                        }
+                    }
+                }
+
+                if (!output.SetSlab(zmin, result))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
     protected:
         // Assign values to the 1-voxel image border.
         void AssignDirichletImageBorder()
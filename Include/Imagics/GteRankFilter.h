@@ -0,0 +1,519 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/13)
+
+#pragma once
+
+#include <LowLevel/GteLogger.h>
+#include <Imagics/GteImage2.h>
+#include <Imagics/GteImage3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Rank filters (median, minimum, maximum, percentiles) of 2D and 3D images.
+// The window of a pixel is the square or cube of side 2*radius+1 centered
+// at the pixel.  Pixels of the window outside the image are replaced by the
+// nearest image pixel.  For a window of n pixels, the output is the window
+// value of index floor(rank*(n-1)+1/2) in increasing order, so rank 0 is
+// the minimum, rank 1/2 is the median and rank 1 is the maximum.
+//
+// Small windows are processed with sorting networks.  The pixels of a row
+// are filtered in groups of 64; the window values of the group are copied
+// to n arrays and every comparator of the network is a loop of min and max
+// operations over two arrays, which the compiler vectorizes.  The network
+// is Batcher's odd-even merge sort, restricted to the comparators on which
+// the output value depends.
+//
+// Larger windows of 8-bit and 16-bit integer images are processed in
+// constant time per pixel, independent of the radius, with the histogram
+// algorithm of
+//   S. Perreault and P. Hebert, "Median filtering in constant time," IEEE
+//   Transactions on Image Processing, 16(9), pp. 2389-2394, 2007.
+// Each column of the window has a histogram that is updated by one pixel
+// per z-slice when the window moves to the next row, and the histogram of
+// the window is updated by adding and subtracting column histograms when
+// the window moves to the next pixel.  The histograms have two levels: the
+// coarse level counts the upper half of the bits of the values and is
+// always updated, and the fine level of a coarse bin is updated only when
+// the output value is in that bin.  Larger windows of other pixel types
+// are processed with std::nth_element.
+//
+// The image is partitioned into tiles of columns and strips of rows, which
+// are distributed over the threads.
+
+namespace gte
+{
+    template <typename PixelType>
+    class RankFilter
+    {
+    public:
+        // Construction.
+        RankFilter(unsigned int numThreads = 1)
+            :
+            mNumThreads(numThreads > 0 ? numThreads : 1)
+        {
+        }
+
+        // The output image is resized to the dimensions of the input image
+        // and must be an object different from the input image.
+        void Execute(Image2<PixelType> const& input, int radius, double rank,
+            Image2<PixelType>& output)
+        {
+            int const dim0 = input.GetDimension(0), dim1 = input.GetDimension(1);
+            if (output.GetDimensions() != input.GetDimensions())
+            {
+                output.Reconstruct(dim0, dim1);
+            }
+            Filter({ dim0, dim1, 1 }, { radius, radius, 0 }, rank,
+                input.GetPixels().data(), output.GetPixels().data());
+        }
+
+        void Execute(Image3<PixelType> const& input, int radius, double rank,
+            Image3<PixelType>& output)
+        {
+            int const dim0 = input.GetDimension(0), dim1 = input.GetDimension(1);
+            int const dim2 = input.GetDimension(2);
+            if (output.GetDimensions() != input.GetDimensions())
+            {
+                output.Reconstruct(dim0, dim1, dim2);
+            }
+            Filter({ dim0, dim1, dim2 }, { radius, radius, radius }, rank,
+                input.GetPixels().data(), output.GetPixels().data());
+        }
+
+        inline void Median(Image2<PixelType> const& input, int radius,
+            Image2<PixelType>& output)
+        {
+            Execute(input, radius, 0.5, output);
+        }
+
+        inline void Median(Image3<PixelType> const& input, int radius,
+            Image3<PixelType>& output)
+        {
+            Execute(input, radius, 0.5, output);
+        }
+
+        // Windows of at most this number of pixels are processed with
+        // sorting networks.  The histograms are faster for windows larger
+        // than 7x7, and the sorting networks are faster than
+        // std::nth_element for all the windows up to 7x7x7.
+        static int const maxNetworkSize =
+            (std::is_integral<PixelType>::value && sizeof(PixelType) <= 2 ? 49 : 343);
+
+    private:
+        // Images with 8-bit and 16-bit integer pixels are filtered with
+        // histograms when the window is large.
+        static bool const msUseHistogram =
+            std::is_integral<PixelType>::value && sizeof(PixelType) <= 2;
+
+        void Filter(std::array<int, 3> const& dims, std::array<int, 3> const& radius,
+            double rank, PixelType const* input, PixelType* output)
+        {
+            if (radius[0] < 0)
+            {
+                LogError("The radius must be nonnegative.");
+                return;
+            }
+
+            if (dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0)
+            {
+                return;
+            }
+
+            int const n = (2 * radius[0] + 1) * (2 * radius[1] + 1) * (2 * radius[2] + 1);
+            double const t = std::min(std::max(rank, 0.0), 1.0);
+            int const k = static_cast<int>(std::floor(t * (n - 1) + 0.5));
+            if (n <= maxNetworkSize)
+            {
+                FilterNetwork(dims, radius, n, k, input, output);
+            }
+            else
+            {
+                FilterLarge(dims, radius, n, k, input, output,
+                    std::integral_constant<bool, msUseHistogram>());
+            }
+        }
+
+        // Batcher's odd-even merge sort for n values, where each comparator
+        // (i,j) with i < j stores the minimum in i and the maximum in j.
+        // The comparators that do not affect the output k are removed.
+        static void CreateNetwork(int n, int k, std::vector<std::pair<int, int>>& network)
+        {
+            std::vector<std::pair<int, int>> comparators;
+            for (int p = 1; p < n; p += p)
+            {
+                for (int q = p; q > 0; q /= 2)
+                {
+                    for (int j = q % p; j + q < n; j += q + q)
+                    {
+                        for (int i = 0; i < q && i + j + q < n; ++i)
+                        {
+                            if ((i + j) / (p + p) == (i + j + q) / (p + p))
+                            {
+                                comparators.push_back(std::make_pair(i + j, i + j + q));
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::vector<bool> needed(n, false);
+            needed[k] = true;
+            network.clear();
+            for (auto c = comparators.rbegin(); c != comparators.rend(); ++c)
+            {
+                if (needed[c->first] || needed[c->second])
+                {
+                    needed[c->first] = true;
+                    needed[c->second] = true;
+                    network.push_back(*c);
+                }
+            }
+            std::reverse(network.begin(), network.end());
+        }
+
+        void FilterNetwork(std::array<int, 3> const& dims, std::array<int, 3> const& radius,
+            int n, int k, PixelType const* input, PixelType* output)
+        {
+            std::vector<std::pair<int, int>> network;
+            CreateNetwork(n, k, network);
+
+            int const numRows = dims[1] * dims[2];
+            ExecuteRanges(numRows, [&dims, &radius, n, k, input, output, &network](int rmin, int rmax)
+            {
+                int const groupSize = 64;
+                std::vector<PixelType> window(static_cast<size_t>(n) * groupSize);
+                std::vector<PixelType const*> rows;
+                for (int r = rmin; r < rmax; ++r)
+                {
+                    int const y = r % dims[1], z = r / dims[1];
+                    GetRows(dims, radius, input, y, z, rows);
+
+                    for (int x0 = 0; x0 < dims[0]; x0 += groupSize)
+                    {
+                        int const length = std::min(groupSize, dims[0] - x0);
+                        PixelType* values = window.data();
+                        for (auto source : rows)
+                        {
+                            for (int dx = -radius[0]; dx <= radius[0]; ++dx, values += groupSize)
+                            {
+                                int const xs = x0 + dx;
+                                if (0 <= xs && xs + length <= dims[0])
+                                {
+                                    std::memcpy(values, source + xs, length * sizeof(PixelType));
+                                }
+                                else
+                                {
+                                    for (int i = 0; i < length; ++i)
+                                    {
+                                        values[i] = source[std::min(std::max(xs + i, 0), dims[0] - 1)];
+                                    }
+                                }
+                            }
+                        }
+
+                        // The minima and maxima are computed in local
+                        // arrays, which do not alias the window, so that
+                        // the loop is vectorized without runtime checks.
+                        for (auto const& c : network)
+                        {
+                            PixelType* v0 = window.data() + c.first * groupSize;
+                            PixelType* v1 = window.data() + c.second * groupSize;
+                            std::array<PixelType, groupSize> minValue, maxValue;
+                            for (int i = 0; i < groupSize; ++i)
+                            {
+                                minValue[i] = std::min(v0[i], v1[i]);
+                                maxValue[i] = std::max(v0[i], v1[i]);
+                            }
+                            std::memcpy(v0, minValue.data(), sizeof(minValue));
+                            std::memcpy(v1, maxValue.data(), sizeof(maxValue));
+                        }
+
+                        std::memcpy(output + static_cast<size_t>(r) * dims[0] + x0,
+                            window.data() + k * groupSize, length * sizeof(PixelType));
+                    }
+                }
+            });
+        }
+
+        void FilterLarge(std::array<int, 3> const& dims, std::array<int, 3> const& radius,
+            int n, int k, PixelType const* input, PixelType* output, std::false_type)
+        {
+            int const numRows = dims[1] * dims[2];
+            ExecuteRanges(numRows, [&dims, &radius, n, k, input, output](int rmin, int rmax)
+            {
+                std::vector<PixelType> values(n);
+                std::vector<PixelType const*> rows;
+                for (int r = rmin; r < rmax; ++r)
+                {
+                    int const y = r % dims[1], z = r / dims[1];
+                    GetRows(dims, radius, input, y, z, rows);
+
+                    PixelType* target = output + static_cast<size_t>(r) * dims[0];
+                    for (int x = 0; x < dims[0]; ++x)
+                    {
+                        auto value = values.begin();
+                        for (auto source : rows)
+                        {
+                            for (int dx = -radius[0]; dx <= radius[0]; ++dx, ++value)
+                            {
+                                *value = source[std::min(std::max(x + dx, 0), dims[0] - 1)];
+                            }
+                        }
+                        std::nth_element(values.begin(), values.begin() + k, values.end());
+                        target[x] = values[k];
+                    }
+                }
+            });
+        }
+
+        void FilterLarge(std::array<int, 3> const& dims, std::array<int, 3> const& radius,
+            int, int k, PixelType const* input, PixelType* output, std::true_type)
+        {
+            // The values are mapped to keys 0 <= key < numBins.  The coarse
+            // bin of a key is key >> fineBits and its fine bin is the key.
+            int const numBits = 8 * static_cast<int>(sizeof(PixelType));
+            int const fineBits = numBits / 2;
+            int const numBins = (1 << numBits);
+            int const numCoarse = (1 << (numBits - fineBits));
+            int const numFine = (1 << fineBits);
+            if ((2 * radius[1] + 1) * (2 * radius[2] + 1) > std::numeric_limits<uint16_t>::max())
+            {
+                LogError("The radius is too large.");
+                return;
+            }
+
+            // The column histograms of a tile occupy at most 4MB.
+            int const maxColumns = std::max(2 * radius[0] + 16,
+                (1 << 22) / (numBins * static_cast<int>(sizeof(uint16_t))));
+            int const tileWidth = std::min(dims[0], maxColumns - 2 * radius[0]);
+            int const numTiles = (dims[0] + tileWidth - 1) / tileWidth;
+
+            // Each z-slice of a tile is partitioned into strips so that
+            // there are several items per thread.
+            int const numTarget = (mNumThreads > 1 ? 4 * static_cast<int>(mNumThreads) : 1);
+            int numStrips = (numTarget + numTiles * dims[2] - 1) / (numTiles * dims[2]);
+            numStrips = std::min(std::max(numStrips, 1), dims[1]);
+            int const stripHeight = (dims[1] + numStrips - 1) / numStrips;
+            numStrips = (dims[1] + stripHeight - 1) / stripHeight;
+            int const numItems = numTiles * dims[2] * numStrips;
+
+            ExecuteRanges(numItems, [&](int imin, int imax)
+            {
+                std::vector<uint16_t> columnCoarse(static_cast<size_t>(maxColumns) * numCoarse);
+                std::vector<uint16_t> columnFine(static_cast<size_t>(maxColumns) * numBins);
+                std::vector<uint32_t> kernelCoarse(numCoarse), kernelFine(numBins);
+                std::vector<int> lastUpdate(numCoarse);
+                std::vector<PixelType const*> rows;
+                int const width = 2 * radius[0] + 1;
+
+                // Add or subtract the histogram of a column to or from the
+                // histogram of the window.
+                auto updateCoarse = [&](int column, int sign)
+                {
+                    uint16_t const* source = &columnCoarse[static_cast<size_t>(column) * numCoarse];
+                    for (int b = 0; b < numCoarse; ++b)
+                    {
+                        kernelCoarse[b] += sign * source[b];
+                    }
+                };
+
+                auto updateFine = [&](int column, int coarse, int sign)
+                {
+                    uint16_t const* source = &columnFine[static_cast<size_t>(column) * numBins
+                        + static_cast<size_t>(coarse) * numFine];
+                    uint32_t* target = &kernelFine[static_cast<size_t>(coarse) * numFine];
+                    for (int f = 0; f < numFine; ++f)
+                    {
+                        target[f] += sign * source[f];
+                    }
+                };
+
+                for (int item = imin; item < imax; ++item)
+                {
+                    int const strip = item % numStrips;
+                    int const z = (item / numStrips) % dims[2];
+                    int const tile = item / (numStrips * dims[2]);
+                    int const x0 = tile * tileWidth;
+                    int const x1 = std::min(x0 + tileWidth, dims[0]);
+                    int const y0 = strip * stripHeight;
+                    int const y1 = std::min(y0 + stripHeight, dims[1]);
+                    int const numColumns = x1 - x0 + 2 * radius[0];
+
+                    // The histograms of the columns x0-radius <= x <
+                    // x1+radius for the first row of the strip.
+                    std::fill(columnCoarse.begin(), columnCoarse.begin() + static_cast<size_t>(numColumns) * numCoarse, 0);
+                    std::fill(columnFine.begin(), columnFine.begin() + static_cast<size_t>(numColumns) * numBins, 0);
+                    GetRows(dims, { 0, radius[1], radius[2] }, input, y0, z, rows);
+                    for (auto source : rows)
+                    {
+                        for (int j = 0; j < numColumns; ++j)
+                        {
+                            int const xs = std::min(std::max(x0 - radius[0] + j, 0), dims[0] - 1);
+                            int const key = Key(source[xs]);
+                            ++columnCoarse[static_cast<size_t>(j) * numCoarse + (key >> fineBits)];
+                            ++columnFine[static_cast<size_t>(j) * numBins + key];
+                        }
+                    }
+
+                    for (int y = y0; y < y1; ++y)
+                    {
+                        if (y > y0)
+                        {
+                            // Replace the pixels of row y-1-radius by those
+                            // of row y+radius.
+                            int const yOld = std::max(y - 1 - radius[1], 0);
+                            int const yNew = std::min(y + radius[1], dims[1] - 1);
+                            for (int dz = -radius[2]; dz <= radius[2]; ++dz)
+                            {
+                                int const zs = std::min(std::max(z + dz, 0), dims[2] - 1);
+                                PixelType const* sourceOld = input + dims[0] * (yOld + static_cast<size_t>(dims[1]) * zs);
+                                PixelType const* sourceNew = input + dims[0] * (yNew + static_cast<size_t>(dims[1]) * zs);
+                                for (int j = 0; j < numColumns; ++j)
+                                {
+                                    int const xs = std::min(std::max(x0 - radius[0] + j, 0), dims[0] - 1);
+                                    int const keyOld = Key(sourceOld[xs]);
+                                    int const keyNew = Key(sourceNew[xs]);
+                                    if (keyOld != keyNew)
+                                    {
+                                        --columnCoarse[static_cast<size_t>(j) * numCoarse + (keyOld >> fineBits)];
+                                        --columnFine[static_cast<size_t>(j) * numBins + keyOld];
+                                        ++columnCoarse[static_cast<size_t>(j) * numCoarse + (keyNew >> fineBits)];
+                                        ++columnFine[static_cast<size_t>(j) * numBins + keyNew];
+                                    }
+                                }
+                            }
+                        }
+
+                        // The window of pixel x0+s consists of the columns
+                        // s <= j < s+width.  The fine histogram of coarse
+                        // bin b is that of the window of pixel
+                        // x0+lastUpdate[b], or it is invalid when
+                        // lastUpdate[b] is negative.
+                        std::fill(kernelCoarse.begin(), kernelCoarse.end(), 0u);
+                        std::fill(lastUpdate.begin(), lastUpdate.end(), -1);
+                        for (int j = 0; j < width; ++j)
+                        {
+                            updateCoarse(j, 1);
+                        }
+
+                        PixelType* target = output + dims[0] * (y + static_cast<size_t>(dims[1]) * z);
+                        for (int s = 0; s < x1 - x0; ++s)
+                        {
+                            if (s > 0)
+                            {
+                                updateCoarse(s + width - 1, 1);
+                                updateCoarse(s - 1, -1);
+                            }
+
+                            uint32_t count = 0;
+                            int b = 0;
+                            while (count + kernelCoarse[b] <= static_cast<uint32_t>(k))
+                            {
+                                count += kernelCoarse[b++];
+                            }
+
+                            int const last = lastUpdate[b];
+                            if (last < 0 || 2 * (s - last) >= width)
+                            {
+                                std::fill(kernelFine.begin() + static_cast<size_t>(b) * numFine,
+                                    kernelFine.begin() + static_cast<size_t>(b + 1) * numFine, 0u);
+                                for (int j = s; j < s + width; ++j)
+                                {
+                                    updateFine(j, b, 1);
+                                }
+                            }
+                            else
+                            {
+                                for (int i = last + 1; i <= s; ++i)
+                                {
+                                    updateFine(i + width - 1, b, 1);
+                                    updateFine(i - 1, b, -1);
+                                }
+                            }
+                            lastUpdate[b] = s;
+
+                            uint32_t const* fine = &kernelFine[static_cast<size_t>(b) * numFine];
+                            int f = 0;
+                            while (count + fine[f] <= static_cast<uint32_t>(k))
+                            {
+                                count += fine[f++];
+                            }
+                            target[x0 + s] = Value((b << fineBits) + f);
+                        }
+                    }
+                }
+            });
+        }
+
+        // The pointers to the rows (y+dy,z+dz) of the window, clamped to
+        // the image.
+        static void GetRows(std::array<int, 3> const& dims, std::array<int, 3> const& radius,
+            PixelType const* input, int y, int z, std::vector<PixelType const*>& rows)
+        {
+            rows.clear();
+            for (int dz = -radius[2]; dz <= radius[2]; ++dz)
+            {
+                int const zs = std::min(std::max(z + dz, 0), dims[2] - 1);
+                for (int dy = -radius[1]; dy <= radius[1]; ++dy)
+                {
+                    int const ys = std::min(std::max(y + dy, 0), dims[1] - 1);
+                    rows.push_back(input + dims[0] * (ys + static_cast<size_t>(dims[1]) * zs));
+                }
+            }
+        }
+
+        // The mapping between 8-bit or 16-bit values and histogram bins.
+        static inline int Key(PixelType value)
+        {
+            return static_cast<int>(value) - static_cast<int>(std::numeric_limits<PixelType>::min());
+        }
+
+        static inline PixelType Value(int key)
+        {
+            return static_cast<PixelType>(key + static_cast<int>(std::numeric_limits<PixelType>::min()));
+        }
+
+        // Partition numItems items into contiguous ranges, one per thread,
+        // and call function(imin, imax) for each range.
+        template <typename Function>
+        void ExecuteRanges(int numItems, Function const& function)
+        {
+            int const numThreads = std::min(static_cast<int>(mNumThreads), numItems);
+            if (numThreads > 1)
+            {
+                std::vector<std::thread> process(numThreads);
+                for (int t = 0; t < numThreads; ++t)
+                {
+                    int imin = static_cast<int>(static_cast<int64_t>(numItems) * t / numThreads);
+                    int imax = static_cast<int>(static_cast<int64_t>(numItems) * (t + 1) / numThreads);
+                    process[t] = std::thread([&function, imin, imax]()
+                    {
+                        function(imin, imax);
+                    });
+                }
+
+                for (auto& p : process)
+                {
+                    p.join();
+                }
+            }
+            else
+            {
+                function(0, numItems);
+            }
+        }
+
+        unsigned int mNumThreads;
+    };
+}
@@ -3,11 +3,12 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2019/03/09)
+// File Version: 3.0.3 (2019/09/12)
 
 #pragma once
 
 #include <Imagics/GteMarchingCubes.h>
+#include <Imagics/GteBrickedImage3.h>
 #include <Imagics/GteImage3.h>
 #include <Mathematics/GteUniqueVerticesTriangles.h>
 #include <Mathematics/GteVector3.h>
@@ -160,6 +161,50 @@ namespace gte
             return true;
         }
 
+        // Extract the triangle mesh for a 3D image that is stored in a file.
+        // The image is loaded in slabs of numSlices+1 z-slices; consecutive
+        // slabs share one z-slice.  The output is the same as that of
+        // Extract(level, vertices, indices) for the image in memory.
+        static bool ExtractStreamed(BrickedImage3<Real> const& image, int numSlices,
+            Real level, std::vector<Vector3<Real>>& vertices, std::vector<int>& indices)
+        {
+            vertices.clear();
+            indices.clear();
+            if (numSlices <= 0)
+            {
+                return false;
+            }
+
+            Image3<Real> slab;
+            std::vector<Vector3<Real>> slabVertices;
+            std::vector<int> slabIndices;
+            int const dimension2 = image.GetDimension(2);
+            for (int zmin = 0; zmin + 1 < dimension2; zmin += numSlices)
+            {
+                int zmax = std::min(zmin + numSlices + 1, dimension2);
+                image.GetSlab(zmin, zmax, slab);
+                SurfaceExtractorMC extractor(slab);
+                if (!extractor.Extract(level, slabVertices, slabIndices))
+                {
+                    vertices.clear();
+                    indices.clear();
+                    return false;
+                }
+
+                int vbase = static_cast<int>(vertices.size());
+                for (auto vertex : slabVertices)
+                {
+                    vertex[2] += static_cast<Real>(zmin);
+                    vertices.push_back(vertex);
+                }
+                for (auto index : slabIndices)
+                {
+                    indices.push_back(vbase + index);
+                }
+            }
+            return true;
+        }
+
         // The extraction has duplicate vertices on edges shared by voxels.  This
         // function will eliminate the duplication.
         void MakeUnique(std::vector<Vector3<Real>>& vertices, std::vector<int>& indices) const
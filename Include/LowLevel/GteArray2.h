@@ -3,16 +3,17 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/24)
 
 #pragma once
 
-#include <GTEngineDEF.h>
-#include <cstddef>
-#include <vector>
+#include <LowLevel/GteArrayStorage.h>
 
 // The Array2 class represents a 2-dimensional array that minimizes the number
-// of new and delete calls.  The T objects are stored in a contiguous array.
+// of new and delete calls.  The T objects are stored in a contiguous block
+// with stride-based addressing; see GteArrayStorage.h.  The element (i0,i1)
+// is GetData()[i0 + stride1*i1], where stride1 = GetStride1() is bound0
+// unless the rows are padded.
 
 namespace gte
 {
@@ -23,14 +24,17 @@ class Array2
 public:
     // Construction.  The first constructor generates an array of objects that
     // are owned by Array2.  The second constructor is given an array of
-    // objects that are owned by the caller.  The array has bound0 columns and
-    // bound1 rows.
+    // objects that are owned by the caller, stored contiguously without
+    // padding.  The third constructor allows the alignment, the row padding
+    // and the arena of the storage to be specified.  The array has
+    // bound0 columns and bound1 rows.
     Array2(size_t bound0, size_t bound1);
     Array2(size_t bound0, size_t bound1, T* objects);
+    Array2(size_t bound0, size_t bound1, ArrayOptions const& options);
 
     // Support for dynamic resizing, copying, or moving.  If 'other' does
-    // not own the original 'objects', they are not copied by the assignment
-    // operator.
+    // not own the original 'objects' (caller or arena storage), they are not
+    // copied by the assignment operator.
     Array2();
     Array2(Array2 const& other);
     Array2& operator=(Array2 const& other);
@@ -41,18 +45,21 @@ public:
     //   Array2<T> myArray(3, 2);
     //   T* row1 = myArray[1];
     //   T row1Col2 = myArray[1][2];
+    //   T row1Col2 = myArray(2, 1);
     inline size_t GetBound0() const;
     inline size_t GetBound1() const;
+    inline size_t GetStride1() const;
     inline T const* operator[] (int row) const;
     inline T* operator[] (int row);
+    inline T const& operator()(size_t i0, size_t i1) const;
+    inline T& operator()(size_t i0, size_t i1);
+    inline T const* GetData() const;
+    inline T* GetData();
 
 private:
-    void SetPointers(T* objects);
-    void SetPointers(Array2 const& other);
-
     size_t mBound0, mBound1;
-    std::vector<T> mObjects;
-    std::vector<T*> mIndirect1;
+    size_t mStride1;
+    ArrayStorage<T> mStorage;
 };
 
 template <typename T>
@@ -60,10 +67,9 @@ Array2<T>::Array2(size_t bound0, size_t bound1)
     :
     mBound0(bound0),
     mBound1(bound1),
-    mObjects(bound0 * bound1),
-    mIndirect1(bound1)
+    mStride1(bound0),
+    mStorage(bound0 * bound1, ArrayOptions())
 {
-    SetPointers(mObjects.data());
 }
 
 template <typename T>
@@ -71,16 +77,28 @@ Array2<T>::Array2(size_t bound0, size_t bound1, T* objects)
     :
     mBound0(bound0),
     mBound1(bound1),
-    mIndirect1(bound1)
+    mStride1(bound0),
+    mStorage(objects)
+{
+}
+
+template <typename T>
+Array2<T>::Array2(size_t bound0, size_t bound1, ArrayOptions const& options)
+    :
+    mBound0(bound0),
+    mBound1(bound1),
+    mStride1(ArrayStorage<T>::GetRowStride(bound0, options)),
+    mStorage(mStride1 * bound1, options)
 {
-    SetPointers(objects);
 }
 
 template <typename T>
 Array2<T>::Array2()
     :
     mBound0(0),
-    mBound1(0)
+    mBound1(0),
+    mStride1(0),
+    mStorage()
 {
 }
 
@@ -93,9 +111,10 @@ Array2<T>::Array2(Array2 const& other)
 template <typename T>
 Array2<T>& Array2<T>::operator=(Array2 const& other)
 {
-    // The copy is valid whether or not other.mObjects has elements.
-    mObjects = other.mObjects;
-    SetPointers(other);
+    mBound0 = other.mBound0;
+    mBound1 = other.mBound1;
+    mStride1 = other.mStride1;
+    mStorage = other.mStorage;
     return *this;
 }
 
@@ -108,9 +127,10 @@ Array2<T>::Array2(Array2&& other)
 template <typename T>
 Array2<T>& Array2<T>::operator=(Array2&& other)
 {
-    // The move is valid whether or not other.mObjects has elements.
-    mObjects = std::move(other.mObjects);
-    SetPointers(other);
+    mBound0 = other.mBound0;
+    mBound1 = other.mBound1;
+    mStride1 = other.mStride1;
+    mStorage = std::move(other.mStorage);
     return *this;
 }
 
@@ -126,46 +146,46 @@ size_t Array2<T>::GetBound1() const
     return mBound1;
 }
 
+template <typename T> inline
+size_t Array2<T>::GetStride1() const
+{
+    return mStride1;
+}
+
 template <typename T> inline
 T const* Array2<T>::operator[] (int row) const
 {
-    return mIndirect1[row];
+    return mStorage.Get() + mStride1 * row;
 }
 
 template <typename T> inline
 T* Array2<T>::operator[] (int row)
 {
-    return mIndirect1[row];
+    return mStorage.Get() + mStride1 * row;
 }
 
-template <typename T>
-void Array2<T>::SetPointers(T* objects)
+template <typename T> inline
+T const& Array2<T>::operator()(size_t i0, size_t i1) const
 {
-    for (size_t i1 = 0; i1 < mBound1; ++i1)
-    {
-        size_t j0 = mBound0 * i1;  // = bound0 * (i1 + j1) where j1 = 0
-        mIndirect1[i1] = &objects[j0];
-    }
+    return mStorage.Get()[i0 + mStride1 * i1];
 }
 
-template <typename T>
-void Array2<T>::SetPointers(Array2 const& other)
+template <typename T> inline
+T& Array2<T>::operator()(size_t i0, size_t i1)
 {
-    mBound0 = other.mBound0;
-    mBound1 = other.mBound1;
-    mIndirect1.resize(mBound1);
-
-    if (mBound0 > 0)
-    {
-        // The objects are owned.
-        SetPointers(mObjects.data());
-    }
-    else if (mIndirect1.size() > 0)
-    {
-        // The objects are not owned.
-        SetPointers(other.mIndirect1[0]);
-    }
-    // else 'other' is an empty Array2.
+    return mStorage.Get()[i0 + mStride1 * i1];
+}
+
+template <typename T> inline
+T const* Array2<T>::GetData() const
+{
+    return mStorage.Get();
+}
+
+template <typename T> inline
+T* Array2<T>::GetData()
+{
+    return mStorage.Get();
 }
 
 }
@@ -3,16 +3,18 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/24)
 
 #pragma once
 
-#include <GTEngineDEF.h>
-#include <cstddef>
-#include <vector>
+#include <LowLevel/GteArrayStorage.h>
 
 // The Array3 class represents a 3-dimensional array that minimizes the number
-// of new and delete calls.  The T objects are stored in a contiguous array.
+// of new and delete calls.  The T objects are stored in a contiguous block
+// with stride-based addressing; see GteArrayStorage.h.  The element
+// (i0,i1,i2) is GetData()[i0 + stride1*i1 + stride2*i2], where stride1 =
+// GetStride1() is bound0 unless the rows are padded and stride2 =
+// GetStride2() = stride1*bound1.
 
 namespace gte
 {
@@ -23,39 +25,47 @@ class Array3
 public:
     // Construction.  The first constructor generates an array of objects that
     // are owned by Array3.  The second constructor is given an array of
-    // objects that are owned by the caller.  The array has bound0 columns,
-    // bound1 rows, and bound2 slices.
+    // objects that are owned by the caller, stored contiguously without
+    // padding.  The third constructor allows the alignment, the row padding
+    // and the arena of the storage to be specified.  The array has
+    // bound0 columns, bound1 rows, and bound2 slices.
     Array3(size_t bound0, size_t bound1, size_t bound2);
     Array3(size_t bound0, size_t bound1, size_t bound2, T* objects);
+    Array3(size_t bound0, size_t bound1, size_t bound2,
+        ArrayOptions const& options);
 
     // Support for dynamic resizing, copying, or moving.  If 'other' does
-    // not own the original 'objects', they are not copied by the assignment
-    // operator.
+    // not own the original 'objects' (caller or arena storage), they are not
+    // copied by the assignment operator.
     Array3();
-    Array3(Array3 const&);
-    Array3& operator=(Array3 const&);
-    Array3(Array3&&);
-    Array3& operator=(Array3&&);
+    Array3(Array3 const& other);
+    Array3& operator=(Array3 const& other);
+    Array3(Array3&& other);
+    Array3& operator=(Array3&& other);
 
     // Access to the array.  Sample usage is
     //   Array3<T> myArray(4, 3, 2);
-    //   T** slice1 = myArray[1];
     //   T* slice1row2 = myArray[1][2];
     //   T slice1Row2Col3 = myArray[1][2][3];
+    //   T slice1Row2Col3 = myArray(3, 2, 1);
+    // The operator[] returns a view that supports further indexing; it is
+    // not a T** as in earlier versions.
     inline size_t GetBound0() const;
     inline size_t GetBound1() const;
     inline size_t GetBound2() const;
-    inline T* const* operator[] (int slice) const;
-    inline T** operator[] (int slice);
+    inline size_t GetStride1() const;
+    inline size_t GetStride2() const;
+    inline ArrayView2<T const> operator[] (int slice) const;
+    inline ArrayView2<T> operator[] (int slice);
+    inline T const& operator()(size_t i0, size_t i1, size_t i2) const;
+    inline T& operator()(size_t i0, size_t i1, size_t i2);
+    inline T const* GetData() const;
+    inline T* GetData();
 
 private:
-    void SetPointers(T* objects);
-    void SetPointers(Array3 const& other);
-
     size_t mBound0, mBound1, mBound2;
-    std::vector<T> mObjects;
-    std::vector<T*> mIndirect1;
-    std::vector<T**> mIndirect2;
+    size_t mStride1, mStride2;
+    ArrayStorage<T> mStorage;
 };
 
 template <typename T>
@@ -64,11 +74,10 @@ Array3<T>::Array3(size_t bound0, size_t bound1, size_t bound2)
     mBound0(bound0),
     mBound1(bound1),
     mBound2(bound2),
-    mObjects(bound0 * bound1 * bound2),
-    mIndirect1(bound1 * bound2),
-    mIndirect2(bound2)
+    mStride1(bound0),
+    mStride2(mStride1 * bound1),
+    mStorage(bound0 * bound1 * bound2, ArrayOptions())
 {
-    SetPointers(mObjects.data());
 }
 
 template <typename T>
@@ -77,10 +86,22 @@ Array3<T>::Array3(size_t bound0, size_t bound1, size_t bound2, T* objects)
     mBound0(bound0),
     mBound1(bound1),
     mBound2(bound2),
-    mIndirect1(bound1 * bound2),
-    mIndirect2(bound2)
+    mStride1(bound0),
+    mStride2(mStride1 * bound1),
+    mStorage(objects)
+{
+}
+
+template <typename T>
+Array3<T>::Array3(size_t bound0, size_t bound1, size_t bound2, ArrayOptions const& options)
+    :
+    mBound0(bound0),
+    mBound1(bound1),
+    mBound2(bound2),
+    mStride1(ArrayStorage<T>::GetRowStride(bound0, options)),
+    mStride2(mStride1 * bound1),
+    mStorage(mStride2 * bound2, options)
 {
-    SetPointers(objects);
 }
 
 template <typename T>
@@ -88,7 +109,10 @@ Array3<T>::Array3()
     :
     mBound0(0),
     mBound1(0),
-    mBound2(0)
+    mBound2(0),
+    mStride1(0),
+    mStride2(0),
+    mStorage()
 {
 }
 
@@ -101,9 +125,12 @@ Array3<T>::Array3(Array3 const& other)
 template <typename T>
 Array3<T>& Array3<T>::operator=(Array3 const& other)
 {
-    // The copy is valid whether or not other.mObjects has elements.
-    mObjects = other.mObjects;
-    SetPointers(other);
+    mBound0 = other.mBound0;
+    mBound1 = other.mBound1;
+    mBound2 = other.mBound2;
+    mStride1 = other.mStride1;
+    mStride2 = other.mStride2;
+    mStorage = other.mStorage;
     return *this;
 }
 
@@ -116,9 +143,12 @@ Array3<T>::Array3(Array3&& other)
 template <typename T>
 Array3<T>& Array3<T>::operator=(Array3&& other)
 {
-    // The move is valid whether or not other.mObjects has elements.
-    mObjects = std::move(other.mObjects);
-    SetPointers(other);
+    mBound0 = other.mBound0;
+    mBound1 = other.mBound1;
+    mBound2 = other.mBound2;
+    mStride1 = other.mStride1;
+    mStride2 = other.mStride2;
+    mStorage = std::move(other.mStorage);
     return *this;
 }
 
@@ -141,52 +171,51 @@ size_t Array3<T>::GetBound2() const
 }
 
 template <typename T> inline
-T* const* Array3<T>::operator[] (int slice) const
+size_t Array3<T>::GetStride1() const
 {
-    return mIndirect2[slice];
+    return mStride1;
 }
 
 template <typename T> inline
-T** Array3<T>::operator[] (int slice)
+size_t Array3<T>::GetStride2() const
 {
-    return mIndirect2[slice];
+    return mStride2;
 }
 
-template <typename T>
-void Array3<T>::SetPointers(T* objects)
+template <typename T> inline
+ArrayView2<T const> Array3<T>::operator[] (int slice) const
 {
-    for (size_t i2 = 0; i2 < mBound2; ++i2)
-    {
-        size_t j1 = mBound1 * i2;  // = bound1 * (i2 + j2) where j2 = 0
-        mIndirect2[i2] = &mIndirect1[j1];
-        for (size_t i1 = 0; i1 < mBound1; ++i1)
-        {
-            size_t j0 = mBound0 * (i1 + j1);
-            mIndirect2[i2][i1] = &objects[j0];
-        }
-    }
+    return ArrayView2<T const>(mStorage.Get() + mStride2 * slice, mStride1);
 }
 
-template <typename T>
-void Array3<T>::SetPointers(Array3 const& other)
+template <typename T> inline
+ArrayView2<T> Array3<T>::operator[] (int slice)
 {
-    mBound0 = other.mBound0;
-    mBound1 = other.mBound1;
-    mBound2 = other.mBound2;
-    mIndirect1.resize(mBound1 * mBound2);
-    mIndirect2.resize(mBound2);
-
-    if (mBound0 > 0)
-    {
-        // The objects are owned.
-        SetPointers(mObjects.data());
-    }
-    else if (mIndirect1.size() > 0)
-    {
-        // The objects are not owned.
-        SetPointers(other.mIndirect2[0][0]);
-    }
-    // else 'other' is an empty Array3.
+    return ArrayView2<T>(mStorage.Get() + mStride2 * slice, mStride1);
+}
+
+template <typename T> inline
+T const& Array3<T>::operator()(size_t i0, size_t i1, size_t i2) const
+{
+    return mStorage.Get()[i0 + mStride1 * i1 + mStride2 * i2];
+}
+
+template <typename T> inline
+T& Array3<T>::operator()(size_t i0, size_t i1, size_t i2)
+{
+    return mStorage.Get()[i0 + mStride1 * i1 + mStride2 * i2];
+}
+
+template <typename T> inline
+T const* Array3<T>::GetData() const
+{
+    return mStorage.Get();
+}
+
+template <typename T> inline
+T* Array3<T>::GetData()
+{
+    return mStorage.Get();
 }
 
 }
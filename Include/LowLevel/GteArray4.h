@@ -3,16 +3,19 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/24)
 
 #pragma once
 
-#include <GTEngineDEF.h>
-#include <cstddef>
-#include <vector>
+#include <LowLevel/GteArrayStorage.h>
 
 // The Array4 class represents a 4-dimensional array that minimizes the number
-// of new and delete calls.  The T objects are stored in a contiguous array.
+// of new and delete calls.  The T objects are stored in a contiguous block
+// with stride-based addressing; see GteArrayStorage.h.  The element
+// (i0,i1,i2,i3) is GetData()[i0 + stride1*i1 + stride2*i2 + stride3*i3],
+// where stride1 = GetStride1() is bound0 unless the rows are padded,
+// stride2 = GetStride2() = stride1*bound1 and stride3 = GetStride3() =
+// stride2*bound2.
 
 namespace gte
 {
@@ -23,42 +26,50 @@ class Array4
 public:
     // Construction.  The first constructor generates an array of objects that
     // are owned by Array4.  The second constructor is given an array of
-    // objects that are owned by the caller.  The array has bound0 columns,
-    // bound1 rows, bound2 slices, and bound3 cuboids.
+    // objects that are owned by the caller, stored contiguously without
+    // padding.  The third constructor allows the alignment, the row padding
+    // and the arena of the storage to be specified.  The array has
+    // bound0 columns, bound1 rows, bound2 slices, and bound3 cuboids.
     Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3);
-    Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3, T* objects);
+    Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3,
+        T* objects);
+    Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3,
+        ArrayOptions const& options);
 
     // Support for dynamic resizing, copying, or moving.  If 'other' does
-    // not own the original 'objects', they are not copied by the assignment
-    // operator.
+    // not own the original 'objects' (caller or arena storage), they are not
+    // copied by the assignment operator.
     Array4();
-    Array4(Array4 const&);
-    Array4& operator=(Array4 const&);
-    Array4(Array4&&);
-    Array4& operator=(Array4&&);
+    Array4(Array4 const& other);
+    Array4& operator=(Array4 const& other);
+    Array4(Array4&& other);
+    Array4& operator=(Array4&& other);
 
     // Access to the array.  Sample usage is
     //   Array4<T> myArray(5, 4, 3, 2);
-    //   T*** cuboid1 = myArray[1];
-    //   T** cuboid1Slice2 = myArray[1][2];
     //   T* cuboid1Slice2Row3 = myArray[1][2][3];
     //   T cuboid1Slice2Row3Col4 = myArray[1][2][3][4];
+    //   T cuboid1Slice2Row3Col4 = myArray(4, 3, 2, 1);
+    // The operator[] returns a view that supports further indexing; it is
+    // not a T*** as in earlier versions.
     inline size_t GetBound0() const;
     inline size_t GetBound1() const;
     inline size_t GetBound2() const;
     inline size_t GetBound3() const;
-    inline T** const* operator[] (int cuboid) const;
-    inline T*** operator[] (int cuboid);
+    inline size_t GetStride1() const;
+    inline size_t GetStride2() const;
+    inline size_t GetStride3() const;
+    inline ArrayView3<T const> operator[] (int cuboid) const;
+    inline ArrayView3<T> operator[] (int cuboid);
+    inline T const& operator()(size_t i0, size_t i1, size_t i2, size_t i3) const;
+    inline T& operator()(size_t i0, size_t i1, size_t i2, size_t i3);
+    inline T const* GetData() const;
+    inline T* GetData();
 
 private:
-    void SetPointers(T* objects);
-    void SetPointers(Array4 const& other);
-
     size_t mBound0, mBound1, mBound2, mBound3;
-    std::vector<T> mObjects;
-    std::vector<T*> mIndirect1;
-    std::vector<T**> mIndirect2;
-    std::vector<T***> mIndirect3;
+    size_t mStride1, mStride2, mStride3;
+    ArrayStorage<T> mStorage;
 };
 
 template <typename T>
@@ -68,26 +79,41 @@ Array4<T>::Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3)
     mBound1(bound1),
     mBound2(bound2),
     mBound3(bound3),
-    mObjects(bound0 * bound1 * bound2 * bound3),
-    mIndirect1(bound1 * bound2 * bound3),
-    mIndirect2(bound2 * bound3),
-    mIndirect3(bound3)
+    mStride1(bound0),
+    mStride2(mStride1 * bound1),
+    mStride3(mStride2 * bound2),
+    mStorage(bound0 * bound1 * bound2 * bound3, ArrayOptions())
+{
+}
+
+template <typename T>
+Array4<T>::Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3,
+    T* objects)
+    :
+    mBound0(bound0),
+    mBound1(bound1),
+    mBound2(bound2),
+    mBound3(bound3),
+    mStride1(bound0),
+    mStride2(mStride1 * bound1),
+    mStride3(mStride2 * bound2),
+    mStorage(objects)
 {
-    SetPointers(mObjects.data());
 }
 
 template <typename T>
-Array4<T>::Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3, T* objects)
+Array4<T>::Array4(size_t bound0, size_t bound1, size_t bound2, size_t bound3,
+    ArrayOptions const& options)
     :
     mBound0(bound0),
     mBound1(bound1),
     mBound2(bound2),
     mBound3(bound3),
-    mIndirect1(bound1 * bound2 * bound3),
-    mIndirect2(bound2 * bound3),
-    mIndirect3(bound3)
+    mStride1(ArrayStorage<T>::GetRowStride(bound0, options)),
+    mStride2(mStride1 * bound1),
+    mStride3(mStride2 * bound2),
+    mStorage(mStride3 * bound3, options)
 {
-    SetPointers(objects);
 }
 
 template <typename T>
@@ -96,7 +122,11 @@ Array4<T>::Array4()
     mBound0(0),
     mBound1(0),
     mBound2(0),
-    mBound3(0)
+    mBound3(0),
+    mStride1(0),
+    mStride2(0),
+    mStride3(0),
+    mStorage()
 {
 }
 
@@ -109,9 +139,14 @@ Array4<T>::Array4(Array4 const& other)
 template <typename T>
 Array4<T>& Array4<T>::operator=(Array4 const& other)
 {
-    // The copy is valid whether or not other.mObjects has elements.
-    mObjects = other.mObjects;
-    SetPointers(other);
+    mBound0 = other.mBound0;
+    mBound1 = other.mBound1;
+    mBound2 = other.mBound2;
+    mBound3 = other.mBound3;
+    mStride1 = other.mStride1;
+    mStride2 = other.mStride2;
+    mStride3 = other.mStride3;
+    mStorage = other.mStorage;
     return *this;
 }
 
@@ -124,9 +159,14 @@ Array4<T>::Array4(Array4&& other)
 template <typename T>
 Array4<T>& Array4<T>::operator=(Array4&& other)
 {
-    // The move is valid whether or not other.mObjects has elements.
-    mObjects = std::move(other.mObjects);
-    SetPointers(other);
+    mBound0 = other.mBound0;
+    mBound1 = other.mBound1;
+    mBound2 = other.mBound2;
+    mBound3 = other.mBound3;
+    mStride1 = other.mStride1;
+    mStride2 = other.mStride2;
+    mStride3 = other.mStride3;
+    mStorage = std::move(other.mStorage);
     return *this;
 }
 
@@ -155,59 +195,57 @@ size_t Array4<T>::GetBound3() const
 }
 
 template <typename T> inline
-T** const* Array4<T>::operator[] (int cuboid) const
+size_t Array4<T>::GetStride1() const
 {
-    return mIndirect3[cuboid];
+    return mStride1;
 }
 
 template <typename T> inline
-T*** Array4<T>::operator[] (int cuboid)
+size_t Array4<T>::GetStride2() const
 {
-    return mIndirect3[cuboid];
+    return mStride2;
 }
 
-template <typename T>
-void Array4<T>::SetPointers(T* objects)
-{
-    for (size_t i3 = 0; i3 < mBound3; ++i3)
-    {
-        size_t j2 = mBound2 * i3;  // = bound2 * (i3 + j3) where j3 = 0
-        mIndirect3[i3] = &mIndirect2[j2];
-        for (size_t i2 = 0; i2 < mBound2; ++i2)
-        {
-            size_t j1 = mBound1 * (i2 + j2);
-            mIndirect3[i3][i2] = &mIndirect1[j1];
-            for (size_t i1 = 0; i1 < mBound1; ++i1)
-            {
-                size_t j0 = mBound0 * (i1 + j1);
-                mIndirect3[i3][i2][i1] = &objects[j0];
-            }
-        }
-    }
+template <typename T> inline
+size_t Array4<T>::GetStride3() const
+{
+    return mStride3;
 }
 
-template <typename T>
-void Array4<T>::SetPointers(Array4 const& other)
+template <typename T> inline
+ArrayView3<T const> Array4<T>::operator[] (int cuboid) const
 {
-    mBound0 = other.mBound0;
-    mBound1 = other.mBound1;
-    mBound2 = other.mBound2;
-    mBound3 = other.mBound3;
-    mIndirect1.resize(mBound1 * mBound2 * mBound3);
-    mIndirect2.resize(mBound2 * mBound3);
-    mIndirect3.resize(mBound3);
-
-    if (mBound0 > 0)
-    {
-        // The objects are owned.
-        SetPointers(mObjects.data());
-    }
-    else if (mIndirect1.size() > 0)
-    {
-        // The objects are not owned.
-        SetPointers(other.mIndirect3[0][0][0]);
-    }
-    // else 'other' is an empty Array3.
+    return ArrayView3<T const>(mStorage.Get() + mStride3 * cuboid, mStride1, mStride2);
+}
+
+template <typename T> inline
+ArrayView3<T> Array4<T>::operator[] (int cuboid)
+{
+    return ArrayView3<T>(mStorage.Get() + mStride3 * cuboid, mStride1, mStride2);
+}
+
+template <typename T> inline
+T const& Array4<T>::operator()(size_t i0, size_t i1, size_t i2, size_t i3) const
+{
+    return mStorage.Get()[i0 + mStride1 * i1 + mStride2 * i2 + mStride3 * i3];
+}
+
+template <typename T> inline
+T& Array4<T>::operator()(size_t i0, size_t i1, size_t i2, size_t i3)
+{
+    return mStorage.Get()[i0 + mStride1 * i1 + mStride2 * i2 + mStride3 * i3];
+}
+
+template <typename T> inline
+T const* Array4<T>::GetData() const
+{
+    return mStorage.Get();
+}
+
+template <typename T> inline
+T* Array4<T>::GetData()
+{
+    return mStorage.Get();
 }
 
 }
@@ -0,0 +1,381 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/24)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Support for the flat storage of Array2, Array3 and Array4.  The elements
+// of an array are stored in a single block.  The first index (bound0) varies
+// fastest; consecutive rows of bound0 elements start 'stride1' elements
+// apart, where stride1 is bound0 or, when the rows are padded, bound0
+// rounded up so that every row starts on an 'alignment' boundary.  The
+// higher strides are products of stride1 and the bounds, so a[z][y][x] is
+// computed as base[x + stride1*y + stride2*z] without indirection tables.
+//
+// The block is owned by the array (allocated on the heap with the requested
+// alignment), allocated from an ArrayArena, or supplied by the caller.
+
+namespace gte
+{
+
+// A bump allocator for the storage of many arrays.  The memory is obtained
+// in large blocks and is released only by Clear() or by the destructor, so
+// arrays allocated from the arena must not outlive it.  The arena does not
+// call destructors, so ArrayStorage uses an arena only for trivially
+// destructible types and allocates other types on the heap.
+class ArrayArena
+{
+public:
+    // Construction and destruction.  Allocations larger than blockSize bytes
+    // receive a block of their own.
+    ArrayArena(size_t blockSize = (static_cast<size_t>(1) << 20));
+    ArrayArena(ArrayArena const&) = delete;
+    ArrayArena& operator=(ArrayArena const&) = delete;
+
+    // Return numBytes of memory aligned to 'alignment' bytes, which must be
+    // a power of two.
+    void* Allocate(size_t numBytes, size_t alignment);
+
+    // Release all the blocks.
+    void Clear();
+
+private:
+    size_t mBlockSize;
+    std::vector<std::unique_ptr<char[]>> mBlocks;
+    char* mCurrent;
+    size_t mAvailable;
+};
+
+// The options for constructing arrays.  The alignment is in bytes and must
+// be a power of two.  When padRows is true and the alignment is a multiple
+// of sizeof(T), each row is padded to a multiple of the alignment; this
+// allows SIMD loads of full rows.  When arena is not null, the storage is
+// allocated from the arena rather than the heap.
+struct ArrayOptions
+{
+    enum { DEFAULT_ALIGNMENT = 64 };
+
+    ArrayOptions(size_t inAlignment = DEFAULT_ALIGNMENT, bool inPadRows = false,
+        ArrayArena* inArena = nullptr);
+
+    size_t alignment;
+    bool padRows;
+    ArrayArena* arena;
+};
+
+template <typename T>
+class ArrayStorage
+{
+public:
+    // Construction and destruction.  The objects are value initialized when
+    // the storage is allocated (heap or arena).  The storage of the last
+    // constructor is owned by the caller.
+    ArrayStorage();
+    ArrayStorage(size_t numElements, ArrayOptions const& options);
+    ArrayStorage(T* objects);
+    ~ArrayStorage();
+
+    // Support for copying or moving.  If 'other' does not own its objects
+    // (arena or caller storage), the copy refers to the same objects.
+    ArrayStorage(ArrayStorage const& other);
+    ArrayStorage& operator=(ArrayStorage const& other);
+    ArrayStorage(ArrayStorage&& other);
+    ArrayStorage& operator=(ArrayStorage&& other);
+
+    inline T* Get() const;
+
+    // The number of elements between the starts of consecutive rows of
+    // bound0 elements.
+    static size_t GetRowStride(size_t bound0, ArrayOptions const& options);
+
+private:
+    void Allocate(size_t numElements, size_t alignment);
+    void Free();
+
+    T* mObjects;
+    size_t mNumElements;
+    size_t mAlignment;
+    void* mBlock;  // not null when the objects are owned
+};
+
+// The views returned by the operator[] of Array3 and Array4.  They are
+// lightweight and are meant to be used only in expressions such as
+// a[z][y][x].
+template <typename T>
+class ArrayView2
+{
+public:
+    inline ArrayView2(T* objects, size_t stride1);
+    inline T* operator[] (int row) const;
+
+private:
+    T* mObjects;
+    size_t mStride1;
+};
+
+template <typename T>
+class ArrayView3
+{
+public:
+    inline ArrayView3(T* objects, size_t stride1, size_t stride2);
+    inline ArrayView2<T> operator[] (int slice) const;
+
+private:
+    T* mObjects;
+    size_t mStride1, mStride2;
+};
+
+
+inline ArrayArena::ArrayArena(size_t blockSize)
+    :
+    mBlockSize(blockSize),
+    mCurrent(nullptr),
+    mAvailable(0)
+{
+}
+
+inline void* ArrayArena::Allocate(size_t numBytes, size_t alignment)
+{
+    size_t const mask = alignment - 1;
+    size_t pad = (alignment - (reinterpret_cast<uintptr_t>(mCurrent) & mask)) & mask;
+    if (mCurrent == nullptr || pad + numBytes > mAvailable)
+    {
+        size_t const size = std::max(mBlockSize, numBytes + mask);
+        mBlocks.push_back(std::unique_ptr<char[]>(new char[size]));
+        mCurrent = mBlocks.back().get();
+        mAvailable = size;
+        pad = (alignment - (reinterpret_cast<uintptr_t>(mCurrent) & mask)) & mask;
+    }
+
+    char* result = mCurrent + pad;
+    mCurrent = result + numBytes;
+    mAvailable -= pad + numBytes;
+    return result;
+}
+
+inline void ArrayArena::Clear()
+{
+    mBlocks.clear();
+    mCurrent = nullptr;
+    mAvailable = 0;
+}
+
+
+inline ArrayOptions::ArrayOptions(size_t inAlignment, bool inPadRows,
+    ArrayArena* inArena)
+    :
+    alignment(inAlignment),
+    padRows(inPadRows),
+    arena(inArena)
+{
+}
+
+
+template <typename T>
+ArrayStorage<T>::ArrayStorage()
+    :
+    mObjects(nullptr),
+    mNumElements(0),
+    mAlignment(alignof(T)),
+    mBlock(nullptr)
+{
+}
+
+template <typename T>
+ArrayStorage<T>::ArrayStorage(size_t numElements, ArrayOptions const& options)
+    :
+    mObjects(nullptr),
+    mNumElements(0),
+    mAlignment(std::max(options.alignment, alignof(T))),
+    mBlock(nullptr)
+{
+    if (options.arena && std::is_trivially_destructible<T>::value)
+    {
+        mObjects = static_cast<T*>(options.arena->Allocate(
+            numElements * sizeof(T), mAlignment));
+        mNumElements = numElements;
+        for (size_t i = 0; i < numElements; ++i)
+        {
+            new (&mObjects[i]) T();
+        }
+    }
+    else
+    {
+        Allocate(numElements, mAlignment);
+        for (size_t i = 0; i < mNumElements; ++i)
+        {
+            new (&mObjects[i]) T();
+        }
+    }
+}
+
+template <typename T>
+ArrayStorage<T>::ArrayStorage(T* objects)
+    :
+    mObjects(objects),
+    mNumElements(0),
+    mAlignment(alignof(T)),
+    mBlock(nullptr)
+{
+}
+
+template <typename T>
+ArrayStorage<T>::~ArrayStorage()
+{
+    Free();
+}
+
+template <typename T>
+ArrayStorage<T>::ArrayStorage(ArrayStorage const& other)
+    :
+    mObjects(nullptr),
+    mNumElements(0),
+    mAlignment(alignof(T)),
+    mBlock(nullptr)
+{
+    *this = other;
+}
+
+template <typename T>
+ArrayStorage<T>& ArrayStorage<T>::operator=(ArrayStorage const& other)
+{
+    if (this != &other)
+    {
+        Free();
+        mAlignment = other.mAlignment;
+        if (other.mBlock)
+        {
+            Allocate(other.mNumElements, other.mAlignment);
+            for (size_t i = 0; i < mNumElements; ++i)
+            {
+                new (&mObjects[i]) T(other.mObjects[i]);
+            }
+        }
+        else
+        {
+            mObjects = other.mObjects;
+            mNumElements = other.mNumElements;
+        }
+    }
+    return *this;
+}
+
+template <typename T>
+ArrayStorage<T>::ArrayStorage(ArrayStorage&& other)
+    :
+    mObjects(nullptr),
+    mNumElements(0),
+    mAlignment(alignof(T)),
+    mBlock(nullptr)
+{
+    *this = std::move(other);
+}
+
+template <typename T>
+ArrayStorage<T>& ArrayStorage<T>::operator=(ArrayStorage&& other)
+{
+    if (this != &other)
+    {
+        Free();
+        mObjects = other.mObjects;
+        mNumElements = other.mNumElements;
+        mAlignment = other.mAlignment;
+        mBlock = other.mBlock;
+        other.mObjects = nullptr;
+        other.mNumElements = 0;
+        other.mBlock = nullptr;
+    }
+    return *this;
+}
+
+template <typename T> inline
+T* ArrayStorage<T>::Get() const
+{
+    return mObjects;
+}
+
+template <typename T>
+size_t ArrayStorage<T>::GetRowStride(size_t bound0, ArrayOptions const& options)
+{
+    if (options.padRows && options.alignment % sizeof(T) == 0)
+    {
+        size_t const multiple = options.alignment / sizeof(T);
+        return ((bound0 + multiple - 1) / multiple) * multiple;
+    }
+    return bound0;
+}
+
+template <typename T>
+void ArrayStorage<T>::Allocate(size_t numElements, size_t alignment)
+{
+    // The objects are constructed by the caller.
+    if (numElements > 0)
+    {
+        mBlock = ::operator new(numElements * sizeof(T) + alignment - 1);
+        uintptr_t address = reinterpret_cast<uintptr_t>(mBlock);
+        address = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        mObjects = reinterpret_cast<T*>(address);
+        mNumElements = numElements;
+    }
+}
+
+template <typename T>
+void ArrayStorage<T>::Free()
+{
+    if (mBlock)
+    {
+        for (size_t i = 0; i < mNumElements; ++i)
+        {
+            mObjects[i].~T();
+        }
+        ::operator delete(mBlock);
+        mBlock = nullptr;
+    }
+    mObjects = nullptr;
+    mNumElements = 0;
+}
+
+
+template <typename T> inline
+ArrayView2<T>::ArrayView2(T* objects, size_t stride1)
+    :
+    mObjects(objects),
+    mStride1(stride1)
+{
+}
+
+template <typename T> inline
+T* ArrayView2<T>::operator[] (int row) const
+{
+    return mObjects + mStride1 * row;
+}
+
+template <typename T> inline
+ArrayView3<T>::ArrayView3(T* objects, size_t stride1, size_t stride2)
+    :
+    mObjects(objects),
+    mStride1(stride1),
+    mStride2(stride2)
+{
+}
+
+template <typename T> inline
+ArrayView2<T> ArrayView3<T>::operator[] (int slice) const
+{
+    return ArrayView2<T>(mObjects + mStride2 * slice, mStride1);
+}
+
+
+}
@@ -0,0 +1,400 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/16)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A hash map with the interface of ThreadSafeMap for maps that are read
+// much more often than they are modified, such as the maps from front-end
+// graphics objects to back-end objects.  The keys are distributed among
+// shards by their hash values.  Each shard is an open-addressing table with
+// linear probing and is protected by its own reader-writer lock, so readers
+// never block each other and writers block only the readers of one shard.
+// The hash values of std::hash are mixed before use, because for pointers
+// they are the addresses, whose low-order bits are the same for all objects
+// of a type.  The Key type must be default constructible and support
+// operator==.
+
+namespace gte
+{
+
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class ConcurrentHashMap
+{
+public:
+    // Construction and destruction.  The number of shards is rounded up to a
+    // power of two.
+    virtual ~ConcurrentHashMap();
+    ConcurrentHashMap(size_t numShards = 64);
+
+    // All the operations are thread-safe.
+    bool HasElements() const;
+    size_t GetNumElements() const;
+    bool Exists(Key key) const;
+    void Insert(Key key, Value value);
+    bool Remove(Key key, Value& value);
+    void RemoveAll();
+    bool Get(Key key, Value& value) const;
+    void GatherAll(std::vector<Value>& values) const;
+
+protected:
+    // A reader-writer spin lock.  The low-order bits count the readers and
+    // the high-order bit is set by a writer, which then waits for the
+    // readers to leave.  New readers back off while the bit is set, so the
+    // writers are not starved.
+    class SharedSpinLock
+    {
+    public:
+        SharedSpinLock();
+        void Lock();
+        void Unlock();
+        void LockShared();
+        void UnlockShared();
+
+    private:
+        enum : uint32_t { WRITER = 0x80000000u };
+        std::atomic<uint32_t> mState;
+    };
+
+    struct Slot
+    {
+        Slot() : hash(0), key(), value(), occupied(false) {}
+        size_t hash;
+        Key key;
+        Value value;
+        bool occupied;
+    };
+
+    // The slots are a power of two in number and at most 3/4 full.  The
+    // shards are padded so that the locks of different shards are not on
+    // the same cache line.
+    enum { CACHE_LINE_SIZE = 64, MIN_NUM_SLOTS = 16 };
+
+    struct Shard
+    {
+        Shard() : numElements(0), slots(MIN_NUM_SLOTS) {}
+        mutable SharedSpinLock lock;
+        size_t numElements;
+        std::vector<Slot> slots;
+        char pad[CACHE_LINE_SIZE];
+    };
+
+    // The hash value selects the shard with its low-order bits; the
+    // remaining bits, returned in 'hash', select the slot.
+    Shard& GetShard(Key const& key, size_t& hash) const;
+
+    // Return the index of the slot that contains the key or, when the key
+    // is not in the table, the index of the empty slot that ends its probe
+    // sequence.
+    static size_t Find(Shard const& shard, Key const& key, size_t hash);
+
+    // Double the number of slots and reinsert the elements.
+    static void Grow(Shard& shard);
+
+    // Remove the element of an occupied slot.  The elements after it in
+    // the probe sequence are shifted back so that no tombstones are needed.
+    static void Erase(Shard& shard, size_t i);
+
+    mutable std::vector<Shard> mShards;
+    size_t mShardMask;
+    int mNumShardBits;
+    std::atomic<size_t> mNumElements;
+    Hasher mHasher;
+};
+
+
+template <typename Key, typename Value, typename Hasher>
+ConcurrentHashMap<Key, Value, Hasher>::~ConcurrentHashMap()
+{
+}
+
+template <typename Key, typename Value, typename Hasher>
+ConcurrentHashMap<Key, Value, Hasher>::ConcurrentHashMap(size_t numShards)
+    :
+    mShardMask(0),
+    mNumShardBits(0),
+    mNumElements(0)
+{
+    size_t shardCount = 1;
+    while (shardCount < numShards)
+    {
+        shardCount <<= 1;
+        ++mNumShardBits;
+    }
+
+    mShards = std::vector<Shard>(shardCount);
+    mShardMask = shardCount - 1;
+}
+
+template <typename Key, typename Value, typename Hasher>
+bool ConcurrentHashMap<Key, Value, Hasher>::HasElements() const
+{
+    return mNumElements.load() > 0;
+}
+
+template <typename Key, typename Value, typename Hasher>
+size_t ConcurrentHashMap<Key, Value, Hasher>::GetNumElements() const
+{
+    return mNumElements.load();
+}
+
+template <typename Key, typename Value, typename Hasher>
+bool ConcurrentHashMap<Key, Value, Hasher>::Exists(Key key) const
+{
+    size_t hash;
+    Shard const& shard = GetShard(key, hash);
+    shard.lock.LockShared();
+    bool exists = shard.slots[Find(shard, key, hash)].occupied;
+    shard.lock.UnlockShared();
+    return exists;
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::Insert(Key key, Value value)
+{
+    size_t hash;
+    Shard& shard = GetShard(key, hash);
+    shard.lock.Lock();
+    {
+        size_t i = Find(shard, key, hash);
+        if (!shard.slots[i].occupied)
+        {
+            if (4 * (shard.numElements + 1) > 3 * shard.slots.size())
+            {
+                Grow(shard);
+                i = Find(shard, key, hash);
+            }
+
+            Slot& slot = shard.slots[i];
+            slot.hash = hash;
+            slot.key = key;
+            slot.occupied = true;
+            ++shard.numElements;
+            ++mNumElements;
+        }
+        shard.slots[i].value = value;
+    }
+    shard.lock.Unlock();
+}
+
+template <typename Key, typename Value, typename Hasher>
+bool ConcurrentHashMap<Key, Value, Hasher>::Remove(Key key, Value& value)
+{
+    bool exists;
+    size_t hash;
+    Shard& shard = GetShard(key, hash);
+    shard.lock.Lock();
+    {
+        size_t i = Find(shard, key, hash);
+        exists = shard.slots[i].occupied;
+        if (exists)
+        {
+            value = std::move(shard.slots[i].value);
+            Erase(shard, i);
+            --shard.numElements;
+            --mNumElements;
+        }
+    }
+    shard.lock.Unlock();
+    return exists;
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::RemoveAll()
+{
+    for (auto& shard : mShards)
+    {
+        shard.lock.Lock();
+        {
+            mNumElements -= shard.numElements;
+            shard.numElements = 0;
+            shard.slots = std::vector<Slot>(MIN_NUM_SLOTS);
+        }
+        shard.lock.Unlock();
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+bool ConcurrentHashMap<Key, Value, Hasher>::Get(Key key, Value& value) const
+{
+    bool exists;
+    size_t hash;
+    Shard const& shard = GetShard(key, hash);
+    shard.lock.LockShared();
+    {
+        Slot const& slot = shard.slots[Find(shard, key, hash)];
+        exists = slot.occupied;
+        if (exists)
+        {
+            value = slot.value;
+        }
+    }
+    shard.lock.UnlockShared();
+    return exists;
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::GatherAll(std::vector<Value>& values) const
+{
+    // The shards are locked one at a time, so the values are a snapshot of
+    // the map only when no other thread modifies it.
+    values.clear();
+    for (auto const& shard : mShards)
+    {
+        shard.lock.LockShared();
+        {
+            for (auto const& slot : shard.slots)
+            {
+                if (slot.occupied)
+                {
+                    values.push_back(slot.value);
+                }
+            }
+        }
+        shard.lock.UnlockShared();
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+typename ConcurrentHashMap<Key, Value, Hasher>::Shard&
+ConcurrentHashMap<Key, Value, Hasher>::GetShard(Key const& key, size_t& hash) const
+{
+    // The finalizer of MurmurHash3 mixes all the bits of the input into
+    // the low-order bits of the output.
+    uint64_t h = static_cast<uint64_t>(mHasher(key));
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+
+    hash = static_cast<size_t>(h >> mNumShardBits);
+    return mShards[static_cast<size_t>(h) & mShardMask];
+}
+
+template <typename Key, typename Value, typename Hasher>
+size_t ConcurrentHashMap<Key, Value, Hasher>::Find(Shard const& shard, Key const& key, size_t hash)
+{
+    size_t const mask = shard.slots.size() - 1;
+    size_t i = hash & mask;
+    for (;;)
+    {
+        Slot const& slot = shard.slots[i];
+        if (!slot.occupied || (slot.hash == hash && slot.key == key))
+        {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::Grow(Shard& shard)
+{
+    std::vector<Slot> slots(2 * shard.slots.size());
+    size_t const mask = slots.size() - 1;
+    for (auto& slot : shard.slots)
+    {
+        if (slot.occupied)
+        {
+            size_t i = slot.hash & mask;
+            while (slots[i].occupied)
+            {
+                i = (i + 1) & mask;
+            }
+            slots[i] = std::move(slot);
+        }
+    }
+    shard.slots = std::move(slots);
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::Erase(Shard& shard, size_t i)
+{
+    // An element at slot j with home slot h can fill the hole when the hole
+    // is in the cyclic range [h,j) of its probe sequence.
+    size_t const mask = shard.slots.size() - 1;
+    size_t hole = i;
+    for (size_t j = (i + 1) & mask; shard.slots[j].occupied; j = (j + 1) & mask)
+    {
+        size_t home = shard.slots[j].hash & mask;
+        if (((hole - home) & mask) < ((j - home) & mask))
+        {
+            shard.slots[hole] = std::move(shard.slots[j]);
+            hole = j;
+        }
+    }
+    shard.slots[hole] = Slot();
+}
+
+template <typename Key, typename Value, typename Hasher>
+ConcurrentHashMap<Key, Value, Hasher>::SharedSpinLock::SharedSpinLock()
+    :
+    mState(0)
+{
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::SharedSpinLock::Lock()
+{
+    // Claim the writer bit, and then wait for the readers to leave.
+    uint32_t state = mState.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        if ((state & WRITER) == 0 && mState.compare_exchange_weak(state,
+            state | WRITER, std::memory_order_acquire))
+        {
+            break;
+        }
+        std::this_thread::yield();
+        state = mState.load(std::memory_order_relaxed);
+    }
+
+    while (mState.load(std::memory_order_acquire) != WRITER)
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::SharedSpinLock::Unlock()
+{
+    mState.fetch_sub(WRITER, std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::SharedSpinLock::LockShared()
+{
+    for (;;)
+    {
+        if ((mState.fetch_add(1, std::memory_order_acquire) & WRITER) == 0)
+        {
+            return;
+        }
+        mState.fetch_sub(1, std::memory_order_relaxed);
+        while (mState.load(std::memory_order_relaxed) & WRITER)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+void ConcurrentHashMap<Key, Value, Hasher>::SharedSpinLock::UnlockShared()
+{
+    mState.fetch_sub(1, std::memory_order_release);
+}
+
+
+}
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/24)
 
 #pragma once
 
@@ -17,20 +17,28 @@ namespace gte
 template <bool RowMajor, typename Real, int... Dimensions>
 class LexicoArray2 {};
 
-// The array dimensions are known only at run time.
+// The array dimensions are known only at run time.  The stride is the number
+// of elements between the starts of consecutive rows (row major) or columns
+// (column major).  It defaults to the number of columns (row major) or rows
+// (column major); a larger stride allows access to padded storage.  For
+// example, an Array2<Real> 'a' is viewed as a row-major matrix by
+//   LexicoArray2<true, Real> view((int)a.GetBound1(), (int)a.GetBound0(),
+//       (int)a.GetStride1(), a.GetData());
 template <typename Real>
 class LexicoArray2<true, Real>
 {
 public:
     inline LexicoArray2(int numRows, int numCols, Real* matrix);
+    inline LexicoArray2(int numRows, int numCols, int stride, Real* matrix);
 
     inline int GetNumRows() const;
     inline int GetNumCols() const;
+    inline int GetStride() const;
     inline Real& operator()(int r, int c);
     inline Real const& operator()(int r, int c) const;
 
 private:
-    int mNumRows, mNumCols;
+    int mNumRows, mNumCols, mStride;
     Real* mMatrix;
 };
 
@@ -39,14 +47,16 @@ class LexicoArray2<false, Real>
 {
 public:
     inline LexicoArray2(int numRows, int numCols, Real* matrix);
+    inline LexicoArray2(int numRows, int numCols, int stride, Real* matrix);
 
     inline int GetNumRows() const;
     inline int GetNumCols() const;
+    inline int GetStride() const;
     inline Real& operator()(int r, int c);
     inline Real const& operator()(int r, int c) const;
 
 private:
-    int mNumRows, mNumCols;
+    int mNumRows, mNumCols, mStride;
     Real* mMatrix;
 };
 
@@ -87,6 +97,18 @@ LexicoArray2<true, Real>::LexicoArray2(int numRows, int numCols, Real* matrix)
     :
     mNumRows(numRows),
     mNumCols(numCols),
+    mStride(numCols),
+    mMatrix(matrix)
+{
+}
+
+template <typename Real> inline
+LexicoArray2<true, Real>::LexicoArray2(int numRows, int numCols, int stride,
+    Real* matrix)
+    :
+    mNumRows(numRows),
+    mNumCols(numCols),
+    mStride(stride),
     mMatrix(matrix)
 {
 }
@@ -103,16 +125,22 @@ int LexicoArray2<true, Real>::GetNumCols() const
     return mNumCols;
 }
 
+template <typename Real> inline
+int LexicoArray2<true, Real>::GetStride() const
+{
+    return mStride;
+}
+
 template <typename Real> inline
 Real& LexicoArray2<true, Real>::operator()(int r, int c)
 {
-    return mMatrix[c + mNumCols*r];
+    return mMatrix[c + mStride*r];
 }
 
 template <typename Real> inline
 Real const& LexicoArray2<true, Real>::operator()(int r, int c) const
 {
-    return mMatrix[c + mNumCols*r];
+    return mMatrix[c + mStride*r];
 }
 
 
@@ -122,6 +150,18 @@ LexicoArray2<false, Real>::LexicoArray2(int numRows, int numCols, Real* matrix)
     :
     mNumRows(numRows),
     mNumCols(numCols),
+    mStride(numRows),
+    mMatrix(matrix)
+{
+}
+
+template <typename Real> inline
+LexicoArray2<false, Real>::LexicoArray2(int numRows, int numCols, int stride,
+    Real* matrix)
+    :
+    mNumRows(numRows),
+    mNumCols(numCols),
+    mStride(stride),
     mMatrix(matrix)
 {
 }
@@ -138,16 +178,22 @@ int LexicoArray2<false, Real>::GetNumCols() const
     return mNumCols;
 }
 
+template <typename Real> inline
+int LexicoArray2<false, Real>::GetStride() const
+{
+    return mStride;
+}
+
 template <typename Real> inline
 Real& LexicoArray2<false, Real>::operator()(int r, int c)
 {
-    return mMatrix[r + mNumRows*c];
+    return mMatrix[r + mStride*c];
 }
 
 template <typename Real> inline
 Real const& LexicoArray2<false, Real>::operator()(int r, int c) const
 {
-    return mMatrix[r + mNumRows*c];
+    return mMatrix[r + mStride*c];
 }
 
 
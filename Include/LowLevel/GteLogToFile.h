@@ -3,24 +3,30 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/16)
 
 #pragma once
 
 #include <LowLevel/GteLogger.h>
+#include <fstream>
 
 namespace gte
 {
 
+// The file is opened once and written through a buffer, which is flushed
+// by the logger after each message in synchronous mode and after each batch
+// of messages in asynchronous mode.
 class GTE_IMPEXP LogToFile : public Logger::Listener
 {
 public:
     LogToFile(std::string const& filename, int flags);
 
+    virtual void Flush();
+
 private:
     virtual void Report(std::string const& message);
 
-    std::string mFilename;
+    std::ofstream mFile;
 };
 
 }
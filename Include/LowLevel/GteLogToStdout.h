@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/16)
 
 #pragma once
 
@@ -17,6 +17,8 @@ class GTE_IMPEXP LogToStdout : public Logger::Listener
 public:
     LogToStdout(int flags);
 
+    virtual void Flush();
+
 private:
     virtual void Report(std::string const& message);
 };
@@ -3,11 +3,15 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/16)
 
 #pragma once
 
 #include <GTEngineDEF.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
@@ -24,17 +28,47 @@ class GTE_IMPEXP Logger
 {
 public:
     // Construction.  The Logger object is designed to exist only for a
-    // single-line call.  A string is generated from the input parameters and
-    // is used for reporting.
+    // single-line call.  The file and function must be string literals, as
+    // generated by __FILE__ and __FUNCTION__.  A string is generated from
+    // the input parameters when the message is reported.
     Logger(char const* file, char const* function, int line,
         std::string const& message);
 
-    // Notify current listeners about the logged information.
+    // Notify current listeners about the logged information.  Assertions
+    // and errors are always reported before the functions return.  In
+    // asynchronous mode, warnings and information are queued for the writer
+    // thread.
     void Assertion();
     void Error();
     void Warning();
     void Information();
 
+    // The macros call this before the message is generated.  The function
+    // returns 'false' when no listener wants to hear about the type of
+    // message (flag is one of the LISTEN_FOR_* values) or when the call site
+    // has exceeded the rate limit.
+    static bool Admit(int flag, char const* file, int line);
+
+    // Limit the number of messages per second from each call site, which
+    // is identified by file and line.  Sites that hash to the same slot of a
+    // small table share the limit.  The default 0 means no limit.
+    static void SetRateLimit(int maxMessagesPerSecond);
+    static int GetRateLimit();
+    static uint64_t GetNumSuppressed();
+
+    // In asynchronous mode, each thread queues its warnings and information
+    // messages in a lock-free buffer of its own, and a writer thread reports
+    // them to the listeners in batches.  A thread whose buffer is full
+    // waits for the writer to drain it; the other threads are not affected.
+    // Flush() returns after the messages queued by the calling thread are
+    // reported.
+    // Switching off asynchronous mode flushes all the buffers.  The mode is
+    // switched off when the writer is destroyed at program exit, so messages
+    // logged by later static destructors are reported synchronously.
+    static void SetAsynchronous(bool asynchronous);
+    static bool IsAsynchronous();
+    static void Flush();
+
     // Listeners subscribe to Logger to receive message strings.
     class Listener
     {
@@ -62,6 +96,11 @@ public:
         void Warning(std::string const& message);
         void Information(std::string const& message);
 
+        // Write any messages buffered by the listener.  The logger calls
+        // this after each message in synchronous mode and after each batch
+        // of messages in asynchronous mode.
+        virtual void Flush();
+
     private:
         virtual void Report(std::string const& message);
 
@@ -72,10 +111,45 @@ public:
     static void Unsubscribe(Listener* listener);
 
 private:
+    // Support for asynchronous mode, implemented in GteLogger.cpp.
+    class Writer;
+
+    // Generate the string for the listeners.
+    static std::string Format(char const* file, char const* function,
+        int line, std::string const& message);
+
+    // Report the message to the listeners that want to hear about it.  The
+    // caller must own msMutex.
+    static void Report(int flag, std::string const& message);
+
+    // Report an assertion or error immediately.
+    void ReportNow(int flag);
+
+    // Report a warning or information immediately or queue it.
+    void ReportLater(int flag);
+
+    char const* mFile;
+    char const* mFunction;
+    int mLine;
     std::string mMessage;
 
+    // The listeners and the union of their flags.
     static std::mutex msMutex;
     static std::set<Listener*> msListeners;
+    static std::atomic<int> msFlags;
+
+    // The rate limit.  Each slot of the table stores the current second in
+    // its high 32 bits and the number of messages in that second in its low
+    // 32 bits.
+    enum { NUM_RATE_SLOTS = 256 };
+    static std::atomic<int> msMaxPerSecond;
+    static std::array<std::atomic<uint64_t>, NUM_RATE_SLOTS> msRateSlots;
+    static std::atomic<uint64_t> msNumSuppressed;
+
+    // The writer is created on the first switch to asynchronous mode and
+    // exists until the program terminates.
+    static Writer& GetWriter();
+    static std::atomic<bool> msAsynchronous;
 };
 
 }
@@ -83,20 +157,44 @@ private:
 
 #if !defined(GTE_NO_LOGGER)
 
+// The message is not evaluated unless Logger::Admit returns 'true'.  Each
+// macro is a single statement that requires the terminating semicolon, so
+// it can be the unbraced body of an if-else construct.
 #define LogAssert(condition, message) \
-    if (!(condition)) \
+    do \
     { \
-        gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Assertion(); \
-    }
+        if (!(condition) && gte::Logger::Admit(gte::Logger::Listener::LISTEN_FOR_ASSERTION, __FILE__, __LINE__)) \
+        { \
+            gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Assertion(); \
+        } \
+    } while (0)
 
 #define LogError(message) \
-    gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Error()
+    do \
+    { \
+        if (gte::Logger::Admit(gte::Logger::Listener::LISTEN_FOR_ERROR, __FILE__, __LINE__)) \
+        { \
+            gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Error(); \
+        } \
+    } while (0)
 
 #define LogWarning(message) \
-    gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Warning()
+    do \
+    { \
+        if (gte::Logger::Admit(gte::Logger::Listener::LISTEN_FOR_WARNING, __FILE__, __LINE__)) \
+        { \
+            gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Warning(); \
+        } \
+    } while (0)
 
 #define LogInformation(message) \
-    gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Information()
+    do \
+    { \
+        if (gte::Logger::Admit(gte::Logger::Listener::LISTEN_FOR_INFORMATION, __FILE__, __LINE__)) \
+        { \
+            gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Information(); \
+        } \
+    } while (0)
 
 #else
 
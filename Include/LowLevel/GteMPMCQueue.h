@@ -0,0 +1,294 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/15)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A bounded queue for multiple producers and multiple consumers that does
+// not use locks, based on
+//   D. Vyukov, "Bounded MPMC queue,"
+//   http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// The elements are stored in a ring buffer.  Each cell of the buffer has a
+// sequence number that tells whether the cell is ready to be written by a
+// producer or read by a consumer.  A producer claims a cell by a
+// compare-and-swap of the enqueue position, writes the element and then
+// publishes it by storing the next sequence number; a consumer does the
+// same with the dequeue position.  Producers and consumers do not touch
+// the same cache lines unless the queue is nearly empty or nearly full.
+//
+// Push and Pop never block; they return 'false' when the queue is full or
+// empty, respectively, as for ThreadSafeQueue.  WaitPush and WaitPop retry
+// until they succeed, yielding the processor between retries.  When the
+// queue is constructed with blocking waits, they sleep on a condition
+// variable after NUM_YIELDS retries.  The condition variable is signaled
+// only when a thread is waiting; the cost is a memory fence in every Push
+// and Pop.
+
+namespace gte
+{
+
+template <typename Element>
+class MPMCQueue
+{
+public:
+    // Construction and destruction.  The capacity is maxNumElements rounded
+    // up to a power of two (at least 2).  The storage for the elements is
+    // allocated by the constructor, so Element must be default
+    // constructible.
+    ~MPMCQueue();
+    MPMCQueue(size_t maxNumElements, bool blockingWaits = false);
+
+    // All the operations are thread-safe.  The number of elements can be
+    // out of date when the function returns.
+    size_t GetMaxNumElements() const;
+    size_t GetNumElements() const;
+    bool Push(Element const& element);
+    bool Pop(Element& element);
+    void WaitPush(Element const& element);
+    void WaitPop(Element& element);
+
+private:
+    struct Cell
+    {
+        Cell() : sequence(0) {}
+        std::atomic<size_t> sequence;
+        Element element;
+    };
+
+    bool TryPush(Element const& element);
+    bool TryPop(Element& element);
+
+    // Signal the condition when threads are waiting on it.
+    void Notify(std::atomic<int>& numWaiting, std::condition_variable& condition);
+
+    // The enqueue and dequeue positions are on different cache lines.
+    enum { CACHE_LINE_SIZE = 64 };
+
+    std::vector<Cell> mCells;
+    size_t mMask;
+    bool mBlockingWaits;
+    char mPad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> mEnqueuePosition;
+    char mPad1[CACHE_LINE_SIZE];
+    std::atomic<size_t> mDequeuePosition;
+    char mPad2[CACHE_LINE_SIZE];
+
+    // Support for blocking waits.
+    enum { NUM_YIELDS = 64 };
+    std::mutex mWaitMutex;
+    std::condition_variable mNotFull, mNotEmpty;
+    std::atomic<int> mNumWaitingPush, mNumWaitingPop;
+};
+
+
+template <typename Element>
+MPMCQueue<Element>::~MPMCQueue()
+{
+}
+
+template <typename Element>
+MPMCQueue<Element>::MPMCQueue(size_t maxNumElements, bool blockingWaits)
+    :
+    mMask(0),
+    mBlockingWaits(blockingWaits),
+    mEnqueuePosition(0),
+    mDequeuePosition(0),
+    mNumWaitingPush(0),
+    mNumWaitingPop(0)
+{
+    size_t capacity = 2;
+    while (capacity < maxNumElements)
+    {
+        capacity <<= 1;
+    }
+
+    mCells = std::vector<Cell>(capacity);
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mMask = capacity - 1;
+}
+
+template <typename Element>
+size_t MPMCQueue<Element>::GetMaxNumElements() const
+{
+    return mCells.size();
+}
+
+template <typename Element>
+size_t MPMCQueue<Element>::GetNumElements() const
+{
+    size_t dequeuePosition = mDequeuePosition.load(std::memory_order_acquire);
+    size_t enqueuePosition = mEnqueuePosition.load(std::memory_order_acquire);
+    return (enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0);
+}
+
+template <typename Element>
+bool MPMCQueue<Element>::Push(Element const& element)
+{
+    if (TryPush(element))
+    {
+        Notify(mNumWaitingPop, mNotEmpty);
+        return true;
+    }
+    return false;
+}
+
+template <typename Element>
+bool MPMCQueue<Element>::Pop(Element& element)
+{
+    if (TryPop(element))
+    {
+        Notify(mNumWaitingPush, mNotFull);
+        return true;
+    }
+    return false;
+}
+
+template <typename Element>
+void MPMCQueue<Element>::WaitPush(Element const& element)
+{
+    // Yield for a while before sleeping, because waking a thread costs
+    // much more than a few retries.
+    for (int i = 0; !mBlockingWaits || i < NUM_YIELDS; ++i)
+    {
+        if (Push(element))
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    // The fence after the registration of the waiting thread pairs with
+    // the fence in Notify():  either the other thread sees the waiting
+    // thread or this thread sees the change of the queue.
+    mNumWaitingPush.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        mNotFull.wait(lock, [this, &element]() { return TryPush(element); });
+    }
+    mNumWaitingPush.fetch_sub(1);
+    Notify(mNumWaitingPop, mNotEmpty);
+}
+
+template <typename Element>
+void MPMCQueue<Element>::WaitPop(Element& element)
+{
+    // Yield for a while before sleeping, because waking a thread costs
+    // much more than a few retries.
+    for (int i = 0; !mBlockingWaits || i < NUM_YIELDS; ++i)
+    {
+        if (Pop(element))
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    mNumWaitingPop.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        mNotEmpty.wait(lock, [this, &element]() { return TryPop(element); });
+    }
+    mNumWaitingPop.fetch_sub(1);
+    Notify(mNumWaitingPush, mNotFull);
+}
+
+template <typename Element>
+bool MPMCQueue<Element>::TryPush(Element const& element)
+{
+    size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Cell& cell = mCells[position & mMask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0)
+        {
+            // The cell is free for this lap.  Claim it.
+            if (mEnqueuePosition.compare_exchange_weak(position, position + 1,
+                std::memory_order_relaxed))
+            {
+                cell.element = element;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The cell has not been read in the previous lap.
+            return false;
+        }
+        else
+        {
+            // Another producer claimed the cell.
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename Element>
+bool MPMCQueue<Element>::TryPop(Element& element)
+{
+    size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Cell& cell = mCells[position & mMask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+        if (difference == 0)
+        {
+            // The cell was written in this lap.  Claim it.
+            if (mDequeuePosition.compare_exchange_weak(position, position + 1,
+                std::memory_order_relaxed))
+            {
+                element = std::move(cell.element);
+                cell.sequence.store(position + mMask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The cell has not been written in this lap.
+            return false;
+        }
+        else
+        {
+            // Another consumer claimed the cell.
+            position = mDequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename Element>
+void MPMCQueue<Element>::Notify(std::atomic<int>& numWaiting,
+    std::condition_variable& condition)
+{
+    if (mBlockingWaits)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (numWaiting.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mWaitMutex);
+            condition.notify_all();
+        }
+    }
+}
+
+
+}
@@ -0,0 +1,84 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/12)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <cstdint>
+#include <string>
+
+// A file whose contents are mapped into the address space of the process.
+// The operating system pages the data in and out on demand, so the file can
+// be much larger than the physical memory.  Modifications through the data
+// pointer of a writable mapping are written to the file by the operating
+// system.
+
+namespace gte
+{
+
+class GTE_IMPEXP MemoryMappedFile
+{
+public:
+    // Construction and destruction.  The destructor closes the file.
+    ~MemoryMappedFile();
+    MemoryMappedFile();
+
+    // Object copies are not allowed.
+    MemoryMappedFile(MemoryMappedFile const&) = delete;
+    MemoryMappedFile& operator=(MemoryMappedFile const&) = delete;
+
+    // Map an existing file.  The function returns 'false' when the file
+    // does not exist, is empty or cannot be mapped.
+    bool Open(std::string const& filename, bool writable);
+
+    // Create a file of the specified size, filled with zeros, and map it
+    // for reading and writing.  An existing file is overwritten.
+    bool Create(std::string const& filename, uint64_t numBytes);
+
+    void Close();
+
+    // Member access.  GetData() returns null when no file is mapped.
+    inline bool IsOpen() const;
+    inline bool IsWritable() const;
+    inline uint8_t* GetData() const;
+    inline uint64_t GetSize() const;
+
+private:
+    bool Map(bool writable);
+
+#if defined(__MSWINDOWS__)
+    void* mFile;
+    void* mMapping;
+#else
+    int mFile;
+#endif
+    uint8_t* mData;
+    uint64_t mSize;
+    bool mWritable;
+};
+
+inline bool MemoryMappedFile::IsOpen() const
+{
+    return mData != nullptr;
+}
+
+inline bool MemoryMappedFile::IsWritable() const
+{
+    return mWritable;
+}
+
+inline uint8_t* MemoryMappedFile::GetData() const
+{
+    return mData;
+}
+
+inline uint64_t MemoryMappedFile::GetSize() const
+{
+    return mSize;
+}
+
+}
@@ -0,0 +1,63 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/14)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <thread>
+#include <vector>
+
+// Partition the items {0,...,numItems-1} into numThreads contiguous ranges
+// and call function(t, imin, imax) for range t = [imin,imax) on its own
+// thread.  The last range contains the remainder of the division.  When
+// there are fewer items than threads, the function is called once on the
+// calling thread with t = 0, so per-thread storage indexed by t must have
+// at least numThreads elements.
+
+namespace gte
+{
+
+template <typename Function>
+void ParallelFor(unsigned int numThreads, int numItems,
+    Function const& function);
+
+
+template <typename Function>
+void ParallelFor(unsigned int numThreads, int numItems,
+    Function const& function)
+{
+    if (numItems < static_cast<int>(numThreads))
+    {
+        numThreads = 1;
+    }
+
+    if (numThreads > 1)
+    {
+        int const numPerThread = numItems / static_cast<int>(numThreads);
+        std::vector<std::thread> process(numThreads);
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            int imin = static_cast<int>(t) * numPerThread;
+            int imax = (t + 1 < numThreads ? imin + numPerThread : numItems);
+            process[t] = std::thread([&function, t, imin, imax]()
+            {
+                function(t, imin, imax);
+            });
+        }
+
+        for (auto& p : process)
+        {
+            p.join();
+        }
+    }
+    else
+    {
+        function(0, 0, numItems);
+    }
+}
+
+}
@@ -0,0 +1,242 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/15)
+
+#pragma once
+
+#include <GTEngineDEF.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A bounded queue for one producer thread and one consumer thread that does
+// not use locks or read-modify-write operations.  The producer owns the
+// tail index and the consumer owns the head index of a ring buffer.  Each
+// thread keeps a copy of the index of the other thread and reloads it only
+// when the queue appears to be full or empty, so in the steady state the
+// threads do not read each other's cache lines.  Push and WaitPush must be
+// called by the same thread, and Pop and WaitPop must be called by the
+// same thread.  The waits are as described in GteMPMCQueue.h.
+
+namespace gte
+{
+
+template <typename Element>
+class SPSCQueue
+{
+public:
+    // Construction and destruction.  The capacity is maxNumElements rounded
+    // up to a power of two (at least 2).  The storage for the elements is
+    // allocated by the constructor, so Element must be default
+    // constructible.
+    ~SPSCQueue();
+    SPSCQueue(size_t maxNumElements, bool blockingWaits = false);
+
+    // The number of elements can be out of date when the function returns.
+    size_t GetMaxNumElements() const;
+    size_t GetNumElements() const;
+    bool Push(Element const& element);
+    bool Pop(Element& element);
+    void WaitPush(Element const& element);
+    void WaitPop(Element& element);
+
+private:
+    bool TryPush(Element const& element);
+    bool TryPop(Element& element);
+
+    // Signal the condition when the other thread is waiting on it.
+    void Notify(std::atomic<int>& numWaiting, std::condition_variable& condition);
+
+    // The data of the producer and of the consumer are on different cache
+    // lines.
+    enum { CACHE_LINE_SIZE = 64 };
+
+    std::vector<Element> mBuffer;
+    size_t mMask;
+    bool mBlockingWaits;
+    char mPad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> mTail;
+    size_t mCachedHead;
+    char mPad1[CACHE_LINE_SIZE];
+    std::atomic<size_t> mHead;
+    size_t mCachedTail;
+    char mPad2[CACHE_LINE_SIZE];
+
+    // Support for blocking waits.
+    enum { NUM_YIELDS = 64 };
+    std::mutex mWaitMutex;
+    std::condition_variable mNotFull, mNotEmpty;
+    std::atomic<int> mNumWaitingPush, mNumWaitingPop;
+};
+
+
+template <typename Element>
+SPSCQueue<Element>::~SPSCQueue()
+{
+}
+
+template <typename Element>
+SPSCQueue<Element>::SPSCQueue(size_t maxNumElements, bool blockingWaits)
+    :
+    mMask(0),
+    mBlockingWaits(blockingWaits),
+    mTail(0),
+    mCachedHead(0),
+    mHead(0),
+    mCachedTail(0),
+    mNumWaitingPush(0),
+    mNumWaitingPop(0)
+{
+    size_t capacity = 2;
+    while (capacity < maxNumElements)
+    {
+        capacity <<= 1;
+    }
+
+    mBuffer.resize(capacity);
+    mMask = capacity - 1;
+}
+
+template <typename Element>
+size_t SPSCQueue<Element>::GetMaxNumElements() const
+{
+    return mBuffer.size();
+}
+
+template <typename Element>
+size_t SPSCQueue<Element>::GetNumElements() const
+{
+    size_t head = mHead.load(std::memory_order_acquire);
+    size_t tail = mTail.load(std::memory_order_acquire);
+    return (tail > head ? tail - head : 0);
+}
+
+template <typename Element>
+bool SPSCQueue<Element>::Push(Element const& element)
+{
+    if (TryPush(element))
+    {
+        Notify(mNumWaitingPop, mNotEmpty);
+        return true;
+    }
+    return false;
+}
+
+template <typename Element>
+bool SPSCQueue<Element>::Pop(Element& element)
+{
+    if (TryPop(element))
+    {
+        Notify(mNumWaitingPush, mNotFull);
+        return true;
+    }
+    return false;
+}
+
+template <typename Element>
+void SPSCQueue<Element>::WaitPush(Element const& element)
+{
+    // Yield for a while before sleeping, because waking a thread costs
+    // much more than a few retries.
+    for (int i = 0; !mBlockingWaits || i < NUM_YIELDS; ++i)
+    {
+        if (Push(element))
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    mNumWaitingPush.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        mNotFull.wait(lock, [this, &element]() { return TryPush(element); });
+    }
+    mNumWaitingPush.fetch_sub(1);
+    Notify(mNumWaitingPop, mNotEmpty);
+}
+
+template <typename Element>
+void SPSCQueue<Element>::WaitPop(Element& element)
+{
+    // Yield for a while before sleeping, because waking a thread costs
+    // much more than a few retries.
+    for (int i = 0; !mBlockingWaits || i < NUM_YIELDS; ++i)
+    {
+        if (Pop(element))
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    mNumWaitingPop.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        mNotEmpty.wait(lock, [this, &element]() { return TryPop(element); });
+    }
+    mNumWaitingPop.fetch_sub(1);
+    Notify(mNumWaitingPush, mNotFull);
+}
+
+template <typename Element>
+bool SPSCQueue<Element>::TryPush(Element const& element)
+{
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mCachedHead == mBuffer.size())
+    {
+        mCachedHead = mHead.load(std::memory_order_acquire);
+        if (tail - mCachedHead == mBuffer.size())
+        {
+            return false;
+        }
+    }
+
+    mBuffer[tail & mMask] = element;
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename Element>
+bool SPSCQueue<Element>::TryPop(Element& element)
+{
+    size_t head = mHead.load(std::memory_order_relaxed);
+    if (head == mCachedTail)
+    {
+        mCachedTail = mTail.load(std::memory_order_acquire);
+        if (head == mCachedTail)
+        {
+            return false;
+        }
+    }
+
+    element = std::move(mBuffer[head & mMask]);
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename Element>
+void SPSCQueue<Element>::Notify(std::atomic<int>& numWaiting,
+    std::condition_variable& condition)
+{
+    if (mBlockingWaits)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (numWaiting.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mWaitMutex);
+            condition.notify_all();
+        }
+    }
+}
+
+
+}
@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.2 (2019/09/22)
 
 #pragma once
 
-#include <Mathematics/GteMath.h>
+#include <Mathematics/GteArrayEstimate.h>
 
 // Approximations to acos(x) of the form f(x) = sqrt(1-x)*p(x)
 // where the polynomial p(x) of degree D minimizes the quantity
@@ -27,6 +27,12 @@ public:
     template <int D>
     inline static Real Degree(Real x);
 
+    // Array version of Degree.  The estimates are computed for x[i] and
+    // stored in y[i] for 0 <= i < numElements, and x and y may be the same
+    // array; see GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -49,6 +55,14 @@ inline Real ACosEstimate<Real>::Degree(Real x)
     return Evaluate(degree<D>(), x);
 }
 
+template <typename Real>
+template <int D>
+void ACosEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return Evaluate(degree<D>(), v); });
+}
+
 template <typename Real>
 inline Real ACosEstimate<Real>::Evaluate(degree<1>, Real x)
 {
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/22)
 
 #pragma once
 
@@ -26,6 +26,12 @@ public:
     //   float result = ASinEstimate<float>::Degree<3>(x);
     template <int D>
     inline static Real Degree(Real x);
+
+    // Array version of Degree.  The estimates are computed for x[i] and
+    // stored in y[i] for 0 <= i < numElements, and x and y may be the same
+    // array; see GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
 };
 
 
@@ -33,7 +39,16 @@ template <typename Real>
 template <int D>
 inline Real ASinEstimate<Real>::Degree(Real x)
 {
-    return (Real)GTE_C_HALF_PI - ACosEstimate<Real>::Degree<D>(x);
+    return (Real)GTE_C_HALF_PI - ACosEstimate<Real>::template Degree<D>(x);
+}
+
+template <typename Real>
+template <int D>
+void ASinEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ACosEstimate<Real>::template Degree<D>(numElements, x, y);
+    ArrayEstimate<Real>::Apply(numElements, y, y,
+        [](Real v) { return (Real)GTE_C_HALF_PI - v; });
 }
 
 
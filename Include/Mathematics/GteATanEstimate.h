@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.2 (2019/09/22)
 
 #pragma once
 
-#include <Mathematics/GteMath.h>
+#include <Mathematics/GteArrayEstimate.h>
 
 // Minimax polynomial approximations to atan(x).  The polynomial p(x) of
 // degree D has only odd-power terms, is required to have linear term x,
@@ -36,6 +36,17 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Array versions of Degree and DegreeRR.  The estimates are computed
+    // for x[i] and stored in y[i] for 0 <= i < numElements, and x and y may
+    // be the same array.  The range reductions are branch-free rewrites of
+    // the scalar ones so that the compiler can vectorize the loops; see
+    // GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
+    template <int D>
+    static void DegreeRR(size_t numElements, Real const* x, Real* y);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -74,6 +85,32 @@ inline Real ATanEstimate<Real>::DegreeRR(Real x)
     }
 }
 
+template <typename Real>
+template <int D>
+void ATanEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return Evaluate(degree<D>(), v); });
+}
+
+template <typename Real>
+template <int D>
+void ATanEstimate<Real>::DegreeRR(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y, [](Real v)
+    {
+        // The cases are combined so that the polynomial is evaluated once.
+        // The arithmetic is the same as that of the scalar code.
+        bool const inside = (std::abs(v) <= (Real)1);
+        Real numer = (inside ? v : (Real)1);
+        Real denom = (inside ? (Real)1 : v);
+        Real poly = Evaluate(degree<D>(), numer / denom);
+        Real shift = (inside ? (Real)0 : std::copysign((Real)GTE_C_HALF_PI, v));
+        Real sign = (inside ? (Real)1 : (Real)-1);
+        return sign * (poly - shift);
+    });
+}
+
 template <typename Real>
 inline Real ATanEstimate<Real>::Evaluate(degree<3>, Real x)
 {
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.21.0 (2019/01/17)
+// File Version: 3.21.1 (2019/09/26)
 
 #pragma once
 
@@ -13,3 +13,4 @@
 #include <Mathematics/GteBSNumber.h>
 #include <Mathematics/GteBSRational.h>
 #include <Mathematics/GteBSPrecision.h>
+#include <Mathematics/GteBSTerm.h>
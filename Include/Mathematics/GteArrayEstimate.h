@@ -0,0 +1,164 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/22)
+
+#pragma once
+
+#include <Mathematics/GteMath.h>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Support for evaluating the polynomial estimates (SinEstimate, ExpEstimate,
+// and so on) over arrays.  The array is processed in blocks of BLOCK_SIZE
+// elements.  Each block is copied to local storage, the function is applied
+// in a loop with a constant trip count and the results are copied to the
+// output.  The inner loop has no aliasing and no branches when the function
+// is written in select form, so the compiler can vectorize it for the target
+// instruction set (SSE, AVX or NEON).  The remaining elements are processed
+// by a scalar loop.
+//
+// The range reductions of the scalar estimates use std::frexp, std::ldexp,
+// std::floor and branches, none of which vectorize.  The member functions
+// Split, Scale and Floor are branch-free replacements that manipulate the
+// IEEE 754 bits directly.  Real must be 'float' or 'double'.
+//
+// The array reductions for sin, cos and tan use comparisons converted to 0
+// or 1 and exact arithmetic instead of selections.  The other reductions
+// use conditional expressions.  GCC converts those to vector selections
+// only when floating-point exceptions need not be preserved
+// (-fno-trapping-math), and it vectorizes loops that call std::sqrt (as
+// ACosEstimate and ASinEstimate do) only with -fno-math-errno.  Without
+// these options such loops are compiled as scalar code, which is still
+// correct.
+
+namespace gte
+{
+
+template <typename Real>
+class ArrayEstimate
+{
+public:
+    enum { BLOCK_SIZE = 16 };
+
+    // Compute y[i] = function(x[i]) for 0 <= i < numElements.  The arrays x
+    // and y may be the same.  The function has signature Real(Real).
+    template <typename Function>
+    static void Apply(size_t numElements, Real const* x, Real* y,
+        Function const& function);
+
+    // For finite x > 0, return y in [1,2) and p for which x = y*2^p.  This
+    // is equivalent to y = 2*frexp(x,&p); --p; for such x.
+    inline static Real Split(Real x, int& p);
+
+    // Compute y*2^p.  This is equivalent to ldexp(y,p) except that results
+    // in the subnormal range are formed by two multiplications and might
+    // differ in the last bit.
+    inline static Real Scale(Real y, int p);
+
+    // Compute floor(x) for |x| < 2^31.
+    inline static Real Floor(Real x);
+
+private:
+    typedef typename std::conditional<sizeof(Real) == 4,
+        uint32_t, uint64_t>::type UInt;
+
+    enum
+    {
+        NUM_MANTISSA_BITS = std::numeric_limits<Real>::digits - 1,
+        EXPONENT_BIAS = std::numeric_limits<Real>::max_exponent - 1
+    };
+
+    // Return 2^p for 1 - EXPONENT_BIAS <= p <= EXPONENT_BIAS.
+    inline static Real Power(int p);
+};
+
+
+template <typename Real>
+template <typename Function>
+void ArrayEstimate<Real>::Apply(size_t numElements, Real const* x, Real* y,
+    Function const& function)
+{
+    static_assert(std::is_same<Real, float>::value
+        || std::is_same<Real, double>::value, "Invalid type.");
+
+    Real input[BLOCK_SIZE], output[BLOCK_SIZE];
+    size_t const numBlocks = numElements / BLOCK_SIZE;
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            input[i] = x[i];
+        }
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            output[i] = function(input[i]);
+        }
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+        {
+            y[i] = output[i];
+        }
+        x += BLOCK_SIZE;
+        y += BLOCK_SIZE;
+    }
+
+    size_t const numRemaining = numElements - numBlocks * BLOCK_SIZE;
+    for (size_t i = 0; i < numRemaining; ++i)
+    {
+        y[i] = function(x[i]);
+    }
+}
+
+template <typename Real>
+inline Real ArrayEstimate<Real>::Split(Real x, int& p)
+{
+    // Subnormal numbers are scaled into the normal range.
+    bool const subnormal = (x < std::numeric_limits<Real>::min());
+    x *= (subnormal ? Power(NUM_MANTISSA_BITS) : (Real)1);
+
+    UInt bits;
+    std::memcpy(&bits, &x, sizeof(Real));
+    p = static_cast<int>(bits >> NUM_MANTISSA_BITS) - EXPONENT_BIAS
+        - (subnormal ? NUM_MANTISSA_BITS : 0);
+    bits = (bits & ((static_cast<UInt>(1) << NUM_MANTISSA_BITS) - 1))
+        | (static_cast<UInt>(EXPONENT_BIAS) << NUM_MANTISSA_BITS);
+
+    Real y;
+    std::memcpy(&y, &bits, sizeof(Real));
+    return y;
+}
+
+template <typename Real>
+inline Real ArrayEstimate<Real>::Scale(Real y, int p)
+{
+    // The clamped p is the sum of two exponents in the normal range.  The
+    // clamping does not change finite results, because y*2^p overflows or
+    // underflows for p outside the range when y is in [1,2).
+    int const pmax = 2 * (EXPONENT_BIAS - 1);
+    p = (p < -pmax ? -pmax : (p > pmax ? pmax : p));
+    int const p0 = (p >> 1);
+    return y * Power(p0) * Power(p - p0);
+}
+
+template <typename Real>
+inline Real ArrayEstimate<Real>::Floor(Real x)
+{
+    Real truncated = (Real)((int)x);
+    return truncated - (truncated > x ? (Real)1 : (Real)0);
+}
+
+template <typename Real>
+inline Real ArrayEstimate<Real>::Power(int p)
+{
+    UInt bits = static_cast<UInt>(p + EXPONENT_BIAS) << NUM_MANTISSA_BITS;
+    Real result;
+    std::memcpy(&result, &bits, sizeof(Real));
+    return result;
+}
+
+
+}
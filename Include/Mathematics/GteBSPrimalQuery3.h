@@ -0,0 +1,283 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/26)
+
+#pragma once
+
+#include <Mathematics/GteBSTerm.h>
+#include <Mathematics/GteVector3.h>
+#include <array>
+#include <vector>
+
+// The queries of PrimalQuery3 for 'float' or 'double' vertices, computed
+// exactly with BSTerm.  The results are those of PrimalQuery3<Rational>
+// for BSNumber or BSRational Rational, but the precision of each
+// intermediate value is determined at compile time and all the numbers are
+// stored on the stack.  The vertices are converted to BSTerm once, by the
+// constructor or Set, so the array must not be modified while it is used
+// by the queries.  The largest numbers have the sizes listed in
+// GtePrimalQuery3.h for BSNumber.
+//
+//    query          | float | double
+//    ---------------+-------+-------
+//    ToPlane        |    27 |    197
+//    ToTetrahedron  |    27 |    197
+//    ToCircumsphere |    44 |    329
+//
+// When the inputs are known to be bounded, specify MaxExponent as described
+// for BSInput in GteBSTerm.h to reduce the sizes.
+
+namespace gte
+{
+
+template <typename Real, int MaxExponent = std::numeric_limits<Real>::max_exponent - 1>
+class BSPrimalQuery3
+{
+public:
+    typedef BSInput<Real, MaxExponent> Input;
+
+    // The caller is responsible for ensuring that the array is not empty
+    // before calling queries and that the indices passed to the queries are
+    // valid.  The class does no range checking.
+    BSPrimalQuery3();
+    BSPrimalQuery3(int numVertices, Vector3<Real> const* vertices);
+
+    // Member access.
+    inline void Set(int numVertices, Vector3<Real> const* vertices);
+    inline int GetNumVertices() const;
+    inline Vector3<Real> const* GetVertices() const;
+
+    // The queries are described in GtePrimalQuery3.h.
+    int ToPlane(int i, int v0, int v1, int v2) const;
+    int ToPlane(Vector3<Real> const& test, int v0, int v1, int v2) const;
+    int ToTetrahedron(int i, int v0, int v1, int v2, int v3) const;
+    int ToTetrahedron(Vector3<Real> const& test, int v0, int v1, int v2, int v3) const;
+    int ToCircumsphere(int i, int v0, int v1, int v2, int v3) const;
+    int ToCircumsphere(Vector3<Real> const& test, int v0, int v1, int v2, int v3) const;
+
+private:
+    typedef std::array<Input, 3> Point;
+
+    static Point Convert(Vector3<Real> const& vertex);
+    int ToPlane(Point const& test, int v0, int v1, int v2) const;
+    int ToTetrahedron(Point const& test, int v0, int v1, int v2, int v3) const;
+    int ToCircumsphere(Point const& test, int v0, int v1, int v2, int v3) const;
+
+    int mNumVertices;
+    Vector3<Real> const* mVertices;
+    std::vector<Point> mPoints;
+};
+
+
+template <typename Real, int MaxExponent>
+BSPrimalQuery3<Real, MaxExponent>::BSPrimalQuery3()
+    :
+    mNumVertices(0),
+    mVertices(nullptr)
+{
+}
+
+template <typename Real, int MaxExponent>
+BSPrimalQuery3<Real, MaxExponent>::BSPrimalQuery3(int numVertices,
+    Vector3<Real> const* vertices)
+    :
+    mNumVertices(0),
+    mVertices(nullptr)
+{
+    Set(numVertices, vertices);
+}
+
+template <typename Real, int MaxExponent> inline
+void BSPrimalQuery3<Real, MaxExponent>::Set(int numVertices,
+    Vector3<Real> const* vertices)
+{
+    mNumVertices = numVertices;
+    mVertices = vertices;
+    mPoints.resize(numVertices);
+    for (int i = 0; i < numVertices; ++i)
+    {
+        mPoints[i] = Convert(vertices[i]);
+    }
+}
+
+template <typename Real, int MaxExponent> inline
+int BSPrimalQuery3<Real, MaxExponent>::GetNumVertices() const
+{
+    return mNumVertices;
+}
+
+template <typename Real, int MaxExponent> inline
+Vector3<Real> const* BSPrimalQuery3<Real, MaxExponent>::GetVertices() const
+{
+    return mVertices;
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToPlane(int i, int v0, int v1, int v2)
+    const
+{
+    return ToPlane(mPoints[i], v0, v1, v2);
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToPlane(Vector3<Real> const& test,
+    int v0, int v1, int v2) const
+{
+    return ToPlane(Convert(test), v0, v1, v2);
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToTetrahedron(int i, int v0, int v1,
+    int v2, int v3) const
+{
+    return ToTetrahedron(mPoints[i], v0, v1, v2, v3);
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToTetrahedron(Vector3<Real> const& test,
+    int v0, int v1, int v2, int v3) const
+{
+    return ToTetrahedron(Convert(test), v0, v1, v2, v3);
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToCircumsphere(int i, int v0, int v1,
+    int v2, int v3) const
+{
+    return ToCircumsphere(mPoints[i], v0, v1, v2, v3);
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToCircumsphere(Vector3<Real> const& test,
+    int v0, int v1, int v2, int v3) const
+{
+    return ToCircumsphere(Convert(test), v0, v1, v2, v3);
+}
+
+template <typename Real, int MaxExponent>
+typename BSPrimalQuery3<Real, MaxExponent>::Point
+BSPrimalQuery3<Real, MaxExponent>::Convert(Vector3<Real> const& vertex)
+{
+    Point point = { { Input(vertex[0]), Input(vertex[1]), Input(vertex[2]) } };
+    return point;
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToPlane(Point const& test, int v0,
+    int v1, int v2) const
+{
+    Point const& vec0 = mPoints[v0];
+    Point const& vec1 = mPoints[v1];
+    Point const& vec2 = mPoints[v2];
+
+    auto x0 = test[0] - vec0[0];
+    auto y0 = test[1] - vec0[1];
+    auto z0 = test[2] - vec0[2];
+    auto x1 = vec1[0] - vec0[0];
+    auto y1 = vec1[1] - vec0[1];
+    auto z1 = vec1[2] - vec0[2];
+    auto x2 = vec2[0] - vec0[0];
+    auto y2 = vec2[1] - vec0[1];
+    auto z2 = vec2[2] - vec0[2];
+    auto c0 = y1*z2 - y2*z1;
+    auto c1 = y2*z0 - y0*z2;
+    auto c2 = y0*z1 - y1*z0;
+    auto det = (x0*c0 + x1*c1) + x2*c2;
+    return det.GetSign();
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToTetrahedron(Point const& test,
+    int v0, int v1, int v2, int v3) const
+{
+    int sign0 = ToPlane(test, v1, v2, v3);
+    if (sign0 > 0)
+    {
+        return +1;
+    }
+
+    int sign1 = ToPlane(test, v0, v2, v3);
+    if (sign1 < 0)
+    {
+        return +1;
+    }
+
+    int sign2 = ToPlane(test, v0, v1, v3);
+    if (sign2 > 0)
+    {
+        return +1;
+    }
+
+    int sign3 = ToPlane(test, v0, v1, v2);
+    if (sign3 < 0)
+    {
+        return +1;
+    }
+
+    return ((sign0 && sign1 && sign2 && sign3) ? -1 : 0);
+}
+
+template <typename Real, int MaxExponent>
+int BSPrimalQuery3<Real, MaxExponent>::ToCircumsphere(Point const& test,
+    int v0, int v1, int v2, int v3) const
+{
+    Point const& vec0 = mPoints[v0];
+    Point const& vec1 = mPoints[v1];
+    Point const& vec2 = mPoints[v2];
+    Point const& vec3 = mPoints[v3];
+
+    auto x0 = vec0[0] - test[0];
+    auto y0 = vec0[1] - test[1];
+    auto z0 = vec0[2] - test[2];
+    auto s00 = vec0[0] + test[0];
+    auto s01 = vec0[1] + test[1];
+    auto s02 = vec0[2] + test[2];
+    auto w0 = (s00*x0 + s01*y0) + s02*z0;
+
+    auto x1 = vec1[0] - test[0];
+    auto y1 = vec1[1] - test[1];
+    auto z1 = vec1[2] - test[2];
+    auto s10 = vec1[0] + test[0];
+    auto s11 = vec1[1] + test[1];
+    auto s12 = vec1[2] + test[2];
+    auto w1 = (s10*x1 + s11*y1) + s12*z1;
+
+    auto x2 = vec2[0] - test[0];
+    auto y2 = vec2[1] - test[1];
+    auto z2 = vec2[2] - test[2];
+    auto s20 = vec2[0] + test[0];
+    auto s21 = vec2[1] + test[1];
+    auto s22 = vec2[2] + test[2];
+    auto w2 = (s20*x2 + s21*y2) + s22*z2;
+
+    auto x3 = vec3[0] - test[0];
+    auto y3 = vec3[1] - test[1];
+    auto z3 = vec3[2] - test[2];
+    auto s30 = vec3[0] + test[0];
+    auto s31 = vec3[1] + test[1];
+    auto s32 = vec3[2] + test[2];
+    auto w3 = (s30*x3 + s31*y3) + s32*z3;
+
+    auto a0 = x0*y1 - x1*y0;
+    auto a1 = x0*y2 - x2*y0;
+    auto a2 = x0*y3 - x3*y0;
+    auto a3 = x1*y2 - x2*y1;
+    auto a4 = x1*y3 - x3*y1;
+    auto a5 = x2*y3 - x3*y2;
+
+    auto b0 = z0*w1 - z1*w0;
+    auto b1 = z0*w2 - z2*w0;
+    auto b2 = z0*w3 - z3*w0;
+    auto b3 = z1*w2 - z2*w1;
+    auto b4 = z1*w3 - z3*w1;
+    auto b5 = z2*w3 - z3*w2;
+
+    auto det = ((((a0*b5 - a1*b4) + a2*b3) + a3*b2) - a4*b1) + a5*b0;
+    return det.GetSign();
+}
+
+
+}
@@ -0,0 +1,407 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/26)
+
+#pragma once
+
+#include <Mathematics/GteBSNumber.h>
+#include <Mathematics/GteUIntegerFP32.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+// Exact evaluation of expressions with +, - and * whose inputs are 'float'
+// or 'double', with the precision of every intermediate value determined at
+// compile time.  A BSTerm stores a binary scientific number in the same form
+// as BSNumber, but its template parameters are the precision of the value as
+// computed by class BSPrecision:  the maximum number of bits, the minimum
+// biased exponent and the maximum exponent.  The return type of each
+// operator is computed from the types of its operands using the rules of
+// BSPrecision for BSNumber, so the storage of every value is a
+// UIntegerFP32<N> with the exact N required by its subexpression.  The
+// values live on the stack, there are no heap allocations, and N does not
+// have to be looked up in the tables produced by the PrecisionCalculator
+// tool.  For example,
+//
+//   typedef BSInput<double> Input;
+//   auto det = Input(x0) * Input(y1) - Input(x1) * Input(y0);
+//   int sign = det.GetSign();
+//
+// The expressions are evaluated as they are written rather than stored as
+// trees, because the predicates reuse subexpressions (the differences in
+// GtePrimalQuery3.h occur in many products) that a lazily evaluated tree
+// would compute repeatedly.  The expressions have no divisions, so the
+// results are exact; BSRational is not needed for such expressions.
+
+namespace gte
+{
+    template <int NumBits, int MinBiasedExponent, int MaxExponent>
+    class BSTerm
+    {
+    public:
+        enum
+        {
+            NUM_BITS = NumBits,
+            MIN_BIASED_EXPONENT = MinBiasedExponent,
+            MAX_EXPONENT = MaxExponent,
+            NUM_WORDS = NumBits / 32 + ((NumBits % 32) > 0 ? 1 : 0)
+        };
+
+        typedef UIntegerFP32<NUM_WORDS> UIntegerType;
+
+        // Construction.  The default constructor generates the zero term.
+        // The floating-point inputs must be finite with magnitude smaller
+        // than 2^{MaxExponent+1}.  An input that is out of range triggers
+        // an assertion and is replaced by zero; otherwise, the storage of
+        // the terms computed from it would be too small.
+        BSTerm()
+            :
+            mSign(0),
+            mBiasedExponent(0)
+        {
+        }
+
+        explicit BSTerm(float number)
+        {
+            static_assert(NumBits >= std::numeric_limits<float>::digits &&
+                MinBiasedExponent <= std::numeric_limits<float>::min_exponent
+                - std::numeric_limits<float>::digits, "Insufficient precision.");
+
+            if (IsInRange(number))
+            {
+                Assign(BSNumber<UIntegerType>(number));
+            }
+            else
+            {
+                LogAssert(false, "The input magnitude must be smaller than 2^{MaxExponent+1}.");
+                SetZero();
+            }
+        }
+
+        explicit BSTerm(double number)
+        {
+            static_assert(NumBits >= std::numeric_limits<double>::digits &&
+                MinBiasedExponent <= std::numeric_limits<double>::min_exponent
+                - std::numeric_limits<double>::digits, "Insufficient precision.");
+
+            if (IsInRange(number))
+            {
+                Assign(BSNumber<UIntegerType>(number));
+            }
+            else
+            {
+                LogAssert(false, "The input magnitude must be smaller than 2^{MaxExponent+1}.");
+                SetZero();
+            }
+        }
+
+        // Member access.
+        inline int32_t GetSign() const
+        {
+            return mSign;
+        }
+
+        inline int32_t GetBiasedExponent() const
+        {
+            return mBiasedExponent;
+        }
+
+        inline int32_t GetExponent() const
+        {
+            return mBiasedExponent + mUInteger.GetNumBits() - 1;
+        }
+
+        inline UIntegerType const& GetUInteger() const
+        {
+            return mUInteger;
+        }
+
+        // Unary operations.
+        BSTerm operator-() const
+        {
+            BSTerm result = *this;
+            result.mSign = -result.mSign;
+            return result;
+        }
+
+        // Arithmetic.  These are performed in-place; that is, the result is
+        // stored in 'this' object, which must have the precision required by
+        // the operation.  The binary operators below choose that precision.
+        template <typename Term0, typename Term1>
+        void Add(Term0 const& t0, Term1 const& t1)
+        {
+            AddSigned(t0, t1, t1.GetSign());
+        }
+
+        template <typename Term0, typename Term1>
+        void Sub(Term0 const& t0, Term1 const& t1)
+        {
+            AddSigned(t0, t1, -t1.GetSign());
+        }
+
+        template <typename Term0, typename Term1>
+        void Mul(Term0 const& t0, Term1 const& t1)
+        {
+            mSign = t0.GetSign() * t1.GetSign();
+            if (mSign != 0)
+            {
+                // The limbs used by UIntegerALU32::Mul are bounded by the
+                // sizes of the operand types, so the memory is on the stack
+                // even for the products that exceed its internal buffer.
+                enum
+                {
+                    LIMBS0 = (Term0::NUM_WORDS + 1) / 2,
+                    LIMBS1 = (Term1::NUM_WORDS + 1) / 2,
+                    MIN_LIMBS = (LIMBS0 < LIMBS1 ? LIMBS0 : LIMBS1),
+                    SCRATCH = (MIN_LIMBS < UIntegerType::KARATSUBA_THRESHOLD ?
+                        0 : 6 * (LIMBS0 + LIMBS1) + 1024),
+                    STORAGE = 2 * (LIMBS0 + LIMBS1) + SCRATCH
+                };
+
+                std::array<uint64_t, STORAGE> storage;
+                mBiasedExponent = t0.GetBiasedExponent() + t1.GetBiasedExponent();
+                mUInteger.Mul(t0.GetUInteger(), t1.GetUInteger(), storage.data());
+            }
+            else
+            {
+                SetZero();
+            }
+        }
+
+    private:
+        // The comparison is false for infinities and NaNs.  For the largest
+        // MaxExponent of the type, the bound is infinite.
+        template <typename Real>
+        static bool IsInRange(Real number)
+        {
+            return std::fabs(static_cast<double>(number)) < std::ldexp(1.0, MaxExponent + 1);
+        }
+
+        void SetZero()
+        {
+            mSign = 0;
+            mBiasedExponent = 0;
+            mUInteger = UIntegerType();
+        }
+
+        template <typename Number>
+        void Assign(Number const& number)
+        {
+            if (number.GetSign() != 0)
+            {
+                mSign = number.GetSign();
+                mBiasedExponent = number.GetBiasedExponent();
+                Widen(number.GetUInteger(), mUInteger);
+            }
+            else
+            {
+                SetZero();
+            }
+        }
+
+        // Copy a nonzero number to storage with at least as many words.
+        template <int N>
+        static void Widen(UIntegerFP32<N> const& source, UIntegerType& target)
+        {
+            static_assert(N <= NUM_WORDS, "Invalid size N.");
+
+            target.SetNumBits(source.GetNumBits());
+            std::copy(source.GetBits().begin(),
+                source.GetBits().begin() + source.GetSize(),
+                target.GetBits().begin());
+        }
+
+        // Compute t0 + t1, where t1 is used with the sign 'sign1'.  The
+        // logic is that of BSNumber::operator+.  The arithmetic is applied
+        // to the operands directly; they are converted to the precision of
+        // the result only to compare magnitudes with equal exponents.
+        template <typename Term0, typename Term1>
+        void AddSigned(Term0 const& t0, Term1 const& t1, int32_t sign1)
+        {
+            int32_t const sign0 = t0.GetSign();
+            if (sign1 == 0)
+            {
+                Assign(t0);
+                return;
+            }
+            if (sign0 == 0)
+            {
+                Assign(t1);
+                mSign = sign1;
+                return;
+            }
+
+            if (sign0 == sign1)
+            {
+                // t0 + t1 = sign0*(|t0| + |t1|)
+                AddIgnoreSign(t0, t1);
+                mSign = sign0;
+                return;
+            }
+
+            int32_t const exponent0 = t0.GetExponent();
+            int32_t const exponent1 = t1.GetExponent();
+            bool less;  // |t0| < |t1|
+            if (exponent0 != exponent1)
+            {
+                less = (exponent0 < exponent1);
+            }
+            else
+            {
+                UIntegerType u0, u1;
+                Widen(t0.GetUInteger(), u0);
+                Widen(t1.GetUInteger(), u1);
+                if (u0 == u1)
+                {
+                    // t0 + t1 = 0
+                    SetZero();
+                    return;
+                }
+                less = (u0 < u1);
+            }
+
+            if (!less)
+            {
+                // t0 + t1 = sign0*(|t0| - |t1|)
+                SubIgnoreSign(t0, t1);
+                mSign = sign0;
+            }
+            else
+            {
+                // t0 + t1 = sign1*(|t1| - |t0|)
+                SubIgnoreSign(t1, t0);
+                mSign = sign1;
+            }
+        }
+
+        // Add two positive numbers.
+        template <typename Term0, typename Term1>
+        void AddIgnoreSign(Term0 const& t0, Term1 const& t1)
+        {
+            UIntegerType temp;
+            int32_t const e0 = t0.GetBiasedExponent();
+            int32_t const e1 = t1.GetBiasedExponent();
+            int32_t diff = e0 - e1;
+            if (diff > 0)
+            {
+                temp.ShiftLeft(t0.GetUInteger(), diff);
+                mUInteger.Add(temp, t1.GetUInteger());
+                mBiasedExponent = e1;
+            }
+            else if (diff < 0)
+            {
+                temp.ShiftLeft(t1.GetUInteger(), -diff);
+                mUInteger.Add(t0.GetUInteger(), temp);
+                mBiasedExponent = e0;
+            }
+            else
+            {
+                temp.Add(t0.GetUInteger(), t1.GetUInteger());
+                int32_t shift = mUInteger.ShiftRightToOdd(temp);
+                mBiasedExponent = e0 + shift;
+            }
+        }
+
+        // Subtract two positive numbers where |t0| > |t1|.
+        template <typename Term0, typename Term1>
+        void SubIgnoreSign(Term0 const& t0, Term1 const& t1)
+        {
+            UIntegerType temp;
+            int32_t const e0 = t0.GetBiasedExponent();
+            int32_t const e1 = t1.GetBiasedExponent();
+            int32_t diff = e0 - e1;
+            if (diff > 0)
+            {
+                temp.ShiftLeft(t0.GetUInteger(), diff);
+                mUInteger.Sub(temp, t1.GetUInteger());
+                mBiasedExponent = e1;
+            }
+            else if (diff < 0)
+            {
+                temp.ShiftLeft(t1.GetUInteger(), -diff);
+                mUInteger.Sub(t0.GetUInteger(), temp);
+                mBiasedExponent = e0;
+            }
+            else
+            {
+                temp.Sub(t0.GetUInteger(), t1.GetUInteger());
+                int32_t shift = mUInteger.ShiftRightToOdd(temp);
+                mBiasedExponent = e0 + shift;
+            }
+        }
+
+        int32_t mSign, mBiasedExponent;
+        UIntegerType mUInteger;
+    };
+
+    // The terms for 'float' or 'double' inputs.  The maximum exponent may be
+    // reduced when the inputs are known to be bounded; for example, use 3
+    // when |x| < 16 for all inputs x.
+    template <typename Real, int MaxExponent = std::numeric_limits<Real>::max_exponent - 1>
+    using BSInput = BSTerm<std::numeric_limits<Real>::digits,
+        std::numeric_limits<Real>::min_exponent - std::numeric_limits<Real>::digits,
+        MaxExponent>;
+
+    // The precision of sums, differences and products, which is that of the
+    // BSPrecision operators for BSNumber.
+    template <typename Term0, typename Term1>
+    struct BSTermSum
+    {
+        enum
+        {
+            E0 = static_cast<int>(Term0::MIN_BIASED_EXPONENT),
+            E1 = static_cast<int>(Term1::MIN_BIASED_EXPONENT),
+            M0 = static_cast<int>(Term0::MAX_EXPONENT),
+            M1 = static_cast<int>(Term1::MAX_EXPONENT),
+            MIN_BIASED_EXPONENT = (E0 < E1 ? E0 : E1),
+            MAX_EXPONENT = (M0 > M1 ? M0 : M1) + 1,
+            NUM_BITS = MAX_EXPONENT - MIN_BIASED_EXPONENT
+        };
+
+        typedef BSTerm<NUM_BITS, MIN_BIASED_EXPONENT, MAX_EXPONENT> Type;
+    };
+
+    template <typename Term0, typename Term1>
+    struct BSTermProduct
+    {
+        enum
+        {
+            NUM_BITS = Term0::NUM_BITS + Term1::NUM_BITS,
+            MIN_BIASED_EXPONENT = Term0::MIN_BIASED_EXPONENT + Term1::MIN_BIASED_EXPONENT,
+            MAX_EXPONENT = Term0::MAX_EXPONENT + Term1::MAX_EXPONENT + 1
+        };
+
+        typedef BSTerm<NUM_BITS, MIN_BIASED_EXPONENT, MAX_EXPONENT> Type;
+    };
+
+    template <int B0, int E0, int M0, int B1, int E1, int M1>
+    typename BSTermSum<BSTerm<B0, E0, M0>, BSTerm<B1, E1, M1>>::Type
+    operator+(BSTerm<B0, E0, M0> const& t0, BSTerm<B1, E1, M1> const& t1)
+    {
+        typename BSTermSum<BSTerm<B0, E0, M0>, BSTerm<B1, E1, M1>>::Type result;
+        result.Add(t0, t1);
+        return result;
+    }
+
+    template <int B0, int E0, int M0, int B1, int E1, int M1>
+    typename BSTermSum<BSTerm<B0, E0, M0>, BSTerm<B1, E1, M1>>::Type
+    operator-(BSTerm<B0, E0, M0> const& t0, BSTerm<B1, E1, M1> const& t1)
+    {
+        typename BSTermSum<BSTerm<B0, E0, M0>, BSTerm<B1, E1, M1>>::Type result;
+        result.Sub(t0, t1);
+        return result;
+    }
+
+    template <int B0, int E0, int M0, int B1, int E1, int M1>
+    typename BSTermProduct<BSTerm<B0, E0, M0>, BSTerm<B1, E1, M1>>::Type
+    operator*(BSTerm<B0, E0, M0> const& t0, BSTerm<B1, E1, M1> const& t1)
+    {
+        typename BSTermProduct<BSTerm<B0, E0, M0>, BSTerm<B1, E1, M1>>::Type result;
+        result.Mul(t0, t1);
+        return result;
+    }
+}
@@ -3,12 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.3 (2019/07/30)
+// File Version: 3.0.4 (2019/09/20)
 
 #pragma once
 
 #include <Mathematics/GteBandedMatrix.h>
 #include <Mathematics/GteBasisFunction.h>
+#include <algorithm>
+#include <thread>
 
 // The algorithm implemented here is based on the document
 // https://www.geometrictools.com/Documentation/BSplineCurveLeastSquaresFit.pdf
@@ -32,6 +34,8 @@ namespace gte
             mDegree(degree),
             mNumControls(numControls),
             mControlData(dimension * numControls, (Real)0),
+            mATA(1, 0, 0),
+            mFactored(false),
             mConstructed(false)
         {
             LogAssert(dimension >= 1, "Invalid dimension.");
@@ -62,101 +66,182 @@ namespace gte
             // Fit the data points with a B-spline curve using a least-squares
             // error metric.  The problem is of the form A^T*A*Q = A^T*P,
             // where A^T*A is a banded matrix, P contains the sample data, and
-            // Q is the unknown vector of control points.
+            // Q is the unknown vector of control points.  Row i2 of A has the
+            // degree+1 nonzero basis values at sample i2, which are cached
+            // so that A^T*P can be computed for new samples without
+            // evaluating the basis functions.
             Real tMultiplier = ((Real)1) / (Real)(mNumSamples - 1);
-            Real t;
-            int i0, i1, i2, imin, imax, j;
-
-            // Construct the matrix A^T*A.
-            int degp1 = mDegree + 1;
-            int numBands = (mNumControls > degp1 ? degp1 : mDegree);
-            BandedMatrix<Real> ATAMat(mNumControls, numBands, numBands);
-            for (i0 = 0; i0 < mNumControls; ++i0)
+            int const degp1 = mDegree + 1;
+            mSampleIMin.resize(mNumSamples);
+            mSampleBasis.resize(static_cast<size_t>(mNumSamples) * degp1);
+            for (int i2 = 0, k = 0; i2 < mNumSamples; ++i2)
             {
-                for (i1 = 0; i1 < i0; ++i1)
+                Real t = tMultiplier * (Real)i2;
+                int imin, imax;
+                mBasis.Evaluate(t, 0, imin, imax);
+                mSampleIMin[i2] = imin;
+                for (int i = imin; i <= imax; ++i, ++k)
                 {
-                    ATAMat(i0, i1) = ATAMat(i1, i0);
-                }
-
-                int i1Max = i0 + mDegree;
-                if (i1Max >= mNumControls)
-                {
-                    i1Max = mNumControls - 1;
+                    mSampleBasis[k] = mBasis.GetValue(0, i);
                 }
+            }
 
-                for (i1 = i0; i1 <= i1Max; ++i1)
+            // Construct the matrix A^T*A.  The sums over the samples are
+            // accumulated in the same order as when each entry is computed
+            // separately.
+            int numBands = (mNumControls > degp1 ? degp1 : mDegree);
+            mATA = BandedMatrix<Real>(mNumControls, numBands, numBands);
+            for (int i2 = 0; i2 < mNumSamples; ++i2)
+            {
+                int imin = mSampleIMin[i2];
+                Real const* b = &mSampleBasis[static_cast<size_t>(i2) * degp1];
+                for (int k0 = 0; k0 <= mDegree; ++k0)
                 {
-                    Real value = (Real)0;
-                    for (i2 = 0; i2 < mNumSamples; ++i2)
+                    for (int k1 = k0; k1 <= mDegree; ++k1)
                     {
-                        t = tMultiplier * (Real)i2;
-                        mBasis.Evaluate(t, 0, imin, imax);
-                        if (imin <= i0 && i0 <= imax && imin <= i1 && i1 <= imax)
-                        {
-                            Real b0 = mBasis.GetValue(0, i0);
-                            Real b1 = mBasis.GetValue(0, i1);
-                            value += b0 * b1;
-                        }
+                        mATA(imin + k0, imin + k1) += b[k0] * b[k1];
                     }
-                    ATAMat(i0, i1) = value;
                 }
             }
-
-            // Construct the matrix A^T.
-            Array2<Real> ATMat(mNumSamples, mNumControls);
-            std::memset(ATMat[0], 0, mNumControls * mNumSamples * sizeof(Real));
-            for (i0 = 0; i0 < mNumControls; ++i0)
+            for (int i0 = 0; i0 < mNumControls; ++i0)
             {
-                for (i1 = 0; i1 < mNumSamples; ++i1)
+                for (int i1 = std::max(i0 - numBands, 0); i1 < i0; ++i1)
                 {
-                    t = tMultiplier * (Real)i1;
-                    mBasis.Evaluate(t, 0, imin, imax);
-                    if (imin <= i0 && i0 <= imax)
-                    {
-                        ATMat[i0][i1] = mBasis.GetValue(0, i0);
-                    }
+                    mATA(i0, i1) = mATA(i1, i0);
                 }
             }
 
-            // Compute X0 = (A^T*A)^{-1}*A^T by solving the linear system
-            // A^T*A*X = A^T.
-            mConstructed = ATAMat.template SolveSystem<true>(ATMat[0], mNumSamples);
+            // Factor A^T*A once.  Every fit is then a pair of banded
+            // triangular solves with 'dimension' right-hand sides.
+            mFactored = mATA.CholeskyFactor();
+            if (!mFactored)
+            {
+                LogWarning("Failed to factor linear system.");
+                return;
+            }
+
+            mConstructed = Fit(mSampleData, &mControlData[0]);
             if (!mConstructed)
             {
                 LogWarning("Failed to solve linear system.");
-                return;
+            }
+        }
+
+        // Fit new samples with the same dimension, number of samples,
+        // degree and number of controls.  The factorization of A^T*A that
+        // was computed by the constructor is reused, so the cost is linear
+        // in the number of samples.  This is useful for streaming data,
+        // where the parameters of the fit are fixed but the samples change.
+        // The return value is 'false' when the object was not constructed
+        // successfully.
+        bool Refit(Real const* sampleData)
+        {
+            LogAssert(sampleData, "Invalid sample data.");
+            if (mFactored)
+            {
+                mSampleData = sampleData;
+                mConstructed = Fit(mSampleData, &mControlData[0]);
+                return mConstructed;
+            }
+            return false;
+        }
+
+        // Compute the control points for new samples as in Refit, but
+        // without modifying the object.  The controlData array must have
+        // dimension*numControls elements.  The function may be called from
+        // multiple threads at the same time.
+        bool Fit(Real const* sampleData, Real* controlData) const
+        {
+            if (!mFactored)
+            {
+                return false;
             }
 
-            // The control points for the fitted curve are stored in the
-            // vector Q = X0*P, where P is the vector of sample data.
-            for (i0 = 0; i0 < mNumControls; ++i0)
+            // Compute A^T*P.
+            int const degp1 = mDegree + 1;
+            std::fill(controlData, controlData + mDimension * mNumControls, (Real)0);
+            for (int i2 = 0; i2 < mNumSamples; ++i2)
             {
-                Real* Q = &mControlData[i0 * mDimension];
-                for (i1 = 0; i1 < mNumSamples; ++i1)
+                Real const* P = sampleData + i2 * mDimension;
+                Real const* b = &mSampleBasis[static_cast<size_t>(i2) * degp1];
+                Real* Q = controlData + mSampleIMin[i2] * mDimension;
+                for (int k = 0; k <= mDegree; ++k, Q += mDimension)
                 {
-                    Real const* P = mSampleData + i1 * mDimension;
-                    Real xValue = ATMat[i0][i1];
-                    for (j = 0; j < mDimension; ++j)
+                    for (int j = 0; j < mDimension; ++j)
                     {
-                        Q[j] += xValue * P[j];
+                        Q[j] += b[k] * P[j];
                     }
                 }
             }
 
+            // Solve A^T*A*Q = A^T*P.  The control points are the rows of a
+            // row-major matrix whose columns are the 'dimension' right-hand
+            // sides.
+            if (!mATA.template SolveFactored<true>(controlData, mDimension))
+            {
+                return false;
+            }
+
             // Set the first and last output control points to match the first
             // and last input samples.  This supports the application of
             // fitting keyframe data with B-spline curves.  The user expects
             // that the curve passes through the first and last positions in
             // order to support matching two consecutive keyframe sequences.
-            Real* cEnd0 = &mControlData[0];
-            Real const* sEnd0 = mSampleData;
-            Real* cEnd1 = &mControlData[mDimension * (mNumControls - 1)];
-            Real const* sEnd1 = &mSampleData[mDimension * (mNumSamples - 1)];
-            for (j = 0; j < mDimension; ++j)
+            Real* cEnd0 = controlData;
+            Real const* sEnd0 = sampleData;
+            Real* cEnd1 = &controlData[mDimension * (mNumControls - 1)];
+            Real const* sEnd1 = &sampleData[mDimension * (mNumSamples - 1)];
+            for (int j = 0; j < mDimension; ++j)
             {
                 *cEnd0++ = *sEnd0++;
                 *cEnd1++ = *sEnd1++;
             }
+            return true;
+        }
+
+        // Fit independent curves that have the same parameters as this
+        // object, for example the trajectories of many objects sampled at
+        // the same times.  Curve i has samples sampleData[i] and control
+        // points controlData[i].  The curves are distributed among the
+        // threads.  The return value is 'true' iff all the fits succeed.
+        bool Fit(int numCurves, Real const* const* sampleData,
+            Real* const* controlData, unsigned int numThreads = 1) const
+        {
+            int const numCurveThreads = std::max(std::min(
+                static_cast<int>(numThreads), numCurves), 1);
+            std::vector<char> success(numCurveThreads, 1);
+            auto fitRange = [this, numCurves, numCurveThreads, sampleData,
+                controlData, &success](int t)
+            {
+                int imin = numCurves * t / numCurveThreads;
+                int imax = numCurves * (t + 1) / numCurveThreads;
+                for (int i = imin; i < imax; ++i)
+                {
+                    if (!Fit(sampleData[i], controlData[i]))
+                    {
+                        success[t] = 0;
+                    }
+                }
+            };
+
+            if (numCurveThreads > 1)
+            {
+                std::vector<std::thread> process(numCurveThreads);
+                for (int t = 0; t < numCurveThreads; ++t)
+                {
+                    process[t] = std::thread(fitRange, t);
+                }
+                for (auto& p : process)
+                {
+                    p.join();
+                }
+            }
+            else
+            {
+                fitRange(0);
+            }
+
+            return std::find(success.begin(), success.end(), 0) == success.end();
         }
 
         // To validate construction, create an object as shown:
@@ -246,6 +331,13 @@ namespace gte
         int mNumControls;
         std::vector<Real> mControlData;
         BasisFunction<Real> mBasis;
-        bool mConstructed;
+
+        // The nonzero basis values of the samples, which start at control
+        // mSampleIMin[i] for sample i, and the Cholesky factorization of
+        // A^T*A.
+        std::vector<int> mSampleIMin;
+        std::vector<Real> mSampleBasis;
+        BandedMatrix<Real> mATA;
+        bool mFactored, mConstructed;
     };
 }
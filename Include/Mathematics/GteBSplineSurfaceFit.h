@@ -3,13 +3,15 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2019/05/03)
+// File Version: 3.0.3 (2019/09/20)
 
 #pragma once
 
 #include <Mathematics/GteBandedMatrix.h>
 #include <Mathematics/GteVector3.h>
 #include <Mathematics/GteBasisFunction.h>
+#include <algorithm>
+#include <thread>
 
 // The algorithm implemented here is based on the document
 // https://www.geometrictools.com/Documentation/BSplineSurfaceLeastSquaresFit.pdf
@@ -24,12 +26,15 @@ namespace gte
         //   1 <= degree0 && degree0 + 1 < numControls0 <= numSamples0
         //   1 <= degree1 && degree1 + 1 < numControls1 <= numSamples1
         // The sample data must be in row-major order.  The control data is
-        // also stored in row-major order.
+        // also stored in row-major order.  The work is shared by up to
+        // 'numThreads' threads.
         BSplineSurfaceFit(int degree0, int numControls0, int numSamples0,
-            int degree1, int numControls1, int numSamples1, Vector3<Real> const* sampleData)
+            int degree1, int numControls1, int numSamples1, Vector3<Real> const* sampleData,
+            unsigned int numThreads = 1)
             :
             mSampleData(sampleData),
-            mControlData(numControls0 * numControls1)
+            mControlData(numControls0 * numControls1),
+            mATA{ BandedMatrix<Real>(1, 0, 0), BandedMatrix<Real>(1, 0, 0) }
         {
             LogAssert(1 <= degree0 && degree0 + 1 < numControls0, "Invalid degree.");
             LogAssert(numControls0 <= numSamples0, "Invalid number of controls.");
@@ -75,105 +80,79 @@ namespace gte
             // least-squares error metric.  The problem is of the form
             // A0^T*A0*Q*A1^T*A1 = A0^T*P*A1, where A0^T*A0 and A1^T*A1 are
             // banded matrices, P contains the sample data, and Q is the
-            // unknown matrix of control points.
-            Real t;
-            int i0, i1, i2, imin, imax;
-
-            // Construct the matrices A0^T*A0 and A1^T*A1.
-            BandedMatrix<Real> ATAMat[2] =
-            {
-                BandedMatrix<Real>(mNumControls[0], mDegree[0] + 1, mDegree[0] + 1),
-                BandedMatrix<Real>(mNumControls[1], mDegree[1] + 1, mDegree[1] + 1)
-            };
-
-            for (dim = 0; dim < 2; ++dim)
+            // unknown matrix of control points.  The two dimensions are
+            // independent until the control points are computed, so they
+            // are set up at the same time when numThreads > 1.
+            if (numThreads > 1)
             {
-                for (i0 = 0; i0 < mNumControls[dim]; ++i0)
+                std::thread process[2] =
                 {
-                    for (i1 = 0; i1 < i0; ++i1)
-                    {
-                        ATAMat[dim](i0, i1) = ATAMat[dim](i1, i0);
-                    }
+                    std::thread([this, &tMultiplier]() { Factor(0, tMultiplier[0]); }),
+                    std::thread([this, &tMultiplier]() { Factor(1, tMultiplier[1]); })
+                };
+                process[0].join();
+                process[1].join();
+            }
+            else
+            {
+                Factor(0, tMultiplier[0]);
+                Factor(1, tMultiplier[1]);
+            }
 
-                    int i1Max = i0 + mDegree[dim];
-                    if (i1Max >= mNumControls[dim])
-                    {
-                        i1Max = mNumControls[dim] - 1;
-                    }
+            bool solved = Fit(mSampleData, &mControlData[0], numThreads);
+            LogAssert(solved, "Failed to solve linear system.");
+            (void)solved;
+        }
 
-                    for (i1 = i0; i1 <= i1Max; ++i1)
-                    {
-                        Real value = (Real)0;
-                        for (i2 = 0; i2 < mNumSamples[dim]; ++i2)
-                        {
-                            t = tMultiplier[dim] * (Real)i2;
-                            mBasis[dim].Evaluate(t, 0, imin, imax);
-                            if (imin <= i0 && i0 <= imax && imin <= i1 && i1 <= imax)
-                            {
-                                Real b0 = mBasis[dim].GetValue(0, i0);
-                                Real b1 = mBasis[dim].GetValue(0, i1);
-                                value += b0 * b1;
-                            }
-                        }
-                        ATAMat[dim](i0, i1) = value;
-                    }
-                }
-            }
+        // Fit new samples with the same numbers of samples, degrees and
+        // numbers of controls.  The factorizations of A0^T*A0 and A1^T*A1
+        // that were computed by the constructor are reused.
+        bool Refit(Vector3<Real> const* sampleData, unsigned int numThreads = 1)
+        {
+            LogAssert(sampleData, "Invalid sample data.");
+            mSampleData = sampleData;
+            return Fit(mSampleData, &mControlData[0], numThreads);
+        }
 
-            // Construct the matrices A0^T and A1^T.  A[d]^T has
-            // mNumControls[d] rows and mNumSamples[d] columns.
-            Array2<Real> ATMat[2];
-            for (dim = 0; dim < 2; dim++)
+        // Compute the control points for new samples as in Refit, but
+        // without modifying the object.  The controlData array must have
+        // numControls0*numControls1 elements.  The function may be called
+        // from multiple threads at the same time.  The components of the
+        // control points are computed independently, by up to 3 threads.
+        bool Fit(Vector3<Real> const* sampleData, Vector3<Real>* controlData,
+            unsigned int numThreads = 1) const
+        {
+            int const numComponents = std::max(std::min(static_cast<int>(numThreads), 3), 1);
+            std::vector<char> success(numComponents, 1);
+            auto fitComponents = [this, sampleData, controlData, numComponents, &success](int t)
             {
-                ATMat[dim] = Array2<Real>(mNumSamples[dim], mNumControls[dim]);
-                size_t numBytes = mNumControls[dim] * mNumSamples[dim] * sizeof(Real);
-                std::memset(ATMat[dim][0], 0, numBytes);
-                for (i0 = 0; i0 < mNumControls[dim]; ++i0)
+                for (int c = t; c < 3; c += numComponents)
                 {
-                    for (i1 = 0; i1 < mNumSamples[dim]; ++i1)
+                    if (!FitComponent(sampleData, controlData, c))
                     {
-                        t = tMultiplier[dim] * (Real)i1;
-                        mBasis[dim].Evaluate(t, 0, imin, imax);
-                        if (imin <= i0 && i0 <= imax)
-                        {
-                            ATMat[dim][i0][i1] = mBasis[dim].GetValue(0, i0);
-                        }
+                        success[t] = 0;
                     }
                 }
-            }
-
-            // Compute X0 = (A0^T*A0)^{-1}*A0^T and X1 = (A1^T*A1)^{-1}*A1^T
-            // by solving the linear systems A0^T*A0*X0 = A0^T and
-            // A1^T*A1*X1 = A1^T.
-            for (dim = 0; dim < 2; ++dim)
-            {
-                bool solved = ATAMat[dim].template SolveSystem<true>(ATMat[dim][0],
-                    mNumSamples[dim]);
-                LogAssert(solved, "Failed to solve linear system.");
-                (void)solved;
-            }
+            };
 
-            // The control points for the fitted surface are stored in the matrix
-            // Q = X0*P*X1^T, where P is the matrix of sample data.
-            for (i1 = 0; i1 < mNumControls[1]; ++i1)
+            if (numComponents > 1)
             {
-                for (i0 = 0; i0 < mNumControls[0]; ++i0)
+                std::vector<std::thread> process(numComponents);
+                for (int t = 0; t < numComponents; ++t)
                 {
-                    Vector3<Real> sum = Vector3<Real>::Zero();
-                    for (int j1 = 0; j1 < mNumSamples[1]; ++j1)
-                    {
-                        Real x1Value = ATMat[1][i1][j1];
-                        for (int j0 = 0; j0 < mNumSamples[0]; ++j0)
-                        {
-                            Real x0Value = ATMat[0][i0][j0];
-                            Vector3<Real> sample =
-                                mSampleData[j0 + mNumSamples[0] * j1];
-                            sum += (x0Value * x1Value) * sample;
-                        }
-                    }
-                    mControlData[i0 + mNumControls[0] * i1] = sum;
+                    process[t] = std::thread(fitComponents, t);
+                }
+                for (auto& p : process)
+                {
+                    p.join();
                 }
             }
+            else
+            {
+                fitComponents(0);
+            }
+
+            return std::find(success.begin(), success.end(), 0) == success.end();
         }
 
         // Access to input sample information.
@@ -232,6 +211,116 @@ namespace gte
         }
 
     private:
+        // Cache the basis values at the samples and factor A^T*A for
+        // dimension 'dim'.
+        void Factor(int dim, Real tMultiplier)
+        {
+            int const degree = mDegree[dim], degp1 = degree + 1;
+            int const numSamples = mNumSamples[dim];
+            int const numControls = mNumControls[dim];
+            std::vector<int>& sampleIMin = mSampleIMin[dim];
+            std::vector<Real>& sampleBasis = mSampleBasis[dim];
+            sampleIMin.resize(numSamples);
+            sampleBasis.resize(static_cast<size_t>(numSamples) * degp1);
+            for (int i2 = 0, k = 0; i2 < numSamples; ++i2)
+            {
+                Real t = tMultiplier * (Real)i2;
+                int imin, imax;
+                mBasis[dim].Evaluate(t, 0, imin, imax);
+                sampleIMin[i2] = imin;
+                for (int i = imin; i <= imax; ++i, ++k)
+                {
+                    sampleBasis[k] = mBasis[dim].GetValue(0, i);
+                }
+            }
+
+            // Construct the matrix A^T*A.
+            BandedMatrix<Real>& ATA = mATA[dim];
+            ATA = BandedMatrix<Real>(numControls, degp1, degp1);
+            for (int i2 = 0; i2 < numSamples; ++i2)
+            {
+                int imin = sampleIMin[i2];
+                Real const* b = &sampleBasis[static_cast<size_t>(i2) * degp1];
+                for (int k0 = 0; k0 <= degree; ++k0)
+                {
+                    for (int k1 = k0; k1 <= degree; ++k1)
+                    {
+                        ATA(imin + k0, imin + k1) += b[k0] * b[k1];
+                    }
+                }
+            }
+            for (int i0 = 0; i0 < numControls; ++i0)
+            {
+                for (int i1 = std::max(i0 - degp1, 0); i1 < i0; ++i1)
+                {
+                    ATA(i0, i1) = ATA(i1, i0);
+                }
+            }
+
+            bool factored = ATA.CholeskyFactor();
+            LogAssert(factored, "Failed to factor linear system.");
+            (void)factored;
+        }
+
+        // Compute component c of the control points.  Let B be the
+        // numControls0-by-numControls1 matrix A0^T*P*A1 for component c of
+        // the samples, stored in row-major order.  The columns of B are
+        // solved with the factorization of A0^T*A0, which is a row-major
+        // solve with numControls1 right-hand sides.  The rows of the result
+        // are then solved with the factorization of A1^T*A1, which is a
+        // column-major solve of the transpose.  The control data is in the
+        // order i0 + numControls0*i1, so B is its transpose.
+        bool FitComponent(Vector3<Real> const* sampleData,
+            Vector3<Real>* controlData, int c) const
+        {
+            int const degp1[2] = { mDegree[0] + 1, mDegree[1] + 1 };
+            std::vector<Real> B(static_cast<size_t>(mNumControls[0]) * mNumControls[1], (Real)0);
+            std::vector<Real> row(mNumControls[0]);
+            for (int j1 = 0; j1 < mNumSamples[1]; ++j1)
+            {
+                // Compute row = A0^T*(column j1 of P), and then add its
+                // products with row j1 of A1 to B.
+                std::fill(row.begin(), row.end(), (Real)0);
+                Vector3<Real> const* P = &sampleData[mNumSamples[0] * j1];
+                for (int j0 = 0; j0 < mNumSamples[0]; ++j0)
+                {
+                    Real const* b0 = &mSampleBasis[0][static_cast<size_t>(j0) * degp1[0]];
+                    Real* r = &row[mSampleIMin[0][j0]];
+                    Real p = P[j0][c];
+                    for (int k0 = 0; k0 < degp1[0]; ++k0)
+                    {
+                        r[k0] += b0[k0] * p;
+                    }
+                }
+
+                int i1min = mSampleIMin[1][j1];
+                Real const* b1 = &mSampleBasis[1][static_cast<size_t>(j1) * degp1[1]];
+                for (int i0 = 0; i0 < mNumControls[0]; ++i0)
+                {
+                    Real* Brow = &B[static_cast<size_t>(i0) * mNumControls[1] + i1min];
+                    for (int k1 = 0; k1 < degp1[1]; ++k1)
+                    {
+                        Brow[k1] += row[i0] * b1[k1];
+                    }
+                }
+            }
+
+            if (!mATA[0].template SolveFactored<true>(B.data(), mNumControls[1])
+                || !mATA[1].template SolveFactored<false>(B.data(), mNumControls[0]))
+            {
+                return false;
+            }
+
+            for (int i1 = 0, i = 0; i1 < mNumControls[1]; ++i1)
+            {
+                for (int i0 = 0; i0 < mNumControls[0]; ++i0, ++i)
+                {
+                    controlData[i][c] = B[static_cast<size_t>(i0) * mNumControls[1] + i1];
+                }
+            }
+            return true;
+        }
+
         // Input sample information.
         int mNumSamples[2];
         Vector3<Real> const* mSampleData;
@@ -241,5 +330,12 @@ namespace gte
         int mNumControls[2];
         std::vector<Vector3<Real>> mControlData;
         BasisFunction<Real> mBasis[2];
+
+        // For each dimension, the nonzero basis values of the samples,
+        // which start at control mSampleIMin[dim][i] for sample i, and the
+        // Cholesky factorization of A[dim]^T*A[dim].
+        std::vector<int> mSampleIMin[2];
+        std::vector<Real> mSampleBasis[2];
+        BandedMatrix<Real> mATA[2];
     };
 }
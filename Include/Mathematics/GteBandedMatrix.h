@@ -3,11 +3,12 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2019/04/04)
+// File Version: 3.0.3 (2019/09/20)
 
 #pragma once
 
 #include <LowLevel/GteLexicoArray2.h>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -271,6 +272,29 @@ namespace gte
                 && SolveUpper<RowMajor>(bMatrix, numBColumns);
         }
 
+        // Solve the linear system A*X = B using the Cholesky factorization
+        // stored by a successful call to CholeskyFactor().  The matrix is not
+        // modified, so the factorization may be reused for any number of
+        // right-hand sides B, and calls from different threads are safe.
+        // The output X is stored in B.  The return value is 'true' iff the
+        // system has a solution.
+        bool SolveFactored(Real* bVector) const
+        {
+            return SolveLower(bVector) && SolveUpper(bVector);
+        }
+
+        // The same as SolveFactored(Real*) for an NxM matrix B.  The work
+        // for each row of the factor is applied to all M columns, so with
+        // row-major storage the innermost loops are over contiguous
+        // memory.  'bMatrix' must have the storage order specified by the
+        // template parameter.
+        template <bool RowMajor>
+        bool SolveFactored(Real* bMatrix, int numBColumns) const
+        {
+            return SolveLower<RowMajor>(bMatrix, numBColumns)
+                && SolveUpper<RowMajor>(bMatrix, numBColumns);
+        }
+
         // Compute the inverse of the banded matrix.  The return value is 'true'
         // when the matrix is invertible, in which case the 'inverse' output is
         // valid.  The return value is 'false' when the matrix is not invertible,
@@ -381,16 +405,18 @@ namespace gte
     private:
         // The linear system is L*U*X = B, where A = L*U and U = L^T,  Reduce this
         // to U*X = L^{-1}*B.  The return value is 'true' iff the operation is
-        // successful.
+        // successful.  The entries of L outside the bands are zero, so only
+        // the columns in the bands are visited.
         bool SolveLower(Real* dataVector) const
         {
             int const size = static_cast<int>(mDBand.size());
+            int const numBands = static_cast<int>(mLBands.size());
             for (int r = 0; r < size; ++r)
             {
                 Real lowerRR = operator()(r, r);
                 if (lowerRR > (Real)0)
                 {
-                    for (int c = 0; c < r; ++c)
+                    for (int c = std::max(r - numBands, 0); c < r; ++c)
                     {
                         Real lowerRC = operator()(r, c);
                         dataVector[r] -= lowerRC * dataVector[c];
@@ -407,16 +433,18 @@ namespace gte
 
         // The linear system is U*X = L^{-1}*B.  Reduce this to
         // X = U^{-1}*L^{-1}*B.  The return value is 'true' iff the operation is
-        // successful.
+        // successful.  Only the columns in the bands are visited.
         bool SolveUpper(Real* dataVector) const
         {
             int const size = static_cast<int>(mDBand.size());
+            int const numBands = static_cast<int>(mUBands.size());
             for (int r = size - 1; r >= 0; --r)
             {
                 Real upperRR = operator()(r, r);
                 if (upperRR > (Real)0)
                 {
-                    for (int c = r + 1; c < size; ++c)
+                    int const cMax = std::min(r + numBands, size - 1);
+                    for (int c = r + 1; c <= cMax; ++c)
                     {
                         Real upperRC = operator()(r, c);
                         dataVector[r] -= upperRC * dataVector[c];
@@ -441,12 +469,13 @@ namespace gte
         {
             LexicoArray2<RowMajor, Real> data(mSize, numColumns, dataMatrix);
 
+            int const numBands = static_cast<int>(mLBands.size());
             for (int r = 0; r < mSize; ++r)
             {
                 Real lowerRR = operator()(r, r);
                 if (lowerRR > (Real)0)
                 {
-                    for (int c = 0; c < r; ++c)
+                    for (int c = std::max(r - numBands, 0); c < r; ++c)
                     {
                         Real lowerRC = operator()(r, c);
                         for (int bCol = 0; bCol < numColumns; ++bCol)
@@ -478,12 +507,14 @@ namespace gte
         {
             LexicoArray2<RowMajor, Real> data(mSize, numColumns, dataMatrix);
 
+            int const numBands = static_cast<int>(mUBands.size());
             for (int r = mSize - 1; r >= 0; --r)
             {
                 Real upperRR = operator()(r, r);
                 if (upperRR > (Real)0)
                 {
-                    for (int c = r + 1; c < mSize; ++c)
+                    int const cMax = std::min(r + numBands, mSize - 1);
+                    for (int c = r + 1; c <= cMax; ++c)
                     {
                         Real upperRC = operator()(r, c);
                         for (int bCol = 0; bCol < numColumns; ++bCol)
@@ -0,0 +1,358 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/19)
+
+#pragma once
+
+#include <Mathematics/GteSymmetricEigensolver3x3.h>
+#include <thread>
+#include <vector>
+
+// The noniterative algorithm of NISymmetricEigensolver3x3 applied to arrays
+// of 3x3 symmetric matrices, such as the covariance matrices of point
+// neighborhoods that are used to estimate normals.  The matrices are stored
+// in structure-of-arrays layout: the element aRC of matrix i is aRC[i].  The
+// matrices are processed in groups of 'Lanes', and each step of the
+// algorithm is a loop over the lanes without branches, so the compiler can
+// map a group to SIMD registers (for example, 8 floats to an AVX register).
+// The branches of the scalar algorithm are replaced by computing both
+// alternatives and selecting one of them.  The trigonometric functions are
+// evaluated in separate loops, because they are not inlined.  The
+// operations are those of NISymmetricEigensolver3x3 in the same order, so
+// the results are the same unless the compiler contracts multiplies and
+// adds.  Matrices that are diagonal, including the zero matrix, are rare in
+// practice and are solved by NISymmetricEigensolver3x3.  With GCC and Clang,
+// the loops that contain square roots are vectorized only when compiling
+// with -fno-math-errno.
+//
+// The iterative SymmetricEigensolver3x3 is not batched, because its number
+// of iterations depends on the matrix.
+
+namespace gte
+{
+    template <typename Real, int Lanes = (sizeof(Real) <= 4 ? 8 : 4)>
+    class BatchSymmetricEigensolver3x3
+    {
+    public:
+        // Arrays with fewer than 2^14 matrices are processed by the calling
+        // thread.
+        BatchSymmetricEigensolver3x3(unsigned int numThreads = 1)
+            :
+            mNumThreads(numThreads > 0 ? numThreads : 1)
+        {
+        }
+
+        // The input arrays a[0] through a[5] store the unique elements a00,
+        // a01, a02, a11, a12 and a22 of the matrices.  The eigenvalues of
+        // matrix i are eval[j][i] for 0 <= j <= 2 and the eigenvector of
+        // eval[j][i] has components evec[3*j+k][i] for 0 <= k <= 2.  The
+        // sortType is as in NISymmetricEigensolver3x3: -1 (decreasing),
+        // 0 (the increasing order of the algorithm) or +1 (increasing).  The
+        // eigenvectors of each matrix form a right-handed orthonormal set.
+        void operator()(size_t numMatrices, std::array<Real const*, 6> const& a,
+            int sortType, std::array<Real*, 3> const& eval,
+            std::array<Real*, 9> const& evec) const
+        {
+            size_t const minMatricesPerThread = 16384;
+            size_t numThreads = std::min(static_cast<size_t>(mNumThreads),
+                numMatrices / minMatricesPerThread);
+            if (numThreads > 1)
+            {
+                // The ranges are multiples of Lanes, so that only the last
+                // thread has a partial group.
+                size_t const numGroups = (numMatrices + Lanes - 1) / Lanes;
+                std::vector<std::thread> process(numThreads);
+                for (size_t t = 0; t < numThreads; ++t)
+                {
+                    size_t imin = std::min(numGroups * t / numThreads * Lanes, numMatrices);
+                    size_t imax = std::min(numGroups * (t + 1) / numThreads * Lanes, numMatrices);
+                    process[t] = std::thread([this, imin, imax, &a, sortType, &eval, &evec]()
+                    {
+                        Solve(imin, imax, a, sortType, eval, evec);
+                    });
+                }
+
+                for (auto& p : process)
+                {
+                    p.join();
+                }
+            }
+            else
+            {
+                Solve(0, numMatrices, a, sortType, eval, evec);
+            }
+        }
+
+    private:
+        typedef std::array<Real, Lanes> Pack;
+
+        // Solve for matrices imin through imax-1.
+        void Solve(size_t imin, size_t imax, std::array<Real const*, 6> const& a,
+            int sortType, std::array<Real*, 3> const& eval,
+            std::array<Real*, 9> const& evec) const
+        {
+            std::array<Pack, 6> input;
+            std::array<Pack, 3> value;
+            std::array<Pack, 9> vector;
+            for (size_t i0 = imin; i0 < imax; i0 += Lanes)
+            {
+                // A partial group is padded with zero matrices.
+                int const numLanes = static_cast<int>(std::min(imax - i0, static_cast<size_t>(Lanes)));
+                for (int j = 0; j < 6; ++j)
+                {
+                    for (int k = 0; k < numLanes; ++k)
+                    {
+                        input[j][k] = a[j][i0 + k];
+                    }
+                    for (int k = numLanes; k < Lanes; ++k)
+                    {
+                        input[j][k] = (Real)0;
+                    }
+                }
+
+                Pack norm;
+                SolveGroup(input, value, vector, norm);
+
+                for (int k = 0; k < numLanes; ++k)
+                {
+                    std::array<Real, 3> lambda;
+                    std::array<std::array<Real, 3>, 3> v;
+                    if (!(norm[k] > (Real)0))
+                    {
+                        NISymmetricEigensolver3x3<Real>()(input[0][k], input[1][k],
+                            input[2][k], input[3][k], input[4][k], input[5][k],
+                            sortType, lambda, v);
+                    }
+                    else
+                    {
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            lambda[j] = value[j][k];
+                            v[j] = { vector[3 * j][k], vector[3 * j + 1][k], vector[3 * j + 2][k] };
+                        }
+                        SortEigenstuff<Real>()(sortType, true, lambda, v);
+                    }
+
+                    size_t const i = i0 + k;
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        eval[j][i] = lambda[j];
+                        evec[3 * j][i] = v[j][0];
+                        evec[3 * j + 1][i] = v[j][1];
+                        evec[3 * j + 2][i] = v[j][2];
+                    }
+                }
+            }
+        }
+
+        // The algorithm of NISymmetricEigensolver3x3::operator() for the
+        // lanes of a group.  The eigenvalues are increasing and are not
+        // sorted further.  The outputs are not meaningful for the lanes with
+        // diagonal matrices, which are those whose 'norm' is zero.
+        static void SolveGroup(std::array<Pack, 6> const& input,
+            std::array<Pack, 3>& eval, std::array<Pack, 9>& evec, Pack& norm)
+        {
+            // Precondition the matrix by factoring out the maximum absolute
+            // value of the components.
+            Pack a00, a01, a02, a11, a12, a22, maxAbsElement;
+            for (int k = 0; k < Lanes; ++k)
+            {
+                Real max0 = std::max(std::fabs(input[0][k]), std::fabs(input[1][k]));
+                Real max1 = std::max(std::fabs(input[2][k]), std::fabs(input[3][k]));
+                Real max2 = std::max(std::fabs(input[4][k]), std::fabs(input[5][k]));
+                Real maxAbs = std::max(std::max(max0, max1), max2);
+                Real invMaxAbs = (Real)1 / (maxAbs > (Real)0 ? maxAbs : (Real)1);
+                a00[k] = input[0][k] * invMaxAbs;
+                a01[k] = input[1][k] * invMaxAbs;
+                a02[k] = input[2][k] * invMaxAbs;
+                a11[k] = input[3][k] * invMaxAbs;
+                a12[k] = input[4][k] * invMaxAbs;
+                a22[k] = input[5][k] * invMaxAbs;
+                maxAbsElement[k] = maxAbs;
+            }
+
+            // Compute q, p and cos(3*theta) of the PDF mentioned in
+            // GteSymmetricEigensolver3x3.h.
+            Pack q, p, halfDet;
+            for (int k = 0; k < Lanes; ++k)
+            {
+                norm[k] = a01[k] * a01[k] + a02[k] * a02[k] + a12[k] * a12[k];
+                q[k] = (a00[k] + a11[k] + a22[k]) / (Real)3;
+                Real b00 = a00[k] - q[k];
+                Real b11 = a11[k] - q[k];
+                Real b22 = a22[k] - q[k];
+                Real pk = std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + norm[k] * (Real)2) / (Real)6);
+                pk = (pk > (Real)0 ? pk : (Real)1);
+                Real c00 = b11 * b22 - a12[k] * a12[k];
+                Real c01 = a01[k] * b22 - a12[k] * a02[k];
+                Real c02 = a01[k] * a12[k] - b11 * a02[k];
+                Real det = (b00 * c00 - a01[k] * c01 + a02[k] * c02) / (pk * pk * pk);
+                Real hd = det * (Real)0.5;
+                halfDet[k] = std::min(std::max(hd, (Real)-1), (Real)1);
+                p[k] = pk;
+            }
+
+            Pack angle, cos0, cos2;
+            for (int k = 0; k < Lanes; ++k)
+            {
+                angle[k] = std::acos(halfDet[k]) / (Real)3;
+            }
+            Real const twoThirdsPi = (Real)2.09439510239319549;
+            for (int k = 0; k < Lanes; ++k)
+            {
+                cos2[k] = std::cos(angle[k]);
+            }
+            for (int k = 0; k < Lanes; ++k)
+            {
+                cos0[k] = std::cos(angle[k] + twoThirdsPi);
+            }
+
+            // The eigenvalues are increasing.  The eigenvector of the
+            // eigenvalue that is better separated from the others is
+            // computed first, which is evec[2] when halfDet >= 0 or evec[0]
+            // otherwise.
+            Pack extreme;
+            for (int k = 0; k < Lanes; ++k)
+            {
+                Real beta2 = cos2[k] * (Real)2;
+                Real beta0 = cos0[k] * (Real)2;
+                Real beta1 = -(beta0 + beta2);
+                eval[0][k] = q[k] + p[k] * beta0;
+                eval[1][k] = q[k] + p[k] * beta1;
+                eval[2][k] = q[k] + p[k] * beta2;
+                extreme[k] = (halfDet[k] >= (Real)0 ? eval[2][k] : eval[0][k]);
+            }
+
+            std::array<Pack, 3> W, U;
+            ComputeEigenvector0(a00, a01, a02, a11, a12, a22, extreme, W);
+            ComputeEigenvector1(a00, a01, a02, a11, a12, a22, W, eval[1], U);
+
+            for (int k = 0; k < Lanes; ++k)
+            {
+                // evec[0] = Cross(evec[1],evec[2]) when halfDet >= 0 and
+                // evec[2] = Cross(evec[0],evec[1]) otherwise.
+                bool positive = (halfDet[k] >= (Real)0);
+                Real s = (positive ? (Real)1 : (Real)-1);
+                Real cross0 = s * (U[1][k] * W[2][k] - U[2][k] * W[1][k]);
+                Real cross1 = s * (U[2][k] * W[0][k] - U[0][k] * W[2][k]);
+                Real cross2 = s * (U[0][k] * W[1][k] - U[1][k] * W[0][k]);
+                evec[0][k] = (positive ? cross0 : W[0][k]);
+                evec[1][k] = (positive ? cross1 : W[1][k]);
+                evec[2][k] = (positive ? cross2 : W[2][k]);
+                evec[3][k] = U[0][k];
+                evec[4][k] = U[1][k];
+                evec[5][k] = U[2][k];
+                evec[6][k] = (positive ? W[0][k] : cross0);
+                evec[7][k] = (positive ? W[1][k] : cross1);
+                evec[8][k] = (positive ? W[2][k] : cross2);
+
+                // Revert the preconditioning.
+                eval[0][k] *= maxAbsElement[k];
+                eval[1][k] *= maxAbsElement[k];
+                eval[2][k] *= maxAbsElement[k];
+            }
+        }
+
+        // The lane version of NISymmetricEigensolver3x3::ComputeEigenvector0.
+        static void ComputeEigenvector0(Pack const& a00, Pack const& a01,
+            Pack const& a02, Pack const& a11, Pack const& a12, Pack const& a22,
+            Pack const& eval0, std::array<Pack, 3>& evec0)
+        {
+            for (int k = 0; k < Lanes; ++k)
+            {
+                // The rows of A - eval0*I and their cross products.
+                Real r00 = a00[k] - eval0[k], r01 = a01[k], r02 = a02[k];
+                Real r10 = a01[k], r11 = a11[k] - eval0[k], r12 = a12[k];
+                Real r20 = a02[k], r21 = a12[k], r22 = a22[k] - eval0[k];
+                Real c010 = r01 * r12 - r02 * r11;
+                Real c011 = r02 * r10 - r00 * r12;
+                Real c012 = r00 * r11 - r01 * r10;
+                Real c020 = r01 * r22 - r02 * r21;
+                Real c021 = r02 * r20 - r00 * r22;
+                Real c022 = r00 * r21 - r01 * r20;
+                Real c120 = r11 * r22 - r12 * r21;
+                Real c121 = r12 * r20 - r10 * r22;
+                Real c122 = r10 * r21 - r11 * r20;
+                Real d0 = c010 * c010 + c011 * c011 + c012 * c012;
+                Real d1 = c020 * c020 + c021 * c021 + c022 * c022;
+                Real d2 = c120 * c120 + c121 * c121 + c122 * c122;
+
+                // Select the cross product of largest length.
+                bool select1 = (d1 > d0);
+                Real dmax = (select1 ? d1 : d0);
+                Real x = (select1 ? c020 : c010);
+                Real y = (select1 ? c021 : c011);
+                Real z = (select1 ? c022 : c012);
+                bool select2 = (d2 > dmax);
+                dmax = (select2 ? d2 : dmax);
+                x = (select2 ? c120 : x);
+                y = (select2 ? c121 : y);
+                z = (select2 ? c122 : z);
+
+                Real invLength = (Real)1 / std::sqrt(dmax);
+                evec0[0][k] = x * invLength;
+                evec0[1][k] = y * invLength;
+                evec0[2][k] = z * invLength;
+            }
+        }
+
+        // The lane version of NISymmetricEigensolver3x3::ComputeEigenvector1.
+        static void ComputeEigenvector1(Pack const& a00, Pack const& a01,
+            Pack const& a02, Pack const& a11, Pack const& a12, Pack const& a22,
+            std::array<Pack, 3> const& evec0, Pack const& eval1,
+            std::array<Pack, 3>& evec1)
+        {
+            for (int k = 0; k < Lanes; ++k)
+            {
+                // Compute a right-handed orthonormal set { U, V, evec0 }.
+                Real w0 = evec0[0][k], w1 = evec0[1][k], w2 = evec0[2][k];
+                bool useW0 = (std::fabs(w0) > std::fabs(w1));
+                Real wmax = (useW0 ? w0 : w1);
+                Real invLength = (Real)1 / std::sqrt(wmax * wmax + w2 * w2);
+                Real u0 = (useW0 ? -w2 * invLength : (Real)0);
+                Real u1 = (useW0 ? (Real)0 : +w2 * invLength);
+                Real u2 = (useW0 ? +w0 * invLength : -w1 * invLength);
+                Real v0 = w1 * u2 - w2 * u1;
+                Real v1 = w2 * u0 - w0 * u2;
+                Real v2 = w0 * u1 - w1 * u0;
+
+                // M = J^T*(A - eval1*I)*J for J = [U V].
+                Real au0 = a00[k] * u0 + a01[k] * u1 + a02[k] * u2;
+                Real au1 = a01[k] * u0 + a11[k] * u1 + a12[k] * u2;
+                Real au2 = a02[k] * u0 + a12[k] * u1 + a22[k] * u2;
+                Real av0 = a00[k] * v0 + a01[k] * v1 + a02[k] * v2;
+                Real av1 = a01[k] * v0 + a11[k] * v1 + a12[k] * v2;
+                Real av2 = a02[k] * v0 + a12[k] * v1 + a22[k] * v2;
+                Real m00 = u0 * au0 + u1 * au1 + u2 * au2 - eval1[k];
+                Real m01 = u0 * av0 + u1 * av1 + u2 * av2;
+                Real m11 = v0 * av0 + v1 * av1 + v2 * av2 - eval1[k];
+
+                // Normalize the largest-length row (x,y) of M, where x is
+                // the diagonal entry, and compute the coefficients of U and
+                // V from it.
+                bool useRow0 = (std::fabs(m00) >= std::fabs(m11));
+                Real x = (useRow0 ? m00 : m11), y = m01;
+                Real absX = std::fabs(x), absY = std::fabs(y);
+                bool divideByX = (absX >= absY);
+                Real numer = (divideByX ? y : x);
+                Real denom = (divideByX ? x : y);
+                Real ratio = numer / (denom != (Real)0 ? denom : (Real)1);
+                Real invSqrt = (Real)1 / std::sqrt((Real)1 + ratio * ratio);
+                Real xn = (divideByX ? invSqrt : ratio * invSqrt);
+                Real yn = (divideByX ? ratio * invSqrt : invSqrt);
+                Real cu = (useRow0 ? yn : xn);
+                Real cv = (useRow0 ? xn : yn);
+
+                bool nonzero = (std::max(absX, absY) > (Real)0);
+                evec1[0][k] = (nonzero ? cu * u0 - cv * v0 : u0);
+                evec1[1][k] = (nonzero ? cu * u1 - cv * v1 : u1);
+                evec1[2][k] = (nonzero ? cu * u2 - cv * v2 : u2);
+            }
+        }
+
+        unsigned int mNumThreads;
+    };
+}
@@ -0,0 +1,125 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/18)
+
+#pragma once
+
+#include <Mathematics/GteBlockedMatrixProduct.h>
+#include <vector>
+
+// The product H[0]*H[1]*...*H[k-1] of Householder reflections
+// H[j] = I - tau[j]*V[j]*V[j]^T is I - V*T*V^T, where V is the matrix whose
+// columns are the V[j] and T is upper triangular; see
+//   R. Schreiber and C. Van Loan, "A storage-efficient WY representation
+//   for products of Householder transformations," SIAM J. Sci. Stat.
+//   Comput., 10(1):53-57, 1989.
+// Applying the product to a matrix C as C - V*(T*(V^T*C)) requires two
+// matrix products instead of k rank-1 updates, so most of the work is done
+// by the cache-blocked BlockedMatrixProduct.  A reflection with tau[j] = 0
+// is the identity.
+
+namespace gte
+{
+    template <typename Real>
+    class BlockReflector
+    {
+    public:
+        BlockReflector(unsigned int numThreads = 1)
+            :
+            mProduct(numThreads)
+        {
+        }
+
+        // Compute C = H[0]*H[1]*...*H[k-1]*C, where C is numRows-by-numCols
+        // and V is numRows-by-k with V[j] stored in column j.
+        void Apply(int numRows, int numCols, int k,
+            Real const* V, int vRowStride, int vColStride, Real const* tau,
+            Real* C, int cRowStride, int cColStride)
+        {
+            if (numRows <= 0 || numCols <= 0 || k <= 0)
+            {
+                return;
+            }
+
+            ComputeT(numRows, k, V, vRowStride, vColStride, tau);
+
+            // W = V^T*C, then W = T*W.  T is upper triangular, so row i of
+            // T*W depends only on rows i through k-1 of W.
+            mW.resize(static_cast<size_t>(k) * numCols);
+            mProduct.Multiply(k, numCols, numRows,
+                V, vColStride, vRowStride, C, cRowStride, cColStride,
+                mW.data(), numCols, 1);
+
+            for (int i = 0; i < k; ++i)
+            {
+                Real* wi = &mW[static_cast<size_t>(i) * numCols];
+                Real const tii = mT[i * k + i];
+                for (int c = 0; c < numCols; ++c)
+                {
+                    wi[c] *= tii;
+                }
+                for (int j = i + 1; j < k; ++j)
+                {
+                    Real const tij = mT[i * k + j];
+                    Real const* wj = &mW[static_cast<size_t>(j) * numCols];
+                    for (int c = 0; c < numCols; ++c)
+                    {
+                        wi[c] += tij * wj[c];
+                    }
+                }
+            }
+
+            // C = C - V*W.
+            mProduct.MultiplySubtract(numRows, numCols, k,
+                V, vRowStride, vColStride, mW.data(), numCols, 1,
+                C, cRowStride, cColStride);
+        }
+
+    private:
+        // Column j of T is T(0:j-1,j) = -tau[j]*T(0:j-1,0:j-1)*V(:,0:j-1)^T*V[j]
+        // and T(j,j) = tau[j].  The k-by-k matrix T is stored in row-major
+        // order.
+        void ComputeT(int numRows, int k, Real const* V, int vRowStride,
+            int vColStride, Real const* tau)
+        {
+            mT.assign(static_cast<size_t>(k) * k, (Real)0);
+            mDots.resize(k);
+            for (int j = 0; j < k; ++j)
+            {
+                mT[j * k + j] = tau[j];
+                if (tau[j] == (Real)0)
+                {
+                    continue;
+                }
+
+                Real const* vj = V + j * vColStride;
+                for (int i = 0; i < j; ++i)
+                {
+                    Real const* vi = V + i * vColStride;
+                    Real dot = (Real)0;
+                    for (int r = 0; r < numRows; ++r)
+                    {
+                        dot += vi[r * vRowStride] * vj[r * vRowStride];
+                    }
+                    mDots[i] = dot;
+                }
+
+                for (int i = 0; i < j; ++i)
+                {
+                    Real sum = (Real)0;
+                    for (int m = i; m < j; ++m)
+                    {
+                        sum += mT[i * k + m] * mDots[m];
+                    }
+                    mT[i * k + j] = -tau[j] * sum;
+                }
+            }
+        }
+
+        BlockedMatrixProduct<Real> mProduct;
+        std::vector<Real> mT, mW, mDots;
+    };
+}
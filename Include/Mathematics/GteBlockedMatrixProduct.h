@@ -0,0 +1,378 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/18)
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Cache-blocked products of matrices that are stored as 1-dimensional
+// arrays.  Element (r,c) of a matrix is data[r*rowStride + c*colStride], so
+// the same code handles row-major and column-major storage and transposed
+// operands.  The products are computed as in the GotoBLAS design:  a panel
+// of B that fits in the L3 cache and a block of A that fits in the L2 cache
+// are copied (packed) into contiguous buffers, and a micro-kernel updates an
+// MR-by-NR tile of C held in local variables.  The innermost loops have unit
+// stride and constant trip counts, so the compiler vectorizes them for
+// whatever instruction set it targets.  With multiple threads, each thread
+// computes a panel of rows of C.
+//
+// Each element of C is accumulated in the order of the summation index, as
+// in the triple loop, so the results are those of the triple loop unless
+// the compiler contracts multiplications and additions to fused
+// multiply-adds.
+
+namespace gte
+{
+    template <typename Real>
+    class BlockedMatrixProduct
+    {
+    public:
+        // Products with fewer than 2^18 multiply-adds are computed by the
+        // calling thread.
+        BlockedMatrixProduct(unsigned int numThreads = 1)
+            :
+            mNumThreads(numThreads > 0 ? numThreads : 1)
+        {
+        }
+
+        // C = A*B, where A is numRows-by-numCommon, B is numCommon-by-numCols
+        // and C is numRows-by-numCols.  C must not overlap A or B.
+        void Multiply(int numRows, int numCols, int numCommon,
+            Real const* A, int aRowStride, int aColStride,
+            Real const* B, int bRowStride, int bColStride,
+            Real* C, int cRowStride, int cColStride) const
+        {
+            Operand a = { A, aRowStride, aColStride };
+            Operand b = { B, bRowStride, bColStride };
+            Output c = { C, cRowStride, cColStride };
+            std::vector<int> bounds = Partition(numRows, numCols, numCommon, false);
+            Execute(bounds, [&](int rmin, int rmax)
+            {
+                Gemm(rmin, rmax, numCols, numCommon, a, b, c, false, false);
+            });
+        }
+
+        // C = C - A*B, where the matrices are as in Multiply.  This is the
+        // update of a trailing submatrix in blocked factorizations.
+        void MultiplySubtract(int numRows, int numCols, int numCommon,
+            Real const* A, int aRowStride, int aColStride,
+            Real const* B, int bRowStride, int bColStride,
+            Real* C, int cRowStride, int cColStride) const
+        {
+            Operand a = { A, aRowStride, aColStride };
+            Operand b = { B, bRowStride, bColStride };
+            Output c = { C, cRowStride, cColStride };
+            std::vector<int> bounds = Partition(numRows, numCols, numCommon, false);
+            Execute(bounds, [&](int rmin, int rmax)
+            {
+                Gemm(rmin, rmax, numCols, numCommon, a, b, c, false, true);
+            });
+        }
+
+        // C = A*A^T, where A is numRows-by-numCommon and C is
+        // numRows-by-numRows.  Only the tiles of C that intersect the lower
+        // triangle are computed; the upper triangle is copied from the lower
+        // triangle.  For the normal equations J^T*J, pass A = J^T by
+        // swapping the strides of J.
+        void MultiplySymmetric(int numRows, int numCommon,
+            Real const* A, int aRowStride, int aColStride,
+            Real* C, int cRowStride, int cColStride) const
+        {
+            Operand a = { A, aRowStride, aColStride };
+            Operand b = { A, aColStride, aRowStride };
+            Output c = { C, cRowStride, cColStride };
+            std::vector<int> bounds = Partition(numRows, numRows, numCommon, true);
+            Execute(bounds, [&](int rmin, int rmax)
+            {
+                Gemm(rmin, rmax, numRows, numCommon, a, b, c, true, false);
+            });
+
+            for (int r = 0; r < numRows; ++r)
+            {
+                for (int col = r + 1; col < numRows; ++col)
+                {
+                    C[r * cRowStride + col * cColStride] = C[col * cRowStride + r * cColStride];
+                }
+            }
+        }
+
+        // y = A*x, where A is numRows-by-numCols.  The loop order is chosen
+        // by the storage of A so that the matrix is traversed with unit
+        // stride.  y must not overlap A or x.
+        void Multiply(int numRows, int numCols,
+            Real const* A, int aRowStride, int aColStride,
+            Real const* x, Real* y) const
+        {
+            std::vector<int> bounds = Partition(numRows, numCols, 1, false);
+            Execute(bounds, [&](int rmin, int rmax)
+            {
+                if (aColStride == 1)
+                {
+                    for (int r = rmin; r < rmax; ++r)
+                    {
+                        Real const* row = A + r * aRowStride;
+                        Real sum = (Real)0;
+                        for (int c = 0; c < numCols; ++c)
+                        {
+                            sum += row[c] * x[c];
+                        }
+                        y[r] = sum;
+                    }
+                }
+                else
+                {
+                    std::fill(y + rmin, y + rmax, (Real)0);
+                    for (int c = 0; c < numCols; ++c)
+                    {
+                        Real const* column = A + c * aColStride;
+                        Real const xc = x[c];
+                        for (int r = rmin; r < rmax; ++r)
+                        {
+                            y[r] += column[r * aRowStride] * xc;
+                        }
+                    }
+                }
+            });
+        }
+
+    private:
+        // The tile sizes.  MR-by-NR is the tile of C in the micro-kernel,
+        // KC is the depth of the packed panels, MC is the number of rows of
+        // a packed block of A and NC is the number of columns of a packed
+        // panel of B.
+        enum
+        {
+            MR = 4,
+            NR = (sizeof(Real) <= 4 ? 8 : 4),
+            KC = 256,
+            MC = 128,
+            NC = 2048
+        };
+
+        struct Operand
+        {
+            Real const* data;
+            int rowStride, colStride;
+        };
+
+        struct Output
+        {
+            Real* data;
+            int rowStride, colStride;
+        };
+
+        // Compute rows [rmin,rmax) of C.  For a symmetric product, the tiles
+        // that are strictly above the diagonal are skipped.  To subtract the
+        // product from C, the block of A is negated when it is packed.
+        void Gemm(int rmin, int rmax, int numCols, int numCommon,
+            Operand const& A, Operand const& B, Output const& C,
+            bool lowerOnly, bool subtract) const
+        {
+            if (!subtract)
+            {
+                for (int r = rmin; r < rmax; ++r)
+                {
+                    for (int c = 0; c < numCols; ++c)
+                    {
+                        C.data[r * C.rowStride + c * C.colStride] = (Real)0;
+                    }
+                }
+            }
+
+            // The packed blocks are no larger than the problem requires, so
+            // small products do not pay for initializing full-size buffers.
+            int const kcMax = std::min(static_cast<int>(KC), numCommon);
+            int const mcMax = std::min(static_cast<int>(MC), rmax - rmin);
+            int const ncMax = std::min(static_cast<int>(NC), numCols);
+            std::vector<Real> aPack(static_cast<size_t>((mcMax + MR - 1) / MR) * MR * kcMax);
+            std::vector<Real> bPack(static_cast<size_t>((ncMax + NR - 1) / NR) * NR * kcMax);
+            for (int jc = 0; jc < numCols; jc += NC)
+            {
+                int const nc = std::min(static_cast<int>(NC), numCols - jc);
+                if (lowerOnly && jc >= rmax)
+                {
+                    break;
+                }
+
+                for (int pc = 0; pc < numCommon; pc += KC)
+                {
+                    int const kc = std::min(static_cast<int>(KC), numCommon - pc);
+                    int const ncPacked = (lowerOnly ? std::min(nc, rmax - jc) : nc);
+                    PackB(B, pc, kc, jc, ncPacked, bPack.data());
+
+                    for (int ic = rmin; ic < rmax; ic += MC)
+                    {
+                        int const mc = std::min(static_cast<int>(MC), rmax - ic);
+                        PackA(A, ic, mc, pc, kc, subtract, aPack.data());
+
+                        for (int jr = 0; jr < ncPacked; jr += NR)
+                        {
+                            int const nr = std::min(static_cast<int>(NR), ncPacked - jr);
+                            for (int ir = 0; ir < mc; ir += MR)
+                            {
+                                int const mr = std::min(static_cast<int>(MR), mc - ir);
+                                if (lowerOnly && jc + jr > ic + ir + mr - 1)
+                                {
+                                    continue;
+                                }
+
+                                Real* c = C.data + (ic + ir) * C.rowStride + (jc + jr) * C.colStride;
+                                MicroKernel(kc, aPack.data() + ir * kc, bPack.data() + jr * kc,
+                                    c, C.rowStride, C.colStride, mr, nr);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Copy A(ic+i,pc+k) for 0 <= i < mc and 0 <= k < kc to micro-panels
+        // of MR rows, each stored as kc consecutive columns of MR elements.
+        // The rows past mc in the last micro-panel are zero.
+        static void PackA(Operand const& A, int ic, int mc, int pc, int kc,
+            bool negate, Real* pack)
+        {
+            for (int ir = 0; ir < mc; ir += MR, pack += MR * kc)
+            {
+                int const mr = std::min(static_cast<int>(MR), mc - ir);
+                for (int k = 0; k < kc; ++k)
+                {
+                    Real const* source = A.data + (ic + ir) * A.rowStride + (pc + k) * A.colStride;
+                    Real* target = pack + k * MR;
+                    for (int i = 0; i < mr; ++i)
+                    {
+                        target[i] = (negate ? -source[i * A.rowStride] : source[i * A.rowStride]);
+                    }
+                    for (int i = mr; i < MR; ++i)
+                    {
+                        target[i] = (Real)0;
+                    }
+                }
+            }
+        }
+
+        // Copy B(pc+k,jc+j) for 0 <= k < kc and 0 <= j < nc to micro-panels
+        // of NR columns, each stored as kc consecutive rows of NR elements.
+        static void PackB(Operand const& B, int pc, int kc, int jc, int nc, Real* pack)
+        {
+            for (int jr = 0; jr < nc; jr += NR, pack += NR * kc)
+            {
+                int const nr = std::min(static_cast<int>(NR), nc - jr);
+                for (int k = 0; k < kc; ++k)
+                {
+                    Real const* source = B.data + (pc + k) * B.rowStride + (jc + jr) * B.colStride;
+                    Real* target = pack + k * NR;
+                    for (int j = 0; j < nr; ++j)
+                    {
+                        target[j] = source[j * B.colStride];
+                    }
+                    for (int j = nr; j < NR; ++j)
+                    {
+                        target[j] = (Real)0;
+                    }
+                }
+            }
+        }
+
+        // C += A*B for an MR-by-kc micro-panel of A and a kc-by-NR
+        // micro-panel of B.  Only the mr-by-nr part of the tile is in C.
+        static void MicroKernel(int kc, Real const* a, Real const* b,
+            Real* c, int cRowStride, int cColStride, int mr, int nr)
+        {
+            Real tile[MR][NR];
+            for (int i = 0; i < MR; ++i)
+            {
+                for (int j = 0; j < NR; ++j)
+                {
+                    tile[i][j] = (i < mr && j < nr ? c[i * cRowStride + j * cColStride] : (Real)0);
+                }
+            }
+
+            for (int k = 0; k < kc; ++k, a += MR, b += NR)
+            {
+                for (int i = 0; i < MR; ++i)
+                {
+                    Real const ai = a[i];
+                    for (int j = 0; j < NR; ++j)
+                    {
+                        tile[i][j] += ai * b[j];
+                    }
+                }
+            }
+
+            for (int i = 0; i < mr; ++i)
+            {
+                for (int j = 0; j < nr; ++j)
+                {
+                    c[i * cRowStride + j * cColStride] = tile[i][j];
+                }
+            }
+        }
+
+        // Split the rows of C into panels for the threads.  The panels are
+        // multiples of MR rows.  For a symmetric product, row r has r+1
+        // elements to compute, so the panel boundaries are chosen to give
+        // the threads equal areas of the lower triangle.
+        std::vector<int> Partition(int numRows, int numCols, int numCommon,
+            bool lowerOnly) const
+        {
+            double const minThreadedWork = 262144.0;
+            double work = static_cast<double>(numRows) * static_cast<double>(numCols)
+                * static_cast<double>(numCommon) * (lowerOnly ? 0.5 : 1.0);
+            int numThreads = static_cast<int>(mNumThreads);
+            numThreads = std::min(numThreads, (numRows + MR - 1) / MR);
+            if (work < minThreadedWork || numThreads < 1)
+            {
+                numThreads = 1;
+            }
+
+            std::vector<int> bounds(static_cast<size_t>(numThreads) + 1);
+            bounds[0] = 0;
+            for (int t = 1; t < numThreads; ++t)
+            {
+                double fraction = static_cast<double>(t) / static_cast<double>(numThreads);
+                double r = numRows * (lowerOnly ? std::sqrt(fraction) : fraction);
+                int bound = MR * static_cast<int>(r / MR + 0.5);
+                bounds[t] = std::min(std::max(bound, bounds[t - 1]), numRows);
+            }
+            bounds[numThreads] = numRows;
+            return bounds;
+        }
+
+        template <typename Function>
+        void Execute(std::vector<int> const& bounds, Function const& function) const
+        {
+            size_t const numThreads = bounds.size() - 1;
+            if (numThreads > 1)
+            {
+                std::vector<std::thread> process(numThreads);
+                for (size_t t = 0; t < numThreads; ++t)
+                {
+                    int rmin = bounds[t], rmax = bounds[t + 1];
+                    process[t] = std::thread([&function, rmin, rmax]()
+                    {
+                        function(rmin, rmax);
+                    });
+                }
+
+                for (auto& p : process)
+                {
+                    p.join();
+                }
+            }
+            else
+            {
+                function(bounds[0], bounds[1]);
+            }
+        }
+
+        unsigned int mNumThreads;
+    };
+}
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/22)
 
 #pragma once
 
@@ -12,7 +12,7 @@
 // Minimax polynomial approximations to 2^x.  The polynomial p(x) of
 // degree D minimizes the quantity maximum{|2^x - p(x)| : x in [0,1]}
 // over all polynomials of degree D.  The natural exponential is
-// computed using exp(x) = 2^{x log(2)}, where log(2) is the natural
+// computed using exp(x) = 2^{x/log(2)}, where log(2) is the natural
 // logarithm of 2.
 
 namespace gte
@@ -22,8 +22,8 @@ template <typename Real>
 class ExpEstimate
 {
 public:
-    // The input constraint is x in [0,1].  For example,
-    //   float x; // in [0,1]
+    // The input constraint is x in [0,log(2)].  For example,
+    //   float x; // in [0,log(2)]
     //   float result = ExpEstimate<float>::Degree<3>(x);
     template <int D>
     inline static Real Degree(Real x);
@@ -35,6 +35,17 @@ public:
     //   float result = ExpEstimate<float>::DegreeRR<3>(x);
     template <int D>
     inline static Real DegreeRR(Real x);
+
+    // Array versions of Degree and DegreeRR.  The estimates are computed
+    // for x[i] and stored in y[i] for 0 <= i < numElements, and x and y may
+    // be the same array.  The range reductions are branch-free rewrites of
+    // the scalar ones so that the compiler can vectorize the loops; see
+    // GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
+    template <int D>
+    static void DegreeRR(size_t numElements, Real const* x, Real* y);
 };
 
 
@@ -42,14 +53,32 @@ template <typename Real>
 template <int D>
 inline Real ExpEstimate<Real>::Degree(Real x)
 {
-    return Exp2Estimate<Real>::Degree<D>((Real)GTE_C_LN_2 * x);
+    return Exp2Estimate<Real>::template Degree<D>((Real)GTE_C_INV_LN_2 * x);
 }
 
 template <typename Real>
 template <int D>
 inline Real ExpEstimate<Real>::DegreeRR(Real x)
 {
-    return Exp2Estimate<Real>::DegreeRR<D>((Real)GTE_C_LN_2 * x);
+    return Exp2Estimate<Real>::template DegreeRR<D>((Real)GTE_C_INV_LN_2 * x);
+}
+
+template <typename Real>
+template <int D>
+void ExpEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return (Real)GTE_C_INV_LN_2 * v; });
+    Exp2Estimate<Real>::template Degree<D>(numElements, y, y);
+}
+
+template <typename Real>
+template <int D>
+void ExpEstimate<Real>::DegreeRR(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return (Real)GTE_C_INV_LN_2 * v; });
+    Exp2Estimate<Real>::template DegreeRR<D>(numElements, y, y);
 }
 
 
@@ -3,10 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.3 (2019/06/02)
+// File Version: 3.0.4 (2019/09/17)
 
 #pragma once
 
+#include <Mathematics/GteBlockedMatrixProduct.h>
 #include <Mathematics/GteGVector.h>
 #include <Mathematics/GteGaussianElimination.h>
 #include <algorithm>
@@ -66,6 +67,12 @@ public:
     inline Real const& operator[](int i) const;
     inline Real& operator[](int i);
 
+    // The storage convention as strides:  element (r,c) is the 1-dimensional
+    // element r*GetRowStride() + c*GetColStride().  These support algorithms
+    // that operate on the 1-dimensional array, such as BlockedMatrixProduct.
+    inline int GetRowStride() const;
+    inline int GetColStride() const;
+
     // Comparisons for sorted containers and geometric ordering.
     inline bool operator==(GMatrix const& mat) const;
     inline bool operator!=(GMatrix const& mat) const;
@@ -172,6 +179,50 @@ GMatrix<Real> MultiplyATB(GMatrix<Real> const& A, GMatrix<Real> const& B);
 template <typename Real>
 GMatrix<Real> MultiplyATBT(GMatrix<Real> const& A, GMatrix<Real> const& B);
 
+// The products and the transpose written to caller-provided storage, which
+// avoids the allocation of a new matrix or vector when 'result' already has
+// the correct size.  The products are computed by BlockedMatrixProduct;
+// large products are computed by numThreads threads.  The 'result' may be
+// one of the inputs, in which case the product is computed in a temporary
+// matrix or vector that is then moved to 'result'.
+template <typename Real>
+void Transpose(GMatrix<Real> const& M, GMatrix<Real>& result);
+
+template <typename Real>
+void Multiply(GMatrix<Real> const& M, GVector<Real> const& V,
+    GVector<Real>& result, unsigned int numThreads = 1);
+
+template <typename Real>
+void Multiply(GVector<Real> const& V, GMatrix<Real> const& M,
+    GVector<Real>& result, unsigned int numThreads = 1);
+
+template <typename Real>
+void MultiplyAB(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads = 1);
+
+template <typename Real>
+void MultiplyABT(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads = 1);
+
+template <typename Real>
+void MultiplyATB(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads = 1);
+
+template <typename Real>
+void MultiplyATBT(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads = 1);
+
+// A^T*A and A*A^T.  The results are symmetric, so only the lower triangles
+// are computed.  These are about twice as fast as MultiplyATB(A,A) and
+// MultiplyABT(A,A).
+template <typename Real>
+void MultiplyATA(GMatrix<Real> const& A, GMatrix<Real>& result,
+    unsigned int numThreads = 1);
+
+template <typename Real>
+void MultiplyAAT(GMatrix<Real> const& A, GMatrix<Real>& result,
+    unsigned int numThreads = 1);
+
 // M*D, D is square diagonal (stored as vector)
 template <typename Real>
 GMatrix<Real> MultiplyMD(GMatrix<Real> const& M, GVector<Real> const& D);
@@ -342,6 +393,26 @@ Real& GMatrix<Real>::operator[](int i)
     return mElements[i];
 }
 
+template <typename Real> inline
+int GMatrix<Real>::GetRowStride() const
+{
+#if defined(GTE_USE_ROW_MAJOR)
+    return mNumCols;
+#else
+    return 1;
+#endif
+}
+
+template <typename Real> inline
+int GMatrix<Real>::GetColStride() const
+{
+#if defined(GTE_USE_ROW_MAJOR)
+    return 1;
+#else
+    return mNumRows;
+#endif
+}
+
 template <typename Real> inline
 bool GMatrix<Real>::operator==(GMatrix const& mat) const
 {
@@ -636,7 +707,77 @@ Real Determinant(GMatrix<Real> const& M)
 template <typename Real>
 GMatrix<Real> Transpose(GMatrix<Real> const& M)
 {
-    GMatrix<Real> result(M.GetNumCols(), M.GetNumRows());
+    GMatrix<Real> result;
+    Transpose(M, result);
+    return result;
+}
+
+template <typename Real>
+GVector<Real> operator*(GMatrix<Real> const& M, GVector<Real> const& V)
+{
+    GVector<Real> result;
+    Multiply(M, V, result);
+    return result;
+}
+
+template <typename Real>
+GVector<Real> operator*(GVector<Real> const& V, GMatrix<Real> const& M)
+{
+    GVector<Real> result;
+    Multiply(V, M, result);
+    return result;
+}
+
+template <typename Real>
+GMatrix<Real> operator*(GMatrix<Real> const& A, GMatrix<Real> const& B)
+{
+    return MultiplyAB(A, B);
+}
+
+template <typename Real>
+GMatrix<Real> MultiplyAB(GMatrix<Real> const& A, GMatrix<Real> const& B)
+{
+    GMatrix<Real> result;
+    MultiplyAB(A, B, result);
+    return result;
+}
+
+template <typename Real>
+GMatrix<Real> MultiplyABT(GMatrix<Real> const& A, GMatrix<Real> const& B)
+{
+    GMatrix<Real> result;
+    MultiplyABT(A, B, result);
+    return result;
+}
+
+template <typename Real>
+GMatrix<Real> MultiplyATB(GMatrix<Real> const& A, GMatrix<Real> const& B)
+{
+    GMatrix<Real> result;
+    MultiplyATB(A, B, result);
+    return result;
+}
+
+template <typename Real>
+GMatrix<Real> MultiplyATBT(GMatrix<Real> const& A, GMatrix<Real> const& B)
+{
+    GMatrix<Real> result;
+    MultiplyATBT(A, B, result);
+    return result;
+}
+
+template <typename Real>
+void Transpose(GMatrix<Real> const& M, GMatrix<Real>& result)
+{
+    if (&result == &M)
+    {
+        GMatrix<Real> transpose;
+        Transpose(M, transpose);
+        result = std::move(transpose);
+        return;
+    }
+
+    result.SetSize(M.GetNumCols(), M.GetNumRows());
     for (int r = 0; r < M.GetNumRows(); ++r)
     {
         for (int c = 0; c < M.GetNumCols(); ++c)
@@ -644,137 +785,205 @@ GMatrix<Real> Transpose(GMatrix<Real> const& M)
             result(c, r) = M(r, c);
         }
     }
-    return result;
 }
 
 template <typename Real>
-GVector<Real> operator*(GMatrix<Real> const& M, GVector<Real> const& V)
+void Multiply(GMatrix<Real> const& M, GVector<Real> const& V,
+    GVector<Real>& result, unsigned int numThreads)
 {
 #if defined(GTE_ASSERT_ON_GMATRIX_SIZE_MISMATCH)
     LogAssert(V.GetSize() == M.GetNumCols(), "Mismatched size.");
 #endif
-    GVector<Real> result(M.GetNumRows());
-    for (int r = 0; r < M.GetNumRows(); ++r)
+    if (&result == &V)
     {
-        result[r] = (Real)0;
-        for (int c = 0; c < M.GetNumCols(); ++c)
-        {
-            result[r] += M(r, c) * V[c];
-        }
+        GVector<Real> product;
+        Multiply(M, V, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(M.GetNumRows());
+    if (M.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).Multiply(
+            M.GetNumRows(), M.GetNumCols(),
+            &M[0], M.GetRowStride(), M.GetColStride(),
+            &V[0], &result[0]);
     }
-    return result;
 }
 
 template <typename Real>
-GVector<Real> operator*(GVector<Real> const& V, GMatrix<Real> const& M)
+void Multiply(GVector<Real> const& V, GMatrix<Real> const& M,
+    GVector<Real>& result, unsigned int numThreads)
 {
 #if defined(GTE_ASSERT_ON_GMATRIX_SIZE_MISMATCH)
     LogAssert(V.GetSize() == M.GetNumRows(), "Mismatched size.");
 #endif
-    GVector<Real> result(M.GetNumCols());
-    for (int c = 0; c < M.GetNumCols(); ++c)
+    if (&result == &V)
     {
-        result[c] = (Real)0;
-        for (int r = 0; r < M.GetNumRows(); ++r)
-        {
-            result[c] += V[r] * M(r, c);
-        }
+        GVector<Real> product;
+        Multiply(V, M, product, numThreads);
+        result = std::move(product);
+        return;
     }
-    return result;
-}
 
-template <typename Real>
-GMatrix<Real> operator*(GMatrix<Real> const& A, GMatrix<Real> const& B)
-{
-    return MultiplyAB(A, B);
+    // V^T*M = (M^T*V)^T, and M^T is M with its strides swapped.
+    result.SetSize(M.GetNumCols());
+    if (M.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).Multiply(
+            M.GetNumCols(), M.GetNumRows(),
+            &M[0], M.GetColStride(), M.GetRowStride(),
+            &V[0], &result[0]);
+    }
 }
 
 template <typename Real>
-GMatrix<Real> MultiplyAB(GMatrix<Real> const& A, GMatrix<Real> const& B)
+void MultiplyAB(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads)
 {
 #if defined(GTE_ASSERT_ON_GMATRIX_SIZE_MISMATCH)
     LogAssert(A.GetNumCols() == B.GetNumRows(), "Mismatched size.");
 #endif
-    int const numCommon = A.GetNumCols();
-    GMatrix<Real> result(A.GetNumRows(), B.GetNumCols());
-    for (int r = 0; r < result.GetNumRows(); ++r)
+    if (&result == &A || &result == &B)
     {
-        for (int c = 0; c < result.GetNumCols(); ++c)
-        {
-            result(r, c) = (Real)0;
-            for (int i = 0; i < numCommon; ++i)
-            {
-                result(r, c) += A(r, i) * B(i, c);
-            }
-        }
+        GMatrix<Real> product;
+        MultiplyAB(A, B, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(A.GetNumRows(), B.GetNumCols());
+    if (result.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).Multiply(
+            A.GetNumRows(), B.GetNumCols(), A.GetNumCols(),
+            &A[0], A.GetRowStride(), A.GetColStride(),
+            &B[0], B.GetRowStride(), B.GetColStride(),
+            &result[0], result.GetRowStride(), result.GetColStride());
     }
-    return result;
 }
 
 template <typename Real>
-GMatrix<Real> MultiplyABT(GMatrix<Real> const& A, GMatrix<Real> const& B)
+void MultiplyABT(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads)
 {
 #if defined(GTE_ASSERT_ON_GMATRIX_SIZE_MISMATCH)
     LogAssert(A.GetNumCols() == B.GetNumCols(), "Mismatched size.");
 #endif
-    int const numCommon = A.GetNumCols();
-    GMatrix<Real> result(A.GetNumRows(), B.GetNumRows());
-    for (int r = 0; r < result.GetNumRows(); ++r)
+    if (&result == &A || &result == &B)
     {
-        for (int c = 0; c < result.GetNumCols(); ++c)
-        {
-            result(r, c) = (Real)0;
-            for (int i = 0; i < numCommon; ++i)
-            {
-                result(r, c) += A(r, i) * B(c, i);
-            }
-        }
+        GMatrix<Real> product;
+        MultiplyABT(A, B, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(A.GetNumRows(), B.GetNumRows());
+    if (result.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).Multiply(
+            A.GetNumRows(), B.GetNumRows(), A.GetNumCols(),
+            &A[0], A.GetRowStride(), A.GetColStride(),
+            &B[0], B.GetColStride(), B.GetRowStride(),
+            &result[0], result.GetRowStride(), result.GetColStride());
     }
-    return result;
 }
 
 template <typename Real>
-GMatrix<Real> MultiplyATB(GMatrix<Real> const& A, GMatrix<Real> const& B)
+void MultiplyATB(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads)
 {
 #if defined(GTE_ASSERT_ON_GMATRIX_SIZE_MISMATCH)
     LogAssert(A.GetNumRows() == B.GetNumRows(), "Mismatched size.");
 #endif
-    int const numCommon = A.GetNumRows();
-    GMatrix<Real> result(A.GetNumCols(), B.GetNumCols());
-    for (int r = 0; r < result.GetNumRows(); ++r)
+    if (&result == &A || &result == &B)
     {
-        for (int c = 0; c < result.GetNumCols(); ++c)
-        {
-            result(r, c) = (Real)0;
-            for (int i = 0; i < numCommon; ++i)
-            {
-                result(r, c) += A(i, r) * B(i, c);
-            }
-        }
+        GMatrix<Real> product;
+        MultiplyATB(A, B, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(A.GetNumCols(), B.GetNumCols());
+    if (result.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).Multiply(
+            A.GetNumCols(), B.GetNumCols(), A.GetNumRows(),
+            &A[0], A.GetColStride(), A.GetRowStride(),
+            &B[0], B.GetRowStride(), B.GetColStride(),
+            &result[0], result.GetRowStride(), result.GetColStride());
     }
-    return result;
 }
 
 template <typename Real>
-GMatrix<Real> MultiplyATBT(GMatrix<Real> const& A, GMatrix<Real> const& B)
+void MultiplyATBT(GMatrix<Real> const& A, GMatrix<Real> const& B,
+    GMatrix<Real>& result, unsigned int numThreads)
 {
 #if defined(GTE_ASSERT_ON_GMATRIX_SIZE_MISMATCH)
     LogAssert(A.GetNumRows() == B.GetNumCols(), "Mismatched size.");
 #endif
-    int const numCommon = A.GetNumRows();
-    GMatrix<Real> result(A.GetNumCols(), B.GetNumRows());
-    for (int r = 0; r < result.GetNumRows(); ++r)
+    if (&result == &A || &result == &B)
     {
-        for (int c = 0; c < result.GetNumCols(); ++c)
-        {
-            result(r, c) = (Real)0;
-            for (int i = 0; i < numCommon; ++i)
-            {
-                result(r, c) += A(i, r) * B(c, i);
-            }
-        }
+        GMatrix<Real> product;
+        MultiplyATBT(A, B, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(A.GetNumCols(), B.GetNumRows());
+    if (result.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).Multiply(
+            A.GetNumCols(), B.GetNumRows(), A.GetNumRows(),
+            &A[0], A.GetColStride(), A.GetRowStride(),
+            &B[0], B.GetColStride(), B.GetRowStride(),
+            &result[0], result.GetRowStride(), result.GetColStride());
+    }
+}
+
+template <typename Real>
+void MultiplyATA(GMatrix<Real> const& A, GMatrix<Real>& result,
+    unsigned int numThreads)
+{
+    if (&result == &A)
+    {
+        GMatrix<Real> product;
+        MultiplyATA(A, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(A.GetNumCols(), A.GetNumCols());
+    if (result.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).MultiplySymmetric(
+            A.GetNumCols(), A.GetNumRows(),
+            &A[0], A.GetColStride(), A.GetRowStride(),
+            &result[0], result.GetRowStride(), result.GetColStride());
+    }
+}
+
+template <typename Real>
+void MultiplyAAT(GMatrix<Real> const& A, GMatrix<Real>& result,
+    unsigned int numThreads)
+{
+    if (&result == &A)
+    {
+        GMatrix<Real> product;
+        MultiplyAAT(A, product, numThreads);
+        result = std::move(product);
+        return;
+    }
+
+    result.SetSize(A.GetNumRows(), A.GetNumRows());
+    if (result.GetNumElements() > 0)
+    {
+        BlockedMatrixProduct<Real>(numThreads).MultiplySymmetric(
+            A.GetNumRows(), A.GetNumCols(),
+            &A[0], A.GetRowStride(), A.GetColStride(),
+            &result[0], result.GetRowStride(), result.GetColStride());
     }
-    return result;
 }
 
 template <typename Real>
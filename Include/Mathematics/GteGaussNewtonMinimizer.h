@@ -3,12 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.14.0 (2018/07/16)
+// File Version: 3.14.2 (2019/09/21)
 
 #pragma once
 
 #include <Mathematics/GteCholeskyDecomposition.h>
+#include <Mathematics/GteSparseNormalEquations.h>
 #include <functional>
+#include <memory>
 
 // Let F(p) = (F_{0}(p), F_{1}(p), ..., F_{n-1}(p)) be a vector-valued
 // function of the parameters p = (p_{0}, p_{1}, ..., p_{m-1}).  The
@@ -49,6 +51,13 @@
 // advantage; for example, 3-tuples of components of F(p) might correspond to
 // vectors that can be manipulated using an already existing mathematics
 // library.  The implementation here supports both approaches.
+//
+// When m is large, J^T*J cannot be stored as a dense matrix.  If J is
+// sparse, the caller can instead specify the sparsity pattern of J and
+// functions that compute ranges of rows of F and J.  These are evaluated in
+// parallel, and the normal equations are solved by SparseNormalEquations
+// using a preconditioned conjugate gradient method; see
+// GteSparseNormalEquations.h.
 
 namespace gte
 {
@@ -66,6 +75,9 @@ namespace gte
         typedef std::function<void(DVector const&, RVector&)> FFunction;
         typedef std::function<void(DVector const&, JMatrix&)> JFunction;
         typedef std::function<void(DVector const&, JTJMatrix&, JTFVector&)> JPlusFunction;
+        typedef typename SparseNormalEquations<Real>::Jacobian SparseJMatrix;
+        typedef typename SparseNormalEquations<Real>::FFunction SparseFFunction;
+        typedef typename SparseNormalEquations<Real>::JFunction SparseJFunction;
 
         // NOTE: The C++ compiler for Microsoft Visual Studio 12.0.21005.1 REL
         // (MSVS 2013) appears to have a bug regarding passing std::function
@@ -118,6 +130,38 @@ namespace gte
             LogAssert(mNumPDimensions > 0 && mNumFDimensions > 0, "Invalid dimensions.");
         }
 
+        // Create the minimizer for a sparse Jacobian.  The sparsity pattern
+        // of J is in compressed sparse row format, and the functions compute
+        // the rows [rmin,rmax) of F(p) and J(p).  The rows are split among
+        // 'numThreads' threads.  The dense matrices are not allocated.
+        GaussNewtonMinimizer(int numPDimensions, int numFDimensions,
+            SparseFFunction const& inFFunction, SparseJFunction const& inJFunction,
+            std::vector<int> const& jRowStart, std::vector<int> const& jColumn,
+            unsigned int numThreads = 1)
+            :
+            mNumPDimensions(numPDimensions),
+            mNumFDimensions(numFDimensions),
+            mF(mNumFDimensions),
+            mJ(0, 0),
+            mJTJ(0, 0),
+            mNegJTF(mNumPDimensions),
+            mDecomposer(mNumPDimensions),
+            mUseJFunction(false),
+            mSparse(std::make_unique<SparseNormalEquations<Real>>(numPDimensions,
+                numFDimensions, inFFunction, inJFunction, jRowStart, jColumn, numThreads))
+        {
+        }
+
+        // Parameters of the conjugate gradient solver for a sparse
+        // Jacobian; see SparseNormalEquations::SetSolverParameters.
+        void SetSparseSolverParameters(unsigned int maxIterations, Real tolerance)
+        {
+            if (mSparse)
+            {
+                mSparse->SetSolverParameters(maxIterations, tolerance);
+            }
+        }
+
         // Disallow copy, assignment and move semantics.
         GaussNewtonMinimizer(GaussNewtonMinimizer const&) = delete;
         GaussNewtonMinimizer& operator=(GaussNewtonMinimizer const&) = delete;
@@ -153,15 +197,13 @@ namespace gte
             errorDifferenceTolerance = std::max(errorDifferenceTolerance, (Real)0);
 
             // Compute the initial error.
-            mFFunction(p0, mF);
-            result.minError = Dot(mF, mF);
+            result.minError = ComputeError(p0);
 
             // Do the Gauss-Newton iterations.
             auto pCurrent = p0;
             for (result.numIterations = 1; result.numIterations <= maxIterations; ++result.numIterations)
             {
-                ComputeLinearSystemInputs(pCurrent);
-                if (!mDecomposer.Factor(mJTJ))
+                if (!ComputeUpdate(pCurrent))
                 {
                     // TODO: The matrix mJTJ is positive semi-definite, so the
                     // failure can occur when mJTJ has a zero eigenvalue in
@@ -169,12 +211,9 @@ namespace gte
                     // anyway, perhaps using gradient descent?
                     return result;
                 }
-                mDecomposer.SolveLower(mJTJ, mNegJTF);
-                mDecomposer.SolveUpper(mJTJ, mNegJTF);
 
                 auto pNext = pCurrent + mNegJTF;
-                mFFunction(pNext, mF);
-                Real error = Dot(mF, mF);
+                Real error = ComputeError(pNext);
                 if (error < result.minError)
                 {
                     result.minErrorDifference = result.minError - error;
@@ -196,13 +235,49 @@ namespace gte
         }
 
     private:
+        // Compute F(p) and return |F(p)|^2.
+        Real ComputeError(DVector const& p)
+        {
+            if (mSparse)
+            {
+                return mSparse->ComputeError(p, &mF[0]);
+            }
+
+            mFFunction(p, mF);
+            return Dot(mF, mF);
+        }
+
+        // Solve the normal equations at pCurrent, where mF = F(pCurrent).
+        // The update is stored in mNegJTF.
+        bool ComputeUpdate(DVector const& pCurrent)
+        {
+            if (mSparse)
+            {
+                mSparse->ComputeLinearSystemInputs(pCurrent, &mF[0]);
+                return mSparse->Solve((Real)0, mNegJTF);
+            }
+
+            ComputeLinearSystemInputs(pCurrent);
+            if (!mDecomposer.Factor(mJTJ))
+            {
+                return false;
+            }
+            mDecomposer.SolveLower(mJTJ, mNegJTF);
+            mDecomposer.SolveUpper(mJTJ, mNegJTF);
+            return true;
+        }
+
         void ComputeLinearSystemInputs(DVector const& pCurrent)
         {
             if (mUseJFunction)
             {
                 mJFunction(pCurrent, mJ);
-                mJTJ = MultiplyATB(mJ, mJ);
-                mNegJTF = -(mF * mJ);
+                MultiplyATA(mJ, mJTJ);
+                Multiply(mF, mJ, mNegJTF);
+                for (int i = 0; i < mNumPDimensions; ++i)
+                {
+                    mNegJTF[i] = -mNegJTF[i];
+                }
             }
             else
             {
@@ -224,5 +299,9 @@ namespace gte
         CholeskyDecomposition<Real> mDecomposer;
 
         bool mUseJFunction;
+
+        // The solver for a sparse Jacobian, which is null for the other
+        // constructors.
+        std::unique_ptr<SparseNormalEquations<Real>> mSparse;
     };
 }
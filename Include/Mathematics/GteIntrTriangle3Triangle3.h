@@ -0,0 +1,329 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/03)
+
+#pragma once
+
+#include <Mathematics/GteDistSegmentSegment.h>
+#include <Mathematics/GteIntrTriangle2Triangle2.h>
+#include <Mathematics/GteSegment.h>
+#include <Mathematics/GteVector3.h>
+#include <algorithm>
+
+// The queries consider the triangles to be solids.  The algorithm is the one
+// used by the GPU shader in the AllPairsTriangles sample.  The plane of each
+// triangle is computed and the other triangle is clipped against it.  When
+// the triangles are not coplanar, each clipped set is a (possibly degenerate)
+// segment on the line of intersection of the two planes.  The triangles
+// intersect when the two segments overlap.  When the triangles are coplanar,
+// they are projected onto the coordinate plane most parallel to the common
+// plane and the 2D separating-axis test is applied.  The find-intersection
+// query does not compute the (polygonal) set of intersection in the coplanar
+// case; it only reports that the triangles are coplanar and overlap.
+//
+// A triangle with zero area (a segment or a point) has no plane.  When one
+// triangle is degenerate, it is clipped against the plane of the other and
+// the point of intersection, if any, is tested for containment; when it
+// lies in that plane, the coplanar test is applied.  When both triangles
+// are degenerate, the triangles intersect when the distance between their
+// segments is zero.
+
+namespace gte
+{
+    template <typename Real>
+    class FIQuery<Real, Triangle3<Real>, Triangle3<Real>>
+    {
+    public:
+        struct Result
+        {
+            bool intersect;
+
+            // When 'intersect' is true and 'isCoplanar' is false, the set of
+            // intersection is the segment.  The segment endpoints are equal
+            // when the triangles touch at a single point.  When 'isCoplanar'
+            // is true, the segment is not computed.
+            bool isCoplanar;
+            Segment3<Real> segment;
+        };
+
+        Result operator()(Triangle3<Real> const& triangle0, Triangle3<Real> const& triangle1)
+        {
+            Result result;
+            result.intersect = false;
+            result.isCoplanar = false;
+
+            Vector3<Real> normal0 = Cross(triangle0.v[1] - triangle0.v[0], triangle0.v[2] - triangle0.v[0]);
+            Vector3<Real> normal1 = Cross(triangle1.v[1] - triangle1.v[0], triangle1.v[2] - triangle1.v[0]);
+            bool degenerate0 = (normal0 == Vector3<Real>::Zero());
+            bool degenerate1 = (normal1 == Vector3<Real>::Zero());
+            if (degenerate0 || degenerate1)
+            {
+                if (degenerate0 && degenerate1)
+                {
+                    return IntersectsDegenerate(triangle0, triangle1);
+                }
+                if (degenerate0)
+                {
+                    return IntersectsDegenerate(triangle0, triangle1, normal1);
+                }
+                return IntersectsDegenerate(triangle1, triangle0, normal0);
+            }
+
+            // Clip triangle1 against the plane of triangle0.
+            Real d1[3];
+            int sign1 = Classify(normal0, triangle0.v[0], triangle1, d1);
+            if (sign1 != 0)
+            {
+                // triangle1 is strictly on one side of the plane of triangle0.
+                return result;
+            }
+
+            // Clip triangle0 against the plane of triangle1.
+            Real d0[3];
+            int sign0 = Classify(normal1, triangle1.v[0], triangle0, d0);
+            if (sign0 != 0)
+            {
+                // triangle0 is strictly on one side of the plane of triangle1.
+                return result;
+            }
+
+            // Either triangle can be the one found to lie in the plane of the
+            // other, because the distances are computed with rounding errors.
+            if (IsZero(d1) || IsZero(d0))
+            {
+                result.isCoplanar = true;
+                result.intersect = IntersectsCoplanar(normal0, triangle0, triangle1);
+                return result;
+            }
+
+            // The planes are not the same.  When they are parallel (as
+            // computed), they do not have a line of intersection.
+            Vector3<Real> direction = Cross(normal0, normal1);
+            Real sqrLength = Dot(direction, direction);
+            if (sqrLength == (Real)0)
+            {
+                return result;
+            }
+
+            Vector3<Real> points0[2], points1[2];
+            GetPlaneIntersection(triangle0, d0, points0);
+            GetPlaneIntersection(triangle1, d1, points1);
+
+            // The points all lie on the line of intersection of the planes.
+            // Parameterize by P + t*D, where D is not necessarily unit
+            // length, and compare the t-intervals.
+            Vector3<Real> const& origin = points0[0];
+            Real t00 = (Real)0, t01 = Dot(direction, points0[1] - origin);
+            Real t10 = Dot(direction, points1[0] - origin);
+            Real t11 = Dot(direction, points1[1] - origin);
+            auto I0 = std::minmax(t00, t01);
+            auto I1 = std::minmax(t10, t11);
+            Real tmin = std::max(I0.first, I1.first);
+            Real tmax = std::min(I0.second, I1.second);
+            if (tmin <= tmax)
+            {
+                result.intersect = true;
+                result.segment.p[0] = origin + (tmin / sqrLength) * direction;
+                result.segment.p[1] = origin + (tmax / sqrLength) * direction;
+            }
+            return result;
+        }
+
+    protected:
+        static bool IsZero(Real const d[3])
+        {
+            return d[0] == (Real)0 && d[1] == (Real)0 && d[2] == (Real)0;
+        }
+
+        // The endpoints of the longest edge of a triangle with zero area.
+        // They are equal when the triangle is a point.
+        static Segment3<Real> GetLongestEdge(Triangle3<Real> const& triangle)
+        {
+            Segment3<Real> segment(triangle.v[0], triangle.v[1]);
+            Real maxSqrLength = Dot(triangle.v[1] - triangle.v[0], triangle.v[1] - triangle.v[0]);
+            for (int i0 = 1, i1 = 2; i0 < 3; i1 = i0++)
+            {
+                Vector3<Real> edge = triangle.v[i1] - triangle.v[i0];
+                Real sqrLength = Dot(edge, edge);
+                if (sqrLength > maxSqrLength)
+                {
+                    segment.p[0] = triangle.v[i0];
+                    segment.p[1] = triangle.v[i1];
+                    maxSqrLength = sqrLength;
+                }
+            }
+            return segment;
+        }
+
+        // Both triangles have zero area.
+        Result IntersectsDegenerate(Triangle3<Real> const& triangle0,
+            Triangle3<Real> const& triangle1) const
+        {
+            Result result;
+            DCPQuery<Real, Segment3<Real>, Segment3<Real>> query;
+            auto dcp = query(GetLongestEdge(triangle0), GetLongestEdge(triangle1));
+            result.intersect = (dcp.sqrDistance == (Real)0);
+            result.isCoplanar = false;
+            if (result.intersect)
+            {
+                result.segment.p[0] = dcp.closest[0];
+                result.segment.p[1] = dcp.closest[0];
+            }
+            return result;
+        }
+
+        // The first triangle has zero area and the second triangle, whose
+        // normal is provided, does not.
+        Result IntersectsDegenerate(Triangle3<Real> const& degenerate,
+            Triangle3<Real> const& triangle, Vector3<Real> const& normal) const
+        {
+            Result result;
+            result.intersect = false;
+            result.isCoplanar = false;
+
+            Real d[3];
+            if (Classify(normal, triangle.v[0], degenerate, d) != 0)
+            {
+                return result;
+            }
+
+            if (IsZero(d))
+            {
+                result.isCoplanar = true;
+                result.intersect = IntersectsCoplanar(normal, triangle, degenerate);
+                return result;
+            }
+
+            // The segment crosses the plane at a single point, so both
+            // outputs of GetPlaneIntersection are that point.  It is tested
+            // for containment as a triangle with three equal vertices.
+            Vector3<Real> points[2];
+            GetPlaneIntersection(degenerate, d, points);
+            Triangle3<Real> point(points[0], points[0], points[0]);
+            if (IntersectsCoplanar(normal, triangle, point))
+            {
+                result.intersect = true;
+                result.segment.p[0] = points[0];
+                result.segment.p[1] = points[0];
+            }
+            return result;
+        }
+
+        // Compute the signed distances (scaled by the length of the normal)
+        // of the triangle vertices to the plane Dot(N,X-P) = 0.  The return
+        // value is +1 when all distances are positive, -1 when all distances
+        // are negative, or 0 otherwise.
+        int Classify(Vector3<Real> const& N, Vector3<Real> const& P,
+            Triangle3<Real> const& triangle, Real d[3]) const
+        {
+            int positive = 0, negative = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                d[i] = Dot(N, triangle.v[i] - P);
+                if (d[i] > (Real)0)
+                {
+                    ++positive;
+                }
+                else if (d[i] < (Real)0)
+                {
+                    ++negative;
+                }
+            }
+            return (positive == 3 ? +1 : (negative == 3 ? -1 : 0));
+        }
+
+        // The triangle is known to intersect the plane but is not contained
+        // by it.  The intersection is a point or a segment.  In the former
+        // case both outputs are the same point.
+        void GetPlaneIntersection(Triangle3<Real> const& triangle,
+            Real const d[3], Vector3<Real> points[2]) const
+        {
+            int numPoints = 0;
+            for (int i0 = 2, i1 = 0; i1 < 3; i0 = i1++)
+            {
+                if (d[i1] == (Real)0)
+                {
+                    points[numPoints++] = triangle.v[i1];
+                }
+                else if (d[i0] * d[i1] < (Real)0)
+                {
+                    points[numPoints++] = (d[i0] * triangle.v[i1] -
+                        d[i1] * triangle.v[i0]) / (d[i0] - d[i1]);
+                }
+
+                if (numPoints == 2)
+                {
+                    return;
+                }
+            }
+            points[1] = points[0];
+        }
+
+        bool IntersectsCoplanar(Vector3<Real> const& normal,
+            Triangle3<Real> const& triangle0, Triangle3<Real> const& triangle1) const
+        {
+            // Project onto the coordinate plane for which the normal has
+            // the largest magnitude component.  Keep the projections
+            // counterclockwise ordered as required by the 2D query.
+            int maxIndex = 0;
+            Real maxValue = std::abs(normal[0]);
+            for (int i = 1; i < 3; ++i)
+            {
+                Real value = std::abs(normal[i]);
+                if (value > maxValue)
+                {
+                    maxIndex = i;
+                    maxValue = value;
+                }
+            }
+
+            int j0 = (maxIndex + 1) % 3, j1 = (maxIndex + 2) % 3;
+            bool reverse = (normal[maxIndex] < (Real)0);
+            Triangle2<Real> projected[2];
+            Triangle3<Real> const* triangles[2] = { &triangle0, &triangle1 };
+            for (int k = 0; k < 2; ++k)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    Vector3<Real> const& v = triangles[k]->v[reverse ? 2 - i : i];
+                    projected[k].v[i] = { v[j0], v[j1] };
+                }
+            }
+
+            // triangle1 lies in the plane of triangle0 but its projection
+            // might be clockwise when the normals are opposite.
+            Vector3<Real> normal1 = Cross(triangle1.v[1] - triangle1.v[0], triangle1.v[2] - triangle1.v[0]);
+            if (Dot(normal, normal1) < (Real)0)
+            {
+                std::swap(projected[1].v[1], projected[1].v[2]);
+            }
+
+            TIQuery<Real, Triangle2<Real>, Triangle2<Real>> query;
+            return query(projected[0], projected[1]).intersect;
+        }
+    };
+
+    template <typename Real>
+    class TIQuery<Real, Triangle3<Real>, Triangle3<Real>>
+        :
+        public FIQuery<Real, Triangle3<Real>, Triangle3<Real>>
+    {
+    public:
+        struct Result
+        {
+            bool intersect;
+        };
+
+        Result operator()(Triangle3<Real> const& triangle0, Triangle3<Real> const& triangle1)
+        {
+            Result result =
+            {
+                FIQuery<Real, Triangle3<Real>, Triangle3<Real>>::operator()(triangle0, triangle1).intersect
+            };
+            return result;
+        }
+    };
+}
@@ -0,0 +1,421 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/06)
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// An iterative solver for the Linear Complementarity Problem (LCP)
+// w = q + M * z, w^T * z = 0, w >= 0, z >= 0, using projected Gauss-Seidel
+// (PGS) iterations.  Each iteration visits the rows i in order and sets
+//   z[i] = max(0, z[i] - (q[i] + sum_j M[i][j]*z[j]) / M[i][i])
+// This converges when M is symmetric positive definite, which is the case
+// for the contact problems of rigid-body simulations, and is useful for
+// positive semidefinite M.  Unlike the pivoting algorithm of LCPSolver,
+// PGS produces an approximate solution, but the cost of an iteration is
+// proportional to the number of nonzero entries of M and the iterations
+// can be started from the solution of the previous frame (warm starting),
+// which usually changes little from frame to frame.
+//
+// M is stored in block compressed sparse row format.  The n variables are
+// partitioned into numBlocks = n/blockSize blocks of consecutive variables,
+// for example, the normal and tangential impulses of a contact point.  The
+// nonzero blockSize-by-blockSize blocks of block row r are
+//   values[k*blockSize*blockSize ...], rowStart[r] <= k < rowStart[r+1]
+// with block column column[k].  Each block is stored in row-major order.
+// The diagonal block of each block row must be stored.
+//
+// Two blocks r and c are coupled when the block M(r,c) or M(c,r) is stored.
+// The connected components of this coupling (the contact islands) are
+// independent LCPs.  They are solved in parallel when the solver is
+// constructed with numThreads larger than 1, and each island stops
+// iterating as soon as it has converged.
+
+namespace gte
+{
+    template <typename Real>
+    class LCPSolverPGS
+    {
+    public:
+        struct Matrix
+        {
+            Matrix()
+                :
+                numBlocks(0),
+                blockSize(1)
+            {
+            }
+
+            int numBlocks, blockSize;
+            std::vector<int> rowStart;  // numBlocks + 1 elements
+            std::vector<int> column;    // rowStart[numBlocks] elements
+            std::vector<Real> values;   // column.size() * blockSize^2 elements
+        };
+
+        // Convert an n-by-n matrix stored in row-major order to the sparse
+        // format.  The blocks with all entries zero are not stored, except
+        // for the diagonal blocks.  The blockSize must divide n.
+        static Matrix CreateMatrix(int n, int blockSize, Real const* M)
+        {
+            Matrix sparse;
+            sparse.blockSize = blockSize;
+            sparse.numBlocks = n / blockSize;
+            sparse.rowStart.push_back(0);
+            for (int r = 0; r < sparse.numBlocks; ++r)
+            {
+                for (int c = 0; c < sparse.numBlocks; ++c)
+                {
+                    bool isZero = true;
+                    for (int a = 0; a < blockSize && isZero; ++a)
+                    {
+                        for (int b = 0; b < blockSize; ++b)
+                        {
+                            if (M[(r * blockSize + a) * n + c * blockSize + b] != (Real)0)
+                            {
+                                isZero = false;
+                                break;
+                            }
+                        }
+                    }
+
+                    if (!isZero || r == c)
+                    {
+                        sparse.column.push_back(c);
+                        for (int a = 0; a < blockSize; ++a)
+                        {
+                            for (int b = 0; b < blockSize; ++b)
+                            {
+                                sparse.values.push_back(M[(r * blockSize + a) * n + c * blockSize + b]);
+                            }
+                        }
+                    }
+                }
+                sparse.rowStart.push_back(static_cast<int>(sparse.column.size()));
+            }
+            return sparse;
+        }
+
+        // The iterations for an island stop when the largest change in
+        // z[i] during an iteration is not larger than the tolerance times
+        // the largest z[i] of the island, or when the maximum number of
+        // iterations is reached.  The tolerance is relative, because PGS
+        // converges linearly and rarely reaches a zero change.
+        LCPSolverPGS(int maxIterations = 64, Real tolerance = (Real)1e-6,
+            unsigned int numThreads = 1)
+            :
+            mMaxIterations(maxIterations > 0 ? maxIterations : 64),
+            mTolerance(tolerance),
+            mNumThreads(numThreads),
+            mNumIterations(0),
+            mNumIslands(0)
+        {
+        }
+
+        inline void SetMaxIterations(int maxIterations)
+        {
+            mMaxIterations = (maxIterations > 0 ? maxIterations : 64);
+        }
+
+        inline int GetMaxIterations() const
+        {
+            return mMaxIterations;
+        }
+
+        inline void SetTolerance(Real tolerance)
+        {
+            mTolerance = tolerance;
+        }
+
+        inline Real GetTolerance() const
+        {
+            return mTolerance;
+        }
+
+        // The largest number of iterations used by an island in the last
+        // call to Solve, and the number of islands.
+        inline int GetNumIterations() const
+        {
+            return mNumIterations;
+        }
+
+        inline int GetNumIslands() const
+        {
+            return mNumIslands;
+        }
+
+        // The input q must have n = M.numBlocks * M.blockSize elements.  When
+        // z has n elements on input, it is the initial guess for the
+        // iterations (negative values are clamped to zero); typically it is
+        // the solution of the previous frame.  Otherwise, the iterations
+        // start at z = 0.  The function returns 'true' when every island
+        // converged within the maximum number of iterations.  In either
+        // case, the outputs w and z are the current iterates.
+        bool Solve(Matrix const& M, std::vector<Real> const& q,
+            std::vector<Real>& w, std::vector<Real>& z)
+        {
+            int const numBlocks = M.numBlocks;
+            int const blockSize = M.blockSize;
+            int const n = numBlocks * blockSize;
+            mNumIterations = 0;
+            mNumIslands = 0;
+            if (n <= 0 || static_cast<int>(q.size()) != n)
+            {
+                w.clear();
+                z.clear();
+                return false;
+            }
+
+            if (static_cast<int>(z.size()) == n)
+            {
+                for (auto& value : z)
+                {
+                    value = std::max(value, (Real)0);
+                }
+            }
+            else
+            {
+                z.assign(n, (Real)0);
+            }
+
+            ComputeInverseDiagonal(M);
+            ComputeIslands(M);
+
+            // Solve the islands, larger islands first so that the threads
+            // are balanced.  The islands do not share any variables, so the
+            // threads write disjoint elements of z.
+            std::vector<int> iterations(mNumIslands, 0);
+            unsigned int numThreads = std::min(mNumThreads,
+                static_cast<unsigned int>(mNumIslands));
+            if (numThreads > 1)
+            {
+                std::vector<std::vector<int>> partition(numThreads);
+                std::vector<size_t> load(numThreads, 0);
+                for (auto island : mIslandOrder)
+                {
+                    size_t cost = 0;
+                    for (int i = mIslandStart[island]; i < mIslandStart[island + 1]; ++i)
+                    {
+                        int r = mIslandBlocks[i];
+                        cost += static_cast<size_t>(M.rowStart[r + 1] - M.rowStart[r]);
+                    }
+                    auto least = std::min_element(load.begin(), load.end()) - load.begin();
+                    partition[least].push_back(island);
+                    load[least] += cost;
+                }
+
+                std::vector<std::thread> process(numThreads);
+                for (unsigned int t = 0; t < numThreads; ++t)
+                {
+                    process[t] = std::thread([this, t, &M, &q, &z, &partition, &iterations]()
+                    {
+                        for (auto island : partition[t])
+                        {
+                            iterations[island] = SolveIsland(island, M, q, z);
+                        }
+                    });
+                }
+
+                for (auto& p : process)
+                {
+                    p.join();
+                }
+            }
+            else
+            {
+                for (auto island : mIslandOrder)
+                {
+                    iterations[island] = SolveIsland(island, M, q, z);
+                }
+            }
+
+            bool converged = true;
+            for (auto numIterations : iterations)
+            {
+                mNumIterations = std::max(mNumIterations, std::abs(numIterations));
+                if (numIterations < 0)
+                {
+                    converged = false;
+                }
+            }
+
+            // w = q + M*z
+            w.resize(n);
+            for (int r = 0; r < numBlocks; ++r)
+            {
+                for (int a = 0; a < blockSize; ++a)
+                {
+                    w[r * blockSize + a] = RowProduct(M, q, z, r, a);
+                }
+            }
+            return converged;
+        }
+
+    private:
+        // Compute q[i] + sum_j M[i][j]*z[j] for i = r*blockSize+a.
+        Real RowProduct(Matrix const& M, std::vector<Real> const& q,
+            std::vector<Real> const& z, int r, int a) const
+        {
+            int const blockSize = M.blockSize;
+            Real sum = q[r * blockSize + a];
+            for (int k = M.rowStart[r]; k < M.rowStart[r + 1]; ++k)
+            {
+                Real const* row = &M.values[(k * blockSize + a) * blockSize];
+                Real const* zc = &z[M.column[k] * blockSize];
+                for (int b = 0; b < blockSize; ++b)
+                {
+                    sum += row[b] * zc[b];
+                }
+            }
+            return sum;
+        }
+
+        // The reciprocals of the diagonal entries of M.  A row with a
+        // nonpositive diagonal entry cannot be relaxed; its z[i] is left
+        // unchanged.
+        void ComputeInverseDiagonal(Matrix const& M)
+        {
+            int const blockSize = M.blockSize;
+            mInvDiagonal.assign(M.numBlocks * blockSize, (Real)0);
+            for (int r = 0; r < M.numBlocks; ++r)
+            {
+                for (int k = M.rowStart[r]; k < M.rowStart[r + 1]; ++k)
+                {
+                    if (M.column[k] == r)
+                    {
+                        Real const* block = &M.values[k * blockSize * blockSize];
+                        for (int a = 0; a < blockSize; ++a)
+                        {
+                            Real diagonal = block[a * blockSize + a];
+                            if (diagonal > (Real)0)
+                            {
+                                mInvDiagonal[r * blockSize + a] = ((Real)1) / diagonal;
+                            }
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Compute the connected components of the block coupling graph
+        // using union-find.  The blocks of island k are
+        // mIslandBlocks[mIslandStart[k] ... mIslandStart[k+1]-1] in
+        // increasing order, and mIslandOrder lists the islands by
+        // decreasing size.
+        void ComputeIslands(Matrix const& M)
+        {
+            int const numBlocks = M.numBlocks;
+            mParent.resize(numBlocks);
+            std::iota(mParent.begin(), mParent.end(), 0);
+            for (int r = 0; r < numBlocks; ++r)
+            {
+                for (int k = M.rowStart[r]; k < M.rowStart[r + 1]; ++k)
+                {
+                    int root0 = Find(r), root1 = Find(M.column[k]);
+                    if (root0 != root1)
+                    {
+                        mParent[std::max(root0, root1)] = std::min(root0, root1);
+                    }
+                }
+            }
+
+            // Label the islands in the order of their smallest blocks and
+            // bucket the blocks by island.
+            mIslandOf.resize(numBlocks);
+            mNumIslands = 0;
+            for (int r = 0; r < numBlocks; ++r)
+            {
+                int root = Find(r);
+                mIslandOf[r] = (root == r ? mNumIslands++ : mIslandOf[root]);
+            }
+
+            mIslandStart.assign(mNumIslands + 1, 0);
+            for (int r = 0; r < numBlocks; ++r)
+            {
+                ++mIslandStart[mIslandOf[r] + 1];
+            }
+            std::partial_sum(mIslandStart.begin(), mIslandStart.end(), mIslandStart.begin());
+
+            mIslandBlocks.resize(numBlocks);
+            std::vector<int> next(mIslandStart.begin(), mIslandStart.end() - 1);
+            for (int r = 0; r < numBlocks; ++r)
+            {
+                mIslandBlocks[next[mIslandOf[r]]++] = r;
+            }
+
+            mIslandOrder.resize(mNumIslands);
+            std::iota(mIslandOrder.begin(), mIslandOrder.end(), 0);
+            std::stable_sort(mIslandOrder.begin(), mIslandOrder.end(),
+                [this](int i0, int i1)
+                {
+                    return mIslandStart[i0 + 1] - mIslandStart[i0] >
+                        mIslandStart[i1 + 1] - mIslandStart[i1];
+                });
+        }
+
+        int Find(int r)
+        {
+            while (mParent[r] != r)
+            {
+                mParent[r] = mParent[mParent[r]];
+                r = mParent[r];
+            }
+            return r;
+        }
+
+        // Apply the PGS iterations to an island.  The return value is the
+        // number of iterations when the island converged or the negative of
+        // the number when it did not.
+        int SolveIsland(int island, Matrix const& M, std::vector<Real> const& q,
+            std::vector<Real>& z) const
+        {
+            int const blockSize = M.blockSize;
+            int const imin = mIslandStart[island];
+            int const imax = mIslandStart[island + 1];
+            for (int iteration = 1; iteration <= mMaxIterations; ++iteration)
+            {
+                Real maxDelta = (Real)0, maxZ = (Real)0;
+                for (int i = imin; i < imax; ++i)
+                {
+                    int r = mIslandBlocks[i];
+                    for (int a = 0; a < blockSize; ++a)
+                    {
+                        int row = r * blockSize + a;
+                        Real invDiagonal = mInvDiagonal[row];
+                        if (invDiagonal > (Real)0)
+                        {
+                            Real oldZ = z[row];
+                            Real newZ = std::max(oldZ - RowProduct(M, q, z, r, a) * invDiagonal, (Real)0);
+                            z[row] = newZ;
+                            maxDelta = std::max(maxDelta, std::abs(newZ - oldZ));
+                            maxZ = std::max(maxZ, newZ);
+                        }
+                    }
+                }
+
+                if (maxDelta <= mTolerance * maxZ)
+                {
+                    return iteration;
+                }
+            }
+            return -mMaxIterations;
+        }
+
+        int mMaxIterations;
+        Real mTolerance;
+        unsigned int mNumThreads;
+        int mNumIterations, mNumIslands;
+
+        // Storage that is reused by the calls to Solve.
+        std::vector<Real> mInvDiagonal;
+        std::vector<int> mParent, mIslandOf, mIslandStart, mIslandBlocks, mIslandOrder;
+    };
+}
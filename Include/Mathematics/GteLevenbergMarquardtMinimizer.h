@@ -3,12 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.14.0 (2018/07/16)
+// File Version: 3.14.2 (2019/09/21)
 
 #pragma once
 
 #include <Mathematics/GteCholeskyDecomposition.h>
+#include <Mathematics/GteSparseNormalEquations.h>
 #include <functional>
+#include <memory>
 
 // See GteGaussNewtonMinimizer.h for a formulation of the minimization
 // problem and how Levenberg-Marquardt relates to Gauss-Newton.
@@ -29,6 +31,9 @@ namespace gte
         typedef std::function<void(DVector const&, RVector&)> FFunction;
         typedef std::function<void(DVector const&, JMatrix&)> JFunction;
         typedef std::function<void(DVector const&, JTJMatrix&, JTFVector&)> JPlusFunction;
+        typedef typename SparseNormalEquations<Real>::Jacobian SparseJMatrix;
+        typedef typename SparseNormalEquations<Real>::FFunction SparseFFunction;
+        typedef typename SparseNormalEquations<Real>::JFunction SparseJFunction;
 
         // NOTE: The C++ compiler for Microsoft Visual Studio 12.0.21005.1 REL
         // (MSVS 2013) appears to have a bug regarding passing std::function
@@ -81,6 +86,38 @@ namespace gte
             LogAssert(mNumPDimensions > 0 && mNumFDimensions > 0, "Invalid dimensions.");
         }
 
+        // Create the minimizer for a sparse Jacobian; see the comments in
+        // GteGaussNewtonMinimizer.h.  J(p) and J^T(p)*J(p) are computed
+        // once for each iterate p, and the diagonal adjustments of the
+        // Levenberg-Marquardt steps are applied by the solver.
+        LevenbergMarquardtMinimizer(int numPDimensions, int numFDimensions,
+            SparseFFunction const& inFFunction, SparseJFunction const& inJFunction,
+            std::vector<int> const& jRowStart, std::vector<int> const& jColumn,
+            unsigned int numThreads = 1)
+            :
+            mNumPDimensions(numPDimensions),
+            mNumFDimensions(numFDimensions),
+            mF(mNumFDimensions),
+            mJ(0, 0),
+            mJTJ(0, 0),
+            mNegJTF(mNumPDimensions),
+            mDecomposer(mNumPDimensions),
+            mUseJFunction(false),
+            mSparse(std::make_unique<SparseNormalEquations<Real>>(numPDimensions,
+                numFDimensions, inFFunction, inJFunction, jRowStart, jColumn, numThreads))
+        {
+        }
+
+        // Parameters of the conjugate gradient solver for a sparse
+        // Jacobian; see SparseNormalEquations::SetSolverParameters.
+        void SetSparseSolverParameters(unsigned int maxIterations, Real tolerance)
+        {
+            if (mSparse)
+            {
+                mSparse->SetSolverParameters(maxIterations, tolerance);
+            }
+        }
+
         // Disallow copy, assignment and move semantics.
         LevenbergMarquardtMinimizer(LevenbergMarquardtMinimizer const&) = delete;
         LevenbergMarquardtMinimizer& operator=(LevenbergMarquardtMinimizer const&) = delete;
@@ -134,13 +171,18 @@ namespace gte
             errorDifferenceTolerance = std::max(errorDifferenceTolerance, (Real)0);
 
             // Compute the initial error.
-            mFFunction(p0, mF);
-            result.minError = Dot(mF, mF);
+            result.minError = ComputeError(p0);
 
             // Do the Levenberg-Marquart iterations.
             auto pCurrent = p0;
             for (result.numIterations = 1; result.numIterations <= maxIterations; ++result.numIterations)
             {
+                // The last evaluation of F was at pCurrent.
+                if (mSparse)
+                {
+                    mSparse->ComputeLinearSystemInputs(pCurrent, &mF[0]);
+                }
+
                 std::pair<bool, bool> status;
                 DVector pNext;
                 for (result.numAdjustments = 0; result.numAdjustments < maxAdjustments; ++result.numAdjustments)
@@ -200,13 +242,49 @@ namespace gte
         }
 
     private:
+        // Compute F(p) and return |F(p)|^2.
+        Real ComputeError(DVector const& p)
+        {
+            if (mSparse)
+            {
+                return mSparse->ComputeError(p, &mF[0]);
+            }
+
+            mFFunction(p, mF);
+            return Dot(mF, mF);
+        }
+
+        // Solve the adjusted normal equations at pCurrent.  The update is
+        // stored in mNegJTF.
+        bool ComputeUpdate(DVector const& pCurrent, Real lambda)
+        {
+            if (mSparse)
+            {
+                Real diagonalAdjust = lambda * mSparse->GetTrace() / static_cast<Real>(mNumPDimensions);
+                return mSparse->Solve(diagonalAdjust, mNegJTF);
+            }
+
+            ComputeLinearSystemInputs(pCurrent, lambda);
+            if (!mDecomposer.Factor(mJTJ))
+            {
+                return false;
+            }
+            mDecomposer.SolveLower(mJTJ, mNegJTF);
+            mDecomposer.SolveUpper(mJTJ, mNegJTF);
+            return true;
+        }
+
         void ComputeLinearSystemInputs(DVector const& pCurrent, Real lambda)
         {
             if (mUseJFunction)
             {
                 mJFunction(pCurrent, mJ);
-                mJTJ = MultiplyATB(mJ, mJ);
-                mNegJTF = -(mF * mJ);
+                MultiplyATA(mJ, mJTJ);
+                Multiply(mF, mJ, mNegJTF);
+                for (int i = 0; i < mNumPDimensions; ++i)
+                {
+                    mNegJTF[i] = -mNegJTF[i];
+                }
             }
             else
             {
@@ -236,8 +314,7 @@ namespace gte
             Real updateLengthTolerance, Real errorDifferenceTolerance, DVector& pNext,
             Result& result)
         {
-            ComputeLinearSystemInputs(pCurrent, lambdaFactor);
-            if (!mDecomposer.Factor(mJTJ))
+            if (!ComputeUpdate(pCurrent, lambdaFactor))
             {
                 // TODO: The matrix mJTJ is positive semi-definite, so the
                 // failure can occur when mJTJ has a zero eigenvalue in
@@ -245,12 +322,9 @@ namespace gte
                 // anyway, perhaps using gradient descent?
                 return std::make_pair(true, false);
             }
-            mDecomposer.SolveLower(mJTJ, mNegJTF);
-            mDecomposer.SolveUpper(mJTJ, mNegJTF);
 
             pNext = pCurrent + mNegJTF;
-            mFFunction(pNext, mF);
-            Real error = Dot(mF, mF);
+            Real error = ComputeError(pNext);
             if (error < result.minError)
             {
                 result.minErrorDifference = result.minError - error;
@@ -288,5 +362,9 @@ namespace gte
         CholeskyDecomposition<Real> mDecomposer;
 
         bool mUseJFunction;
+
+        // The solver for a sparse Jacobian, which is null for the other
+        // constructors.
+        std::unique_ptr<SparseNormalEquations<Real>> mSparse;
     };
 }
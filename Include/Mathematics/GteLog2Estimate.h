@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.2 (2019/09/22)
 
 #pragma once
 
-#include <Mathematics/GteMath.h>
+#include <Mathematics/GteArrayEstimate.h>
 
 // Minimax polynomial approximations to log2(x).  The polynomial p(x) of
 // degree D minimizes the quantity maximum{|log2(x) - p(x)| : x in [1,2]}
@@ -34,6 +34,17 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Array versions of Degree and DegreeRR.  The estimates are computed
+    // for x[i] and stored in y[i] for 0 <= i < numElements, and x and y may
+    // be the same array.  The range reductions are branch-free rewrites of
+    // the scalar ones so that the compiler can vectorize the loops; see
+    // GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
+    template <int D>
+    static void DegreeRR(size_t numElements, Real const* x, Real* y);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -70,6 +81,26 @@ inline Real Log2Estimate<Real>::DegreeRR(Real x)
     return result;
 }
 
+template <typename Real>
+template <int D>
+void Log2Estimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return Evaluate(degree<D>(), v - (Real)1); });
+}
+
+template <typename Real>
+template <int D>
+void Log2Estimate<Real>::DegreeRR(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y, [](Real v)
+    {
+        int p;
+        Real r = ArrayEstimate<Real>::Split(v, p);  // r in [1,2)
+        return Evaluate(degree<D>(), r - (Real)1) + (Real)p;
+    });
+}
+
 template <typename Real>
 inline Real Log2Estimate<Real>::Evaluate(degree<1>, Real t)
 {
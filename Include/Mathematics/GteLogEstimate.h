@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/22)
 
 #pragma once
 
@@ -34,6 +34,17 @@ public:
     //   float result = LogEstimate<float>::DegreeRR<3>(x);
     template <int D>
     inline static Real DegreeRR(Real x);
+
+    // Array versions of Degree and DegreeRR.  The estimates are computed
+    // for x[i] and stored in y[i] for 0 <= i < numElements, and x and y may
+    // be the same array.  The range reductions are branch-free rewrites of
+    // the scalar ones so that the compiler can vectorize the loops; see
+    // GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
+    template <int D>
+    static void DegreeRR(size_t numElements, Real const* x, Real* y);
 };
 
 
@@ -41,14 +52,32 @@ template <typename Real>
 template <int D>
 inline Real LogEstimate<Real>::Degree(Real x)
 {
-    return Log2Estimate<Real>::Degree<D>(x) * (Real)GTE_C_INV_LN_2;
+    return Log2Estimate<Real>::template Degree<D>(x) * (Real)GTE_C_LN_2;
 }
 
 template <typename Real>
 template <int D>
 inline Real LogEstimate<Real>::DegreeRR(Real x)
 {
-    return Log2Estimate<Real>::DegreeRR<D>(x) * (Real)GTE_C_INV_LN_2;
+    return Log2Estimate<Real>::template DegreeRR<D>(x) * (Real)GTE_C_LN_2;
+}
+
+template <typename Real>
+template <int D>
+void LogEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    Log2Estimate<Real>::template Degree<D>(numElements, x, y);
+    ArrayEstimate<Real>::Apply(numElements, y, y,
+        [](Real v) { return v * (Real)GTE_C_LN_2; });
+}
+
+template <typename Real>
+template <int D>
+void LogEstimate<Real>::DegreeRR(size_t numElements, Real const* x, Real* y)
+{
+    Log2Estimate<Real>::template DegreeRR<D>(numElements, x, y);
+    ArrayEstimate<Real>::Apply(numElements, y, y,
+        [](Real v) { return v * (Real)GTE_C_LN_2; });
 }
 
 
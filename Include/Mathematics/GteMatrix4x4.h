@@ -3,12 +3,13 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2019/05/04)
+// File Version: 3.0.3 (2019/09/23)
 
 #pragma once
 
 #include <Mathematics/GteMatrix.h>
 #include <Mathematics/GteVector4.h>
+#include <Mathematics/GteSIMD4.h>
 
 namespace gte
 {
@@ -366,4 +367,91 @@ namespace gte
 
         return M;
     }
+
+    // Fast paths for 'float' using SIMD4.  The nontemplate overloads are
+    // selected over the generic templates of GteMatrix.h and produce the same
+    // results, because each product is accumulated in the same order (see
+    // SIMD4::Combine).  The slices of the storage are the rows for
+    // GTE_USE_ROW_MAJOR and the columns for GTE_USE_COL_MAJOR; they are
+    // transposed in registers when the other kind is needed.  Call the
+    // templates explicitly, for example MultiplyAB<4, 4, 4, float>(A, B), to
+    // bypass the fast paths.
+    inline void LoadSlices(Matrix4x4<float> const& M, SIMD4* slices)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            slices[i] = SIMD4::Load(&M[4 * i]);
+        }
+    }
+
+    // M*V
+    inline Vector4<float> operator*(Matrix4x4<float> const& M, Vector4<float> const& V)
+    {
+        SIMD4 columns[4];
+        LoadSlices(M, columns);
+#if defined(GTE_USE_ROW_MAJOR)
+        SIMD4::Transpose(columns[0], columns[1], columns[2], columns[3]);
+#endif
+        Vector4<float> result;
+        SIMD4::Combine(columns, SIMD4::Load(&V[0])).Store(&result[0]);
+        return result;
+    }
+
+    // V^T*M
+    inline Vector4<float> operator*(Vector4<float> const& V, Matrix4x4<float> const& M)
+    {
+        SIMD4 rows[4];
+        LoadSlices(M, rows);
+#if !defined(GTE_USE_ROW_MAJOR)
+        SIMD4::Transpose(rows[0], rows[1], rows[2], rows[3]);
+#endif
+        Vector4<float> result;
+        SIMD4::Combine(rows, SIMD4::Load(&V[0])).Store(&result[0]);
+        return result;
+    }
+
+    // A*B.  For row-major storage, row r of A*B is the combination of the
+    // rows of B with the coefficients in row r of A.  For column-major
+    // storage, column c of A*B is the combination of the columns of A with
+    // the coefficients in column c of B.
+    inline Matrix4x4<float> MultiplyAB(Matrix4x4<float> const& A, Matrix4x4<float> const& B)
+    {
+#if defined(GTE_USE_ROW_MAJOR)
+        Matrix4x4<float> const& S = B;
+        Matrix4x4<float> const& C = A;
+#else
+        Matrix4x4<float> const& S = A;
+        Matrix4x4<float> const& C = B;
+#endif
+        SIMD4 slices[4];
+        LoadSlices(S, slices);
+        Matrix4x4<float> result;
+        for (int i = 0; i < 4; ++i)
+        {
+            SIMD4::Combine(slices, SIMD4::Load(&C[4 * i])).Store(&result[4 * i]);
+        }
+        return result;
+    }
+
+    inline Matrix4x4<float> operator*(Matrix4x4<float> const& A, Matrix4x4<float> const& B)
+    {
+        return MultiplyAB(A, B);
+    }
+
+    // Compute output[i] = M*input[i] for 0 <= i < numVectors.  The arrays may
+    // be the same.  The matrix is loaded once, and pairs of vectors are
+    // transformed with AVX2 when the CPU supports it (see GteSIMD4.h).
+    inline void Multiply(Matrix4x4<float> const& M, size_t numVectors,
+        Vector4<float> const* input, Vector4<float>* output)
+    {
+        static_assert(sizeof(Vector4<float>) == 4 * sizeof(float),
+            "Vector4<float> must be a packed 4-tuple.");
+
+        SIMD4 columns[4];
+        LoadSlices(M, columns);
+#if defined(GTE_USE_ROW_MAJOR)
+        SIMD4::Transpose(columns[0], columns[1], columns[2], columns[3]);
+#endif
+        SIMD4::MultiplyColumns(columns, numVectors, &input[0][0], &output[0][0]);
+    }
 }
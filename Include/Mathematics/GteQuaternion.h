@@ -3,13 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/12/11)
+// File Version: 3.0.2 (2019/09/23)
 
 #pragma once
 
 #include <Mathematics/GteVector.h>
 #include <Mathematics/GteMatrix.h>
 #include <Mathematics/GteChebyshevRatio.h>
+#include <Mathematics/GteSIMD4.h>
 
 // A quaternion is of the form
 //   q = x * i + y * j + z * k + w * 1 = x * i + y * j + z * k + w
@@ -287,6 +288,25 @@ namespace gte
         );
     }
 
+    // Fast path for 'float' using SIMD4.  Each output lane is the sum of the
+    // four products in the order of the generic function, so the results are
+    // the same.  The term for x0 is x0*(w1,-z1,y1,-x1), the term for y0 is
+    // y0*(z1,w1,-x1,-y1), the term for z0 is z0*(-y1,x1,w1,-z1) and the term
+    // for w0 is w0*(x1,y1,z1,w1).  Rotate and the other generic functions use
+    // this overload for 'float'.  Call operator*<float>(q0, q1) to bypass it.
+    inline Quaternion<float> operator*(Quaternion<float> const& q0, Quaternion<float> const& q1)
+    {
+        SIMD4 const a = SIMD4::Load(&q0[0]);
+        SIMD4 const b = SIMD4::Load(&q1[0]);
+        SIMD4 result = a.Splat<0>() * (b.Permute<3, 2, 1, 0>() * SIMD4(+1.0f, -1.0f, +1.0f, -1.0f));
+        result = result + a.Splat<1>() * (b.Permute<2, 3, 0, 1>() * SIMD4(+1.0f, +1.0f, -1.0f, -1.0f));
+        result = result + a.Splat<2>() * (b.Permute<1, 0, 3, 2>() * SIMD4(-1.0f, +1.0f, +1.0f, -1.0f));
+        result = result + a.Splat<3>() * b;
+        Quaternion<float> product;
+        result.Store(&product[0]);
+        return product;
+    }
+
     // For a nonzero quaternion q = (x,y,z,w), inv(q) = (-x,-y,-z,w)/|q|^2, where
     // |q| is the length of the quaternion.  When q is zero, the function returns
     // zero, which is considered to be an improbable case.
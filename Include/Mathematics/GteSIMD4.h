@@ -0,0 +1,321 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/23)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// A portable 4-tuple of 'float' for the fast paths of Vector4<float>,
+// Matrix4x4<float> and Quaternion<float>.  The backend is selected at
+// compile time.  SSE2 is used when the compiler targets it (x64, or x86
+// with /arch:SSE2 or -msse2); otherwise the lanes are a std::array and the
+// operations are scalar loops.  Define GTE_DISABLE_SIMD to force the scalar
+// backend.  (The MSW-only SIMD class of GteIntelSSE.h is unrelated.)
+//
+// The batch product MultiplyColumns uses 256-bit AVX2 registers.  When the
+// compiler targets AVX2 (/arch:AVX2, -mavx2) these are used directly.  When
+// it targets only SSE2, an AVX2 version is compiled anyway and selected at
+// run time when the CPU supports AVX2 (cpuid).
+//
+// No fused multiply-add instructions are used, so the fast paths produce
+// the same results as the generic code when they accumulate in the same
+// order.
+
+#if !defined(GTE_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GTE_SIMD4_SSE2
+#if defined(__AVX2__)
+#define GTE_SIMD4_AVX2
+#elif defined(_MSC_VER) || defined(__GNUC__)
+#define GTE_SIMD4_AVX2_DISPATCH
+#endif
+#endif
+#endif
+
+#if defined(GTE_SIMD4_AVX2) || defined(GTE_SIMD4_AVX2_DISPATCH)
+#include <immintrin.h>
+#elif defined(GTE_SIMD4_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(GTE_SIMD4_AVX2_DISPATCH) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace gte
+{
+    class SIMD4
+    {
+    public:
+        // Construction.  The default constructor does not initialize the
+        // lanes.
+        SIMD4() = default;
+
+#if defined(GTE_SIMD4_SSE2)
+        explicit SIMD4(float number)
+            :
+            mTuple(_mm_set1_ps(number))
+        {
+        }
+
+        SIMD4(float x0, float x1, float x2, float x3)
+            :
+            mTuple(_mm_setr_ps(x0, x1, x2, x3))
+        {
+        }
+
+        // The pointers need not be 16-byte aligned.
+        inline static SIMD4 Load(float const* v)
+        {
+            return SIMD4(_mm_loadu_ps(v));
+        }
+
+        inline void Store(float* v) const
+        {
+            _mm_storeu_ps(v, mTuple);
+        }
+
+        inline SIMD4 operator+(SIMD4 const& v) const
+        {
+            return SIMD4(_mm_add_ps(mTuple, v.mTuple));
+        }
+
+        inline SIMD4 operator-(SIMD4 const& v) const
+        {
+            return SIMD4(_mm_sub_ps(mTuple, v.mTuple));
+        }
+
+        inline SIMD4 operator*(SIMD4 const& v) const
+        {
+            return SIMD4(_mm_mul_ps(mTuple, v.mTuple));
+        }
+
+        inline SIMD4 operator-() const
+        {
+            return SIMD4(_mm_xor_ps(mTuple, _mm_set1_ps(-0.0f)));
+        }
+
+        // Return (v[i0], v[i1], v[i2], v[i3]).
+        template <int i0, int i1, int i2, int i3>
+        inline SIMD4 Permute() const
+        {
+            return SIMD4(_mm_shuffle_ps(mTuple, mTuple,
+                _MM_SHUFFLE(i3, i2, i1, i0)));
+        }
+
+        // Transpose the 4x4 table whose rows are v0 through v3.
+        inline static void Transpose(SIMD4& v0, SIMD4& v1, SIMD4& v2, SIMD4& v3)
+        {
+            _MM_TRANSPOSE4_PS(v0.mTuple, v1.mTuple, v2.mTuple, v3.mTuple);
+        }
+
+    private:
+        explicit SIMD4(__m128 tuple)
+            :
+            mTuple(tuple)
+        {
+        }
+
+        __m128 mTuple;
+#else
+        explicit SIMD4(float number)
+        {
+            mTuple.fill(number);
+        }
+
+        SIMD4(float x0, float x1, float x2, float x3)
+            :
+            mTuple{ { x0, x1, x2, x3 } }
+        {
+        }
+
+        inline static SIMD4 Load(float const* v)
+        {
+            return SIMD4(v[0], v[1], v[2], v[3]);
+        }
+
+        inline void Store(float* v) const
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                v[i] = mTuple[i];
+            }
+        }
+
+        inline SIMD4 operator+(SIMD4 const& v) const
+        {
+            return SIMD4(mTuple[0] + v.mTuple[0], mTuple[1] + v.mTuple[1],
+                mTuple[2] + v.mTuple[2], mTuple[3] + v.mTuple[3]);
+        }
+
+        inline SIMD4 operator-(SIMD4 const& v) const
+        {
+            return SIMD4(mTuple[0] - v.mTuple[0], mTuple[1] - v.mTuple[1],
+                mTuple[2] - v.mTuple[2], mTuple[3] - v.mTuple[3]);
+        }
+
+        inline SIMD4 operator*(SIMD4 const& v) const
+        {
+            return SIMD4(mTuple[0] * v.mTuple[0], mTuple[1] * v.mTuple[1],
+                mTuple[2] * v.mTuple[2], mTuple[3] * v.mTuple[3]);
+        }
+
+        inline SIMD4 operator-() const
+        {
+            return SIMD4(-mTuple[0], -mTuple[1], -mTuple[2], -mTuple[3]);
+        }
+
+        template <int i0, int i1, int i2, int i3>
+        inline SIMD4 Permute() const
+        {
+            return SIMD4(mTuple[i0], mTuple[i1], mTuple[i2], mTuple[i3]);
+        }
+
+        inline static void Transpose(SIMD4& v0, SIMD4& v1, SIMD4& v2, SIMD4& v3)
+        {
+            std::swap(v0.mTuple[1], v1.mTuple[0]);
+            std::swap(v0.mTuple[2], v2.mTuple[0]);
+            std::swap(v0.mTuple[3], v3.mTuple[0]);
+            std::swap(v1.mTuple[2], v2.mTuple[1]);
+            std::swap(v1.mTuple[3], v3.mTuple[1]);
+            std::swap(v2.mTuple[3], v3.mTuple[2]);
+        }
+
+    private:
+        std::array<float, 4> mTuple;
+#endif
+
+    public:
+        inline static SIMD4 Zero()
+        {
+            return SIMD4(0.0f);
+        }
+
+        // Return (v[i], v[i], v[i], v[i]).
+        template <int i>
+        inline SIMD4 Splat() const
+        {
+            return Permute<i, i, i, i>();
+        }
+
+        // Compute 0 + s[0]*c[0] + s[1]*c[1] + s[2]*c[2] + s[3]*c[3], where
+        // the c[j] are splats of the lanes of c, with the additions in the
+        // order listed.  This is the order of the generic matrix products,
+        // which start with 0 and accumulate one term at a time.
+        inline static SIMD4 Combine(SIMD4 const* s, SIMD4 const& c)
+        {
+            SIMD4 result = Zero() + s[0] * c.Splat<0>();
+            result = result + s[1] * c.Splat<1>();
+            result = result + s[2] * c.Splat<2>();
+            result = result + s[3] * c.Splat<3>();
+            return result;
+        }
+
+        // Compute output[i] = Combine(columns, input[i]) for the 4-tuples
+        // stored contiguously in the arrays, 0 <= i < numTuples.  The arrays
+        // may be the same.
+        static void MultiplyColumns(SIMD4 const* columns, size_t numTuples,
+            float const* input, float* output)
+        {
+#if defined(GTE_SIMD4_AVX2)
+            MultiplyColumnsAVX2(columns, numTuples, input, output);
+#else
+#if defined(GTE_SIMD4_AVX2_DISPATCH)
+            if (SupportsAVX2())
+            {
+                MultiplyColumnsAVX2(columns, numTuples, input, output);
+                return;
+            }
+#endif
+            for (size_t i = 0; i < numTuples; ++i, input += 4, output += 4)
+            {
+                Combine(columns, Load(input)).Store(output);
+            }
+#endif
+        }
+
+        // Query the CPU for AVX2 support, including the operating system
+        // support for saving the 256-bit registers.
+        static bool SupportsAVX2()
+        {
+#if defined(GTE_SIMD4_AVX2)
+            return true;
+#elif defined(GTE_SIMD4_AVX2_DISPATCH) && defined(_MSC_VER)
+            static bool const supported = []()
+            {
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7)
+                {
+                    return false;
+                }
+                __cpuid(info, 1);
+                bool const osxsave = ((info[2] & (1 << 27)) != 0);
+                bool const avx = ((info[2] & (1 << 28)) != 0);
+                __cpuidex(info, 7, 0);
+                bool const avx2 = ((info[1] & (1 << 5)) != 0);
+                return osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6;
+            }();
+            return supported;
+#elif defined(GTE_SIMD4_AVX2_DISPATCH)
+            static bool const supported = []()
+            {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+            return supported;
+#else
+            return false;
+#endif
+        }
+
+    private:
+#if defined(GTE_SIMD4_AVX2) || defined(GTE_SIMD4_AVX2_DISPATCH)
+        // Two 4-tuples are processed per iteration.  _mm256_permute_ps
+        // splats each lane within the 128-bit halves, so the arithmetic is
+        // that of Combine.
+#if defined(GTE_SIMD4_AVX2_DISPATCH) && defined(__GNUC__)
+        __attribute__((target("avx2")))
+#endif
+        static void MultiplyColumnsAVX2(SIMD4 const* columns,
+            size_t numTuples, float const* input, float* output)
+        {
+            float table[16];
+            for (int j = 0; j < 4; ++j)
+            {
+                columns[j].Store(&table[4 * j]);
+            }
+            __m256 const c0 = _mm256_broadcast_ps((__m128 const*)&table[0]);
+            __m256 const c1 = _mm256_broadcast_ps((__m128 const*)&table[4]);
+            __m256 const c2 = _mm256_broadcast_ps((__m128 const*)&table[8]);
+            __m256 const c3 = _mm256_broadcast_ps((__m128 const*)&table[12]);
+
+            size_t i = 0;
+            for (; i + 2 <= numTuples; i += 2, input += 8, output += 8)
+            {
+                __m256 const v = _mm256_loadu_ps(input);
+                __m256 result = _mm256_add_ps(_mm256_setzero_ps(),
+                    _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00)));
+                result = _mm256_add_ps(result,
+                    _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)));
+                result = _mm256_add_ps(result,
+                    _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)));
+                result = _mm256_add_ps(result,
+                    _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF)));
+                _mm256_storeu_ps(output, result);
+            }
+
+            if (i < numTuples)
+            {
+                Combine(columns, Load(input)).Store(output);
+            }
+        }
+#endif
+    };
+}
@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.2 (2019/09/22)
 
 #pragma once
 
-#include <Mathematics/GteMath.h>
+#include <Mathematics/GteArrayEstimate.h>
 
 // Minimax polynomial approximations to sin(x).  The polynomial p(x) of
 // degree D has only odd-power terms, is required to have linear term x,
@@ -36,6 +36,17 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Array versions of Degree and DegreeRR.  The estimates are computed
+    // for x[i] and stored in y[i] for 0 <= i < numElements, and x and y may
+    // be the same array.  The range reductions are branch-free rewrites of
+    // the scalar ones so that the compiler can vectorize the loops; see
+    // GteArrayEstimate.h.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
+    template <int D>
+    static void DegreeRR(size_t numElements, Real const* x, Real* y);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -65,6 +76,35 @@ inline Real SinEstimate<Real>::DegreeRR(Real x)
     return Degree<D>(Reduce(x));
 }
 
+template <typename Real>
+template <int D>
+void SinEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return Evaluate(degree<D>(), v); });
+}
+
+template <typename Real>
+template <int D>
+void SinEstimate<Real>::DegreeRR(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y, [](Real v)
+    {
+        Real quotient = (Real)GTE_C_INV_TWO_PI * v;
+        quotient = (Real)((int)(quotient + std::copysign((Real)0.5, quotient)));
+        Real r = v - (Real)GTE_C_TWO_PI * quotient;
+
+        // The reflections r -> pi - r and r -> -pi - r are computed as
+        // sign*(r - shift) with the comparison converted to 0 or 1.  The
+        // arithmetic is exact and there are no selections, so the loop
+        // vectorizes even when floating-point exceptions must be preserved.
+        Real reflect = (Real)(std::abs(r) > (Real)GTE_C_HALF_PI);
+        Real shift = reflect * std::copysign((Real)GTE_C_PI, r);
+        Real sign = (Real)1 - (Real)2 * reflect;
+        return Evaluate(degree<D>(), sign * (r - shift));
+    });
+}
+
 template <typename Real>
 inline Real SinEstimate<Real>::Evaluate(degree<3>, Real x)
 {
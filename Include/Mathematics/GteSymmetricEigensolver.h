@@ -3,14 +3,17 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.3 (2019/05/03)
+// File Version: 3.0.4 (2019/09/18)
 
 #pragma once
 
 #include <LowLevel/GteRangeIteration.h>
+#include <Mathematics/GteBlockReflector.h>
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
+#include <thread>
 #include <vector>
 
 // The SymmetricEigensolver class is an implementation of Algorithm 8.2.3
@@ -99,6 +102,45 @@
 // comperr is the computation E = Q^T*A*Q - D.  The construction of the full
 // eigenvector matrix is, of course, quite expensive.  If you need only a
 // small number of eigenvectors, use function GetEigenvector(int,Real*).
+//
+// For N >= DIVIDE_AND_CONQUER_SIZE, the solver uses algorithms whose work is
+// mostly matrix-matrix products, which are computed by the cache-blocked
+// and optionally threaded BlockedMatrixProduct.  The tridiagonalization
+// processes BLOCK_SIZE columns at a time; the reflections of a block are
+// accumulated in matrices V and W and applied to the remainder of the matrix
+// as A - V*W^T - W*V^T, as in LAPACK's DSYTRD.  The tridiagonal matrix is
+// diagonalized by Cuppen's divide-and-conquer algorithm, described in
+//   J. J. M. Cuppen, "A divide and conquer method for the symmetric
+//   tridiagonal eigenproblem," Numer. Math. 36:177-195, 1981.
+// The tridiagonal matrix T is split into two halves, T = diag(T0,T1) +
+// rho*z*z^T, and the eigensystems of the halves are computed recursively
+// (concurrently, when threads are available).  The eigenvalues of T are the
+// roots of the secular equation 1 + rho*sum_i z[i]^2/(d[i] - lambda) = 0,
+// where d are the eigenvalues of the halves.  Eigenvalues of the halves that
+// are (nearly) eigenvalues of T are deflated as in LAPACK's DLAED2.  The
+// eigenvectors are computed from a modified z as in
+//   M. Gu and S. C. Eisenstat, "A divide-and-conquer algorithm for the
+//   symmetric tridiagonal eigenproblem," SIAM J. Matrix Anal. Appl.
+//   16(1):172-191, 1995.
+// so that they are orthogonal to working precision.  Solve(...) computes
+// the eigenvectors of T, which requires N*N additional elements of memory,
+// and GetEigenvectors(...) multiplies them by the Householder reflections
+// using the block representation of BlockReflector.  The return value of
+// Solve(...) is the total number of QR iterations for the subproblems of
+// size at most LEAF_SIZE at the bottom of the recursion.
+//
+// The times in seconds for random matrices of type double, 1 thread, are
+// listed next.  The unblocked times are for the QR algorithm used for all
+// N in previous versions.
+//
+//   N  | unblocked Solve | GetEigenvectors | blocked Solve | GetEigenvectors
+// -----+-----------------+-----------------+---------------+----------------
+//  256 |      0.014      |      0.118      |     0.028     |      0.013
+//  512 |      0.125      |      1.398      |     0.181     |      0.097
+// 1024 |      1.404      |     19.484      |     1.493     |      0.712
+//
+// The blocked Solve(...) is slower, because it computes the eigenvectors of
+// the tridiagonal matrix.  The total time is much smaller.
 
 namespace gte
 {
@@ -111,8 +153,11 @@ public:
     // and the matrix is stored in row-major order.  The maximum number of
     // iterations ('maxIterations') must be specified for the reduction of a
     // tridiagonal matrix to a diagonal matrix.  The goal is to compute
-    // NxN orthogonal Q and NxN diagonal D for which Q^T*A*Q = D.
-    SymmetricEigensolver(int size, unsigned int maxIterations);
+    // NxN orthogonal Q and NxN diagonal D for which Q^T*A*Q = D.  For
+    // N >= DIVIDE_AND_CONQUER_SIZE, the matrix products and the halves of
+    // the divide-and-conquer recursion use up to 'numThreads' threads.
+    SymmetricEigensolver(int size, unsigned int maxIterations,
+        unsigned int numThreads = 1);
 
     // A copy of the NxN symmetric input is made internally.  The order of
     // the eigenvalues is specified by sortType: -1 (decreasing), 0 (no
@@ -148,6 +193,18 @@ public:
     void GetEigenvector(int c, Real* eigenvector) const;
     Real GetEigenvalue(int c) const;
 
+    // The sizes of the blocked algorithms.  Matrices with fewer than
+    // DIVIDE_AND_CONQUER_SIZE rows are processed by the unblocked
+    // algorithms.  The divide-and-conquer recursion stops at tridiagonal
+    // matrices with at most LEAF_SIZE rows, which are processed by the QR
+    // algorithm.
+    enum
+    {
+        BLOCK_SIZE = 32,
+        LEAF_SIZE = 32,
+        DIVIDE_AND_CONQUER_SIZE = 64
+    };
+
 private:
     // Tridiagonalize using Householder reflections.  On input, mMatrix is a
     // copy of the input matrix.  On output, the upper-triangular part of
@@ -155,11 +212,26 @@ private:
     // lower-triangular part contains 2/Dot(v,v) that are used in computing
     // eigenvectors and the part below the subdiagonal stores the essential
     // parts of the Householder vectors v (the elements of v after the
-    // leading 1-valued component).
+    // leading 1-valued component).  When the part of a column below the
+    // subdiagonal is already zero, the reflection is the identity and 0 is
+    // stored instead of 2/Dot(v,v).
     void Tridiagonalize();
 
+    // The blocked tridiagonalization for N >= DIVIDE_AND_CONQUER_SIZE.  The
+    // Householder vectors and 2/Dot(v,v) are stored as in Tridiagonalize(),
+    // but the upper-triangular part of mMatrix is not meaningful on output.
+    void TridiagonalizeBlocked();
+
     // A helper for generating Givens rotation sine and cosine robustly.
-    void GetSinCos(Real u, Real v, Real& cs, Real& sn);
+    static void GetSinCos(Real u, Real v, Real& cs, Real& sn);
+
+    // Reduce the tridiagonal matrix with the specified diagonal and
+    // superdiagonal to a diagonal matrix by QR steps.  Each Givens rotation
+    // is passed to rotate(index, cs, sn).  The return value is the number of
+    // iterations or 0xFFFFFFFF when convergence did not occur.
+    template <typename Rotate>
+    static unsigned int ReduceTridiagonal(int size, Real* diagonal,
+        Real* superdiagonal, unsigned int maxIterations, Rotate const& rotate);
 
     // The QR step with implicit shift.  Generally, the initial T is unreduced
     // tridiagonal (all subdiagonal entries are nonzero).  If a QR step causes
@@ -169,7 +241,38 @@ private:
     // of the algorithm.  The inputs imin and imax identify the subblock of T
     // to be processed.   That block has upper-left element T(imin,imin) and
     // lower-right element T(imax,imax).
-    void DoQRImplicitShift(int imin, int imax);
+    template <typename Rotate>
+    static void DoQRImplicitShift(Real* diagonal, Real* superdiagonal,
+        int imin, int imax, Rotate const& rotate);
+
+    // Compute the eigensystem of the size-by-size tridiagonal matrix with
+    // diagonal d and superdiagonal e.  On output, d stores the eigenvalues
+    // in increasing order and the size-by-size block of mTEigenvectors
+    // whose upper-left element is 'eigenvectors' stores the eigenvectors as
+    // columns.  The 'determinant' is that of the block, +1 or -1.  The
+    // return value is 'false' when a QR reduction did not converge.
+    bool DivideAndConquer(int size, Real* d, Real* e, Real* eigenvectors,
+        int depth, unsigned int& numIterations, int& determinant);
+
+    // Compute the eigensystem of D + rho*z*z^T, where D = diag(d) are the
+    // eigenvalues of the two halves and the columns of the block of
+    // mTEigenvectors are their eigenvectors.  The first 'half' eigenvalues
+    // belong to the upper half.  The return value is the determinant of the
+    // orthogonal matrix that multiplies the block.
+    int Merge(int size, int half, Real* d, Real* z, Real rho,
+        Real* eigenvectors, int depth);
+
+    // Compute the root lambda in (d[j],d[j+1]) of the secular equation
+    // 1/rho + sum_i zsqr[i]/(d[i] - lambda) = 0 for the increasing d[].
+    // The root of index size-1 is larger than d[size-1].  The root is
+    // computed as an offset from the closer pole, and delta[i] is set to
+    // d[i] - lambda, which is then accurate even when lambda is very close
+    // to d[i].
+    static void SolveSecularEquation(int j, int size, Real const* d,
+        Real const* zsqr, Real rho, Real& lambda, Real* delta);
+
+    // Return +1 for an even permutation and -1 for an odd permutation.
+    static int GetPermutationSign(std::vector<int> const& permutation);
 
     // Sort the eigenvalues and compute the corresponding permutation of the
     // indices of the array storing the eigenvalues.  The permutation is used
@@ -177,6 +280,10 @@ private:
     // GetEigenvalues(...) and GetEigenvectors(...).
     void ComputePermutation(int sortType);
 
+    // The type of the eigenvector matrix before sorting, +1 for a rotation
+    // and 0 for a reflection.
+    int GetUnsortedMatrixType() const;
+
     // The number N of rows and columns of the matrices to be processed.
     int mSize;
 
@@ -184,6 +291,10 @@ private:
     // to a diagonal matrix.
     unsigned int mMaxIterations;
 
+    // Support for the blocked algorithms.
+    unsigned int mNumThreads;
+    bool mUseDivideAndConquer;
+
     // The internal copy of a matrix passed to the solver.  See the comments
     // about function Tridiagonalize() about what is stored in the matrix.
     std::vector<Real> mMatrix;  // NxN elements
@@ -200,7 +311,8 @@ private:
     // R(index+1,index) = -sn, and R(index+1,index+1) = cs.  If N is the
     // matrix size and K is the maximum number of iterations, the maximum
     // number of Givens rotations is K*(N-1).  The maximum amount of memory
-    // is allocated to store these.
+    // is allocated to store these, except for the divide-and-conquer
+    // algorithm, which does not use them.
     struct GivensRotation
     {
         GivensRotation();
@@ -211,6 +323,15 @@ private:
 
     std::vector<GivensRotation> mGivens;  // K*(N-1) elements
 
+    // The eigenvectors of the tridiagonal matrix computed by the
+    // divide-and-conquer algorithm, stored in row-major order, and the
+    // determinant of that matrix (+1 for the QR algorithm).
+    std::vector<Real> mTEigenvectors;  // NxN elements
+    int mTDeterminant;
+
+    // The number of Householder reflections that are not the identity.
+    int mNumReflections;
+
     // When sorting is requested, the permutation associated with the sort is
     // stored in mPermutation.  When sorting is not requested, mPermutation[0]
     // is set to -1.  mVisited is used for finding cycles in the permutation.
@@ -231,10 +352,14 @@ private:
 
 template <typename Real>
 SymmetricEigensolver<Real>::SymmetricEigensolver(int size,
-    unsigned int maxIterations)
+    unsigned int maxIterations, unsigned int numThreads)
     :
     mSize(0),
     mMaxIterations(0),
+    mNumThreads(numThreads > 0 ? numThreads : 1),
+    mUseDivideAndConquer(false),
+    mTDeterminant(1),
+    mNumReflections(0),
     mEigenvectorMatrixType(-1)
 {
     if (size > 1 && maxIterations > 0)
@@ -244,12 +369,21 @@ SymmetricEigensolver<Real>::SymmetricEigensolver(int size,
         mMatrix.resize(size*size);
         mDiagonal.resize(size);
         mSuperdiagonal.resize(size - 1);
-        mGivens.reserve(maxIterations * (size - 1));
         mPermutation.resize(size);
         mVisited.resize(size);
         mPVector.resize(size);
         mVVector.resize(size);
         mWVector.resize(size);
+
+        mUseDivideAndConquer = (size >= DIVIDE_AND_CONQUER_SIZE);
+        if (mUseDivideAndConquer)
+        {
+            mTEigenvectors.resize(size*size);
+        }
+        else
+        {
+            mGivens.reserve(maxIterations * (size - 1));
+        }
     }
 }
 
@@ -262,50 +396,71 @@ unsigned int SymmetricEigensolver<Real>::Solve(Real const* input,
     if (mSize > 0)
     {
         std::copy(input, input + mSize*mSize, mMatrix.begin());
-        Tridiagonalize();
 
-        mGivens.clear();
-        for (unsigned int j = 0; j < mMaxIterations; ++j)
-        {
-            int imin = -1, imax = -1;
-            for (int i = mSize - 2; i >= 0; --i)
-            {
-                // When a01 is much smaller than its diagonal neighbors, it is
-                // effectively zero.
-                Real a00 = mDiagonal[i];
-                Real a01 = mSuperdiagonal[i];
-                Real a11 = mDiagonal[i + 1];
-                Real sum = std::abs(a00) + std::abs(a11);
-                if (sum + std::abs(a01) != sum)
+        if (mUseDivideAndConquer)
+        {
+            TridiagonalizeBlocked();
+
+            // Scale the tridiagonal matrix so that its largest element has
+            // magnitude 1, which avoids overflow and underflow in the
+            // products of the divide-and-conquer algorithm.
+            Real scale = (Real)0;
+            for (int i = 0; i < mSize; ++i)
+            {
+                scale = std::max(scale, std::abs(mDiagonal[i]));
+            }
+            for (int i = 0; i < mSize - 1; ++i)
+            {
+                scale = std::max(scale, std::abs(mSuperdiagonal[i]));
+            }
+            if (scale > (Real)0)
+            {
+                for (int i = 0; i < mSize; ++i)
                 {
-                    if (imax == -1)
-                    {
-                        imax = i;
-                    }
-                    imin = i;
+                    mDiagonal[i] /= scale;
                 }
-                else
+                for (int i = 0; i < mSize - 1; ++i)
                 {
-                    // The superdiagonal term is effectively zero compared to
-                    // the neighboring diagonal terms.
-                    if (imin >= 0)
-                    {
-                        break;
-                    }
+                    mSuperdiagonal[i] /= scale;
                 }
             }
 
-            if (imax == -1)
+            std::fill(mTEigenvectors.begin(), mTEigenvectors.end(), (Real)0);
+            unsigned int numIterations = 0;
+            if (!DivideAndConquer(mSize, &mDiagonal[0], &mSuperdiagonal[0],
+                &mTEigenvectors[0], 0, numIterations, mTDeterminant))
+            {
+                return 0xFFFFFFFF;
+            }
+
+            if (scale > (Real)0)
             {
-                // The algorithm has converged.
-                ComputePermutation(sortType);
-                return j;
+                for (int i = 0; i < mSize; ++i)
+                {
+                    mDiagonal[i] *= scale;
+                }
             }
 
-            // Process the lower-right-most unreduced tridiagonal block.
-            DoQRImplicitShift(imin, imax);
+            ComputePermutation(sortType);
+            return numIterations;
+        }
+
+        Tridiagonalize();
+        mTDeterminant = 1;
+
+        mGivens.clear();
+        unsigned int numIterations = ReduceTridiagonal(mSize, &mDiagonal[0],
+            &mSuperdiagonal[0], mMaxIterations,
+            [this](int index, Real cs, Real sn)
+            {
+                mGivens.push_back(GivensRotation(index, cs, sn));
+            });
+
+        if (numIterations != 0xFFFFFFFF)
+        {
+            ComputePermutation(sortType);
         }
-        return 0xFFFFFFFF;
+        return numIterations;
     }
     else
     {
@@ -343,72 +498,102 @@ void SymmetricEigensolver<Real>::GetEigenvectors(Real* eigenvectors) const
 
     if (eigenvectors && mSize > 0)
     {
-        // Start with the identity matrix.
-        std::fill(eigenvectors, eigenvectors + mSize*mSize, (Real)0);
-        for (int d = 0; d < mSize; ++d)
+        if (mUseDivideAndConquer)
         {
-            eigenvectors[d + mSize*d] = (Real)1;
-        }
-
-        // Multiply the Householder reflections using backward accumulation.
-        int r, c;
-        for (int i = mSize - 3, rmin = i + 1; i >= 0; --i, --rmin)
-        {
-            // Copy the v vector and 2/Dot(v,v) from the matrix.
-            Real const* column = &mMatrix[i];
-            Real twoinvvdv = column[mSize*(i + 1)];
-            for (r = 0; r < i + 1; ++r)
+            // Start with the eigenvectors of the tridiagonal matrix and
+            // multiply by the Householder reflections, BLOCK_SIZE of them
+            // at a time, using backward accumulation.
+            std::copy(mTEigenvectors.begin(), mTEigenvectors.end(), eigenvectors);
+
+            BlockReflector<Real> reflector(mNumThreads);
+            std::vector<Real> V, tau(BLOCK_SIZE);
+            for (int i1 = mSize - 2; i1 > 0; i1 -= BLOCK_SIZE)
             {
-                mVVector[r] = (Real)0;
+                // The reflections i0 through i1-1 modify rows i0+1 through
+                // N-1.  Row 'rmin' of the matrix is row 0 of V.
+                int i0 = std::max(i1 - static_cast<int>(BLOCK_SIZE), 0);
+                int k = i1 - i0, rmin = i0 + 1, numRows = mSize - rmin;
+                V.assign(numRows * k, (Real)0);
+                for (int i = i0; i < i1; ++i)
+                {
+                    int j = i - i0;
+                    tau[j] = mMatrix[i + mSize*(i + 1)];
+                    V[(i + 1 - rmin) * k + j] = (Real)1;
+                    for (int r = i + 2; r < mSize; ++r)
+                    {
+                        V[(r - rmin) * k + j] = mMatrix[i + mSize*r];
+                    }
+                }
+
+                reflector.Apply(numRows, mSize, k, &V[0], k, 1, &tau[0],
+                    eigenvectors + mSize*rmin, mSize, 1);
             }
-            mVVector[r] = (Real)1;
-            for (++r; r < mSize; ++r)
+        }
+        else
+        {
+            // Start with the identity matrix.
+            std::fill(eigenvectors, eigenvectors + mSize*mSize, (Real)0);
+            for (int d = 0; d < mSize; ++d)
             {
-                mVVector[r] = column[mSize*r];
+                eigenvectors[d + mSize*d] = (Real)1;
             }
 
-            // Compute the w vector.
-            for (r = 0; r < mSize; ++r)
+            // Multiply the Householder reflections using backward
+            // accumulation.
+            int r, c;
+            for (int i = mSize - 3, rmin = i + 1; i >= 0; --i, --rmin)
             {
-                mWVector[r] = (Real)0;
-                for (c = rmin; c < mSize; ++c)
+                // Copy the v vector and 2/Dot(v,v) from the matrix.
+                Real const* column = &mMatrix[i];
+                Real twoinvvdv = column[mSize*(i + 1)];
+                for (r = 0; r < i + 1; ++r)
                 {
-                    mWVector[r] += mVVector[c] * eigenvectors[r + mSize*c];
+                    mVVector[r] = (Real)0;
+                }
+                mVVector[r] = (Real)1;
+                for (++r; r < mSize; ++r)
+                {
+                    mVVector[r] = column[mSize*r];
                 }
-                mWVector[r] *= twoinvvdv;
-            }
 
-            // Update the matrix, Q <- Q - v*w^T.
-            for (r = rmin; r < mSize; ++r)
-            {
-                for (c = 0; c < mSize; ++c)
+                // Compute the w vector.
+                for (r = 0; r < mSize; ++r)
+                {
+                    mWVector[r] = (Real)0;
+                    for (c = rmin; c < mSize; ++c)
+                    {
+                        mWVector[r] += mVVector[c] * eigenvectors[r + mSize*c];
+                    }
+                    mWVector[r] *= twoinvvdv;
+                }
+
+                // Update the matrix, Q <- Q - v*w^T.
+                for (r = rmin; r < mSize; ++r)
                 {
-                    eigenvectors[c + mSize*r] -= mVVector[r] * mWVector[c];
+                    for (c = 0; c < mSize; ++c)
+                    {
+                        eigenvectors[c + mSize*r] -= mVVector[r] * mWVector[c];
+                    }
                 }
             }
-        }
 
-        // Multiply the Givens rotations.
-        for (auto const& givens : mGivens)
-        {
-            for (r = 0; r < mSize; ++r)
+            // Multiply the Givens rotations.
+            for (auto const& givens : mGivens)
             {
-                int j = givens.index + mSize*r;
-                Real& q0 = eigenvectors[j];
-                Real& q1 = eigenvectors[j + 1];
-                Real prd0 = givens.cs * q0 - givens.sn * q1;
-                Real prd1 = givens.sn * q0 + givens.cs * q1;
-                q0 = prd0;
-                q1 = prd1;
+                for (r = 0; r < mSize; ++r)
+                {
+                    int j = givens.index + mSize*r;
+                    Real& q0 = eigenvectors[j];
+                    Real& q1 = eigenvectors[j + 1];
+                    Real prd0 = givens.cs * q0 - givens.sn * q1;
+                    Real prd1 = givens.sn * q0 + givens.cs * q1;
+                    q0 = prd0;
+                    q1 = prd1;
+                }
             }
         }
 
-        // The number of Householder reflections is H = mSize - 2.  If H is
-        // even, the product of Householder reflections is a rotation;
-        // otherwise, H is odd and the product is a reflection.  The number 
-        // of Givens rotations does not influence the type of the product of
-        // Householder reflections.
-        mEigenvectorMatrixType = 1 - (mSize & 1);
+        mEigenvectorMatrixType = GetUnsortedMatrixType();
 
         if (mPermutation[0] >= 0)
         {
@@ -461,28 +646,32 @@ const
         // y = H*x, then x and y are swapped for the next H
         Real* x = eigenvector;
         Real* y = &mPVector[0];
+        int p = (mPermutation[0] >= 0 ? mPermutation[c] : c);
 
-        // Start with the Euclidean basis vector.
-        std::memset(x, 0, mSize*sizeof(Real));
-        if (mPermutation[0] >= 0)
+        if (mUseDivideAndConquer)
         {
-            // Sorting was requested.
-            x[mPermutation[c]] = (Real)1;
+            // Start with the eigenvector of the tridiagonal matrix.
+            for (int r = 0; r < mSize; ++r)
+            {
+                x[r] = mTEigenvectors[p + mSize*r];
+            }
         }
         else
         {
-            x[c] = (Real)1;
-        }
+            // Start with the Euclidean basis vector.
+            std::memset(x, 0, mSize*sizeof(Real));
+            x[p] = (Real)1;
 
-        // Apply the Givens rotations.
-        for (auto const& givens : gte::reverse(mGivens))
-        {
-            Real& xr = x[givens.index];
-            Real& xrp1 = x[givens.index + 1];
-            Real tmp0 = givens.cs * xr + givens.sn * xrp1;
-            Real tmp1 = -givens.sn * xr + givens.cs * xrp1;
-            xr = tmp0;
-            xrp1 = tmp1;
+            // Apply the Givens rotations.
+            for (auto const& givens : gte::reverse(mGivens))
+            {
+                Real& xr = x[givens.index];
+                Real& xrp1 = x[givens.index + 1];
+                Real tmp0 = givens.cs * xr + givens.sn * xrp1;
+                Real tmp1 = -givens.sn * xr + givens.cs * xrp1;
+                xr = tmp0;
+                xrp1 = tmp1;
+            }
         }
 
         // Apply the Householder reflections.
@@ -551,6 +740,7 @@ template <typename Real>
 void SymmetricEigensolver<Real>::Tridiagonalize()
 {
     int r, c;
+    mNumReflections = 0;
     for (int i = 0, ip1 = 1; i < mSize - 2; ++i, ++ip1)
     {
         // Compute the Householder vector.  Read the initial vector from the
@@ -580,6 +770,7 @@ void SymmetricEigensolver<Real>::Tridiagonalize()
                 vr *= invDenom;
                 vdv += vr * vr;
             }
+            ++mNumReflections;
         }
 
         // Compute the rank-1 offsets v*w^T and w*v^T.
@@ -626,7 +817,9 @@ void SymmetricEigensolver<Real>::Tridiagonalize()
         // index i+1 is also not stored; instead, the quantity 2/Dot(v,v) is
         // stored for use in eigenvector construction. That construction must
         // take into account the implied components that are not stored.
-        mMatrix[i + mSize*ip1] = twoinvvdv;
+        // When the vector is zero, the reflection is the identity, which is
+        // represented by storing 0 instead of 2/Dot(v,v).
+        mMatrix[i + mSize*ip1] = (length > (Real)0 ? twoinvvdv : (Real)0);
         for (r = ip1 + 1; r < mSize; ++r)
         {
             mMatrix[i + mSize*r] = mVVector[r];
@@ -644,6 +837,152 @@ void SymmetricEigensolver<Real>::Tridiagonalize()
     mDiagonal[k] = mMatrix[index];
 }
 
+template <typename Real>
+void SymmetricEigensolver<Real>::TridiagonalizeBlocked()
+{
+    // Element (r,c) of the matrix is mMatrix[c + mSize*r].  The algorithm
+    // uses both triangles of the matrix, so copy the upper triangle, which
+    // is the one used by Tridiagonalize(), to the lower triangle.
+    int const n = mSize;
+    Real* A = &mMatrix[0];
+    for (int r = 1; r < n; ++r)
+    {
+        for (int c = 0; c < r; ++c)
+        {
+            A[c + n*r] = A[r + n*c];
+        }
+    }
+
+    // The Householder vectors v and the vectors w of the current block
+    // are the columns of the N-by-BLOCK_SIZE matrices V and W, stored in
+    // row-major order.  The part of the matrix that has not been reduced is
+    // A - V*W^T - W*V^T.
+    int const nb = BLOCK_SIZE;
+    BlockedMatrixProduct<Real> product(mNumThreads);
+    std::vector<Real> V(n * nb), W(n * nb), VTv(nb), WTv(nb);
+    Real* v = &mVVector[0];
+    Real* p = &mPVector[0];
+
+    mNumReflections = 0;
+    for (int i0 = 0; i0 < n - 2; i0 += nb)
+    {
+        int const i1 = std::min(i0 + nb, n - 2);
+        std::fill(V.begin(), V.end(), (Real)0);
+        std::fill(W.begin(), W.end(), (Real)0);
+
+        for (int i = i0, ip1 = i0 + 1; i < i1; ++i, ++ip1)
+        {
+            // Apply the previous reflections of the block to column i.
+            int const k = i - i0;
+            Real const* Vi = &V[i * nb];
+            Real const* Wi = &W[i * nb];
+            for (int r = i; r < n; ++r)
+            {
+                Real const* Vr = &V[r * nb];
+                Real const* Wr = &W[r * nb];
+                Real sum = (Real)0;
+                for (int j = 0; j < k; ++j)
+                {
+                    sum += Vr[j] * Wi[j] + Wr[j] * Vi[j];
+                }
+                A[i + n*r] -= sum;
+            }
+
+            // Compute the Householder vector for the column.
+            Real length = (Real)0;
+            for (int r = ip1; r < n; ++r)
+            {
+                Real vr = A[i + n*r];
+                v[r] = vr;
+                length += vr * vr;
+            }
+            length = std::sqrt(length);
+
+            mDiagonal[i] = A[i + n*i];
+            Real twoinvvdv = (Real)0;
+            if (length > (Real)0)
+            {
+                Real sgn = (v[ip1] >= (Real)0 ? (Real)1 : (Real)-1);
+                Real invDenom = ((Real)1) / (v[ip1] + sgn * length);
+                Real vdv = (Real)1;
+                v[ip1] = (Real)1;
+                for (int r = ip1 + 1; r < n; ++r)
+                {
+                    v[r] *= invDenom;
+                    vdv += v[r] * v[r];
+                }
+                twoinvvdv = ((Real)1 / vdv) * (Real)2;
+                mSuperdiagonal[i] = -sgn * length;
+                ++mNumReflections;
+            }
+            else
+            {
+                mSuperdiagonal[i] = (Real)0;
+            }
+
+            if (twoinvvdv != (Real)0)
+            {
+                // p = (2/Dot(v,v))*(A - V*W^T - W*V^T)*v for rows i+1
+                // through N-1.  The matrix-vector product is the dominant
+                // cost of the tridiagonalization.
+                int const m = n - ip1;
+                product.Multiply(m, m, A + ip1 + n*ip1, n, 1, v + ip1, p + ip1);
+                for (int j = 0; j < k; ++j)
+                {
+                    Real vtv = (Real)0, wtv = (Real)0;
+                    for (int r = ip1; r < n; ++r)
+                    {
+                        vtv += V[r * nb + j] * v[r];
+                        wtv += W[r * nb + j] * v[r];
+                    }
+                    VTv[j] = vtv;
+                    WTv[j] = wtv;
+                }
+
+                Real pdvtvdv = (Real)0;
+                for (int r = ip1; r < n; ++r)
+                {
+                    Real const* Vr = &V[r * nb];
+                    Real const* Wr = &W[r * nb];
+                    Real sum = p[r];
+                    for (int j = 0; j < k; ++j)
+                    {
+                        sum -= Vr[j] * WTv[j] + Wr[j] * VTv[j];
+                    }
+                    p[r] = sum * twoinvvdv;
+                    pdvtvdv += p[r] * v[r];
+                }
+
+                // w = p - (Dot(p,v)/Dot(v,v))*v
+                pdvtvdv *= twoinvvdv * (Real)0.5;
+                for (int r = ip1; r < n; ++r)
+                {
+                    V[r * nb + k] = v[r];
+                    W[r * nb + k] = p[r] - pdvtvdv * v[r];
+                }
+            }
+
+            // Store the vector and 2/Dot(v,v) as in Tridiagonalize().
+            A[i + n*ip1] = twoinvvdv;
+            for (int r = ip1 + 1; r < n; ++r)
+            {
+                A[i + n*r] = (twoinvvdv != (Real)0 ? v[r] : (Real)0);
+            }
+        }
+
+        // Update the part of the matrix after the block.
+        int const m = n - i1, k = i1 - i0;
+        product.MultiplySubtract(m, m, k, &V[i1 * nb], nb, 1, &W[i1 * nb], 1, nb,
+            A + i1 + n*i1, n, 1);
+        product.MultiplySubtract(m, m, k, &W[i1 * nb], nb, 1, &V[i1 * nb], 1, nb,
+            A + i1 + n*i1, n, 1);
+    }
+
+    mDiagonal[n - 2] = A[(n - 2) + n*(n - 2)];
+    mSuperdiagonal[n - 2] = A[(n - 2) + n*(n - 1)];
+    mDiagonal[n - 1] = A[(n - 1) + n*(n - 1)];
+}
+
 template <typename Real>
 void SymmetricEigensolver<Real>::GetSinCos(Real x, Real y, Real& cs, Real& sn)
 {
@@ -672,19 +1011,69 @@ void SymmetricEigensolver<Real>::GetSinCos(Real x, Real y, Real& cs, Real& sn)
 }
 
 template <typename Real>
-void SymmetricEigensolver<Real>::DoQRImplicitShift(int imin, int imax)
+template <typename Rotate>
+unsigned int SymmetricEigensolver<Real>::ReduceTridiagonal(int size,
+    Real* diagonal, Real* superdiagonal, unsigned int maxIterations,
+    Rotate const& rotate)
+{
+    for (unsigned int j = 0; j < maxIterations; ++j)
+    {
+        int imin = -1, imax = -1;
+        for (int i = size - 2; i >= 0; --i)
+        {
+            // When a01 is much smaller than its diagonal neighbors, it is
+            // effectively zero.
+            Real a00 = diagonal[i];
+            Real a01 = superdiagonal[i];
+            Real a11 = diagonal[i + 1];
+            Real sum = std::abs(a00) + std::abs(a11);
+            if (sum + std::abs(a01) != sum)
+            {
+                if (imax == -1)
+                {
+                    imax = i;
+                }
+                imin = i;
+            }
+            else
+            {
+                // The superdiagonal term is effectively zero compared to
+                // the neighboring diagonal terms.
+                if (imin >= 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (imax == -1)
+        {
+            // The algorithm has converged.
+            return j;
+        }
+
+        // Process the lower-right-most unreduced tridiagonal block.
+        DoQRImplicitShift(diagonal, superdiagonal, imin, imax, rotate);
+    }
+    return 0xFFFFFFFF;
+}
+
+template <typename Real>
+template <typename Rotate>
+void SymmetricEigensolver<Real>::DoQRImplicitShift(Real* diagonal,
+    Real* superdiagonal, int imin, int imax, Rotate const& rotate)
 {
     // The implicit shift.  Compute the eigenvalue u of the lower-right 2x2
     // block that is closer to a11.
-    Real a00 = mDiagonal[imax];
-    Real a01 = mSuperdiagonal[imax];
-    Real a11 = mDiagonal[imax + 1];
+    Real a00 = diagonal[imax];
+    Real a01 = superdiagonal[imax];
+    Real a11 = diagonal[imax + 1];
     Real dif = (a00 - a11) * (Real)0.5;
     Real sgn = (dif >= (Real)0 ? (Real)1 : (Real)-1);
     Real a01sqr = a01 * a01;
     Real u = a11 - a01sqr / (dif + sgn * std::sqrt(dif*dif + a01sqr));
-    Real x = mDiagonal[imin] - u;
-    Real y = mSuperdiagonal[imin];
+    Real x = diagonal[imin] - u;
+    Real y = superdiagonal[imin];
 
     Real a12, a22, a23, tmp11, tmp12, tmp21, tmp22, cs, sn;
     Real a02 = (Real)0;
@@ -694,7 +1083,7 @@ void SymmetricEigensolver<Real>::DoQRImplicitShift(int imin, int imax)
         // Compute the Givens rotation and save it for use in computing the
         // eigenvectors.
         GetSinCos(x, y, cs, sn);
-        mGivens.push_back(GivensRotation(i1, cs, sn));
+        rotate(i1, cs, sn);
 
         // Update the tridiagonal matrix.  This amounts to updating a 4x4
         // subblock,
@@ -711,42 +1100,635 @@ void SymmetricEigensolver<Real>::DoQRImplicitShift(int imin, int imax)
         // change.
         if (i1 > imin)
         {
-            mSuperdiagonal[i0] = cs*mSuperdiagonal[i0] - sn*a02;
+            superdiagonal[i0] = cs*superdiagonal[i0] - sn*a02;
         }
 
-        a11 = mDiagonal[i1];
-        a12 = mSuperdiagonal[i1];
-        a22 = mDiagonal[i2];
+        a11 = diagonal[i1];
+        a12 = superdiagonal[i1];
+        a22 = diagonal[i2];
         tmp11 = cs*a11 - sn*a12;
         tmp12 = cs*a12 - sn*a22;
         tmp21 = sn*a11 + cs*a12;
         tmp22 = sn*a12 + cs*a22;
-        mDiagonal[i1] = cs*tmp11 - sn*tmp12;
-        mSuperdiagonal[i1] = sn*tmp11 + cs*tmp12;
-        mDiagonal[i2] = sn*tmp21 + cs*tmp22;
+        diagonal[i1] = cs*tmp11 - sn*tmp12;
+        superdiagonal[i1] = sn*tmp11 + cs*tmp12;
+        diagonal[i2] = sn*tmp21 + cs*tmp22;
 
         if (i1 < imax)
         {
-            a23 = mSuperdiagonal[i2];
+            a23 = superdiagonal[i2];
             a02 = -sn*a23;
-            mSuperdiagonal[i2] = cs*a23;
+            superdiagonal[i2] = cs*a23;
 
             // Update the parameters for the next Givens rotation.
-            x = mSuperdiagonal[i1];
+            x = superdiagonal[i1];
             y = a02;
         }
     }
 }
 
+template <typename Real>
+bool SymmetricEigensolver<Real>::DivideAndConquer(int size, Real* d, Real* e,
+    Real* eigenvectors, int depth, unsigned int& numIterations,
+    int& determinant)
+{
+    int const n = size, stride = mSize;
+
+    if (n <= LEAF_SIZE)
+    {
+        // Accumulate the Givens rotations of the QR algorithm in the block,
+        // which starts as the identity (the caller zeroed it).
+        for (int i = 0; i < n; ++i)
+        {
+            eigenvectors[i + stride*i] = (Real)1;
+        }
+
+        numIterations = ReduceTridiagonal(n, d, e, mMaxIterations,
+            [eigenvectors, n, stride](int index, Real cs, Real sn)
+            {
+                for (int r = 0; r < n; ++r)
+                {
+                    Real& q0 = eigenvectors[index + stride*r];
+                    Real& q1 = eigenvectors[index + 1 + stride*r];
+                    Real prd0 = cs * q0 - sn * q1;
+                    Real prd1 = sn * q0 + cs * q1;
+                    q0 = prd0;
+                    q1 = prd1;
+                }
+            });
+        if (numIterations == 0xFFFFFFFF)
+        {
+            return false;
+        }
+
+        // Sort the eigenvalues in increasing order.  Each swap of two
+        // columns changes the sign of the determinant.
+        determinant = 1;
+        for (int i = 0; i < n - 1; ++i)
+        {
+            int jmin = i;
+            for (int j = i + 1; j < n; ++j)
+            {
+                if (d[j] < d[jmin])
+                {
+                    jmin = j;
+                }
+            }
+            if (jmin != i)
+            {
+                std::swap(d[i], d[jmin]);
+                for (int r = 0; r < n; ++r)
+                {
+                    std::swap(eigenvectors[i + stride*r], eigenvectors[jmin + stride*r]);
+                }
+                determinant = -determinant;
+            }
+        }
+        return true;
+    }
+
+    // T = diag(T0,T1) + rho*u*u^T, where u = e[half-1] + sgn*e[half] (the
+    // Euclidean basis vectors), rho = |beta| and sgn = sign(beta) for the
+    // superdiagonal term beta that couples T0 and T1.
+    int const half = n / 2;
+    Real const beta = e[half - 1];
+    Real const rho = std::abs(beta);
+    d[half - 1] -= rho;
+    d[half] -= rho;
+
+    unsigned int numIterations0 = 0, numIterations1 = 0;
+    int determinant0 = 1, determinant1 = 1;
+    bool converged0 = false, converged1 = false;
+    Real* eigenvectors1 = eigenvectors + half + stride*half;
+    if ((1u << depth) < mNumThreads)
+    {
+        std::thread worker([this, half, d, e, eigenvectors, depth,
+            &numIterations0, &determinant0, &converged0]()
+        {
+            converged0 = DivideAndConquer(half, d, e, eigenvectors, depth + 1,
+                numIterations0, determinant0);
+        });
+        converged1 = DivideAndConquer(n - half, d + half, e + half,
+            eigenvectors1, depth + 1, numIterations1, determinant1);
+        worker.join();
+    }
+    else
+    {
+        converged0 = DivideAndConquer(half, d, e, eigenvectors, depth + 1,
+            numIterations0, determinant0);
+        converged1 = DivideAndConquer(n - half, d + half, e + half,
+            eigenvectors1, depth + 1, numIterations1, determinant1);
+    }
+    numIterations = numIterations0 + numIterations1;
+    if (!converged0 || !converged1)
+    {
+        return false;
+    }
+
+    // z = diag(Q0,Q1)^T*u is the last row of Q0 followed by sgn times the
+    // first row of Q1.
+    std::vector<Real> z(n);
+    Real const sgn = (beta >= (Real)0 ? (Real)1 : (Real)-1);
+    for (int j = 0; j < half; ++j)
+    {
+        z[j] = eigenvectors[j + stride*(half - 1)];
+    }
+    for (int j = half; j < n; ++j)
+    {
+        z[j] = sgn * eigenvectors[j + stride*half];
+    }
+
+    determinant = determinant0 * determinant1 *
+        Merge(n, half, d, &z[0], rho, eigenvectors, depth);
+    return true;
+}
+
+template <typename Real>
+int SymmetricEigensolver<Real>::Merge(int size, int half, Real* d, Real* z,
+    Real rho, Real* eigenvectors, int depth)
+{
+    int const n = size, stride = mSize;
+    unsigned int const numThreads = std::max(mNumThreads >> depth, 1u);
+
+    // Normalize z, which has length sqrt(2).
+    Real zsqrLength = (Real)0;
+    for (int i = 0; i < n; ++i)
+    {
+        zsqrLength += z[i] * z[i];
+    }
+    Real invLength = ((Real)1) / std::sqrt(zsqrLength);
+    for (int i = 0; i < n; ++i)
+    {
+        z[i] *= invLength;
+    }
+    rho *= zsqrLength;
+
+    // Sort d in increasing order.  The halves are already sorted, so the
+    // sort is a merge.  Column i of Q is column sorted[i] of diag(Q0,Q1).
+    // The type of a column is 0 when it is nonzero only in the upper half,
+    // 1 when it is nonzero only in the lower half or 2 when it is dense.
+    std::vector<int> sorted(n);
+    for (int i = 0; i < n; ++i)
+    {
+        sorted[i] = i;
+    }
+    std::inplace_merge(sorted.begin(), sorted.begin() + half, sorted.end(),
+        [d](int i0, int i1) { return d[i0] < d[i1]; });
+
+    std::vector<Real> dsort(n), zsort(n), Q(n * n);
+    std::vector<int> type(n);
+    for (int i = 0; i < n; ++i)
+    {
+        int j = sorted[i];
+        dsort[i] = d[j];
+        zsort[i] = z[j];
+        type[i] = (j < half ? 0 : 1);
+        for (int r = 0; r < n; ++r)
+        {
+            Q[i + n*r] = eigenvectors[j + stride*r];
+        }
+    }
+
+    // Deflate.  An eigenpair of D is (nearly) an eigenpair of D + rho*z*z^T
+    // when rho*|z[i]| is small.  When two eigenvalues of D are nearly equal,
+    // a Givens rotation of their eigenvectors zeros one component of z, and
+    // that eigenpair is deflated.  See LAPACK's DLAED2.
+    Real const epsilon = std::numeric_limits<Real>::epsilon();
+    Real dmax = (Real)0, zmax = (Real)0;
+    for (int i = 0; i < n; ++i)
+    {
+        dmax = std::max(dmax, std::abs(dsort[i]));
+        zmax = std::max(zmax, std::abs(zsort[i]));
+    }
+    Real const tolerance = (Real)8 * epsilon * std::max(dmax, zmax);
+
+    std::vector<int> kept, deflated;
+    kept.reserve(n);
+    deflated.reserve(n);
+    if (rho * zmax <= tolerance)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            deflated.push_back(i);
+        }
+    }
+    else
+    {
+        int previous = -1;
+        for (int i = 0; i < n; ++i)
+        {
+            if (rho * std::abs(zsort[i]) <= tolerance)
+            {
+                deflated.push_back(i);
+                continue;
+            }
+
+            if (previous >= 0)
+            {
+                Real s = zsort[previous], c = zsort[i];
+                Real length = std::sqrt(c * c + s * s);
+                c /= length;
+                s = -s / length;
+                if (std::abs((dsort[i] - dsort[previous]) * c * s) <= tolerance)
+                {
+                    // Rotate columns 'previous' and 'i', which zeros
+                    // zsort[previous].
+                    zsort[i] = length;
+                    zsort[previous] = (Real)0;
+                    for (int r = 0; r < n; ++r)
+                    {
+                        Real& q0 = Q[previous + n*r];
+                        Real& q1 = Q[i + n*r];
+                        Real prd0 = c * q0 + s * q1;
+                        Real prd1 = c * q1 - s * q0;
+                        q0 = prd0;
+                        q1 = prd1;
+                    }
+                    if (type[previous] != type[i])
+                    {
+                        type[i] = 2;
+                    }
+
+                    Real csqr = c * c, ssqr = s * s;
+                    Real dprevious = dsort[previous] * csqr + dsort[i] * ssqr;
+                    dsort[i] = dsort[previous] * ssqr + dsort[i] * csqr;
+                    dsort[previous] = dprevious;
+                    deflated.push_back(previous);
+                }
+                else
+                {
+                    kept.push_back(previous);
+                }
+            }
+            previous = i;
+        }
+        if (previous >= 0)
+        {
+            kept.push_back(previous);
+        }
+    }
+
+    // Solve the secular equation for the k kept eigenvalues, whose d are
+    // increasing.  Row j of delta stores dkept[i] - lambda[j].
+    int const k = static_cast<int>(kept.size());
+    std::vector<Real> dkept(k), zsqr(k), lambda(k), delta(k * k), zhat(k), U(k * k);
+    for (int i = 0; i < k; ++i)
+    {
+        dkept[i] = dsort[kept[i]];
+        zsqr[i] = zsort[kept[i]] * zsort[kept[i]];
+    }
+
+    auto solve = [&](int jmin, int jmax)
+    {
+        for (int j = jmin; j < jmax; ++j)
+        {
+            SolveSecularEquation(j, k, &dkept[0], &zsqr[0], rho, lambda[j],
+                &delta[j * k]);
+        }
+    };
+
+    if (numThreads > 1 && k >= 256)
+    {
+        std::vector<std::thread> workers(numThreads - 1);
+        for (unsigned int t = 1; t < numThreads; ++t)
+        {
+            int jmin = static_cast<int>(k * t / numThreads);
+            int jmax = static_cast<int>(k * (t + 1) / numThreads);
+            workers[t - 1] = std::thread([&solve, jmin, jmax]()
+            {
+                solve(jmin, jmax);
+            });
+        }
+        solve(0, static_cast<int>(k / numThreads));
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    else
+    {
+        solve(0, k);
+    }
+
+    // Compute the z for which the lambda are the exact eigenvalues of
+    // D + rho*z*z^T (Gu and Eisenstat), and then the eigenvectors
+    // u[j] = (D - lambda[j]*I)^{-1}*z as the columns of the k-by-k matrix U.
+    for (int i = 0; i < k; ++i)
+    {
+        Real product = -delta[i * k + i];
+        for (int j = 0; j < k; ++j)
+        {
+            if (j != i)
+            {
+                product *= delta[j * k + i] / (dkept[i] - dkept[j]);
+            }
+        }
+        Real zabs = std::sqrt(std::abs(product) / rho);
+        zhat[i] = (zsort[kept[i]] >= (Real)0 ? zabs : -zabs);
+    }
+
+    for (int j = 0; j < k; ++j)
+    {
+        Real sqrLength = (Real)0;
+        for (int i = 0; i < k; ++i)
+        {
+            Real value = zhat[i] / delta[j * k + i];
+            U[i * k + j] = value;
+            sqrLength += value * value;
+        }
+        Real invLength = ((Real)1) / std::sqrt(sqrLength);
+        for (int i = 0; i < k; ++i)
+        {
+            U[i * k + j] *= invLength;
+        }
+    }
+
+    // Sort the eigenvalues.  The eigenvalue of position[i] is lambda[i] for
+    // i < k or dsort[deflated[i-k]] for i >= k.
+    std::vector<int> position(n);
+    {
+        std::vector<Real> values(n);
+        std::vector<int> order(n);
+        for (int i = 0; i < n; ++i)
+        {
+            values[i] = (i < k ? lambda[i] : dsort[deflated[i - k]]);
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(),
+            [&values](int i0, int i1) { return values[i0] < values[i1]; });
+        for (int i = 0; i < n; ++i)
+        {
+            position[order[i]] = i;
+            d[i] = values[order[i]];
+        }
+    }
+
+    // The eigenvectors are Q(:,kept)*U and Q(:,deflated).  Rows 0 through
+    // half-1 of Q(:,kept) are zero in the columns of type 1 and rows half
+    // through n-1 are zero in the columns of type 0, so the product is
+    // computed in two parts that skip those columns.
+    std::vector<Real> product(n * k);
+    BlockedMatrixProduct<Real> multiplier(numThreads);
+    for (int part = 0; part < 2; ++part)
+    {
+        int const rmin = (part == 0 ? 0 : half);
+        int const rmax = (part == 0 ? half : n);
+        int const skip = (part == 0 ? 1 : 0);
+        std::vector<int> columns;
+        for (int i = 0; i < k; ++i)
+        {
+            if (type[kept[i]] != skip)
+            {
+                columns.push_back(i);
+            }
+        }
+
+        int const numRows = rmax - rmin;
+        int const numColumns = static_cast<int>(columns.size());
+        if (numColumns == 0)
+        {
+            std::fill(product.begin() + rmin * k, product.begin() + rmax * k, (Real)0);
+            continue;
+        }
+
+        std::vector<Real> Qpart(numRows * numColumns), Upart(numColumns * k);
+        for (int c = 0; c < numColumns; ++c)
+        {
+            int i = columns[c];
+            for (int r = 0; r < numRows; ++r)
+            {
+                Qpart[c + numColumns * r] = Q[kept[i] + n * (rmin + r)];
+            }
+            std::copy(&U[i * k], &U[i * k] + k, &Upart[c * k]);
+        }
+
+        multiplier.Multiply(numRows, k, numColumns, &Qpart[0], numColumns, 1,
+            &Upart[0], k, 1, &product[rmin * k], k, 1);
+    }
+
+    for (int r = 0; r < n; ++r)
+    {
+        Real* target = eigenvectors + stride*r;
+        for (int j = 0; j < k; ++j)
+        {
+            target[position[j]] = product[j + k*r];
+        }
+        for (int j = k; j < n; ++j)
+        {
+            target[position[j]] = Q[deflated[j - k] + n*r];
+        }
+    }
+
+    // The eigenvectors are diag(Q0,Q1)*P*G*M, where P is the permutation
+    // matrix of 'sorted', G is the product of the Givens rotations and M
+    // maps column kept[j] to position[j] with U and column deflated[j-k]
+    // to position[j].  The determinant of U is (-1)^k times the product of
+    // the signs of zhat, because U is a Cauchy matrix with scaled rows and
+    // columns whose determinant has the sign (-1)^k when d and lambda
+    // interlace.
+    std::vector<int> mapping(n);
+    for (int j = 0; j < n; ++j)
+    {
+        mapping[j < k ? kept[j] : deflated[j - k]] = position[j];
+    }
+
+    int determinant = GetPermutationSign(sorted) * GetPermutationSign(mapping);
+    if (k & 1)
+    {
+        determinant = -determinant;
+    }
+    for (int i = 0; i < k; ++i)
+    {
+        if (zhat[i] < (Real)0)
+        {
+            determinant = -determinant;
+        }
+    }
+    return determinant;
+}
+
+template <typename Real>
+void SymmetricEigensolver<Real>::SolveSecularEquation(int j, int size,
+    Real const* d, Real const* zsqr, Real rho, Real& lambda, Real* delta)
+{
+    // The root is computed as lambda = d[origin] + tau.  The function
+    // f(tau) = 1/rho + sum_i zsqr[i]/(d[i] - d[origin] - tau) is increasing
+    // on the interval (lower,upper) that contains the root.
+    int const n = size;
+    Real const invRho = ((Real)1) / rho;
+    Real const epsilon = std::numeric_limits<Real>::epsilon();
+    int origin;
+    Real lower, upper;
+    if (j < n - 1)
+    {
+        // Choose the pole closer to the root by the sign of f at the
+        // midpoint of the interval.
+        Real halfGap = (d[j + 1] - d[j]) * (Real)0.5;
+        Real f = invRho;
+        for (int i = 0; i < n; ++i)
+        {
+            f += zsqr[i] / ((d[i] - d[j]) - halfGap);
+        }
+
+        if (f >= (Real)0)
+        {
+            origin = j;
+            lower = (Real)0;
+            upper = halfGap;
+        }
+        else
+        {
+            origin = j + 1;
+            lower = -halfGap;
+            upper = (Real)0;
+        }
+    }
+    else
+    {
+        // The root is in (d[n-1],d[n-1] + rho*Dot(z,z)).
+        Real sum = (Real)0;
+        for (int i = 0; i < n; ++i)
+        {
+            sum += zsqr[i];
+        }
+        origin = j;
+        lower = (Real)0;
+        upper = rho * sum;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        delta[i] = d[i] - d[origin];
+    }
+
+    // Each iteration models f by the terms of the poles d[j] and d[j+1],
+    // with weights chosen to match the derivatives of the sums of the terms
+    // for i <= j and i > j, plus a constant (the "middle way" of LAPACK's
+    // DLAED4).  The root of the model is the next iterate unless it is not
+    // in the current interval, in which case the interval is bisected.
+    int const maxIterations = 256;
+    Real tau = (lower + upper) * (Real)0.5;
+    for (int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        Real psi = (Real)0, dpsi = (Real)0, phi = (Real)0, dphi = (Real)0;
+        for (int i = 0; i <= j; ++i)
+        {
+            Real term = zsqr[i] / (delta[i] - tau);
+            psi += term;
+            dpsi += term / (delta[i] - tau);
+        }
+        for (int i = j + 1; i < n; ++i)
+        {
+            Real term = zsqr[i] / (delta[i] - tau);
+            phi += term;
+            dphi += term / (delta[i] - tau);
+        }
+
+        Real f = invRho + psi + phi;
+        Real bound = epsilon * ((Real)8 * (phi - psi) + (Real)2 * invRho +
+            (Real)3 * std::abs(tau) * (dpsi + dphi));
+        if (std::abs(f) <= bound)
+        {
+            break;
+        }
+
+        if (f > (Real)0)
+        {
+            upper = tau;
+        }
+        else
+        {
+            lower = tau;
+        }
+
+        Real eta = (Real)0;
+        bool valid = false;
+        Real dj = delta[j] - tau;
+        if (j < n - 1)
+        {
+            // Solve c + s/(dj - eta) + t/(dj1 - eta) = 0 for eta in
+            // (dj,dj1), which is c*eta^2 - a*eta + b = 0.
+            Real dj1 = delta[j + 1] - tau;
+            Real s = dj * dj * dpsi, t = dj1 * dj1 * dphi;
+            Real c = f - dj * dpsi - dj1 * dphi;
+            Real a = c * (dj + dj1) + s + t;
+            Real b = c * dj * dj1 + s * dj1 + t * dj;
+            if (c != (Real)0)
+            {
+                Real discr = std::sqrt(std::abs(a * a - (Real)4 * b * c));
+                Real q = (a >= (Real)0 ? a + discr : a - discr) * (Real)0.5;
+                if (q != (Real)0)
+                {
+                    Real eta0 = q / c, eta1 = b / q;
+                    eta = (dj < eta0 && eta0 < dj1 ? eta0 : eta1);
+                    valid = true;
+                }
+            }
+            else if (a != (Real)0)
+            {
+                eta = b / a;
+                valid = true;
+            }
+        }
+        else
+        {
+            // Solve c + s/(dj - eta) = 0.
+            Real s = dj * dj * dpsi;
+            Real c = f - dj * dpsi;
+            if (c != (Real)0)
+            {
+                eta = dj + s / c;
+                valid = true;
+            }
+        }
+
+        Real next = tau + eta;
+        if (!valid || !(lower < next && next < upper))
+        {
+            next = (lower + upper) * (Real)0.5;
+        }
+
+        if (next == tau || upper - lower <= (Real)2 * epsilon *
+            std::max(std::abs(lower), std::abs(upper)))
+        {
+            break;
+        }
+        tau = next;
+    }
+
+    lambda = d[origin] + tau;
+    for (int i = 0; i < n; ++i)
+    {
+        delta[i] -= tau;
+    }
+}
+
+template <typename Real>
+int SymmetricEigensolver<Real>::GetPermutationSign(
+    std::vector<int> const& permutation)
+{
+    // The sign is (-1)^(n - c), where c is the number of cycles.
+    int const n = static_cast<int>(permutation.size());
+    std::vector<char> visited(n, 0);
+    int numCycles = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (!visited[i])
+        {
+            ++numCycles;
+            for (int j = i; !visited[j]; j = permutation[j])
+            {
+                visited[j] = 1;
+            }
+        }
+    }
+    return ((n - numCycles) & 1 ? -1 : 1);
+}
+
 template <typename Real>
 void SymmetricEigensolver<Real>::ComputePermutation(int sortType)
 {
-    // The number of Householder reflections is H = mSize - 2.  If H is
-    // even, the product of Householder reflections is a rotation;
-    // otherwise, H is odd and the product is a reflection.  The number 
-    // of Givens rotations does not influence the type of the product of
-    // Householder reflections.
-    mEigenvectorMatrixType = 1 - (mSize & 1);
+    mEigenvectorMatrixType = GetUnsortedMatrixType();
 
     if (sortType == 0)
     {
@@ -813,6 +1795,17 @@ void SymmetricEigensolver<Real>::ComputePermutation(int sortType)
     //   eigenitem[i3] = save;
 }
 
+template <typename Real>
+int SymmetricEigensolver<Real>::GetUnsortedMatrixType() const
+{
+    // Each Householder reflection that is not the identity has determinant
+    // -1 and each Givens rotation has determinant +1.  The eigenvectors of
+    // the tridiagonal matrix computed by divide-and-conquer have
+    // determinant mTDeterminant.
+    int determinant = ((mNumReflections & 1) ? -mTDeterminant : mTDeterminant);
+    return (determinant > 0 ? 1 : 0);
+}
+
 template <typename Real>
 SymmetricEigensolver<Real>::GivensRotation::GivensRotation()
 {
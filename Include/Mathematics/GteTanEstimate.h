@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.2 (2019/09/22)
 
 #pragma once
 
-#include <Mathematics/GteMath.h>
+#include <Mathematics/GteArrayEstimate.h>
 
 // Minimax polynomial approximations to tan(x).  The polynomial p(x) of
 // degree D has only odd-power terms, is required to have linear term x,
@@ -40,6 +40,21 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Array versions of Degree and DegreeRR.  The estimates are computed
+    // for x[i] and stored in y[i] for 0 <= i < numElements, and x and y may
+    // be the same array.  The range reductions are branch-free rewrites of
+    // the scalar ones so that the compiler can vectorize the loops; see
+    // GteArrayEstimate.h.
+    //
+    // The array reduction computes x - pi*trunc(x/pi) instead of
+    // fmod(x,pi), which does not vectorize.  The two differ only by
+    // rounding errors that grow with |x|.
+    template <int D>
+    static void Degree(size_t numElements, Real const* x, Real* y);
+
+    template <int D>
+    static void DegreeRR(size_t numElements, Real const* x, Real* y);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -85,6 +100,37 @@ inline Real TanEstimate<Real>::DegreeRR(Real x)
     }
 }
 
+template <typename Real>
+template <int D>
+void TanEstimate<Real>::Degree(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y,
+        [](Real v) { return Evaluate(degree<D>(), v); });
+}
+
+template <typename Real>
+template <int D>
+void TanEstimate<Real>::DegreeRR(size_t numElements, Real const* x, Real* y)
+{
+    ArrayEstimate<Real>::Apply(numElements, x, y, [](Real v)
+    {
+        Real r = v - (Real)GTE_C_PI * (Real)((int)((Real)GTE_C_INV_PI * v));
+        r -= (Real)(std::abs(r) > (Real)GTE_C_HALF_PI)
+            * std::copysign((Real)GTE_C_PI, r);
+
+        // The three cases of the scalar DegreeRR are combined into
+        // numer/denom with the polynomial evaluated once.  The comparison
+        // is converted to 0 or 1 so that there are no selections, and the
+        // arithmetic is the same as that of the scalar code.
+        Real sign = (Real)(std::abs(r) > (Real)GTE_C_QUARTER_PI)
+            * std::copysign((Real)1, r);
+        Real poly = Evaluate(degree<D>(), r - sign * (Real)GTE_C_QUARTER_PI);
+        Real numer = poly + sign;
+        Real denom = (Real)1 - sign * poly;
+        return numer / denom;
+    });
+}
+
 template <typename Real>
 inline Real TanEstimate<Real>::Evaluate(degree<3>, Real x)
 {
@@ -0,0 +1,432 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/03)
+
+#pragma once
+
+#include <Mathematics/GteAlignedBox.h>
+#include <Mathematics/GteIntrTriangle3Triangle3.h>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
+// Compute all pairs of intersecting triangles between two triangle meshes.
+// A bounding volume hierarchy (BVH) of axis-aligned boxes is built for each
+// mesh.  The two hierarchies are traversed simultaneously, descending only
+// into pairs of nodes whose boxes overlap, so that the number of
+// triangle-triangle queries is proportional to the number of triangles
+// near the intersection curve rather than to the product of the numbers of
+// triangles.  The brute-force alternative is the all-pairs comparison in the
+// AllPairsTriangles sample.
+//
+// The hierarchies are built once per mesh topology.  When the vertices of
+// a mesh move (rigidly or by deformation) but the triangles do not change,
+// call UpdateMesh0 or UpdateMesh1 to refit the boxes bottom-up in linear
+// time; the tree structure is preserved.  The fitted boxes are not as tight
+// as rebuilt ones after large deformations, in which case call SetMesh0 or
+// SetMesh1 to rebuild.
+
+namespace gte
+{
+    template <typename Real>
+    class TriangleMeshIntersection3
+    {
+    public:
+        // The 'indices' are lookups into the 'vertices' array.  The number
+        // of indices must be a multiple of 3, each triple representing a
+        // triangle.  If t is a triangle index, the triangle is formed by
+        // vertices[indices[3 * t + i]] for 0 <= i <= 2.
+        //
+        // The traversal of the hierarchies is multithreaded when
+        // numThreads > 1; choose 1 <= numThreads <=
+        // std::thread::hardware_concurrency().  The leaves of the
+        // hierarchies store at most maxLeafTriangles triangles.
+        TriangleMeshIntersection3(unsigned int numThreads = 1, int maxLeafTriangles = 4)
+            :
+            mNumThreads(numThreads > 0 ? numThreads : 1),
+            mMaxLeafTriangles(maxLeafTriangles > 0 ? maxLeafTriangles : 1)
+        {
+        }
+
+        struct Intersection
+        {
+            // Triangle indices: triangle[0] for mesh0, triangle[1] for mesh1.
+            std::array<int, 2> triangle;
+
+            // The set of intersection when the triangles are not coplanar.
+            // When 'isCoplanar' is true, the segment is not computed.
+            bool isCoplanar;
+            Segment3<Real> segment;
+
+            bool operator<(Intersection const& other) const
+            {
+                return triangle < other.triangle;
+            }
+        };
+
+        // Build the bounding volume hierarchies.
+        void SetMesh0(std::vector<Vector3<Real>> const& vertices, std::vector<int> const& indices)
+        {
+            mHierarchy[0].Build(vertices, indices, mMaxLeafTriangles);
+        }
+
+        void SetMesh1(std::vector<Vector3<Real>> const& vertices, std::vector<int> const& indices)
+        {
+            mHierarchy[1].Build(vertices, indices, mMaxLeafTriangles);
+        }
+
+        // Refit the bounding volume hierarchies after the vertices have
+        // moved.  The number of vertices must be the same as that passed to
+        // the corresponding SetMesh* call.
+        void UpdateMesh0(std::vector<Vector3<Real>> const& vertices)
+        {
+            mHierarchy[0].Refit(vertices);
+        }
+
+        void UpdateMesh1(std::vector<Vector3<Real>> const& vertices)
+        {
+            mHierarchy[1].Refit(vertices);
+        }
+
+        // Compute the intersecting pairs of triangles.  The output is sorted
+        // by the triangle indices.  The return value is true when at least
+        // one pair of triangles intersects.
+        bool operator()(std::vector<Intersection>& intersections)
+        {
+            intersections.clear();
+            if (mHierarchy[0].nodes.size() == 0 || mHierarchy[1].nodes.size() == 0)
+            {
+                return false;
+            }
+
+            if (mNumThreads > 1)
+            {
+                // Expand the root pair breadth-first to obtain enough work
+                // items to distribute among the threads.
+                std::vector<NodePair> frontier;
+                GetFrontier(frontier);
+                unsigned int const numPairs = static_cast<unsigned int>(frontier.size());
+
+                std::vector<std::vector<Intersection>> output(mNumThreads);
+                std::vector<std::thread> process(mNumThreads);
+                for (unsigned int t = 0; t < mNumThreads; ++t)
+                {
+                    process[t] = std::thread([this, t, numPairs, &frontier, &output]()
+                    {
+                        std::vector<NodePair> stack;
+                        for (unsigned int j = t; j < numPairs; j += mNumThreads)
+                        {
+                            Traverse(frontier[j], stack, output[t]);
+                        }
+                    });
+                }
+
+                for (unsigned int t = 0; t < mNumThreads; ++t)
+                {
+                    process[t].join();
+                    intersections.insert(intersections.end(), output[t].begin(), output[t].end());
+                }
+            }
+            else
+            {
+                std::vector<NodePair> stack;
+                Traverse(NodePair{ 0, 0 }, stack, intersections);
+            }
+
+            std::sort(intersections.begin(), intersections.end());
+            return intersections.size() > 0;
+        }
+
+        // Member access.  The number of nodes of a hierarchy is 0 when its
+        // mesh has not been set.
+        inline size_t GetNumNodes(int i) const
+        {
+            return mHierarchy[i].nodes.size();
+        }
+
+    private:
+        class Hierarchy
+        {
+        public:
+            // A node is a leaf when child[0] is -1, in which case the
+            // triangles are triangles[first] through
+            // triangles[first + count - 1].  The children of an interior
+            // node have larger indices than the node itself, which allows a
+            // bottom-up refit by a reverse iteration over the nodes.
+            struct Node
+            {
+                AlignedBox3<Real> box;
+                std::array<int, 2> child;
+                int first, count;
+            };
+
+            void Build(std::vector<Vector3<Real>> const& inVertices,
+                std::vector<int> const& inIndices, int maxLeafTriangles)
+            {
+                vertices = inVertices;
+                indices = inIndices;
+                nodes.clear();
+
+                int const numTriangles = static_cast<int>(indices.size() / 3);
+                if (numTriangles == 0)
+                {
+                    return;
+                }
+
+                triangles.resize(numTriangles);
+                centroids.resize(numTriangles);
+                for (int t = 0; t < numTriangles; ++t)
+                {
+                    triangles[t] = t;
+                    centroids[t] = (vertices[indices[3 * t]] +
+                        vertices[indices[3 * t + 1]] +
+                        vertices[indices[3 * t + 2]]) / (Real)3;
+                }
+
+                // A binary tree with L leaves has 2*L-1 nodes.
+                nodes.reserve(2 * (numTriangles / maxLeafTriangles + 1));
+                BuildNode(0, numTriangles, maxLeafTriangles);
+                centroids.clear();
+            }
+
+            void Refit(std::vector<Vector3<Real>> const& inVertices)
+            {
+                vertices = inVertices;
+                for (int n = static_cast<int>(nodes.size()) - 1; n >= 0; --n)
+                {
+                    Node& node = nodes[n];
+                    if (node.child[0] == -1)
+                    {
+                        node.box = ComputeBox(node.first, node.count);
+                    }
+                    else
+                    {
+                        AlignedBox3<Real> const& box0 = nodes[node.child[0]].box;
+                        AlignedBox3<Real> const& box1 = nodes[node.child[1]].box;
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            node.box.min[j] = std::min(box0.min[j], box1.min[j]);
+                            node.box.max[j] = std::max(box0.max[j], box1.max[j]);
+                        }
+                    }
+                }
+            }
+
+            inline Triangle3<Real> GetTriangle(int t) const
+            {
+                return Triangle3<Real>(vertices[indices[3 * t]],
+                    vertices[indices[3 * t + 1]], vertices[indices[3 * t + 2]]);
+            }
+
+            std::vector<Vector3<Real>> vertices;
+            std::vector<int> indices;
+            std::vector<Node> nodes;
+            std::vector<int> triangles;
+
+        private:
+            int BuildNode(int first, int count, int maxLeafTriangles)
+            {
+                int const n = static_cast<int>(nodes.size());
+                nodes.push_back(Node());
+                nodes[n].box = ComputeBox(first, count);
+                nodes[n].first = first;
+                nodes[n].count = count;
+
+                if (count <= maxLeafTriangles)
+                {
+                    nodes[n].child = { -1, -1 };
+                    return n;
+                }
+
+                // Split at the median centroid along the axis of largest
+                // extent of the centroids.
+                Vector3<Real> cmin = centroids[triangles[first]], cmax = cmin;
+                for (int i = first + 1; i < first + count; ++i)
+                {
+                    Vector3<Real> const& c = centroids[triangles[i]];
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        cmin[j] = std::min(cmin[j], c[j]);
+                        cmax[j] = std::max(cmax[j], c[j]);
+                    }
+                }
+                Vector3<Real> extent = cmax - cmin;
+                int axis = 0;
+                if (extent[1] > extent[axis])
+                {
+                    axis = 1;
+                }
+                if (extent[2] > extent[axis])
+                {
+                    axis = 2;
+                }
+
+                int half = count / 2;
+                std::nth_element(triangles.begin() + first,
+                    triangles.begin() + first + half,
+                    triangles.begin() + first + count,
+                    [this, axis](int t0, int t1)
+                    {
+                        return centroids[t0][axis] < centroids[t1][axis];
+                    });
+
+                // The nodes array might be reallocated by the recursive
+                // calls, so do not hold a reference to nodes[n].
+                int child0 = BuildNode(first, half, maxLeafTriangles);
+                int child1 = BuildNode(first + half, count - half, maxLeafTriangles);
+                nodes[n].child = { child0, child1 };
+                return n;
+            }
+
+            AlignedBox3<Real> ComputeBox(int first, int count) const
+            {
+                AlignedBox3<Real> box;
+                box.min = vertices[indices[3 * triangles[first]]];
+                box.max = box.min;
+                for (int i = first; i < first + count; ++i)
+                {
+                    int const* tri = &indices[3 * triangles[i]];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        Vector3<Real> const& v = vertices[tri[k]];
+                        for (int j = 0; j < 3; ++j)
+                        {
+                            box.min[j] = std::min(box.min[j], v[j]);
+                            box.max[j] = std::max(box.max[j], v[j]);
+                        }
+                    }
+                }
+                return box;
+            }
+
+            std::vector<Vector3<Real>> centroids;
+        };
+
+        struct NodePair
+        {
+            int n0, n1;
+        };
+
+        inline bool Overlap(NodePair const& pair) const
+        {
+            AlignedBox3<Real> const& box0 = mHierarchy[0].nodes[pair.n0].box;
+            AlignedBox3<Real> const& box1 = mHierarchy[1].nodes[pair.n1].box;
+            for (int j = 0; j < 3; ++j)
+            {
+                if (box0.max[j] < box1.min[j] || box0.min[j] > box1.max[j])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Push the children of an overlapping pair.  The node with the
+        // larger number of triangles is split so that the boxes being
+        // compared have comparable sizes.  The return value is false when
+        // both nodes are leaves.
+        template <typename Container>
+        bool Descend(NodePair const& pair, Container& container) const
+        {
+            auto const& node0 = mHierarchy[0].nodes[pair.n0];
+            auto const& node1 = mHierarchy[1].nodes[pair.n1];
+            bool leaf0 = (node0.child[0] == -1), leaf1 = (node1.child[0] == -1);
+            if (leaf0 && leaf1)
+            {
+                return false;
+            }
+
+            if (leaf1 || (!leaf0 && node0.count >= node1.count))
+            {
+                container.push_back(NodePair{ node0.child[0], pair.n1 });
+                container.push_back(NodePair{ node0.child[1], pair.n1 });
+            }
+            else
+            {
+                container.push_back(NodePair{ pair.n0, node1.child[0] });
+                container.push_back(NodePair{ pair.n0, node1.child[1] });
+            }
+            return true;
+        }
+
+        void GetFrontier(std::vector<NodePair>& frontier) const
+        {
+            size_t const desired = 8 * static_cast<size_t>(mNumThreads);
+            frontier.clear();
+            frontier.push_back(NodePair{ 0, 0 });
+
+            std::vector<NodePair> next;
+            bool expanded = true;
+            while (expanded && frontier.size() > 0 && frontier.size() < desired)
+            {
+                expanded = false;
+                next.clear();
+                for (auto const& pair : frontier)
+                {
+                    if (Overlap(pair))
+                    {
+                        if (Descend(pair, next))
+                        {
+                            expanded = true;
+                        }
+                        else
+                        {
+                            next.push_back(pair);
+                        }
+                    }
+                }
+                std::swap(frontier, next);
+            }
+        }
+
+        void Traverse(NodePair const& root, std::vector<NodePair>& stack,
+            std::vector<Intersection>& intersections) const
+        {
+            FIQuery<Real, Triangle3<Real>, Triangle3<Real>> query;
+            Hierarchy const& h0 = mHierarchy[0];
+            Hierarchy const& h1 = mHierarchy[1];
+
+            stack.clear();
+            stack.push_back(root);
+            while (stack.size() > 0)
+            {
+                NodePair pair = stack.back();
+                stack.pop_back();
+                if (!Overlap(pair) || Descend(pair, stack))
+                {
+                    continue;
+                }
+
+                // Both nodes are leaves.  Compare their triangles.
+                auto const& node0 = h0.nodes[pair.n0];
+                auto const& node1 = h1.nodes[pair.n1];
+                for (int i0 = node0.first; i0 < node0.first + node0.count; ++i0)
+                {
+                    int t0 = h0.triangles[i0];
+                    Triangle3<Real> triangle0 = h0.GetTriangle(t0);
+                    for (int i1 = node1.first; i1 < node1.first + node1.count; ++i1)
+                    {
+                        int t1 = h1.triangles[i1];
+                        auto result = query(triangle0, h1.GetTriangle(t1));
+                        if (result.intersect)
+                        {
+                            Intersection intersection;
+                            intersection.triangle = { t0, t1 };
+                            intersection.isCoplanar = result.isCoplanar;
+                            intersection.segment = result.segment;
+                            intersections.push_back(intersection);
+                        }
+                    }
+                }
+            }
+        }
+
+        unsigned int mNumThreads;
+        int mMaxLeafTriangles;
+        std::array<Hierarchy, 2> mHierarchy;
+    };
+}
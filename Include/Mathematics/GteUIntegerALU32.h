@@ -3,16 +3,30 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2017/07/04)
+// File Version: 3.0.3 (2019/09/26)
 
 #pragma once
 
 #include <Mathematics/GteBitHacks.h>
 #include <algorithm>
+#include <array>
+#include <vector>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 // Support for unsigned integer arithmetic in BSNumber and BSRational.  The
 // Curiously Recurring Template Paradigm is used to allow the UInteger
 // types to share code without introducing virtual functions.
+//
+// The numbers are stored as 32-bit blocks, but Mul processes them as 64-bit
+// limbs (pairs of blocks).  The 64x64-bit limb products use unsigned
+// __int128 (GCC, Clang) or _umul128 (MSVC x64) when available and four
+// 32x32-bit products otherwise.  Operands with at least KARATSUBA_THRESHOLD
+// limbs are multiplied using Karatsuba's method, which requires
+// O(n^{log2(3)}) limb products instead of O(n^2).  This matters for the
+// very large numbers that occur in BSRational computations; see the table
+// of sizes in GtePrimalQuery3.h.
 
 namespace gte
 {
@@ -35,19 +49,40 @@ public:
     // Arithmetic operations.  These are performed in-place; that is, the
     // result is stored in 'this' object.  The goal is to reduce the number of
     // object copies, much like the goal is for std::move.  The Sub function
-    // requires the inputs to satisfy n0 > n1.
-    void Add(UInteger const& n0, UInteger const& n1);
-    void Sub(UInteger const& n0, UInteger const& n1);
-    void Mul(UInteger const& n0, UInteger const& n1);
+    // requires the inputs to satisfy n0 > n1.  The inputs may have types
+    // other than UInteger that have the same interface, for example
+    // UIntegerFP32 with smaller N (see GteBSTerm.h), provided that 'this'
+    // object can store the result.
+    template <typename UInteger0, typename UInteger1>
+    void Add(UInteger0 const& n0, UInteger1 const& n1);
+
+    template <typename UInteger0, typename UInteger1>
+    void Sub(UInteger0 const& n0, UInteger1 const& n1);
+
+    template <typename UInteger0, typename UInteger1>
+    void Mul(UInteger0 const& n0, UInteger1 const& n1);
+
+    // Mul uses an array of 64-bit limbs for the inputs, the product and the
+    // scratch memory of Karatsuba's method.  It is on the stack when it is
+    // small and on the heap otherwise.  A caller that can bound the sizes
+    // (BSTerm) may supply it instead; it must have at least
+    // GetMulStorageSize(n0.GetSize(), n1.GetSize()) elements.
+    template <typename UInteger0, typename UInteger1>
+    void Mul(UInteger0 const& n0, UInteger1 const& n1, uint64_t* storage);
+
+    static inline size_t GetMulStorageSize(int32_t numElements0,
+        int32_t numElements1);
 
     // The shift is performed in-place; that is, the result is stored in
     // 'this' object.
-    void ShiftLeft(UInteger const& number, int32_t shift);
+    template <typename UIntegerN>
+    void ShiftLeft(UIntegerN const& number, int32_t shift);
 
     // The 'number' is even and positive.  It is shifted right to become an
     // odd number and the return value is the amount shifted.  The operation
     // is performed in-place; that is, the result is stored in 'this' object.
-    int32_t ShiftRightToOdd(UInteger const& number);
+    template <typename UIntegerN>
+    int32_t ShiftRightToOdd(UIntegerN const& number);
 
     // Get a block of numRequested bits starting with the leading 1-bit of the
     // nonzero number.  The returned number has the prefix stored in the
@@ -55,6 +90,31 @@ public:
     // rounding.  This function supports conversions from 'float' and 'double'.
     // The input 'numRequested' is smaller than 64.
     uint64_t GetPrefix(int32_t numRequested) const;
+
+    // The minimum number of 64-bit limbs of both operands for which Mul uses
+    // Karatsuba's method.  Below it the schoolbook method is faster.
+    enum { KARATSUBA_THRESHOLD = 32 };
+
+private:
+    // Support for Mul.  The limb arrays store the least significant limb
+    // first.  MulLimbs computes product = u0*u1, where product has n0+n1
+    // limbs.  The scratch array must have at least GetScratchSize(n0,n1)
+    // limbs.
+    static inline uint64_t MulAdd(uint64_t a, uint64_t b, uint64_t c0,
+        uint64_t c1, uint64_t& high);
+    static void MulSchoolbook(uint64_t const* u0, int32_t n0,
+        uint64_t const* u1, int32_t n1, uint64_t* product);
+    static void MulLimbs(uint64_t const* u0, int32_t n0, uint64_t const* u1,
+        int32_t n1, uint64_t* product, uint64_t* scratch);
+    static inline size_t GetScratchSize(int32_t n0, int32_t n1);
+
+    // target[0..numTarget) += source[0..numSource) or -= source[0..numSource)
+    // with numTarget >= numSource.  The carry or borrow is propagated through
+    // the target and the final carry or borrow is returned.
+    static uint64_t AddLimbs(uint64_t* target, int32_t numTarget,
+        uint64_t const* source, int32_t numSource);
+    static uint64_t SubLimbs(uint64_t* target, int32_t numTarget,
+        uint64_t const* source, int32_t numSource);
 };
 
 
@@ -170,7 +230,8 @@ bool UIntegerALU32<UInteger>::operator>=(UInteger const& number) const
 }
 
 template <typename UInteger>
-void UIntegerALU32<UInteger>::Add(UInteger const& n0, UInteger const& n1)
+template <typename UInteger0, typename UInteger1>
+void UIntegerALU32<UInteger>::Add(UInteger0 const& n0, UInteger1 const& n1)
 {
     UInteger& self = *(UInteger*)this;
     int32_t n0NumBits = n0.GetNumBits();
@@ -187,10 +248,10 @@ void UIntegerALU32<UInteger>::Add(UInteger const& n0, UInteger const& n1)
     int32_t numElements1 = n1.GetSize();
 
     // Order the inputs so that the first has the most blocks.
-    auto const& u0 =
-        (numElements0 >= numElements1 ? n0.GetBits() : n1.GetBits());
-    auto const& u1 =
-        (numElements0 >= numElements1 ? n1.GetBits() : n0.GetBits());
+    uint32_t const* u0 =
+        (numElements0 >= numElements1 ? &n0.GetBits()[0] : &n1.GetBits()[0]);
+    uint32_t const* u1 =
+        (numElements0 >= numElements1 ? &n1.GetBits()[0] : &n0.GetBits()[0]);
     auto numElements = std::minmax(numElements0, numElements1);
 
     // Add the u1-blocks to u0-blocks.
@@ -237,61 +298,43 @@ void UIntegerALU32<UInteger>::Add(UInteger const& n0, UInteger const& n1)
 }
 
 template <typename UInteger>
-void UIntegerALU32<UInteger>::Sub(UInteger const& n0, UInteger const& n1)
+template <typename UInteger0, typename UInteger1>
+void UIntegerALU32<UInteger>::Sub(UInteger0 const& n0, UInteger1 const& n1)
 {
     UInteger& self = *(UInteger*)this;
     int32_t n0NumBits = n0.GetNumBits();
     auto const& n0Bits = n0.GetBits();
     auto const& n1Bits = n1.GetBits();
 
-    // Subtract the numbers considered as positive integers.  We know that
-    // n0 > n1, so create a number n2 that has the same number of bits as
-    // n0 and use two's-complement to generate -n2, and then add n0 and -n2.
-    // The result is nonnegative, so we do not need to apply two's complement
-    // to a negative result to extract the sign and absolute value.
+    // Subtract the numbers considered as positive integers, propagating the
+    // borrow from one block to the next.  We know that n0 > n1, so the
+    // result is positive and has at most the number of bits of n0.  The
+    // difference of two blocks minus the borrow is computed in 64-bit
+    // arithmetic; a borrow occurs when the difference wraps around, in which
+    // case bit 63 is set.
 
     // Get the input array sizes.  We know numElements0 >= numElements1.
     int32_t numElements0 = n0.GetSize();
     int32_t numElements1 = n1.GetSize();
 
-    // Create the two's-complement number n2.  We know n2.GetNumElements() is
-    // the same as numElements0.
-    UInteger n2(n0NumBits);
-    auto& n2Bits = n2.GetBits();
+    self.SetNumBits(n0NumBits);
+    auto& bits = self.GetBits();
+    uint64_t borrow = 0, diff;
     int32_t i;
     for (i = 0; i < numElements1; ++i)
     {
-        n2Bits[i] = ~n1Bits[i];
+        diff = (uint64_t)n0Bits[i] - (uint64_t)n1Bits[i] - borrow;
+        bits[i] = (uint32_t)(diff & 0x00000000FFFFFFFFull);
+        borrow = (diff >> 63);
     }
     for (/**/; i < numElements0; ++i)
     {
-        n2Bits[i] = ~0u;
-    }
-
-    // Now add 1 to the bit-negated result to obtain -n1.
-    uint64_t carry = 1, sum;
-    for (i = 0; i < numElements0; ++i)
-    {
-        sum = n2Bits[i] + carry;
-        n2Bits[i] = (uint32_t)(sum & 0x00000000FFFFFFFFull);
-        carry = (sum >> 32);
-    }
-
-    // Add the numbers as positive integers.  Set the last block to zero in
-    // case no carry-out occurs.
-    self.SetNumBits(n0NumBits + 1);
-    self.SetBack(0);
-
-    // Add the n0-blocks to n2-blocks.
-    auto& bits = self.GetBits();
-    for (i = 0, carry = 0; i < numElements0; ++i)
-    {
-        sum = n2Bits[i] + (n0Bits[i] + carry);
-        bits[i] = (uint32_t)(sum & 0x00000000FFFFFFFFull);
-        carry = (sum >> 32);
+        diff = (uint64_t)n0Bits[i] - borrow;
+        bits[i] = (uint32_t)(diff & 0x00000000FFFFFFFFull);
+        borrow = (diff >> 63);
     }
 
-    // Strip off the bits introduced by two's-complement.
+    // Strip off the leading zero blocks.
     int32_t block;
     for (block = numElements0 - 1; block >= 0; --block)
     {
@@ -305,7 +348,27 @@ void UIntegerALU32<UInteger>::Sub(UInteger const& n0, UInteger const& n1)
 }
 
 template <typename UInteger>
-void UIntegerALU32<UInteger>::Mul(UInteger const& n0, UInteger const& n1)
+template <typename UInteger0, typename UInteger1>
+void UIntegerALU32<UInteger>::Mul(UInteger0 const& n0, UInteger1 const& n1)
+{
+    // Small products, which are the common case for BSNumber, use the stack
+    // to avoid the allocation.
+    size_t const storageSize = GetMulStorageSize(n0.GetSize(), n1.GetSize());
+    std::array<uint64_t, 256> smallStorage;
+    std::vector<uint64_t> largeStorage;
+    uint64_t* storage = smallStorage.data();
+    if (storageSize > smallStorage.size())
+    {
+        largeStorage.resize(storageSize);
+        storage = largeStorage.data();
+    }
+    Mul(n0, n1, storage);
+}
+
+template <typename UInteger>
+template <typename UInteger0, typename UInteger1>
+void UIntegerALU32<UInteger>::Mul(UInteger0 const& n0, UInteger1 const& n1,
+    uint64_t* storage)
 {
     UInteger& self = *(UInteger*)this;
     int32_t n0NumBits = n0.GetNumBits();
@@ -313,69 +376,45 @@ void UIntegerALU32<UInteger>::Mul(UInteger const& n0, UInteger const& n1)
     auto const& n0Bits = n0.GetBits();
     auto const& n1Bits = n1.GetBits();
 
-    // The number of bits is at most this, possibly one bit smaller.
-    int numBits = n0NumBits + n1NumBits;
-    self.SetNumBits(numBits);
-    auto& bits = self.GetBits();
-
-    // Product of a single-block number with a multiple-block number.
-    UInteger product(numBits);
-    auto& pBits = product.GetBits();
-
-    // Get the array sizes.
+    // Get the array sizes in 32-bit blocks and in 64-bit limbs.
     int32_t const numElements0 = n0.GetSize();
     int32_t const numElements1 = n1.GetSize();
-    int32_t const numElements = self.GetSize();
-
-    // Compute the product v = u0*u1.
-    int32_t i0, i1, i2;
-    uint64_t term, sum;
-
-    // The case i0 == 0 is handled separately to initialize the accumulator
-    // with u0[0]*v.  This avoids having to fill the bytes of 'bits' with
-    // zeros outside the double loop, something that can be a performance
-    // issue when 'numBits' is large.
-    uint64_t block0 = n0Bits[0];
-    uint64_t carry = 0;
-    for (i1 = 0; i1 < numElements1; ++i1)
+    int32_t const numLimbs0 = (numElements0 + 1) / 2;
+    int32_t const numLimbs1 = (numElements1 + 1) / 2;
+    int32_t const numLimbs = numLimbs0 + numLimbs1;
+
+    // The limbs of the inputs, of the product and the scratch memory for
+    // Karatsuba's method are stored in one array.
+    uint64_t* u0 = storage;
+    uint64_t* u1 = u0 + numLimbs0;
+    uint64_t* product = u1 + numLimbs1;
+    uint64_t* scratch = product + numLimbs;
+
+    // Pack the blocks into limbs.  The inputs are copied before 'self' is
+    // modified, so 'self' may be one of the inputs.
+    for (int32_t i = 0, j = 0; i < numLimbs0; ++i, j += 2)
     {
-        term = block0 * n1Bits[i1] + carry;
-        bits[i1] = (uint32_t)(term & 0x00000000FFFFFFFFull);
-        carry = (term >> 32);
+        u0[i] = (j + 1 < numElements0 ? (uint64_t)n0Bits[j + 1] << 32 : 0) | n0Bits[j];
     }
-    if (i1 < numElements)
+    for (int32_t i = 0, j = 0; i < numLimbs1; ++i, j += 2)
     {
-        bits[i1] = (uint32_t)(carry & 0x00000000FFFFFFFFull);
+        u1[i] = (j + 1 < numElements1 ? (uint64_t)n1Bits[j + 1] << 32 : 0) | n1Bits[j];
     }
 
-    for (i0 = 1; i0 < numElements0; ++i0)
-    {
-        // Compute the product p = u0[i0]*u1.
-        block0 = n0Bits[i0];
-        carry = 0;
-        for (i1 = 0, i2 = i0; i1 < numElements1; ++i1, ++i2)
-        {
-            term = block0 * n1Bits[i1] + carry;
-            pBits[i2] = (uint32_t)(term & 0x00000000FFFFFFFFull);
-            carry = (term >> 32);
-        }
-        if (i2 < numElements)
-        {
-            pBits[i2] = (uint32_t)(carry & 0x00000000FFFFFFFFull);
-        }
+    MulLimbs(u0, numLimbs0, u1, numLimbs1, product, scratch);
 
-        // Add p to the accumulator v.
-        carry = 0;
-        for (i1 = 0, i2 = i0; i1 < numElements1; ++i1, ++i2)
-        {
-            sum = pBits[i2] + (bits[i2] + carry);
-            bits[i2] = (uint32_t)(sum & 0x00000000FFFFFFFFull);
-            carry = (sum >> 32);
-        }
-        if (i2 < numElements)
+    // The number of bits is at most this, possibly one bit smaller.  Unpack
+    // the limbs into blocks; the blocks beyond numElements are zero.
+    int numBits = n0NumBits + n1NumBits;
+    self.SetNumBits(numBits);
+    auto& bits = self.GetBits();
+    int32_t const numElements = self.GetSize();
+    for (int32_t i = 0, j = 0; j < numElements; ++i, j += 2)
+    {
+        bits[j] = (uint32_t)(product[i] & 0x00000000FFFFFFFFull);
+        if (j + 1 < numElements)
         {
-            sum = pBits[i2] + carry;
-            bits[i2] = (uint32_t)(sum & 0x00000000FFFFFFFFull);
+            bits[j + 1] = (uint32_t)(product[i] >> 32);
         }
     }
 
@@ -389,7 +428,8 @@ void UIntegerALU32<UInteger>::Mul(UInteger const& n0, UInteger const& n1)
 }
 
 template <typename UInteger>
-void UIntegerALU32<UInteger>::ShiftLeft(UInteger const& number, int32_t shift)
+template <typename UIntegerN>
+void UIntegerALU32<UInteger>::ShiftLeft(UIntegerN const& number, int32_t shift)
 {
     UInteger& self = *(UInteger*)this;
     int32_t nNumBits = number.GetNumBits();
@@ -444,7 +484,8 @@ void UIntegerALU32<UInteger>::ShiftLeft(UInteger const& number, int32_t shift)
 }
 
 template <typename UInteger>
-int32_t UIntegerALU32<UInteger>::ShiftRightToOdd(UInteger const& number)
+template <typename UIntegerN>
+int32_t UIntegerALU32<UInteger>::ShiftRightToOdd(UIntegerN const& number)
 {
     UInteger& self = *(UInteger*)this;
     auto const& nBits = number.GetBits();
@@ -551,4 +592,207 @@ uint64_t UIntegerALU32<UInteger>::GetPrefix(int32_t numRequested) const
 }
 
 
+template <typename UInteger> inline
+uint64_t UIntegerALU32<UInteger>::MulAdd(uint64_t a, uint64_t b, uint64_t c0,
+    uint64_t c1, uint64_t& high)
+{
+    // Compute a*b + c0 + c1, which is smaller than 2^128, and return the low
+    // 64 bits.  The high 64 bits are returned in 'high'.
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 term = (unsigned __int128)a * b + c0 + c1;
+    high = (uint64_t)(term >> 64);
+    return (uint64_t)term;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t hi;
+    uint64_t lo = _umul128(a, b, &hi);
+    lo += c0;
+    hi += (lo < c0 ? 1 : 0);
+    lo += c1;
+    hi += (lo < c1 ? 1 : 0);
+    high = hi;
+    return lo;
+#else
+    uint64_t const a0 = (a & 0x00000000FFFFFFFFull), a1 = (a >> 32);
+    uint64_t const b0 = (b & 0x00000000FFFFFFFFull), b1 = (b >> 32);
+    uint64_t const p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t middle = (p00 >> 32) + (p01 & 0x00000000FFFFFFFFull)
+        + (p10 & 0x00000000FFFFFFFFull);
+    uint64_t lo = (middle << 32) | (p00 & 0x00000000FFFFFFFFull);
+    uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+    lo += c0;
+    hi += (lo < c0 ? 1 : 0);
+    lo += c1;
+    hi += (lo < c1 ? 1 : 0);
+    high = hi;
+    return lo;
+#endif
+}
+
+template <typename UInteger>
+void UIntegerALU32<UInteger>::MulSchoolbook(uint64_t const* u0, int32_t n0,
+    uint64_t const* u1, int32_t n1, uint64_t* product)
+{
+    // The row for u0[0] initializes the product, which avoids filling it
+    // with zeros.  Each following row is multiplied and accumulated in one
+    // pass; a*b + c0 + c1 cannot overflow 128 bits.
+    uint64_t carry = 0;
+    for (int32_t i1 = 0; i1 < n1; ++i1)
+    {
+        product[i1] = MulAdd(u0[0], u1[i1], carry, 0, carry);
+    }
+    product[n1] = carry;
+
+    for (int32_t i0 = 1; i0 < n0; ++i0)
+    {
+        uint64_t const block0 = u0[i0];
+        uint64_t* accumulator = product + i0;
+        carry = 0;
+        for (int32_t i1 = 0; i1 < n1; ++i1)
+        {
+            accumulator[i1] = MulAdd(block0, u1[i1], accumulator[i1], carry, carry);
+        }
+        accumulator[n1] = carry;
+    }
+}
+
+template <typename UInteger>
+void UIntegerALU32<UInteger>::MulLimbs(uint64_t const* u0, int32_t n0,
+    uint64_t const* u1, int32_t n1, uint64_t* product, uint64_t* scratch)
+{
+    if (n0 < n1)
+    {
+        std::swap(u0, u1);
+        std::swap(n0, n1);
+    }
+
+    if (n1 < KARATSUBA_THRESHOLD)
+    {
+        MulSchoolbook(u0, n0, u1, n1, product);
+        return;
+    }
+
+    if (n0 >= 2 * n1)
+    {
+        // The operands are unbalanced.  Multiply u1 by the n1-limb pieces of
+        // u0 and accumulate the partial products.
+        std::fill(product, product + n0 + n1, 0);
+        uint64_t* partial = scratch;
+        for (int32_t offset = 0; offset < n0; offset += n1)
+        {
+            int32_t const m = std::min(n1, n0 - offset);
+            MulLimbs(u0 + offset, m, u1, n1, partial, scratch + 2 * n1);
+            AddLimbs(product + offset, n0 + n1 - offset, partial, m + n1);
+        }
+        return;
+    }
+
+    // Split u0 = a1*B^h + a0 and u1 = b1*B^h + b0, where B = 2^64, a0 and b0
+    // have h limbs and b1 has at least one limb (n1 > n0/2 >= h).  Then
+    //   u0*u1 = z2*B^{2h} + z1*B^h + z0
+    // with z0 = a0*b0, z2 = a1*b1 and z1 = (a0+a1)*(b0+b1) - z0 - z2.
+    int32_t const h = n0 / 2;
+    int32_t const na1 = n0 - h, nb1 = n1 - h;
+    int32_t const nsa = na1 + 1, nsb = std::max(h, nb1) + 1;
+    uint64_t* sa = scratch;
+    uint64_t* sb = sa + nsa;
+    uint64_t* z1 = sb + nsb;
+    uint64_t* next = z1 + nsa + nsb;
+
+    // z0 and z2 are stored in place.
+    MulLimbs(u0, h, u1, h, product, next);
+    MulLimbs(u0 + h, na1, u1 + h, nb1, product + 2 * h, next);
+
+    // sa = a0 + a1 and sb = b0 + b1.
+    std::copy(u0 + h, u0 + n0, sa);
+    sa[na1] = AddLimbs(sa, na1, u0, h);
+    if (nb1 >= h)
+    {
+        std::copy(u1 + h, u1 + n1, sb);
+        sb[nb1] = AddLimbs(sb, nb1, u1, h);
+    }
+    else
+    {
+        std::copy(u1, u1 + h, sb);
+        sb[h] = AddLimbs(sb, h, u1 + h, nb1);
+    }
+
+    // z1 = sa*sb - z0 - z2, which is nonnegative.
+    MulLimbs(sa, nsa, sb, nsb, z1, next);
+    SubLimbs(z1, nsa + nsb, product, 2 * h);
+    SubLimbs(z1, nsa + nsb, product + 2 * h, na1 + nb1);
+
+    // Add z1*B^h.  The leading limbs of z1 are zero beyond the length of the
+    // product.
+    int32_t const numZ1 = std::min(nsa + nsb, n0 + n1 - h);
+    AddLimbs(product + h, n0 + n1 - h, z1, numZ1);
+}
+
+template <typename UInteger> inline
+size_t UIntegerALU32<UInteger>::GetMulStorageSize(int32_t numElements0,
+    int32_t numElements1)
+{
+    int32_t const numLimbs0 = (numElements0 + 1) / 2;
+    int32_t const numLimbs1 = (numElements1 + 1) / 2;
+    return 2 * (static_cast<size_t>(numLimbs0) + static_cast<size_t>(numLimbs1))
+        + GetScratchSize(numLimbs0, numLimbs1);
+}
+
+template <typename UInteger> inline
+size_t UIntegerALU32<UInteger>::GetScratchSize(int32_t n0, int32_t n1)
+{
+    // Each level of Karatsuba's method uses at most 2*max(n0,n1) + 6 limbs
+    // and recurses on operands of about half the size; the unbalanced case
+    // uses 2*min(n0,n1) limbs for the partial products.  By induction on the
+    // levels, 6*(n0+n1) + 1024 limbs suffice.
+    if (std::min(n0, n1) < KARATSUBA_THRESHOLD)
+    {
+        return 0;
+    }
+    return 6 * (static_cast<size_t>(n0) + static_cast<size_t>(n1)) + 1024;
+}
+
+template <typename UInteger>
+uint64_t UIntegerALU32<UInteger>::AddLimbs(uint64_t* target,
+    int32_t numTarget, uint64_t const* source, int32_t numSource)
+{
+    uint64_t carry = 0;
+    int32_t i;
+    for (i = 0; i < numSource; ++i)
+    {
+        uint64_t sum = target[i] + carry;
+        carry = (sum < carry ? 1 : 0);
+        sum += source[i];
+        carry += (sum < source[i] ? 1 : 0);
+        target[i] = sum;
+    }
+    for (/**/; carry > 0 && i < numTarget; ++i)
+    {
+        carry = (++target[i] == 0 ? 1 : 0);
+    }
+    return carry;
+}
+
+template <typename UInteger>
+uint64_t UIntegerALU32<UInteger>::SubLimbs(uint64_t* target,
+    int32_t numTarget, uint64_t const* source, int32_t numSource)
+{
+    uint64_t borrow = 0;
+    int32_t i;
+    for (i = 0; i < numSource; ++i)
+    {
+        uint64_t const value = target[i];
+        uint64_t diff = value - source[i];
+        uint64_t nextBorrow = (diff > value ? 1 : 0);
+        nextBorrow += (diff < borrow ? 1 : 0);
+        target[i] = diff - borrow;
+        borrow = nextBorrow;
+    }
+    for (/**/; borrow > 0 && i < numTarget; ++i)
+    {
+        borrow = (target[i]-- == 0 ? 1 : 0);
+    }
+    return borrow;
+}
+
+
 }
@@ -3,11 +3,12 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2018/10/04)
+// File Version: 3.0.3 (2019/09/23)
 
 #pragma once
 
 #include <Mathematics/GteVector3.h>
+#include <Mathematics/GteSIMD4.h>
 
 namespace gte
 {
@@ -52,6 +53,22 @@ template <typename Real>
 Real ComputeOrthogonalComplement(int numInputs, Vector4<Real>* v,
     bool robust = false);
 
+// Fast paths for 'float' using SIMD4.  The nontemplate overloads are selected
+// over the generic templates of GteVector.h and produce the same results;
+// Dot sums the products in the same order.  Call the templates explicitly,
+// for example Dot<4, float>(v0, v1), to bypass the fast paths.
+inline Vector4<float> operator+(Vector4<float> const& v0,
+    Vector4<float> const& v1);
+
+inline Vector4<float> operator-(Vector4<float> const& v0,
+    Vector4<float> const& v1);
+
+inline Vector4<float> operator*(Vector4<float> const& v, float scalar);
+
+inline Vector4<float> operator*(float scalar, Vector4<float> const& v);
+
+inline float Dot(Vector4<float> const& v0, Vector4<float> const& v1);
+
 
 template <typename Real>
 Vector4<Real> HyperCross(Vector4<Real> const& v0, Vector4<Real> const& v1,
@@ -183,4 +200,41 @@ Real ComputeOrthogonalComplement(int numInputs, Vector4<Real>* v, bool robust)
     return (Real)0;
 }
 
+inline Vector4<float> operator+(Vector4<float> const& v0,
+    Vector4<float> const& v1)
+{
+    Vector4<float> result;
+    (SIMD4::Load(&v0[0]) + SIMD4::Load(&v1[0])).Store(&result[0]);
+    return result;
+}
+
+inline Vector4<float> operator-(Vector4<float> const& v0,
+    Vector4<float> const& v1)
+{
+    Vector4<float> result;
+    (SIMD4::Load(&v0[0]) - SIMD4::Load(&v1[0])).Store(&result[0]);
+    return result;
+}
+
+inline Vector4<float> operator*(Vector4<float> const& v, float scalar)
+{
+    Vector4<float> result;
+    (SIMD4::Load(&v[0]) * SIMD4(scalar)).Store(&result[0]);
+    return result;
+}
+
+inline Vector4<float> operator*(float scalar, Vector4<float> const& v)
+{
+    Vector4<float> result;
+    (SIMD4(scalar) * SIMD4::Load(&v[0])).Store(&result[0]);
+    return result;
+}
+
+inline float Dot(Vector4<float> const& v0, Vector4<float> const& v1)
+{
+    float products[4];
+    (SIMD4::Load(&v0[0]) * SIMD4::Load(&v1[0])).Store(products);
+    return products[0] + products[1] + products[2] + products[3];
+}
+
 }
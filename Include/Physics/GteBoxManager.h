@@ -3,16 +3,32 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.2 (2019/09/04)
 
 #pragma once
 
+#include <LowLevel/GteLogger.h>
 #include <Mathematics/GteIntrAlignedBox3AlignedBox3.h>
 #include <Mathematics/GteEdgeKey.h>
 #include <algorithm>
-#include <set>
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+// The box manager uses sort-and-sweep (sweep-and-prune) to determine the
+// overlapping pairs of boxes.  The endpoints of the box intervals on each
+// axis are stored in structure-of-arrays form (values and owners in
+// separate arrays) so that the incremental insertion sort in Update touches
+// contiguous memory.  The three axes are sorted independently, so Update
+// sorts them in parallel when the manager is constructed with numThreads
+// larger than 1.  During the sorts, every swap of a 'begin' endpoint with an
+// 'end' endpoint makes the pair of boxes a candidate for a change in overlap
+// status.  After the sorts, the candidates are resolved serially against
+// the overlap set, which is a hash set of index pairs.  The changes are
+// reported as lists of added and removed pairs.
+
 namespace gte
 {
 
@@ -20,8 +36,22 @@ template <typename Real>
 class BoxManager
 {
 public:
-    // Construction.
-    BoxManager(std::vector<AlignedBox3<Real>>& boxes);
+    // Hashing for the set of overlapping pairs.
+    struct OverlapHash
+    {
+        size_t operator()(EdgeKey<false> const& key) const
+        {
+            uint64_t v0 = static_cast<uint32_t>(key.V[0]);
+            uint64_t v1 = static_cast<uint32_t>(key.V[1]);
+            return std::hash<uint64_t>()((v0 << 32) | v1);
+        }
+    };
+
+    typedef std::unordered_set<EdgeKey<false>, OverlapHash> OverlapSet;
+
+    // Construction.  The three axes are sorted in parallel when numThreads
+    // is larger than 1; at most 3 threads are used.
+    BoxManager(std::vector<AlignedBox3<Real>>& boxes, unsigned int numThreads = 1);
 
     // No default construction, copy construction, or assignment are allowed.
     BoxManager() = delete;
@@ -29,19 +59,33 @@ public:
     BoxManager& operator=(BoxManager const&) = delete;
 
     // This function is called by the constructor and does the sort-and-sweep
-    // to initialize the update system.  However, if you add or remove items
-    // from the array of boxes after the constructor call, you will need
-    // to call this function once before you start the multiple calls of the
-    // update function.
+    // to initialize the update system.  If you modify the input array of
+    // boxes directly after the constructor call, you will need to call this
+    // function once before you start the multiple calls of the update
+    // function.  To add or remove boxes without a full initialization, use
+    // the Insert and Remove functions.  Boxes removed by Remove stay removed
+    // and their indices remain available to Insert; boxes appended to the
+    // array directly are active.
     void Initialize();
 
     // After the system is initialized, you can move the boxes using this
     // function.  It is not enough to modify the input array of boxes
     // since the endpoint values stored internally by this class must also
-    // change.  You can also retrieve the current rectangles information.
+    // change.  You can also retrieve the current box information.  The box
+    // passed to SetBox must be active.
     void SetBox(int i, AlignedBox3<Real> const& box);
     void GetBox(int i, AlignedBox3<Real>& box) const;
-    
+
+    // Incremental insertion and removal of boxes.  Insert returns the index
+    // of the new box, which is either the index of a previously removed box
+    // or the size of the input array (the box is appended to the array).
+    // The indices of the other boxes are not changed by Insert or Remove.
+    // The overlap set is updated immediately; the changes are appended to
+    // the added and removed lists.
+    int Insert(AlignedBox3<Real> const& box);
+    void Remove(int i);
+    bool IsActive(int i) const;
+
     // When you are finished moving boxes, call this function to determine
     // the overlapping boxes.  An incremental update is applied to determine
     // the new set of overlapping boxes.
@@ -50,42 +94,64 @@ public:
     // If (i,j) is in the overlap set, then box i and box j are
     // overlapping.  The indices are those for the the input array.  The
     // set elements (i,j) are stored so that i < j.
-    std::set<EdgeKey<false>> const& GetOverlap() const;
+    OverlapSet const& GetOverlap() const;
+
+    // The pairs that started overlapping and the pairs that stopped
+    // overlapping.  The lists are cleared at the beginning of Initialize
+    // and Update.  Insert and Remove append to them, so read the lists
+    // before the next call to Update.
+    std::vector<EdgeKey<false>> const& GetAddedOverlaps() const;
+    std::vector<EdgeKey<false>> const& GetRemovedOverlaps() const;
 
 private:
-    class Endpoint
+    // The endpoints for one axis.  The owner of an endpoint is 2*i+type,
+    // where i is the box index and type is 0 for an interval minimum or 1
+    // for an interval maximum.  The lookup table has an entry for each
+    // owner, which is the index of the endpoint in the sorted arrays.  When
+    // a box is removed, its lookup entries are set to -1.
+    struct Endpoints
     {
-    public:
-        Real value; // endpoint value
-        int type;   // '0' if interval min, '1' if interval max.
-        int index;  // index of interval containing this endpoint
-
-        // Support for sorting of endpoints.
-        bool operator<(Endpoint const& endpoint) const;
+        std::vector<Real> value;
+        std::vector<int> owner;
+        std::vector<int> lookup;
+        std::vector<EdgeKey<false>> candidates;
     };
 
-    void InsertionSort(std::vector<Endpoint>& endPoint, std::vector<int>& lookup);
+    // Support for sorting of endpoints.
+    static inline bool Less(Real value0, int owner0, Real value1, int owner1)
+    {
+        if (value0 < value1)
+        {
+            return true;
+        }
+        if (value0 > value1)
+        {
+            return false;
+        }
+        return (owner0 & 1) < (owner1 & 1);
+    }
+
+    bool Overlaps(int i0, int i1) const;
+    void InsertionSort(Endpoints& endpoints);
+    void InsertEndpoint(Endpoints& endpoints, Real value, int owner);
+    void RemoveEndpoint(Endpoints& endpoints, int owner);
+    void AddOverlap(int i0, int i1);
+    void RemoveOverlap(int i0, int i1);
 
     std::vector<AlignedBox3<Real>>& mBoxes;
-    std::vector<Endpoint> mXEndpoints, mYEndpoints, mZEndpoints;
-    std::set<EdgeKey<false>> mOverlap;
-
-    // The intervals are indexed 0 <= i < n.  The endpoint array has 2*n
-    // entries.  The original 2*n interval values are ordered as b[0], e[0],
-    // b[1], e[1], ..., b[n-1], e[n-1].  When the endpoint array is sorted,
-    // the mapping between interval values and endpoints is lost.  In order
-    // to modify interval values that are stored in the endpoint array, we
-    // need to maintain the mapping.  This is done by the following lookup
-    // table of 2*n entries.  The value mLookup[2*i] is the index of b[i]
-    // in the endpoint array.  The value mLookup[2*i+1] is the index of
-    // e[i] in the endpoint array.
-    std::vector<int> mXLookup, mYLookup, mZLookup;
+    unsigned int mNumThreads;
+    std::array<Endpoints, 3> mEndpoints;
+    std::vector<bool> mActive;
+    std::vector<int> mFreeIndices;
+    OverlapSet mOverlap;
+    std::vector<EdgeKey<false>> mAdded, mRemoved;
 };
 
 template <typename Real>
-BoxManager<Real>::BoxManager(std::vector<AlignedBox3<Real> >& boxes)
+BoxManager<Real>::BoxManager(std::vector<AlignedBox3<Real>>& boxes, unsigned int numThreads)
     :
-    mBoxes(boxes)
+    mBoxes(boxes),
+    mNumThreads(numThreads)
 {
     Initialize();
 }
@@ -93,93 +159,116 @@ BoxManager<Real>::BoxManager(std::vector<AlignedBox3<Real> >& boxes)
 template <typename Real>
 void BoxManager<Real>::Initialize()
 {
-    // Get the box endpoints.
-    int intrSize = static_cast<int>(mBoxes.size()), endpSize = 2 * intrSize;
-    mXEndpoints.resize(endpSize);
-    mYEndpoints.resize(endpSize);
-    mZEndpoints.resize(endpSize);
-    for (int i = 0, j = 0; i < intrSize; ++i)
+    mAdded.clear();
+    mRemoved.clear();
+    mFreeIndices.clear();
+    mOverlap.clear();
+
+    // The removed boxes are not part of the sort-and-sweep.
+    int const numBoxes = static_cast<int>(mBoxes.size());
+    mActive.resize(numBoxes, true);
+    int numActive = 0;
+    for (int i = 0; i < numBoxes; ++i)
     {
-        mXEndpoints[j].type = 0;
-        mXEndpoints[j].value = mBoxes[i].min[0];
-        mXEndpoints[j].index = i;
-        mYEndpoints[j].type = 0;
-        mYEndpoints[j].value = mBoxes[i].min[1];
-        mYEndpoints[j].index = i;
-        mZEndpoints[j].type = 0;
-        mZEndpoints[j].value = mBoxes[i].min[2];
-        mZEndpoints[j].index = i;
-        ++j;
-
-        mXEndpoints[j].type = 1;
-        mXEndpoints[j].value = mBoxes[i].max[0];
-        mXEndpoints[j].index = i;
-        mYEndpoints[j].type = 1;
-        mYEndpoints[j].value = mBoxes[i].max[1];
-        mYEndpoints[j].index = i;
-        mZEndpoints[j].type = 1;
-        mZEndpoints[j].value = mBoxes[i].max[2];
-        mZEndpoints[j].index = i;
-        ++j;
+        if (mActive[i])
+        {
+            ++numActive;
+        }
+        else
+        {
+            mFreeIndices.push_back(i);
+        }
     }
 
-    // Sort the rectangle endpoints.
-    std::sort(mXEndpoints.begin(), mXEndpoints.end());
-    std::sort(mYEndpoints.begin(), mYEndpoints.end());
-    std::sort(mZEndpoints.begin(), mZEndpoints.end());
+    // Get the box endpoints and sort them.
+    auto sortAxis = [this, numBoxes, numActive](int axis)
+    {
+        Endpoints& endpoints = mEndpoints[axis];
+        int const endpSize = 2 * numActive;
+        std::vector<std::pair<Real, int>> sorted(endpSize);
+        for (int i = 0, j = 0; i < numBoxes; ++i)
+        {
+            if (mActive[i])
+            {
+                sorted[j++] = std::make_pair(mBoxes[i].min[axis], 2 * i);
+                sorted[j++] = std::make_pair(mBoxes[i].max[axis], 2 * i + 1);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(),
+            [](std::pair<Real, int> const& e0, std::pair<Real, int> const& e1)
+            {
+                return Less(e0.first, e0.second, e1.first, e1.second);
+            });
+
+        // Create the interval-to-endpoint lookup tables.
+        endpoints.value.resize(endpSize);
+        endpoints.owner.resize(endpSize);
+        endpoints.lookup.assign(2 * numBoxes, -1);
+        for (int j = 0; j < endpSize; ++j)
+        {
+            endpoints.value[j] = sorted[j].first;
+            endpoints.owner[j] = sorted[j].second;
+            endpoints.lookup[sorted[j].second] = j;
+        }
+        endpoints.candidates.clear();
+    };
 
-    // Create the interval-to-endpoint lookup tables.
-    mXLookup.resize(endpSize);
-    mYLookup.resize(endpSize);
-    mZLookup.resize(endpSize);
-    for (int j = 0; j < endpSize; ++j)
+    if (mNumThreads > 1)
     {
-        mXLookup[2 * mXEndpoints[j].index + mXEndpoints[j].type] = j;
-        mYLookup[2 * mYEndpoints[j].index + mYEndpoints[j].type] = j;
-        mZLookup[2 * mZEndpoints[j].index + mZEndpoints[j].type] = j;
+        std::array<std::thread, 3> process;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            process[axis] = std::thread(sortAxis, axis);
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            process[axis].join();
+        }
+    }
+    else
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            sortAxis(axis);
+        }
     }
 
-    // Active set of rectangles (stored by index in array).
-    std::set<int> active;
-
-    // set of overlapping rectangles (stored by pairs of indices in array)
-    mOverlap.clear();
+    // Active set of boxes (stored by index in array).  The position of each
+    // box in the active array allows constant-time removal.
+    std::vector<int> active, position(numBoxes, -1);
+    active.reserve(numBoxes);
 
     // Sweep through the endpoints to determine overlapping x-intervals.
-    for (int i = 0; i < endpSize; ++i)
+    Endpoints const& xEndpoints = mEndpoints[0];
+    for (size_t i = 0; i < xEndpoints.owner.size(); ++i)
     {
-        Endpoint& endpoint = mXEndpoints[i];
-        int index = endpoint.index;
-        if (endpoint.type == 0)  // an interval 'begin' value
+        int index = (xEndpoints.owner[i] >> 1);
+        if ((xEndpoints.owner[i] & 1) == 0)  // an interval 'begin' value
         {
             // In the 1D problem, the current interval overlaps with all the
             // active intervals.  In 3D we also need to check for y-overlap
             // and z-overlap.
+            AlignedBox3<Real> const& b1 = mBoxes[index];
             for (auto activeIndex : active)
             {
-                // Rectangles activeIndex and index overlap in the
-                // x-dimension.  Test for overlap in the y-dimension and
-                // z-dimension.
+                // Boxes activeIndex and index overlap in the x-dimension.
+                // Test for overlap in the y-dimension and z-dimension.
                 AlignedBox3<Real> const& b0 = mBoxes[activeIndex];
-                AlignedBox3<Real> const& b1 = mBoxes[index];
                 if (b0.max[1] >= b1.min[1] && b0.min[1] <= b1.max[1]
                     && b0.max[2] >= b1.min[2] && b0.min[2] <= b1.max[2])
                 {
-                    if (activeIndex < index)
-                    {
-                        mOverlap.insert(EdgeKey<false>(activeIndex, index));
-                    }
-                    else
-                    {
-                        mOverlap.insert(EdgeKey<false>(index, activeIndex));
-                    }
+                    AddOverlap(activeIndex, index);
                 }
             }
-            active.insert(index);
+            position[index] = static_cast<int>(active.size());
+            active.push_back(index);
         }
         else  // an interval 'end' value
         {
-            active.erase(index);
+            int p = position[index];
+            position[active.back()] = p;
+            active[p] = active.back();
+            active.pop_back();
         }
     }
 }
@@ -187,13 +276,19 @@ void BoxManager<Real>::Initialize()
 template <typename Real>
 void BoxManager<Real>::SetBox(int i, AlignedBox3<Real> const& box)
 {
+    if (!IsActive(i))
+    {
+        LogError("The box is not active.");
+        return;
+    }
+
     mBoxes[i] = box;
-    mXEndpoints[mXLookup[2 * i]].value = box.min[0];
-    mXEndpoints[mXLookup[2 * i + 1]].value = box.max[0];
-    mYEndpoints[mYLookup[2 * i]].value = box.min[1];
-    mYEndpoints[mYLookup[2 * i + 1]].value = box.max[1];
-    mZEndpoints[mZLookup[2 * i]].value = box.min[2];
-    mZEndpoints[mZLookup[2 * i + 1]].value = box.max[2];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        Endpoints& endpoints = mEndpoints[axis];
+        endpoints.value[endpoints.lookup[2 * i]] = box.min[axis];
+        endpoints.value[endpoints.lookup[2 * i + 1]] = box.max[axis];
+    }
 }
 
 template <typename Real>
@@ -203,94 +298,273 @@ void BoxManager<Real>::GetBox(int i, AlignedBox3<Real>& box) const
 }
 
 template <typename Real>
-void BoxManager<Real>::InsertionSort(std::vector<Endpoint>& endpoint, std::vector<int>& lookup)
+int BoxManager<Real>::Insert(AlignedBox3<Real> const& box)
+{
+    int i;
+    if (mFreeIndices.size() > 0)
+    {
+        i = mFreeIndices.back();
+        mFreeIndices.pop_back();
+        mBoxes[i] = box;
+        mActive[i] = true;
+    }
+    else
+    {
+        i = static_cast<int>(mBoxes.size());
+        mBoxes.push_back(box);
+        mActive.push_back(true);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            mEndpoints[axis].lookup.resize(2 * mBoxes.size());
+        }
+    }
+
+    // The input can be an element of the array, which push_back might have
+    // reallocated, so the endpoints are read from the stored box.
+    AlignedBox3<Real> const& newBox = mBoxes[i];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        InsertEndpoint(mEndpoints[axis], newBox.min[axis], 2 * i);
+        InsertEndpoint(mEndpoints[axis], newBox.max[axis], 2 * i + 1);
+    }
+
+    // The boxes overlapping the new one in the x-dimension have a 'begin'
+    // endpoint before the new 'end' endpoint, and they are not entirely
+    // before the new 'begin' endpoint.
+    Endpoints const& xEndpoints = mEndpoints[0];
+    int const jmax = xEndpoints.lookup[2 * i + 1];
+    for (int j = 0; j < jmax; ++j)
+    {
+        int owner = xEndpoints.owner[j];
+        if ((owner & 1) == 0 && (owner >> 1) != i && Overlaps(i, owner >> 1))
+        {
+            AddOverlap(i, owner >> 1);
+        }
+    }
+    return i;
+}
+
+template <typename Real>
+void BoxManager<Real>::Remove(int i)
 {
-    // Apply an insertion sort.  Under the assumption that the rectangles
-    // have not changed much since the last call, the endpoints are nearly
+    if (!IsActive(i))
+    {
+        return;
+    }
+
+    // Remove the overlapping pairs that involve box i.  The boxes
+    // overlapping in the x-dimension are those with a 'begin' endpoint
+    // before the 'end' endpoint of box i.
+    Endpoints const& xEndpoints = mEndpoints[0];
+    int const jmax = xEndpoints.lookup[2 * i + 1];
+    for (int j = 0; j < jmax; ++j)
+    {
+        int owner = xEndpoints.owner[j];
+        if ((owner & 1) == 0 && (owner >> 1) != i)
+        {
+            RemoveOverlap(i, owner >> 1);
+        }
+    }
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        RemoveEndpoint(mEndpoints[axis], 2 * i + 1);
+        RemoveEndpoint(mEndpoints[axis], 2 * i);
+    }
+
+    mActive[i] = false;
+    mFreeIndices.push_back(i);
+}
+
+template <typename Real>
+bool BoxManager<Real>::IsActive(int i) const
+{
+    return 0 <= i && i < static_cast<int>(mActive.size()) && mActive[i];
+}
+
+template <typename Real>
+bool BoxManager<Real>::Overlaps(int i0, int i1) const
+{
+    AlignedBox3<Real> const& b0 = mBoxes[i0];
+    AlignedBox3<Real> const& b1 = mBoxes[i1];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (b0.max[axis] < b1.min[axis] || b0.min[axis] > b1.max[axis])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Real>
+void BoxManager<Real>::InsertionSort(Endpoints& endpoints)
+{
+    // Apply an insertion sort.  Under the assumption that the boxes have
+    // not changed much since the last call, the endpoints are nearly
     // sorted.  The insertion sort should be very fast in this case.
+    //
+    // Each swap of a 'begin' and an 'end' endpoint of different boxes
+    // means the boxes *might have* stopped overlapping ('begin' moved past
+    // 'end') or *might now* overlap ('end' moved past 'begin').  The
+    // decision requires the other axes, so the pair is only recorded here.
+    // This allows the three axes to be sorted concurrently.  A swap of the
+    // endpoints of the same box (SetBox with min > max) is not a pair.
+    std::vector<Real>& value = endpoints.value;
+    std::vector<int>& owner = endpoints.owner;
+    std::vector<int>& lookup = endpoints.lookup;
+    endpoints.candidates.clear();
 
-    TIQuery<Real, AlignedBox3<Real>, AlignedBox3<Real>> query;
-    int endpSize = static_cast<int>(endpoint.size());
+    int endpSize = static_cast<int>(value.size());
     for (int j = 1; j < endpSize; ++j)
     {
-        Endpoint key = endpoint[j];
+        Real keyValue = value[j];
+        int keyOwner = owner[j];
         int i = j - 1;
-        while (i >= 0 && key < endpoint[i])
+        while (i >= 0 && Less(keyValue, keyOwner, value[i], owner[i]))
         {
-            Endpoint e0 = endpoint[i];
-            Endpoint e1 = endpoint[i + 1];
-
-            // Update the overlap status.
-            if (e0.type == 0)
-            {
-                if (e1.type == 1)
-                {
-                    // The 'b' of interval E0.mIndex was smaller than the 'e'
-                    // of interval E1.mIndex, and the intervals *might have
-                    // been* overlapping.  Now 'b' and 'e' are swapped, and
-                    // the intervals cannot overlap.  Remove the pair from
-                    // the overlap set.  The removal operation needs to find
-                    // the pair and erase it if it exists.  Finding the pair
-                    // is the expensive part of the operation, so there is no
-                    // real time savings in testing for existence first, then
-                    // deleting if it does.
-                    mOverlap.erase(EdgeKey<false>(e0.index, e1.index));
-                }
-            }
-            else
+            int other = owner[i];
+            if ((other & 1) != (keyOwner & 1) && (other >> 1) != (keyOwner >> 1))
             {
-                if (e1.type == 0)
-                {
-                    // The 'b' of interval E1.index was larger than the 'e'
-                    // of interval E0.index, and the intervals were not
-                    // overlapping.  Now 'b' and 'e' are swapped, and the
-                    // intervals *might be* overlapping.  Determine if they
-                    // are overlapping and then insert.
-                    if (query(mBoxes[e0.index], mBoxes[e1.index]).intersect)
-                    {
-                        mOverlap.insert(EdgeKey<false>(e0.index, e1.index));
-                    }
-                }
+                endpoints.candidates.push_back(EdgeKey<false>(other >> 1, keyOwner >> 1));
             }
 
             // Reorder the items to maintain the sorted list.
-            endpoint[i] = e1;
-            endpoint[i + 1] = e0;
-            lookup[2 * e1.index + e1.type] = i;
-            lookup[2 * e0.index + e0.type] = i + 1;
+            value[i + 1] = value[i];
+            owner[i + 1] = other;
+            lookup[other] = i + 1;
             --i;
         }
-        endpoint[i + 1] = key;
-        lookup[2 * key.index + key.type] = i + 1;
+        value[i + 1] = keyValue;
+        owner[i + 1] = keyOwner;
+        lookup[keyOwner] = i + 1;
     }
 }
 
 template <typename Real>
-void BoxManager<Real>::Update()
+void BoxManager<Real>::InsertEndpoint(Endpoints& endpoints, Real value, int owner)
 {
-    InsertionSort(mXEndpoints, mXLookup);
-    InsertionSort(mYEndpoints, mYLookup);
-    InsertionSort(mZEndpoints, mZLookup);
+    // Locate the first endpoint that is not less than the new one and shift
+    // the remaining endpoints up by one.
+    int const endpSize = static_cast<int>(endpoints.value.size());
+    int lo = 0, hi = endpSize;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) >> 1;
+        if (Less(endpoints.value[mid], endpoints.owner[mid], value, owner))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    endpoints.value.insert(endpoints.value.begin() + lo, value);
+    endpoints.owner.insert(endpoints.owner.begin() + lo, owner);
+    for (int j = lo; j <= endpSize; ++j)
+    {
+        endpoints.lookup[endpoints.owner[j]] = j;
+    }
 }
 
 template <typename Real>
-const std::set<EdgeKey<false>>& BoxManager<Real>::GetOverlap() const
+void BoxManager<Real>::RemoveEndpoint(Endpoints& endpoints, int owner)
 {
-    return mOverlap;
+    int const j0 = endpoints.lookup[owner];
+    endpoints.value.erase(endpoints.value.begin() + j0);
+    endpoints.owner.erase(endpoints.owner.begin() + j0);
+    endpoints.lookup[owner] = -1;
+    int const endpSize = static_cast<int>(endpoints.value.size());
+    for (int j = j0; j < endpSize; ++j)
+    {
+        endpoints.lookup[endpoints.owner[j]] = j;
+    }
 }
 
 template <typename Real>
-bool BoxManager<Real>::Endpoint::operator<(const Endpoint& endpoint) const
+void BoxManager<Real>::AddOverlap(int i0, int i1)
 {
-    if (value < endpoint.value)
+    if (mOverlap.insert(EdgeKey<false>(i0, i1)).second)
     {
-        return true;
+        mAdded.push_back(EdgeKey<false>(i0, i1));
     }
-    if (value > endpoint.value)
+}
+
+template <typename Real>
+void BoxManager<Real>::RemoveOverlap(int i0, int i1)
+{
+    if (mOverlap.erase(EdgeKey<false>(i0, i1)) > 0)
     {
-        return false;
+        mRemoved.push_back(EdgeKey<false>(i0, i1));
     }
-    return type < endpoint.type;
+}
+
+template <typename Real>
+void BoxManager<Real>::Update()
+{
+    mAdded.clear();
+    mRemoved.clear();
+
+    if (mNumThreads > 1)
+    {
+        std::array<std::thread, 3> process;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            process[axis] = std::thread([this, axis]()
+            {
+                InsertionSort(mEndpoints[axis]);
+            });
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            process[axis].join();
+        }
+    }
+    else
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            InsertionSort(mEndpoints[axis]);
+        }
+    }
+
+    // Resolve the candidates using the current boxes.  A pair can appear
+    // more than once, but AddOverlap and RemoveOverlap report a change only
+    // when the overlap set is modified.
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (auto const& key : mEndpoints[axis].candidates)
+        {
+            if (Overlaps(key.V[0], key.V[1]))
+            {
+                AddOverlap(key.V[0], key.V[1]);
+            }
+            else
+            {
+                RemoveOverlap(key.V[0], key.V[1]);
+            }
+        }
+    }
+}
+
+template <typename Real>
+typename BoxManager<Real>::OverlapSet const& BoxManager<Real>::GetOverlap() const
+{
+    return mOverlap;
+}
+
+template <typename Real>
+std::vector<EdgeKey<false>> const& BoxManager<Real>::GetAddedOverlaps() const
+{
+    return mAdded;
+}
+
+template <typename Real>
+std::vector<EdgeKey<false>> const& BoxManager<Real>::GetRemovedOverlaps() const
+{
+    return mRemoved;
 }
 
 }
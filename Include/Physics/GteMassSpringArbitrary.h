@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2019/05/03)
+// File Version: 3.0.2 (2019/09/07)
 
 #pragma once
 
@@ -44,6 +44,10 @@ public:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity);
 
+    // The adjacency information is converted to compressed arrays when
+    // springs have been set since the last update.
+    virtual void Update(Real time) override;
+
 protected:
     // Callback for acceleration (ODE solver uses x" = F/m) applied to
     // particle i.  The positions and velocities are not necessarily
@@ -59,6 +63,23 @@ protected:
     // springs adjacent to the particle.  The set elements are spring
     // indices, not indices of adjacent particles.
     std::vector<std::set<int>> mAdjacent;
+
+    // When batching is enabled (SetBatched), process the springs of a
+    // range of particles using the compressed adjacency arrays instead of
+    // calling Acceleration(i,...).  Otherwise the base class calls it.  The springs adjacent to particle i are indexed by
+    // mAdjacentStart[i] <= k < mAdjacentStart[i+1], the other particle of
+    // spring k is mAdjacentParticle[k], and the spring constant and length
+    // are mAdjacentConstant[k] and mAdjacentLength[k].
+    virtual void ComputeAccelerations(int imin, int imax, Real time,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const& velocity,
+        std::vector<Vector<N, Real>>& acceleration) override;
+
+    void CreateAdjacentArrays();
+
+    bool mAdjacentChanged;
+    std::vector<int> mAdjacentStart, mAdjacentParticle;
+    std::vector<Real> mAdjacentConstant, mAdjacentLength;
 };
 
 
@@ -73,7 +94,8 @@ MassSpringArbitrary<N, Real>::MassSpringArbitrary(int numParticles,
     :
     ParticleSystem<N, Real>(numParticles, step),
     mSpring(numSprings),
-    mAdjacent(numParticles)
+    mAdjacent(numParticles),
+    mAdjacentChanged(true)
 {
     std::memset(&mSpring[0], 0, numSprings * sizeof(Spring));
 }
@@ -90,6 +112,7 @@ void MassSpringArbitrary<N, Real>::SetSpring(int index, Spring const& spring)
     mSpring[index] = spring;
     mAdjacent[spring.particle0].insert(index);
     mAdjacent[spring.particle1].insert(index);
+    mAdjacentChanged = true;
 }
 
 template <int N, typename Real> inline
@@ -140,5 +163,77 @@ Vector<N, Real> MassSpringArbitrary<N, Real>::Acceleration(int i, Real time,
     return acceleration;
 }
 
+template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::Update(Real time)
+{
+    if (mAdjacentChanged)
+    {
+        CreateAdjacentArrays();
+        mAdjacentChanged = false;
+    }
+    ParticleSystem<N, Real>::Update(time);
+}
+
+template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::ComputeAccelerations(int imin, int imax,
+    Real time, std::vector<Vector<N, Real>> const& position,
+    std::vector<Vector<N, Real>> const& velocity,
+    std::vector<Vector<N, Real>>& acceleration)
+{
+    if (!this->mBatched)
+    {
+        ParticleSystem<N, Real>::ComputeAccelerations(imin, imax, time,
+            position, velocity, acceleration);
+        return;
+    }
+
+    for (int i = imin; i < imax; ++i)
+    {
+        Real const invMass = this->mInvMass[i];
+        if (invMass > (Real)0)
+        {
+            Vector<N, Real> sum = ExternalAcceleration(i, time, position,
+                velocity);
+
+            Vector<N, Real> const& X = position[i];
+            int const kmax = mAdjacentStart[i + 1];
+            for (int k = mAdjacentStart[i]; k < kmax; ++k)
+            {
+                Vector<N, Real> diff = position[mAdjacentParticle[k]] - X;
+                Real ratio = mAdjacentLength[k] / Length(diff);
+                sum += (invMass * mAdjacentConstant[k] * ((Real)1 - ratio)) * diff;
+            }
+            acceleration[i] = sum;
+        }
+        else
+        {
+            acceleration[i].MakeZero();
+        }
+    }
+}
+
+template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::CreateAdjacentArrays()
+{
+    int const numParticles = this->mNumParticles;
+    mAdjacentStart.resize(numParticles + 1);
+    mAdjacentParticle.clear();
+    mAdjacentConstant.clear();
+    mAdjacentLength.clear();
+    for (int i = 0; i < numParticles; ++i)
+    {
+        mAdjacentStart[i] = static_cast<int>(mAdjacentParticle.size());
+        for (auto adj : mAdjacent[i])
+        {
+            Spring const& spring = mSpring[adj];
+            mAdjacentParticle.push_back(i != spring.particle0 ?
+                spring.particle0 : spring.particle1);
+            mAdjacentConstant.push_back(spring.constant);
+            mAdjacentLength.push_back(spring.length);
+        }
+    }
+    mAdjacentStart[numParticles] = static_cast<int>(mAdjacentParticle.size());
+}
+
 
 }
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2019/05/16)
+// File Version: 3.0.2 (2019/09/07)
 
 #pragma once
 
@@ -70,6 +70,15 @@ protected:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity);
 
+    // When batching is enabled (SetBatched), process the springs of a
+    // range of particles in one pass:  (r,c) is advanced with the particle
+    // index rather than computed by GetCoordinates, and the spring arrays
+    // are read directly.  Otherwise Acceleration(i,...) is called.
+    virtual void ComputeAccelerations(int imin, int imax, Real time,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const& velocity,
+        std::vector<Vector<N, Real>>& acceleration) override;
+
     inline int GetIndex(int r, int c) const;
     void GetCoordinates(int i, int& r, int& c) const;
 
@@ -268,6 +277,71 @@ Vector<N, Real> MassSpringSurface<N, Real>::Acceleration(int i, Real time,
     return acceleration;
 }
 
+template <int N, typename Real>
+void MassSpringSurface<N, Real>::ComputeAccelerations(int imin, int imax,
+    Real time, std::vector<Vector<N, Real>> const& position,
+    std::vector<Vector<N, Real>> const& velocity,
+    std::vector<Vector<N, Real>>& acceleration)
+{
+    if (!this->mBatched)
+    {
+        ParticleSystem<N, Real>::ComputeAccelerations(imin, imax, time,
+            position, velocity, acceleration);
+        return;
+    }
+
+    int r, c;
+    GetCoordinates(imin, r, c);
+    for (int i = imin; i < imax; ++i)
+    {
+        Real const invMass = this->mInvMass[i];
+        if (invMass > (Real)0)
+        {
+            Vector<N, Real> sum = ExternalAcceleration(i, time, position,
+                velocity);
+
+            // Add the acceleration of the spring from particle i to
+            // particle j.
+            Vector<N, Real> const& X = position[i];
+            auto addSpring = [&](int j, Real constant, Real length)
+            {
+                Vector<N, Real> diff = position[j] - X;
+                Real ratio = length / Length(diff);
+                sum += (invMass * constant * ((Real)1 - ratio)) * diff;
+            };
+
+            if (r > 0)
+            {
+                int const prev = i - mNumCols;
+                addSpring(prev, mConstantR[prev], mLengthR[prev]);
+            }
+            if (r < mNumRows - 1)
+            {
+                addSpring(i + mNumCols, mConstantR[i], mLengthR[i]);
+            }
+            if (c > 0)
+            {
+                addSpring(i - 1, mConstantC[i - 1], mLengthC[i - 1]);
+            }
+            if (c < mNumCols - 1)
+            {
+                addSpring(i + 1, mConstantC[i], mLengthC[i]);
+            }
+            acceleration[i] = sum;
+        }
+        else
+        {
+            acceleration[i].MakeZero();
+        }
+
+        if (++c == mNumCols)
+        {
+            c = 0;
+            ++r;
+        }
+    }
+}
+
 template <int N, typename Real> inline
 int MassSpringSurface<N, Real>::GetIndex(int r, int c) const
 {
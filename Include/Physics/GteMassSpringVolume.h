@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/07)
 
 #pragma once
 
@@ -86,6 +86,15 @@ protected:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity);
 
+    // When batching is enabled (SetBatched), the springs of a range of
+    // particles are processed in one pass with (s,r,c) advanced from the
+    // first particle; the six spring arrays are read without GetIndex.
+    // Otherwise the base class calls Acceleration(i,...) per particle.
+    virtual void ComputeAccelerations(int imin, int imax, Real time,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const& velocity,
+        std::vector<Vector<N, Real>>& acceleration) override;
+
     inline int GetIndex(int s, int r, int c) const;
     void GetCoordinates(int i, int& s, int& r, int& c) const;
 
@@ -341,6 +350,85 @@ Vector<N, Real> MassSpringVolume<N, Real>::Acceleration(int i, Real time,
     return acceleration;
 }
 
+template <int N, typename Real>
+void MassSpringVolume<N, Real>::ComputeAccelerations(int imin, int imax,
+    Real time, std::vector<Vector<N, Real>> const& position,
+    std::vector<Vector<N, Real>> const& velocity,
+    std::vector<Vector<N, Real>>& acceleration)
+{
+    if (!this->mBatched)
+    {
+        ParticleSystem<N, Real>::ComputeAccelerations(imin, imax, time,
+            position, velocity, acceleration);
+        return;
+    }
+
+    int const sliceSize = mNumRows * mNumCols;
+    int s, r, c;
+    GetCoordinates(imin, s, r, c);
+    for (int i = imin; i < imax; ++i)
+    {
+        Real const invMass = this->mInvMass[i];
+        if (invMass > (Real)0)
+        {
+            Vector<N, Real> sum = ExternalAcceleration(i, time, position,
+                velocity);
+
+            // Add the acceleration of the spring from particle i to
+            // particle j.
+            Vector<N, Real> const& X = position[i];
+            auto addSpring = [&](int j, Real constant, Real length)
+            {
+                Vector<N, Real> diff = position[j] - X;
+                Real ratio = length / Length(diff);
+                sum += (invMass * constant * ((Real)1 - ratio)) * diff;
+            };
+
+            if (s > 0)
+            {
+                int const prev = i - sliceSize;
+                addSpring(prev, mConstantS[prev], mLengthS[prev]);
+            }
+            if (s < mNumSlices - 1)
+            {
+                addSpring(i + sliceSize, mConstantS[i], mLengthS[i]);
+            }
+            if (r > 0)
+            {
+                int const prev = i - mNumCols;
+                addSpring(prev, mConstantR[prev], mLengthR[prev]);
+            }
+            if (r < mNumRows - 1)
+            {
+                addSpring(i + mNumCols, mConstantR[i], mLengthR[i]);
+            }
+            if (c > 0)
+            {
+                addSpring(i - 1, mConstantC[i - 1], mLengthC[i - 1]);
+            }
+            if (c < mNumCols - 1)
+            {
+                addSpring(i + 1, mConstantC[i], mLengthC[i]);
+            }
+            acceleration[i] = sum;
+        }
+        else
+        {
+            acceleration[i].MakeZero();
+        }
+
+        if (++c == mNumCols)
+        {
+            c = 0;
+            if (++r == mNumRows)
+            {
+                r = 0;
+                ++s;
+            }
+        }
+    }
+}
+
 template <int N, typename Real> inline
 int MassSpringVolume<N, Real>::GetIndex(int s, int r, int c) const
 {
@@ -3,14 +3,43 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.2 (2019/09/07)
 
 #pragma once
 
 #include <Mathematics/GteVector.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
+#include <thread>
 #include <vector>
 
+// The particles are updated by the Runge-Kutta fourth-order solver (the
+// default) or by a linearized implicit Euler solver that is suited to stiff
+// systems such as mass-spring systems with large spring constants.
+//
+// Each stage of a solver computes the accelerations of all the particles by
+// a single call to ComputeAccelerations for a range of particles.  The
+// default implementation calls Acceleration(i,...) for each particle of the
+// range, but a derived class can override it with a kernel that processes
+// the range in one pass.  The mass-spring classes have such kernels, which
+// compute the spring forces directly rather than through Acceleration(i,...);
+// they are used only when enabled by SetBatched(true).  When the system has numThreads larger than 1, the
+// particles are partitioned into contiguous ranges that are processed in
+// parallel, so the acceleration functions must be thread safe.
+//
+// The implicit Euler solver computes the velocity change dv of a step of
+// size h by solving the linear system
+//   (I - h*Jv - h^2*Jx)*dv = h*a(x,v) + h^2*Jx*v
+// where Jx and Jv are the Jacobians of the acceleration with respect to the
+// positions and velocities.  The products of the Jacobians with vectors
+// are approximated by finite differences of the accelerations, so no
+// derivative information is required from the derived classes.  The system
+// is multiplied by the mass matrix, which makes it symmetric for spring
+// forces, and solved by conjugate gradient iterations.  Then v' = v + dv and
+// x' = x + h*v'.
+
 namespace gte
 {
 
@@ -21,7 +50,13 @@ public:
     // Construction and destruction.  If a particle is to be immovable, set
     // its mass to std::numeric_limits<Real>::max().
     virtual ~ParticleSystem();
-    ParticleSystem(int numParticles, Real step);
+    ParticleSystem(int numParticles, Real step, unsigned int numThreads = 1);
+
+    enum Solver
+    {
+        RUNGE_KUTTA_4,
+        IMPLICIT_EULER
+    };
 
     // Member access.
     inline int GetNumParticles() const;
@@ -33,11 +68,29 @@ public:
     inline Vector<N, Real> const& GetPosition(int i) const;
     inline Vector<N, Real> const& GetVelocity(int i) const;
     inline Real GetStep() const;
+    inline void SetNumThreads(unsigned int numThreads);
+    inline unsigned int GetNumThreads() const;
+
+    // Enable the batched acceleration kernel of a derived class.  The
+    // kernel does not call Acceleration(i,...), so enable it only when that
+    // function is not overridden by a class derived from the one that
+    // provides the kernel.  The default is 'false'.
+    inline void SetBatched(bool batched);
+    inline bool GetBatched() const;
+
+    // The implicit Euler solver stops the conjugate gradient iterations
+    // when the residual is reduced by the factor 'tolerance' or when the
+    // maximum number of iterations is reached.
+    inline void SetSolver(Solver solver);
+    inline Solver GetSolver() const;
+    void SetImplicitParameters(int maxIterations, Real tolerance);
+    inline int GetImplicitMaxIterations() const;
+    inline Real GetImplicitTolerance() const;
 
     // Update the particle positions based on current time and particle state.
-    // The Acceleration(...) function is called in this update for each
-    // particle.  This function is virtual so that derived classes can perform
-    // pre-update and/or post-update semantics.
+    // The ComputeAccelerations(...) function is called in this update for
+    // each stage of the solver.  This function is virtual so that derived
+    // classes can perform pre-update and/or post-update semantics.
     virtual void Update(Real time);
 
 protected:
@@ -49,18 +102,58 @@ protected:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity) = 0;
 
+    // Compute acceleration[i] for imin <= i < imax.  The default calls
+    // Acceleration(i,...) for each particle with positive inverse mass and
+    // sets the acceleration of immovable particles to zero.
+    virtual void ComputeAccelerations(int imin, int imax, Real time,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const& velocity,
+        std::vector<Vector<N, Real>>& acceleration);
+
+    // Call function(t, imin, imax) for the partition of the particles into
+    // ranges, one range per thread t.
+    template <typename Function>
+    void Execute(Function const& function);
+
+    void UpdateRungeKutta4(Real time);
+    void UpdateImplicitEuler(Real time);
+
+    // Support for the implicit Euler solver.  Compute
+    //   result = M*(p - h*Jv*p - h^2*Jx*p)
+    // at the state (mPosition,mVelocity) whose accelerations are
+    // mAcceleration, where M is the mass matrix and the components of
+    // immovable particles are zero.
+    void MultiplySystem(Real time, std::vector<Vector<N, Real>> const& p,
+        std::vector<Vector<N, Real>>& result);
+
+    // Compute the dot product of the arrays and the maximum absolute value
+    // of the components of an array.
+    Real Dot(std::vector<Vector<N, Real>> const& u, std::vector<Vector<N, Real>> const& v);
+    Real MaxAbs(std::vector<Vector<N, Real>> const& u);
+
     int mNumParticles;
     std::vector<Real> mMass, mInvMass;
     std::vector<Vector<N, Real>> mPosition, mVelocity;
     Real mStep, mHalfStep, mSixthStep;
+    unsigned int mNumThreads;
+    bool mBatched;
+    Solver mSolver;
+    int mImplicitMaxIterations;
+    Real mImplicitTolerance;
 
-    // Temporary storage for the Runge-Kutta differential equation solver.
-    struct Temporary
-    {
-        Vector<N, Real> d1, d2, d3, d4;
-    };
-    std::vector<Vector<N, Real>> mPTmp, mVTmp;
-    std::vector<Temporary> mPAllTmp, mVAllTmp;
+    // Temporary storage for the differential equation solvers.  The
+    // Runge-Kutta solver alternates between two buffers for the
+    // intermediate states so that each stage reads one buffer while
+    // writing the other, and it accumulates the weighted sum of the
+    // derivatives of the stages.  The implicit Euler solver uses mPTmp[0]
+    // and mVTmp[0] for the perturbed states, mPSum and mVSum for the
+    // velocity change and the right-hand side, and the remaining arrays
+    // for the conjugate gradient iterations.
+    std::vector<Vector<N, Real>> mAcceleration, mPerturbed;
+    std::array<std::vector<Vector<N, Real>>, 2> mPTmp, mVTmp;
+    std::vector<Vector<N, Real>> mPSum, mVSum;
+    std::vector<Vector<N, Real>> mResidual, mDirection, mProduct;
+    std::vector<Real> mPartial;
 };
 
 
@@ -70,7 +163,8 @@ ParticleSystem<N, Real>::~ParticleSystem()
 }
 
 template <int N, typename Real> inline
-ParticleSystem<N, Real>::ParticleSystem(int numParticles, Real step)
+ParticleSystem<N, Real>::ParticleSystem(int numParticles, Real step,
+    unsigned int numThreads)
 :
 mNumParticles(numParticles),
 mMass(numParticles),
@@ -80,15 +174,24 @@ mVelocity(numParticles),
 mStep(step),
 mHalfStep(step / (Real)2),
 mSixthStep(step / (Real)6),
-mPTmp(numParticles),
-mVTmp(numParticles),
-mPAllTmp(numParticles),
-mVAllTmp(numParticles)
+mNumThreads(numThreads > 0 ? numThreads : 1),
+mBatched(false),
+mSolver(RUNGE_KUTTA_4),
+mImplicitMaxIterations(32),
+mImplicitTolerance((Real)1e-4),
+mAcceleration(numParticles),
+mPSum(numParticles),
+mVSum(numParticles)
 {
     std::fill(mMass.begin(), mMass.end(), (Real)0);
     std::fill(mInvMass.begin(), mInvMass.end(), (Real)0);
     std::fill(mPosition.begin(), mPosition.end(), Vector<N, Real>::Zero());
     std::fill(mVelocity.begin(), mVelocity.end(), Vector<N, Real>::Zero());
+    for (int j = 0; j < 2; ++j)
+    {
+        mPTmp[j].resize(numParticles);
+        mVTmp[j].resize(numParticles);
+    }
 }
 
 template <int N, typename Real> inline
@@ -158,105 +261,397 @@ Real ParticleSystem<N, Real>::GetStep() const
     return mStep;
 }
 
+template <int N, typename Real> inline
+void ParticleSystem<N, Real>::SetNumThreads(unsigned int numThreads)
+{
+    mNumThreads = (numThreads > 0 ? numThreads : 1);
+}
+
+template <int N, typename Real> inline
+unsigned int ParticleSystem<N, Real>::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+template <int N, typename Real> inline
+void ParticleSystem<N, Real>::SetBatched(bool batched)
+{
+    mBatched = batched;
+}
+
+template <int N, typename Real> inline
+bool ParticleSystem<N, Real>::GetBatched() const
+{
+    return mBatched;
+}
+
+template <int N, typename Real> inline
+void ParticleSystem<N, Real>::SetSolver(Solver solver)
+{
+    mSolver = solver;
+}
+
+template <int N, typename Real> inline
+typename ParticleSystem<N, Real>::Solver ParticleSystem<N, Real>::GetSolver() const
+{
+    return mSolver;
+}
+
+template <int N, typename Real>
+void ParticleSystem<N, Real>::SetImplicitParameters(int maxIterations,
+    Real tolerance)
+{
+    mImplicitMaxIterations = std::max(maxIterations, 1);
+    mImplicitTolerance = std::max(tolerance, (Real)0);
+}
+
+template <int N, typename Real> inline
+int ParticleSystem<N, Real>::GetImplicitMaxIterations() const
+{
+    return mImplicitMaxIterations;
+}
+
+template <int N, typename Real> inline
+Real ParticleSystem<N, Real>::GetImplicitTolerance() const
+{
+    return mImplicitTolerance;
+}
+
 template <int N, typename Real>
 void ParticleSystem<N, Real>::Update(Real time)
 {
-    // Runge-Kutta fourth-order solver.
-    Real halfTime = time + mHalfStep;
-    Real fullTime = time + mStep;
+    if (mSolver == IMPLICIT_EULER)
+    {
+        UpdateImplicitEuler(time);
+    }
+    else
+    {
+        UpdateRungeKutta4(time);
+    }
+}
 
-    // Compute the first step.
-    int i;
-    for (i = 0; i < mNumParticles; ++i)
+template <int N, typename Real>
+void ParticleSystem<N, Real>::ComputeAccelerations(int imin, int imax,
+    Real time, std::vector<Vector<N, Real>> const& position,
+    std::vector<Vector<N, Real>> const& velocity,
+    std::vector<Vector<N, Real>>& acceleration)
+{
+    for (int i = imin; i < imax; ++i)
     {
-        if (mInvMass[i] >(Real)0)
+        if (mInvMass[i] > (Real)0)
         {
-            mPAllTmp[i].d1 = mVelocity[i];
-            mVAllTmp[i].d1 = Acceleration(i, time, mPosition, mVelocity);
+            acceleration[i] = Acceleration(i, time, position, velocity);
+        }
+        else
+        {
+            acceleration[i].MakeZero();
         }
     }
-    for (i = 0; i < mNumParticles; ++i)
+}
+
+template <int N, typename Real>
+template <typename Function>
+void ParticleSystem<N, Real>::Execute(Function const& function)
+{
+    unsigned int numThreads = mNumThreads;
+    if (static_cast<unsigned int>(mNumParticles) < numThreads)
+    {
+        numThreads = 1;
+    }
+
+    if (numThreads > 1)
     {
-        if (mInvMass[i] >(Real)0)
+        int const numPerThread = mNumParticles / static_cast<int>(numThreads);
+        std::vector<std::thread> process(numThreads);
+        for (unsigned int t = 0; t < numThreads; ++t)
         {
-            mPTmp[i] = mPosition[i] + mHalfStep * mPAllTmp[i].d1;
-            mVTmp[i] = mVelocity[i] + mHalfStep * mVAllTmp[i].d1;
+            int imin = static_cast<int>(t) * numPerThread;
+            int imax = (t + 1 < numThreads ? imin + numPerThread : mNumParticles);
+            process[t] = std::thread([&function, t, imin, imax]()
+            {
+                function(t, imin, imax);
+            });
         }
-        else
+
+        for (auto& p : process)
         {
-            mPTmp[i] = mPosition[i];
-            mVTmp[i].MakeZero();
+            p.join();
         }
     }
+    else
+    {
+        function(0, 0, mNumParticles);
+    }
+}
+
+template <int N, typename Real>
+void ParticleSystem<N, Real>::UpdateRungeKutta4(Real time)
+{
+    // The stage times, the step sizes used to compute the next stage from
+    // the initial state, and the weights of the derivatives in the final
+    // combination.
+    Real const halfTime = time + mHalfStep;
+    Real const fullTime = time + mStep;
+    Real const stageTime[4] = { time, halfTime, halfTime, fullTime };
+    Real const stageStep[3] = { mHalfStep, mHalfStep, mStep };
+    Real const stageWeight[4] = { (Real)1, (Real)2, (Real)2, (Real)1 };
+
+    for (int stage = 0; stage < 4; ++stage)
+    {
+        // The first stage reads the current state.  The other stages read
+        // the buffer written by the previous stage.
+        auto const& P = (stage == 0 ? mPosition : mPTmp[(stage + 1) % 2]);
+        auto const& V = (stage == 0 ? mVelocity : mVTmp[(stage + 1) % 2]);
+        auto& nextP = mPTmp[stage % 2];
+        auto& nextV = mVTmp[stage % 2];
+        Real const weight = stageWeight[stage];
+
+        Execute([this, stage, &stageTime, &stageStep, weight, &P, &V, &nextP, &nextV]
+            (unsigned int, int imin, int imax)
+        {
+            ComputeAccelerations(imin, imax, stageTime[stage], P, V, mAcceleration);
+
+            for (int i = imin; i < imax; ++i)
+            {
+                if (mInvMass[i] > (Real)0)
+                {
+                    if (stage == 0)
+                    {
+                        mPSum[i] = V[i];
+                        mVSum[i] = mAcceleration[i];
+                    }
+                    else
+                    {
+                        mPSum[i] += weight * V[i];
+                        mVSum[i] += weight * mAcceleration[i];
+                    }
+
+                    if (stage < 3)
+                    {
+                        Real const step = stageStep[stage];
+                        nextP[i] = mPosition[i] + step * V[i];
+                        nextV[i] = mVelocity[i] + step * mAcceleration[i];
+                    }
+                    else
+                    {
+                        mPosition[i] += mSixthStep * mPSum[i];
+                        mVelocity[i] += mSixthStep * mVSum[i];
+                    }
+                }
+                else if (stage < 3)
+                {
+                    nextP[i] = mPosition[i];
+                    nextV[i].MakeZero();
+                }
+            }
+        });
+    }
+}
+
+template <int N, typename Real>
+void ParticleSystem<N, Real>::UpdateImplicitEuler(Real time)
+{
+    Real const fullTime = time + mStep;
+    mPerturbed.resize(mNumParticles);
+    mResidual.resize(mNumParticles);
+    mDirection.resize(mNumParticles);
+    mProduct.resize(mNumParticles);
+
+    // a0 = a(x,v) at the end of the step.
+    Execute([this, fullTime](unsigned int, int imin, int imax)
+    {
+        ComputeAccelerations(imin, imax, fullTime, mPosition, mVelocity, mAcceleration);
+    });
 
-    // Compute the second step.
-    for (i = 0; i < mNumParticles; ++i)
+    // The right-hand side b = M*(h*a0 + h^2*Jx*v) is stored in mVSum.  The
+    // product Jx*v is approximated by (a(x+e*v,v) - a0)/e.
+    Real const h = mStep, hSqr = mStep * mStep;
+    Real const rootEpsilon = std::sqrt(std::numeric_limits<Real>::epsilon());
+    Real const maxPosition = MaxAbs(mPosition);
+    Real const maxVelocity = MaxAbs(mVelocity);
+    if (maxVelocity > (Real)0)
     {
-        if (mInvMass[i] >(Real)0)
+        Real const e = rootEpsilon * ((Real)1 + maxPosition) / maxVelocity;
+        Execute([this, e](unsigned int, int imin, int imax)
         {
-            mPAllTmp[i].d2 = mVTmp[i];
-            mVAllTmp[i].d2 = Acceleration(i, halfTime, mPTmp, mVTmp);
-        }
+            for (int i = imin; i < imax; ++i)
+            {
+                mPTmp[0][i] = mPosition[i] + e * mVelocity[i];
+            }
+        });
+        Execute([this, fullTime, e, h, hSqr](unsigned int, int imin, int imax)
+        {
+            ComputeAccelerations(imin, imax, fullTime, mPTmp[0], mVelocity, mPerturbed);
+            Real const invE = ((Real)1) / e;
+            for (int i = imin; i < imax; ++i)
+            {
+                mVSum[i] = mMass[i] * (h * mAcceleration[i] +
+                    (hSqr * invE) * (mPerturbed[i] - mAcceleration[i]));
+            }
+        });
     }
-    for (i = 0; i < mNumParticles; ++i)
+    else
     {
-        if (mInvMass[i] >(Real)0)
+        Execute([this, h](unsigned int, int imin, int imax)
         {
-            mPTmp[i] = mPosition[i] + mHalfStep * mPAllTmp[i].d2;
-            mVTmp[i] = mVelocity[i] + mHalfStep * mVAllTmp[i].d2;
+            for (int i = imin; i < imax; ++i)
+            {
+                mVSum[i] = (mMass[i] * h) * mAcceleration[i];
+            }
+        });
+    }
+    Execute([this](unsigned int, int imin, int imax)
+    {
+        for (int i = imin; i < imax; ++i)
+        {
+            if (mInvMass[i] == (Real)0)
+            {
+                mVSum[i].MakeZero();
+            }
         }
-        else
+    });
+
+    // Solve for dv (stored in mPSum) by conjugate gradient iterations
+    // starting at dv = 0.
+    std::fill(mPSum.begin(), mPSum.end(), Vector<N, Real>::Zero());
+    mResidual = mVSum;
+    mDirection = mVSum;
+    Real rho = Dot(mResidual, mResidual);
+    Real const threshold = mImplicitTolerance * mImplicitTolerance * rho;
+    for (int iteration = 0; iteration < mImplicitMaxIterations && rho > threshold; ++iteration)
+    {
+        MultiplySystem(fullTime, mDirection, mProduct);
+        Real denominator = Dot(mDirection, mProduct);
+        if (denominator <= (Real)0)
         {
-            mPTmp[i] = mPosition[i];
-            mVTmp[i].MakeZero();
+            // The linearized system is not positive definite in this
+            // direction, which can happen for compressed springs.  Keep
+            // the current estimate of dv.
+            break;
         }
+
+        Real const alpha = rho / denominator;
+        Execute([this, alpha](unsigned int, int imin, int imax)
+        {
+            for (int i = imin; i < imax; ++i)
+            {
+                mPSum[i] += alpha * mDirection[i];
+                mResidual[i] -= alpha * mProduct[i];
+            }
+        });
+
+        Real const rhoNext = Dot(mResidual, mResidual);
+        Real const beta = rhoNext / rho;
+        rho = rhoNext;
+        Execute([this, beta](unsigned int, int imin, int imax)
+        {
+            for (int i = imin; i < imax; ++i)
+            {
+                mDirection[i] = mResidual[i] + beta * mDirection[i];
+            }
+        });
     }
 
-    // Compute the third step.
-    for (i = 0; i < mNumParticles; ++i)
+    // v' = v + dv, x' = x + h*v'
+    Execute([this, h](unsigned int, int imin, int imax)
     {
-        if (mInvMass[i] >(Real)0)
+        for (int i = imin; i < imax; ++i)
         {
-            mPAllTmp[i].d3 = mVTmp[i];
-            mVAllTmp[i].d3 = Acceleration(i, halfTime, mPTmp, mVTmp);
+            if (mInvMass[i] > (Real)0)
+            {
+                mVelocity[i] += mPSum[i];
+                mPosition[i] += h * mVelocity[i];
+            }
         }
+    });
+}
+
+template <int N, typename Real>
+void ParticleSystem<N, Real>::MultiplySystem(Real time,
+    std::vector<Vector<N, Real>> const& p, std::vector<Vector<N, Real>>& result)
+{
+    // (h*Jv + h^2*Jx)*p is approximated by
+    // (a(x + e*h^2*p, v + e*h*p) - a(x,v))/e.
+    Real const h = mStep, hSqr = mStep * mStep;
+    Real const maxP = MaxAbs(p);
+    if (maxP == (Real)0)
+    {
+        std::fill(result.begin(), result.end(), Vector<N, Real>::Zero());
+        return;
     }
-    for (i = 0; i < mNumParticles; ++i)
+
+    Real const rootEpsilon = std::sqrt(std::numeric_limits<Real>::epsilon());
+    Real const maxPosition = MaxAbs(mPosition);
+    Real const e = rootEpsilon * ((Real)1 + maxPosition) / (hSqr * maxP);
+    Real const eh = e * h, ehSqr = e * hSqr;
+    Execute([this, &p, eh, ehSqr](unsigned int, int imin, int imax)
     {
-        if (mInvMass[i] >(Real)0)
+        for (int i = imin; i < imax; ++i)
         {
-            mPTmp[i] = mPosition[i] + mStep * mPAllTmp[i].d3;
-            mVTmp[i] = mVelocity[i] + mStep * mVAllTmp[i].d3;
+            mPTmp[0][i] = mPosition[i] + ehSqr * p[i];
+            mVTmp[0][i] = mVelocity[i] + eh * p[i];
         }
-        else
+    });
+
+    Execute([this, &p, &result, time, e](unsigned int, int imin, int imax)
+    {
+        ComputeAccelerations(imin, imax, time, mPTmp[0], mVTmp[0], mPerturbed);
+        Real const invE = ((Real)1) / e;
+        for (int i = imin; i < imax; ++i)
         {
-            mPTmp[i] = mPosition[i];
-            mVTmp[i].MakeZero();
+            if (mInvMass[i] > (Real)0)
+            {
+                result[i] = mMass[i] * (p[i] - invE * (mPerturbed[i] - mAcceleration[i]));
+            }
+            else
+            {
+                result[i].MakeZero();
+            }
         }
-    }
+    });
+}
 
-    // Compute the fourth step.
-    for (i = 0; i < mNumParticles; ++i)
+template <int N, typename Real>
+Real ParticleSystem<N, Real>::Dot(std::vector<Vector<N, Real>> const& u,
+    std::vector<Vector<N, Real>> const& v)
+{
+    mPartial.assign(mNumThreads, (Real)0);
+    Execute([this, &u, &v](unsigned int t, int imin, int imax)
     {
-        if (mInvMass[i] >(Real)0)
+        Real sum = (Real)0;
+        for (int i = imin; i < imax; ++i)
         {
-            mPAllTmp[i].d4 = mVTmp[i];
-            mVAllTmp[i].d4 = Acceleration(i, fullTime, mPTmp, mVTmp);
+            sum += gte::Dot(u[i], v[i]);
         }
+        mPartial[t] = sum;
+    });
+
+    Real sum = (Real)0;
+    for (auto value : mPartial)
+    {
+        sum += value;
     }
-    for (i = 0; i < mNumParticles; ++i)
+    return sum;
+}
+
+template <int N, typename Real>
+Real ParticleSystem<N, Real>::MaxAbs(std::vector<Vector<N, Real>> const& u)
+{
+    mPartial.assign(mNumThreads, (Real)0);
+    Execute([this, &u](unsigned int t, int imin, int imax)
     {
-        if (mInvMass[i] >(Real)0)
+        Real maxAbs = (Real)0;
+        for (int i = imin; i < imax; ++i)
         {
-            mPosition[i] += mSixthStep * (mPAllTmp[i].d1 +
-                ((Real)2) * (mPAllTmp[i].d2 + mPAllTmp[i].d3) +
-                mPAllTmp[i].d4);
-
-            mVelocity[i] += mSixthStep * (mVAllTmp[i].d1 +
-                ((Real)2) * (mVAllTmp[i].d2 + mVAllTmp[i].d3) +
-                mVAllTmp[i].d4);
+            for (int j = 0; j < N; ++j)
+            {
+                maxAbs = std::max(maxAbs, std::abs(u[i][j]));
+            }
         }
-    }
+        mPartial[t] = maxAbs;
+    });
+
+    return *std::max_element(mPartial.begin(), mPartial.end());
 }
 
 
@@ -0,0 +1,764 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/05)
+
+#pragma once
+
+#include <Physics/GteRigidBody.h>
+#include <array>
+#include <thread>
+#include <vector>
+
+// RigidBodyWorld integrates a large number of rigid bodies with the same
+// Runge-Kutta fourth-order solver as RigidBody::Update.  The body states are
+// stored in structure-of-arrays form, one array per component, so that each
+// stage of the solver is a loop over contiguous memory that the compiler can
+// vectorize.  The force and torque are computed by a single callback per
+// stage for a range of bodies rather than by two std::function calls per
+// body.  The bodies are partitioned into contiguous ranges that are updated
+// in parallel when the world is constructed with numThreads larger than 1.
+//
+// The world inertia tensors are never formed.  The angular velocity is
+// computed from the angular momentum L as w = R*(J^{-1}*(R^T*L)), which
+// requires three matrix-vector products.  The body inertia tensors are
+// symmetric, so only the upper-triangular entries of the inverses are
+// stored.
+
+namespace gte
+{
+
+template <typename Real>
+class RigidBodyWorld
+{
+public:
+    // Each vector-valued quantity is stored as N arrays, one per component.
+    template <int N>
+    using Components = std::array<std::vector<Real>, N>;
+
+    // The state of the bodies.  The rotation matrix entries are stored in
+    // row-major order, rotation[3*r+c] = R(r,c).
+    struct State
+    {
+        Components<3> position;
+        Components<4> quaternion;
+        Components<3> linearMomentum;
+        Components<3> angularMomentum;
+        Components<9> rotation;
+        Components<3> linearVelocity;
+        Components<3> angularVelocity;
+    };
+
+    // Construction.  The bodies are immovable, as is a default-constructed
+    // RigidBody.  Use the set functions to initialize the states before
+    // starting the simulation.
+    RigidBodyWorld(int numBodies, unsigned int numThreads = 1);
+
+    // Member access.
+    inline int GetNumBodies() const;
+    inline State const& GetState() const;
+
+    // Set the state of body i.
+    void SetMass(int i, Real mass);
+    void SetBodyInertia(int i, Matrix3x3<Real> const& inertia);
+    void SetPosition(int i, Vector3<Real> const& position);
+    void SetQOrientation(int i, Quaternion<Real> const& quatOrient);
+    void SetLinearMomentum(int i, Vector3<Real> const& linearMomentum);
+    void SetAngularMomentum(int i, Vector3<Real> const& angularMomentum);
+    void SetROrientation(int i, Matrix3x3<Real> const& rotOrient);
+    void SetLinearVelocity(int i, Vector3<Real> const& linearVelocity);
+    void SetAngularVelocity(int i, Vector3<Real> const& angularVelocity);
+
+    // Get the state of body i.
+    inline Real GetMass(int i) const;
+    inline Real GetInverseMass(int i) const;
+    inline Matrix3x3<Real> const& GetBodyInertia(int i) const;
+    Matrix3x3<Real> GetBodyInverseInertia(int i) const;
+    Matrix3x3<Real> GetWorldInertia(int i) const;
+    Matrix3x3<Real> GetWorldInverseInertia(int i) const;
+    Vector3<Real> GetPosition(int i) const;
+    Quaternion<Real> GetQOrientation(int i) const;
+    Vector3<Real> GetLinearMomentum(int i) const;
+    Vector3<Real> GetAngularMomentum(int i) const;
+    Matrix3x3<Real> GetROrientation(int i) const;
+    Vector3<Real> GetLinearVelocity(int i) const;
+    Vector3<Real> GetAngularVelocity(int i) const;
+
+    // Copy the state of a RigidBody object into body i, or copy the state
+    // of body i into a RigidBody object.  The force and torque functions of
+    // the object are neither used nor modified.
+    void Set(int i, RigidBody<Real> const& body);
+    void Get(int i, RigidBody<Real>& body) const;
+
+    // Force/torque function format.  The function must compute the force
+    // and torque for the bodies imin <= i < imax at the specified time and
+    // store them in force[][i] and torque[][i].  The states of the bodies
+    // are in 'state'.  The force and torque of body i may depend only on
+    // the state of body i; the other bodies are at different stages of the
+    // solver.  When numThreads is larger than 1, the function is called
+    // concurrently for disjoint ranges, so it must be thread safe.
+    typedef std::function
+    <
+        void
+        (
+            Real,                       // time of application
+            int,                        // imin
+            int,                        // imax
+            RigidBodyWorld const&,      // the world (for mass and inertia)
+            State const&,               // state of the bodies
+            Components<3>&,             // force
+            Components<3>&              // torque
+        )
+    >
+    Function;
+
+    Function mForceTorque;
+
+    // Runge-Kutta fourth-order differential equation solver applied to all
+    // the bodies.
+    void Update(Real t, Real dt);
+
+private:
+    void Update(int imin, int imax, Real t, Real dt);
+
+    // Compute the orientation matrix, linear velocity and angular velocity
+    // of body i from its quaternion and momenta.
+    void ComputeDerived(int i, State& state) const;
+
+    // Call the force/torque function and compute the derivatives of the
+    // state 'source' for the bodies imin <= i < imax.  The derivatives of
+    // the momenta are the force and torque; the derivative of the position
+    // is the linear velocity, which is read directly from 'source'.
+    void ComputeDerivatives(int imin, int imax, Real time, State const& source);
+
+    int mNumBodies;
+    unsigned int mNumThreads;
+
+    // Constant quantities.  The inverse inertia tensors are stored as the
+    // upper-triangular entries (00, 01, 02, 11, 12, 22).
+    std::vector<Real> mMass, mInvMass;
+    std::vector<Matrix3x3<Real>> mInertia;
+    Components<6> mInvInertia;
+
+    // The current state and the state at the intermediate stages of the
+    // solver.
+    State mState, mStage;
+
+    // Storage for the derivatives at a stage and their weighted sums over
+    // the stages.
+    Components<3> mForce, mTorque;
+    Components<4> mDQDT;
+    Components<3> mSumDXDT, mSumDPDT, mSumDLDT;
+    Components<4> mSumDQDT;
+};
+
+
+template <typename Real>
+RigidBodyWorld<Real>::RigidBodyWorld(int numBodies, unsigned int numThreads)
+    :
+    mNumBodies(numBodies),
+    mNumThreads(numThreads),
+    mMass(numBodies, std::numeric_limits<Real>::max()),
+    mInvMass(numBodies, (Real)0),
+    mInertia(numBodies, Matrix3x3<Real>::Identity())
+{
+    // The default bodies are immovable.
+    auto resize = [numBodies](std::vector<Real>& component, Real value)
+    {
+        component.resize(numBodies, value);
+    };
+
+    for (int j = 0; j < 6; ++j)
+    {
+        resize(mInvInertia[j], (Real)0);
+    }
+
+    for (State* state : { &mState, &mStage })
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            resize(state->position[j], (Real)0);
+            resize(state->linearMomentum[j], (Real)0);
+            resize(state->angularMomentum[j], (Real)0);
+            resize(state->linearVelocity[j], (Real)0);
+            resize(state->angularVelocity[j], (Real)0);
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            resize(state->quaternion[j], (Real)(j == 3 ? 1 : 0));
+        }
+        for (int j = 0; j < 9; ++j)
+        {
+            resize(state->rotation[j], (Real)(j % 4 == 0 ? 1 : 0));
+        }
+    }
+
+    for (int j = 0; j < 3; ++j)
+    {
+        resize(mForce[j], (Real)0);
+        resize(mTorque[j], (Real)0);
+        resize(mSumDXDT[j], (Real)0);
+        resize(mSumDPDT[j], (Real)0);
+        resize(mSumDLDT[j], (Real)0);
+    }
+    for (int j = 0; j < 4; ++j)
+    {
+        resize(mDQDT[j], (Real)0);
+        resize(mSumDQDT[j], (Real)0);
+    }
+}
+
+template <typename Real> inline
+int RigidBodyWorld<Real>::GetNumBodies() const
+{
+    return mNumBodies;
+}
+
+template <typename Real> inline
+typename RigidBodyWorld<Real>::State const& RigidBodyWorld<Real>::GetState() const
+{
+    return mState;
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetMass(int i, Real mass)
+{
+    if ((Real)0 < mass && mass < std::numeric_limits<Real>::max())
+    {
+        mMass[i] = mass;
+        mInvMass[i] = ((Real)1) / mass;
+    }
+    else
+    {
+        // Assume the body as immovable.
+        mMass[i] = std::numeric_limits<Real>::max();
+        mInvMass[i] = (Real)0;
+        mInertia[i] = Matrix3x3<Real>::Identity();
+        for (int j = 0; j < 6; ++j)
+        {
+            mInvInertia[j][i] = (Real)0;
+        }
+        SetQOrientation(i, Quaternion<Real>::Identity());
+        for (int j = 0; j < 3; ++j)
+        {
+            mState.linearMomentum[j][i] = (Real)0;
+            mState.angularMomentum[j][i] = (Real)0;
+        }
+        ComputeDerived(i, mState);
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetBodyInertia(int i, Matrix3x3<Real> const& inertia)
+{
+    mInertia[i] = inertia;
+    Matrix3x3<Real> invInertia = Inverse(inertia);
+    mInvInertia[0][i] = invInertia(0, 0);
+    mInvInertia[1][i] = invInertia(0, 1);
+    mInvInertia[2][i] = invInertia(0, 2);
+    mInvInertia[3][i] = invInertia(1, 1);
+    mInvInertia[4][i] = invInertia(1, 2);
+    mInvInertia[5][i] = invInertia(2, 2);
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetPosition(int i, Vector3<Real> const& position)
+{
+    for (int j = 0; j < 3; ++j)
+    {
+        mState.position[j][i] = position[j];
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetQOrientation(int i, Quaternion<Real> const& quatOrient)
+{
+    for (int j = 0; j < 4; ++j)
+    {
+        mState.quaternion[j][i] = quatOrient[j];
+    }
+    ComputeDerived(i, mState);
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetLinearMomentum(int i, Vector3<Real> const& linearMomentum)
+{
+    for (int j = 0; j < 3; ++j)
+    {
+        mState.linearMomentum[j][i] = linearMomentum[j];
+        mState.linearVelocity[j][i] = mInvMass[i] * linearMomentum[j];
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetAngularMomentum(int i, Vector3<Real> const& angularMomentum)
+{
+    for (int j = 0; j < 3; ++j)
+    {
+        mState.angularMomentum[j][i] = angularMomentum[j];
+    }
+    ComputeDerived(i, mState);
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetROrientation(int i, Matrix3x3<Real> const& rotOrient)
+{
+    Quaternion<Real> quatOrient = Rotation<3, Real>(rotOrient);
+    for (int j = 0; j < 4; ++j)
+    {
+        mState.quaternion[j][i] = quatOrient[j];
+    }
+    for (int j = 0; j < 9; ++j)
+    {
+        mState.rotation[j][i] = rotOrient(j / 3, j % 3);
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetLinearVelocity(int i, Vector3<Real> const& linearVelocity)
+{
+    for (int j = 0; j < 3; ++j)
+    {
+        mState.linearVelocity[j][i] = linearVelocity[j];
+        mState.linearMomentum[j][i] = mMass[i] * linearVelocity[j];
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::SetAngularVelocity(int i, Vector3<Real> const& angularVelocity)
+{
+    Matrix3x3<Real> rotOrient = GetROrientation(i);
+    Vector3<Real> angularMomentum = angularVelocity * rotOrient;  // M = R^T*V
+    angularMomentum = mInertia[i] * angularMomentum;              // M = J*R^T*V
+    angularMomentum = rotOrient * angularMomentum;                // M = R*J*R^T*V
+    for (int j = 0; j < 3; ++j)
+    {
+        mState.angularVelocity[j][i] = angularVelocity[j];
+        mState.angularMomentum[j][i] = angularMomentum[j];
+    }
+}
+
+template <typename Real> inline
+Real RigidBodyWorld<Real>::GetMass(int i) const
+{
+    return mMass[i];
+}
+
+template <typename Real> inline
+Real RigidBodyWorld<Real>::GetInverseMass(int i) const
+{
+    return mInvMass[i];
+}
+
+template <typename Real> inline
+Matrix3x3<Real> const& RigidBodyWorld<Real>::GetBodyInertia(int i) const
+{
+    return mInertia[i];
+}
+
+template <typename Real>
+Matrix3x3<Real> RigidBodyWorld<Real>::GetBodyInverseInertia(int i) const
+{
+    Matrix3x3<Real> invInertia;
+    invInertia(0, 0) = mInvInertia[0][i];
+    invInertia(0, 1) = mInvInertia[1][i];
+    invInertia(0, 2) = mInvInertia[2][i];
+    invInertia(1, 0) = mInvInertia[1][i];
+    invInertia(1, 1) = mInvInertia[3][i];
+    invInertia(1, 2) = mInvInertia[4][i];
+    invInertia(2, 0) = mInvInertia[2][i];
+    invInertia(2, 1) = mInvInertia[4][i];
+    invInertia(2, 2) = mInvInertia[5][i];
+    return invInertia;
+}
+
+template <typename Real>
+Matrix3x3<Real> RigidBodyWorld<Real>::GetWorldInertia(int i) const
+{
+    Matrix3x3<Real> rotOrient = GetROrientation(i);
+    return MultiplyABT(rotOrient * mInertia[i], rotOrient);  // R*J*R^T
+}
+
+template <typename Real>
+Matrix3x3<Real> RigidBodyWorld<Real>::GetWorldInverseInertia(int i) const
+{
+    Matrix3x3<Real> rotOrient = GetROrientation(i);
+    return MultiplyABT(rotOrient * GetBodyInverseInertia(i), rotOrient);  // R*J^{-1}*R^T
+}
+
+template <typename Real>
+Vector3<Real> RigidBodyWorld<Real>::GetPosition(int i) const
+{
+    return Vector3<Real>{ mState.position[0][i], mState.position[1][i],
+        mState.position[2][i] };
+}
+
+template <typename Real>
+Quaternion<Real> RigidBodyWorld<Real>::GetQOrientation(int i) const
+{
+    return Quaternion<Real>(mState.quaternion[0][i], mState.quaternion[1][i],
+        mState.quaternion[2][i], mState.quaternion[3][i]);
+}
+
+template <typename Real>
+Vector3<Real> RigidBodyWorld<Real>::GetLinearMomentum(int i) const
+{
+    return Vector3<Real>{ mState.linearMomentum[0][i],
+        mState.linearMomentum[1][i], mState.linearMomentum[2][i] };
+}
+
+template <typename Real>
+Vector3<Real> RigidBodyWorld<Real>::GetAngularMomentum(int i) const
+{
+    return Vector3<Real>{ mState.angularMomentum[0][i],
+        mState.angularMomentum[1][i], mState.angularMomentum[2][i] };
+}
+
+template <typename Real>
+Matrix3x3<Real> RigidBodyWorld<Real>::GetROrientation(int i) const
+{
+    Matrix3x3<Real> rotOrient;
+    for (int j = 0; j < 9; ++j)
+    {
+        rotOrient(j / 3, j % 3) = mState.rotation[j][i];
+    }
+    return rotOrient;
+}
+
+template <typename Real>
+Vector3<Real> RigidBodyWorld<Real>::GetLinearVelocity(int i) const
+{
+    return Vector3<Real>{ mState.linearVelocity[0][i],
+        mState.linearVelocity[1][i], mState.linearVelocity[2][i] };
+}
+
+template <typename Real>
+Vector3<Real> RigidBodyWorld<Real>::GetAngularVelocity(int i) const
+{
+    return Vector3<Real>{ mState.angularVelocity[0][i],
+        mState.angularVelocity[1][i], mState.angularVelocity[2][i] };
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::Set(int i, RigidBody<Real> const& body)
+{
+    SetMass(i, body.GetMass());
+    SetBodyInertia(i, body.GetBodyInertia());
+    SetPosition(i, body.GetPosition());
+    SetQOrientation(i, body.GetQOrientation());
+    SetLinearMomentum(i, body.GetLinearMomentum());
+    SetAngularMomentum(i, body.GetAngularMomentum());
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::Get(int i, RigidBody<Real>& body) const
+{
+    if (mInvMass[i] == (Real)0)
+    {
+        // The body is immovable.  Casting the Real-valued sentinel
+        // std::numeric_limits<Real>::max() to float is undefined when Real
+        // is double, so pass the float infinity explicitly; RigidBody then
+        // selects its own immovable state (zero inverse mass and inverse
+        // inertia, zero momenta).
+        body.SetMass(std::numeric_limits<float>::infinity());
+        body.SetPosition(GetPosition(i));
+        body.SetQOrientation(GetQOrientation(i));
+        return;
+    }
+
+    body.SetMass(static_cast<float>(mMass[i]));
+    body.SetBodyInertia(mInertia[i]);
+    body.SetPosition(GetPosition(i));
+    body.SetQOrientation(GetQOrientation(i));
+    body.SetLinearMomentum(GetLinearMomentum(i));
+    body.SetAngularMomentum(GetAngularMomentum(i));
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::Update(Real t, Real dt)
+{
+    if (mNumThreads > 1 && mNumBodies >= static_cast<int>(mNumThreads))
+    {
+        // Partition the bodies into contiguous ranges, one per thread.
+        int const numThreads = static_cast<int>(mNumThreads);
+        int const numPerThread = mNumBodies / numThreads;
+        std::vector<std::thread> process(numThreads);
+        for (int k = 0, imin = 0; k < numThreads; ++k, imin += numPerThread)
+        {
+            int imax = (k + 1 < numThreads ? imin + numPerThread : mNumBodies);
+            process[k] = std::thread([this, imin, imax, t, dt]()
+            {
+                Update(imin, imax, t, dt);
+            });
+        }
+
+        for (auto& p : process)
+        {
+            p.join();
+        }
+    }
+    else
+    {
+        Update(0, mNumBodies, t, dt);
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::Update(int imin, int imax, Real t, Real dt)
+{
+    Real const halfDT = ((Real)0.5)*dt;
+    Real const sixthDT = dt / ((Real)6);
+    Real const two = (Real)2;
+    Real const TpHalfDT = t + halfDT;
+    Real const TpDT = t + dt;
+
+    // The stage times, the step sizes used to compute the next stage from
+    // the initial state S0, and the weights of the derivatives in the final
+    // combination S1 = S0 + (DT/6)*(A1+2*(A2+A3)+A4).
+    Real const time[4] = { t, TpHalfDT, TpHalfDT, TpDT };
+    Real const step[3] = { halfDT, halfDT, dt };
+    Real const weight[4] = { (Real)1, two, two, (Real)1 };
+
+    State& S0 = mState;
+    State& B = mStage;
+
+    for (int stage = 0; stage < 4; ++stage)
+    {
+        // A = G(time,source).  The first stage is evaluated at S0 and the
+        // others at the previous stage B.
+        State const& source = (stage == 0 ? S0 : B);
+        ComputeDerivatives(imin, imax, time[stage], source);
+
+        Real const w = weight[stage];
+        if (stage == 0)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                Real const* dxdt = source.linearVelocity[j].data();
+                Real const* dpdt = mForce[j].data();
+                Real const* dldt = mTorque[j].data();
+                Real* sumDXDT = mSumDXDT[j].data();
+                Real* sumDPDT = mSumDPDT[j].data();
+                Real* sumDLDT = mSumDLDT[j].data();
+                for (int i = imin; i < imax; ++i)
+                {
+                    sumDXDT[i] = dxdt[i];
+                    sumDPDT[i] = dpdt[i];
+                    sumDLDT[i] = dldt[i];
+                }
+            }
+            for (int j = 0; j < 4; ++j)
+            {
+                Real const* dqdt = mDQDT[j].data();
+                Real* sumDQDT = mSumDQDT[j].data();
+                for (int i = imin; i < imax; ++i)
+                {
+                    sumDQDT[i] = dqdt[i];
+                }
+            }
+        }
+        else
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                Real const* dxdt = source.linearVelocity[j].data();
+                Real const* dpdt = mForce[j].data();
+                Real const* dldt = mTorque[j].data();
+                Real* sumDXDT = mSumDXDT[j].data();
+                Real* sumDPDT = mSumDPDT[j].data();
+                Real* sumDLDT = mSumDLDT[j].data();
+                for (int i = imin; i < imax; ++i)
+                {
+                    sumDXDT[i] += w * dxdt[i];
+                    sumDPDT[i] += w * dpdt[i];
+                    sumDLDT[i] += w * dldt[i];
+                }
+            }
+            for (int j = 0; j < 4; ++j)
+            {
+                Real const* dqdt = mDQDT[j].data();
+                Real* sumDQDT = mSumDQDT[j].data();
+                for (int i = imin; i < imax; ++i)
+                {
+                    sumDQDT[i] += w * dqdt[i];
+                }
+            }
+        }
+
+        if (stage < 3)
+        {
+            // B = S0 + step*A.  When the source is B, its velocities are
+            // read before ComputeDerived overwrites them.
+            Real const h = step[stage];
+            for (int j = 0; j < 3; ++j)
+            {
+                Real const* x0 = S0.position[j].data();
+                Real const* p0 = S0.linearMomentum[j].data();
+                Real const* l0 = S0.angularMomentum[j].data();
+                Real const* dxdt = source.linearVelocity[j].data();
+                Real const* dpdt = mForce[j].data();
+                Real const* dldt = mTorque[j].data();
+                Real* x = B.position[j].data();
+                Real* p = B.linearMomentum[j].data();
+                Real* l = B.angularMomentum[j].data();
+                for (int i = imin; i < imax; ++i)
+                {
+                    x[i] = x0[i] + h * dxdt[i];
+                    p[i] = p0[i] + h * dpdt[i];
+                    l[i] = l0[i] + h * dldt[i];
+                }
+            }
+            for (int j = 0; j < 4; ++j)
+            {
+                Real const* q0 = S0.quaternion[j].data();
+                Real const* dqdt = mDQDT[j].data();
+                Real* q = B.quaternion[j].data();
+                for (int i = imin; i < imax; ++i)
+                {
+                    q[i] = q0[i] + h * dqdt[i];
+                }
+            }
+            for (int i = imin; i < imax; ++i)
+            {
+                ComputeDerived(i, B);
+            }
+        }
+    }
+
+    // S1 = S0 + (DT/6)*(A1+2*(A2+A3)+A4)
+    for (int j = 0; j < 3; ++j)
+    {
+        Real* x = S0.position[j].data();
+        Real* p = S0.linearMomentum[j].data();
+        Real* l = S0.angularMomentum[j].data();
+        Real const* sumDXDT = mSumDXDT[j].data();
+        Real const* sumDPDT = mSumDPDT[j].data();
+        Real const* sumDLDT = mSumDLDT[j].data();
+        for (int i = imin; i < imax; ++i)
+        {
+            x[i] += sixthDT * sumDXDT[i];
+            p[i] += sixthDT * sumDPDT[i];
+            l[i] += sixthDT * sumDLDT[i];
+        }
+    }
+    for (int j = 0; j < 4; ++j)
+    {
+        Real* q = S0.quaternion[j].data();
+        Real const* sumDQDT = mSumDQDT[j].data();
+        for (int i = imin; i < imax; ++i)
+        {
+            q[i] += sixthDT * sumDQDT[i];
+        }
+    }
+    for (int i = imin; i < imax; ++i)
+    {
+        ComputeDerived(i, S0);
+    }
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::ComputeDerived(int i, State& state) const
+{
+    Real const qx = state.quaternion[0][i];
+    Real const qy = state.quaternion[1][i];
+    Real const qz = state.quaternion[2][i];
+    Real const qw = state.quaternion[3][i];
+
+    // The conversion is that of Rotation<3,Real>(Quaternion<Real>).
+    Real const twoX = ((Real)2)*qx;
+    Real const twoY = ((Real)2)*qy;
+    Real const twoZ = ((Real)2)*qz;
+    Real const twoXX = twoX*qx;
+    Real const twoXY = twoX*qy;
+    Real const twoXZ = twoX*qz;
+    Real const twoXW = twoX*qw;
+    Real const twoYY = twoY*qy;
+    Real const twoYZ = twoY*qz;
+    Real const twoYW = twoY*qw;
+    Real const twoZZ = twoZ*qz;
+    Real const twoZW = twoZ*qw;
+
+    Real r[9];
+    r[0] = (Real)1 - twoYY - twoZZ;
+    r[4] = (Real)1 - twoXX - twoZZ;
+    r[8] = (Real)1 - twoXX - twoYY;
+#if defined(GTE_USE_MAT_VEC)
+    r[1] = twoXY - twoZW;
+    r[2] = twoXZ + twoYW;
+    r[3] = twoXY + twoZW;
+    r[5] = twoYZ - twoXW;
+    r[6] = twoXZ - twoYW;
+    r[7] = twoYZ + twoXW;
+#else
+    r[3] = twoXY - twoZW;
+    r[6] = twoXZ + twoYW;
+    r[1] = twoXY + twoZW;
+    r[7] = twoYZ - twoXW;
+    r[2] = twoXZ - twoYW;
+    r[5] = twoYZ + twoXW;
+#endif
+    for (int j = 0; j < 9; ++j)
+    {
+        state.rotation[j][i] = r[j];
+    }
+
+    Real const invMass = mInvMass[i];
+    for (int j = 0; j < 3; ++j)
+    {
+        state.linearVelocity[j][i] = invMass * state.linearMomentum[j][i];
+    }
+
+    // V = R^T*M
+    Real const m0 = state.angularMomentum[0][i];
+    Real const m1 = state.angularMomentum[1][i];
+    Real const m2 = state.angularMomentum[2][i];
+    Real const v0 = r[0] * m0 + r[3] * m1 + r[6] * m2;
+    Real const v1 = r[1] * m0 + r[4] * m1 + r[7] * m2;
+    Real const v2 = r[2] * m0 + r[5] * m1 + r[8] * m2;
+
+    // V = J^{-1}*R^T*M
+    Real const j00 = mInvInertia[0][i], j01 = mInvInertia[1][i];
+    Real const j02 = mInvInertia[2][i], j11 = mInvInertia[3][i];
+    Real const j12 = mInvInertia[4][i], j22 = mInvInertia[5][i];
+    Real const u0 = j00 * v0 + j01 * v1 + j02 * v2;
+    Real const u1 = j01 * v0 + j11 * v1 + j12 * v2;
+    Real const u2 = j02 * v0 + j12 * v1 + j22 * v2;
+
+    // V = R*J^{-1}*R^T*M
+    state.angularVelocity[0][i] = r[0] * u0 + r[1] * u1 + r[2] * u2;
+    state.angularVelocity[1][i] = r[3] * u0 + r[4] * u1 + r[5] * u2;
+    state.angularVelocity[2][i] = r[6] * u0 + r[7] * u1 + r[8] * u2;
+}
+
+template <typename Real>
+void RigidBodyWorld<Real>::ComputeDerivatives(int imin, int imax, Real time,
+    State const& source)
+{
+    mForceTorque(time, imin, imax, *this, source, mForce, mTorque);
+
+    // dQ/dT = 0.5*W*Q, where W = (w0,w1,w2,0).
+    Real const half = (Real)0.5;
+    Real const* w0 = source.angularVelocity[0].data();
+    Real const* w1 = source.angularVelocity[1].data();
+    Real const* w2 = source.angularVelocity[2].data();
+    Real const* qx = source.quaternion[0].data();
+    Real const* qy = source.quaternion[1].data();
+    Real const* qz = source.quaternion[2].data();
+    Real const* qw = source.quaternion[3].data();
+    Real* dqx = mDQDT[0].data();
+    Real* dqy = mDQDT[1].data();
+    Real* dqz = mDQDT[2].data();
+    Real* dqw = mDQDT[3].data();
+    for (int i = imin; i < imax; ++i)
+    {
+        dqx[i] = half * (+w0[i] * qw[i] + w1[i] * qz[i] - w2[i] * qy[i]);
+        dqy[i] = half * (-w0[i] * qz[i] + w1[i] * qw[i] + w2[i] * qx[i]);
+        dqz[i] = half * (+w0[i] * qy[i] - w1[i] * qx[i] + w2[i] * qw[i]);
+        dqw[i] = half * (-w0[i] * qx[i] - w1[i] * qy[i] - w2[i] * qz[i]);
+    }
+}
+
+
+}
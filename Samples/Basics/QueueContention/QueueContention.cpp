@@ -0,0 +1,140 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/15)
+
+#include <LowLevel/GteTimer.h>
+#include <LowLevel/GteMPMCQueue.h>
+#include <LowLevel/GteSPSCQueue.h>
+#include <LowLevel/GteThreadSafeQueue.h>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace gte;
+
+// Compare the throughput of ThreadSafeQueue (one mutex), MPMCQueue with
+// yielding and with blocking waits, and SPSCQueue for several numbers of
+// producer and consumer threads.  Every producer pushes the same number of
+// integers and the consumers pop all of them; the sum of the popped
+// integers is compared to the expected sum.  ThreadSafeQueue has no waiting
+// operations, so its producers and consumers yield until Push or Pop
+// succeeds.
+
+static int const capacity = 1024;
+static int const numPerProducer = 1000000;
+
+template <typename Queue>
+static void WaitPush(Queue& queue, int element)
+{
+    queue.WaitPush(element);
+}
+
+template <typename Queue>
+static void WaitPop(Queue& queue, int& element)
+{
+    queue.WaitPop(element);
+}
+
+static void WaitPush(ThreadSafeQueue<int>& queue, int element)
+{
+    while (!queue.Push(element))
+    {
+        std::this_thread::yield();
+    }
+}
+
+static void WaitPop(ThreadSafeQueue<int>& queue, int& element)
+{
+    while (!queue.Pop(element))
+    {
+        std::this_thread::yield();
+    }
+}
+
+// Return the throughput in millions of elements per second, or a negative
+// number when the sum is incorrect.
+template <typename Queue>
+static double Measure(Queue& queue, int numProducers, int numConsumers)
+{
+    int64_t const numElements = static_cast<int64_t>(numProducers) * numPerProducer;
+    std::atomic<int64_t> numPopped(0), sum(0);
+
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < numProducers; ++p)
+    {
+        threads.push_back(std::thread([&queue]()
+        {
+            for (int i = 1; i <= numPerProducer; ++i)
+            {
+                WaitPush(queue, i);
+            }
+        }));
+    }
+
+    for (int c = 0; c < numConsumers; ++c)
+    {
+        // The consumers share the work by claiming elements before popping
+        // them, so every claimed element is eventually pushed.
+        threads.push_back(std::thread([&queue, &numPopped, &sum, numElements]()
+        {
+            int64_t localSum = 0;
+            while (numPopped.fetch_add(1) < numElements)
+            {
+                int element;
+                WaitPop(queue, element);
+                localSum += element;
+            }
+            sum += localSum;
+        }));
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = timer.GetSeconds();
+
+    int64_t const expected = numProducers * (static_cast<int64_t>(numPerProducer) * (numPerProducer + 1) / 2);
+    return (sum == expected ? numElements / (1.0e6 * seconds) : -1.0);
+}
+
+int main(int, char const*[])
+{
+    std::cout << "throughput in millions of elements per second (capacity " << capacity << ")" << std::endl;
+    std::cout << "  producers  consumers  ThreadSafeQueue  MPMC(yield)  MPMC(block)  SPSC" << std::endl;
+
+    int const counts[][2] = { { 1, 1 }, { 1, 4 }, { 4, 1 }, { 2, 2 }, { 4, 4 }, { 8, 8 } };
+    for (auto const& count : counts)
+    {
+        int numProducers = count[0], numConsumers = count[1];
+
+        ThreadSafeQueue<int> locked(capacity);
+        double lockedRate = Measure(locked, numProducers, numConsumers);
+
+        MPMCQueue<int> yielding(capacity, false);
+        double yieldingRate = Measure(yielding, numProducers, numConsumers);
+
+        MPMCQueue<int> blocking(capacity, true);
+        double blockingRate = Measure(blocking, numProducers, numConsumers);
+
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(11) << numProducers
+            << std::setw(11) << numConsumers
+            << std::setw(17) << lockedRate
+            << std::setw(13) << yieldingRate
+            << std::setw(13) << blockingRate;
+
+        if (numProducers == 1 && numConsumers == 1)
+        {
+            SPSCQueue<int> single(capacity);
+            std::cout << std::setw(6) << Measure(single, 1, 1);
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
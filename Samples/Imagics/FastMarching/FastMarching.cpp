@@ -0,0 +1,136 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/11)
+
+#include <LowLevel/GteTimer.h>
+#include <Imagics/GteFastMarch3.h>
+#include <Imagics/GteFastMarchBucketed.h>
+#include <Imagics/GteFastSweep.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+using namespace gte;
+
+// Compare the solvers of the eikonal equation on cubic grids: FastMarch3
+// (min-heap), FastMarchBucketed (untidy priority queue) and FastSweep
+// (Gauss-Seidel sweeps, single-threaded and multithreaded).  The front
+// starts at the center of the grid.  For the constant speed, the error is
+// measured against the Euclidean distance to the center.  For the variable
+// speed, the difference to the FastMarch3 times is reported.
+
+static double MaxDifference(std::vector<float> const& times0, std::vector<float> const& times1)
+{
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < times0.size(); ++i)
+    {
+        if (times0[i] >= 0.0f && times1[i] >= 0.0f)
+        {
+            maxDiff = std::max(maxDiff, (double)std::fabs(times0[i] - times1[i]));
+        }
+    }
+    return maxDiff;
+}
+
+int main(int, char const*[])
+{
+    unsigned int const numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int variable = 0; variable < 2; ++variable)
+    {
+        std::cout << (variable ? "variable speed, difference to heap" : "constant speed, error to exact distance")
+            << std::endl;
+        std::cout << "  bound  heap(ms)  bucket(ms)  sweep1(ms)  sweep" << numThreads
+            << "(ms)  iters  heapErr  bucketErr  sweepErr" << std::endl;
+
+        for (size_t bound = 32; bound <= 128; bound *= 2)
+        {
+            size_t const quantity = bound * bound * bound;
+            size_t const center = bound / 2;
+            std::vector<size_t> seeds{ center + bound * (center + bound * center) };
+            std::vector<float> speeds(quantity, 1.0f);
+            if (variable)
+            {
+                for (size_t z = 0, i = 0; z < bound; ++z)
+                {
+                    for (size_t y = 0; y < bound; ++y)
+                    {
+                        for (size_t x = 0; x < bound; ++x, ++i)
+                        {
+                            // Slow layers along the z-axis.
+                            speeds[i] = 1.0f + 0.75f * std::sin(0.3f * (float)z + 0.1f * (float)x);
+                        }
+                    }
+                }
+            }
+
+            Timer timer;
+            FastMarch3<float> heap(bound, bound, bound, 1.0f, 1.0f, 1.0f, seeds, speeds);
+            while (heap.GetNumTrials() > 0)
+            {
+                heap.Iterate();
+            }
+            int64_t heapTime = timer.GetMicroseconds();
+            std::vector<float> heapTimes(quantity);
+            for (size_t i = 0; i < quantity; ++i)
+            {
+                heapTimes[i] = heap.GetTime(i);
+            }
+
+            timer.Reset();
+            FastMarchBucketed<float> bucketed(bound, bound, bound, 1.0f, 1.0f, 1.0f, seeds, speeds);
+            bucketed.Execute();
+            int64_t bucketTime = timer.GetMicroseconds();
+
+            timer.Reset();
+            FastSweep<float> sweep1(bound, bound, bound, 1.0f, 1.0f, 1.0f, seeds, speeds, 1);
+            sweep1.SetTolerance(1e-4f);
+            sweep1.Execute();
+            int64_t sweep1Time = timer.GetMicroseconds();
+
+            timer.Reset();
+            FastSweep<float> sweepN(bound, bound, bound, 1.0f, 1.0f, 1.0f, seeds, speeds, numThreads);
+            sweepN.SetTolerance(1e-4f);
+            sweepN.Execute();
+            int64_t sweepNTime = timer.GetMicroseconds();
+
+            std::vector<float> reference(quantity);
+            if (variable)
+            {
+                reference = heapTimes;
+            }
+            else
+            {
+                for (size_t z = 0, i = 0; z < bound; ++z)
+                {
+                    for (size_t y = 0; y < bound; ++y)
+                    {
+                        for (size_t x = 0; x < bound; ++x, ++i)
+                        {
+                            float dx = (float)x - (float)center;
+                            float dy = (float)y - (float)center;
+                            float dz = (float)z - (float)center;
+                            reference[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+                        }
+                    }
+                }
+            }
+
+            std::cout << std::setw(7) << bound << std::fixed << std::setprecision(1)
+                << std::setw(10) << heapTime * 0.001
+                << std::setw(12) << bucketTime * 0.001
+                << std::setw(12) << sweep1Time * 0.001
+                << std::setw(12) << sweepNTime * 0.001
+                << std::setw(7) << sweepN.GetNumIterations() << std::setprecision(4)
+                << std::setw(9) << MaxDifference(heapTimes, reference)
+                << std::setw(11) << MaxDifference(bucketed.GetTimes(), reference)
+                << std::setw(10) << MaxDifference(sweepN.GetTimes(), reference)
+                << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -3,12 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.2 (2019/05/03)
+// File Version: 3.0.3 (2019/09/13)
 
 #include "MedianFilteringWindow.h"
 #include <LowLevel/GteLogReporter.h>
+#include <LowLevel/GteTimer.h>
 #include <Graphics/GteGraphicsDefaults.h>
 #include <random>
+#include <thread>
 
 int main(int, char const*[])
 {
@@ -95,6 +97,10 @@ void MedianFilteringWindow::OnIdle()
     mOverlay[1]->SetTexture(mImage[1]);
     std::array<float, 4> textColor{ 1.0f, 1.0f, 0.0f, 1.0f };
     mEngine->Draw(8, mYSize - 24, textColor, msName[mSelection]);
+    if (mBenchmarkMessage != "")
+    {
+        mEngine->Draw(8, mYSize - 40, textColor, mBenchmarkMessage);
+    }
     mEngine->Draw(8, mYSize - 8, textColor, mTimer.GetFPS());
     mEngine->DisplayColorBuffer(0);
 
@@ -140,6 +146,11 @@ bool MedianFilteringWindow::OnCharPress(unsigned char key, int x, int y)
         mEngine->CopyCpuToGpu(mImage[1]);
         mCProgram = mMedianProgram[3];
         return true;
+
+    case 'b':
+    case 'B':
+        Benchmark();
+        return true;
     }
 
     return Window::OnCharPress(key, x, y);
@@ -217,6 +228,64 @@ bool MedianFilteringWindow::CreatePrograms(unsigned int txWidth, unsigned int tx
     return true;
 }
 
+void MedianFilteringWindow::Benchmark()
+{
+    // The shaders load zeros outside the image and RankFilter uses the
+    // nearest image pixels, so the results are compared only at the pixels
+    // whose windows are inside the image.
+    int const numRuns = 16;
+    int const radius = (mSelection < 2 ? 1 : 2);
+    int const txWidth = static_cast<int>(mOriginal->GetWidth());
+    int const txHeight = static_cast<int>(mOriginal->GetHeight());
+
+    std::memcpy(mImage[0]->GetData(), mOriginal->GetData(), mOriginal->GetNumBytes());
+    mEngine->CopyCpuToGpu(mImage[0]);
+    mCProgram->GetCShader()->Set("inImage", mImage[0]);
+    mCProgram->GetCShader()->Set("outImage", mImage[1]);
+    mEngine->Execute(mCProgram, mNumXGroups, mNumYGroups, 1);
+    mEngine->WaitForFinish();
+    Timer timer;
+    for (int i = 0; i < numRuns; ++i)
+    {
+        mEngine->Execute(mCProgram, mNumXGroups, mNumYGroups, 1);
+    }
+    mEngine->WaitForFinish();
+    double gpuMilliseconds = 1000.0 * timer.GetSeconds() / numRuns;
+    mEngine->CopyGpuToCpu(mImage[1]);
+
+    Image2<float> input(txWidth, txHeight), output;
+    std::memcpy(input.GetPixels().data(), mOriginal->GetData(), mOriginal->GetNumBytes());
+    RankFilter<float> filter(std::max(std::thread::hardware_concurrency(), 1u));
+    filter.Median(input, radius, output);
+    timer.Reset();
+    for (int i = 0; i < numRuns; ++i)
+    {
+        filter.Median(input, radius, output);
+    }
+    double cpuMilliseconds = 1000.0 * timer.GetSeconds() / numRuns;
+
+    auto const* gpuOutput = mImage[1]->Get<float>();
+    int numMismatches = 0;
+    for (int y = radius; y < txHeight - radius; ++y)
+    {
+        for (int x = radius; x < txWidth - radius; ++x)
+        {
+            if (gpuOutput[x + txWidth * y] != output(x, y))
+            {
+                ++numMismatches;
+            }
+        }
+    }
+
+    mBenchmarkMessage = "gpu " + std::to_string(gpuMilliseconds) + " ms, cpu "
+        + std::to_string(cpuMilliseconds) + " ms, mismatches = "
+        + std::to_string(numMismatches);
+
+    // Restart the iterated filtering with the original image.
+    std::memcpy(mImage[1]->GetData(), mOriginal->GetData(), mOriginal->GetNumBytes());
+    mEngine->CopyCpuToGpu(mImage[1]);
+}
+
 std::string MedianFilteringWindow::msName[4] =
 {
     "median 3x3 by insertion sort",
@@ -3,11 +3,12 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2019/04/19)
+// File Version: 3.0.2 (2019/09/13)
 
 #pragma once
 
 #include <Applications/GteWindow3.h>
+#include <Imagics/GteRankFilter.h>
 using namespace gte;
 
 class MedianFilteringWindow : public Window
@@ -22,6 +23,10 @@ private:
     bool SetEnvironment();
     bool CreatePrograms(unsigned int txWidth, unsigned int txHeight);
 
+    // Compare the times of the selected shader and of RankFilter for the
+    // same window size.
+    void Benchmark();
+
     std::shared_ptr<Texture2> mOriginal;
     std::shared_ptr<Texture2> mImage[2];
     std::shared_ptr<OverlayEffect> mOverlay[2];
@@ -35,4 +40,5 @@ private:
     std::shared_ptr<ComputeProgram> mCProgram;
     unsigned int mNumXGroups, mNumYGroups;
     static std::string msName[4];
+    std::string mBenchmarkMessage;
 };
@@ -3,11 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/15)
 
 #pragma once
 
-#include <LowLevel/GteThreadSafeQueue.h>
+#include <LowLevel/GteMPMCQueue.h>
 #include "VideoStream.h"
 #include <thread>
 
@@ -18,9 +18,9 @@ public:
     // least one element and all elements must be nonnull.  NOTE:  No
     // error checking is performed for this condition.  The manager maintains
     // a queue of pending frames to process.  You must specify the maximum
-    // number.  In the producer-consumer model where the producer and
-    // consumer keep up with each other, the number of elements in the queue
-    // is 0 or 1.
+    // number, which is rounded up to a power of two.  In the producer-
+    // consumer model where the producer and consumer keep up with each
+    // other, the number of elements in the queue is 0 or 1.
     ~VideoStreamManager();
     VideoStreamManager(std::vector<std::shared_ptr<VideoStream>> const& videoStreams,
         size_t maxQueueElements);
@@ -33,7 +33,7 @@ public:
     // all frames from the video streams.
     struct Frame
     {
-        Frame(size_t n) : number(0xFFFFFFFF), frames(n), microseconds(0) {}
+        Frame(size_t n = 0) : number(0xFFFFFFFF), frames(n), microseconds(0) {}
         unsigned int number;
         std::vector<VideoStream::Frame> frames;
         int64_t microseconds;
@@ -87,7 +87,7 @@ protected:
     std::vector<std::shared_ptr<VideoStream>> mVideoStreams;
 
     // The queue of frames to process.
-    mutable gte::ThreadSafeQueue<Frame> mFrameQueue;
+    mutable gte::MPMCQueue<Frame> mFrameQueue;
 
     // The timer is used to compute how long it takes to produce the frame.
     // The current frame counter is used for the Frame.number member.
@@ -0,0 +1,241 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/26)
+
+#include <LowLevel/GteTimer.h>
+#include <Mathematics/GteArbitraryPrecision.h>
+#include <Mathematics/GteBSPrimalQuery3.h>
+#include <Mathematics/GtePrimalQuery3.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace gte;
+
+// Micro-benchmarks for the arbitrary-precision arithmetic.  The first table
+// multiplies random numbers whose product has the number of 32-bit words
+// reported by the PrecisionCalculator tool for the primal queries.  It lists
+// the time of UIntegerAP32::Mul and of the 32-bit schoolbook multiplication
+// that Mul used previously (reproduced here), and verifies that the products
+// are equal.  The previous method is skipped for the largest sizes.  The
+// second table lists the throughput of ToCircumsphere for double inputs with
+// small and with widely varying exponents, computed by PrimalQuery3 with
+// BSNumber<UIntegerAP32> (heap storage), with BSNumber<UIntegerFP32<329>>
+// (the N listed for the query) and with BSRational<UIntegerAP32>, and by
+// BSPrimalQuery3, whose storage is sized at compile time.  The last column
+// reports whether all the signs equal those of BSPrimalQuery3.
+
+static double const minSeconds = 0.1;
+static int32_t const maxPreviousWords = 32768;
+
+// The Mul of UIntegerALU32 before 64-bit limbs and Karatsuba's method.
+static void MulPrevious(std::vector<uint32_t> const& u0,
+    std::vector<uint32_t> const& u1, std::vector<uint32_t>& bits)
+{
+    size_t const numElements0 = u0.size(), numElements1 = u1.size();
+    size_t const numElements = numElements0 + numElements1;
+    bits.resize(numElements);
+    std::vector<uint32_t> pBits(numElements);
+    uint64_t block0 = u0[0], carry = 0, term, sum;
+    size_t i0, i1, i2;
+    for (i1 = 0; i1 < numElements1; ++i1)
+    {
+        term = block0 * u1[i1] + carry;
+        bits[i1] = (uint32_t)(term & 0x00000000FFFFFFFFull);
+        carry = (term >> 32);
+    }
+    bits[i1] = (uint32_t)(carry & 0x00000000FFFFFFFFull);
+
+    for (i0 = 1; i0 < numElements0; ++i0)
+    {
+        block0 = u0[i0];
+        carry = 0;
+        for (i1 = 0, i2 = i0; i1 < numElements1; ++i1, ++i2)
+        {
+            term = block0 * u1[i1] + carry;
+            pBits[i2] = (uint32_t)(term & 0x00000000FFFFFFFFull);
+            carry = (term >> 32);
+        }
+        if (i2 < numElements)
+        {
+            pBits[i2] = (uint32_t)(carry & 0x00000000FFFFFFFFull);
+        }
+
+        carry = 0;
+        for (i1 = 0, i2 = i0; i1 < numElements1; ++i1, ++i2)
+        {
+            sum = pBits[i2] + (bits[i2] + carry);
+            bits[i2] = (uint32_t)(sum & 0x00000000FFFFFFFFull);
+            carry = (sum >> 32);
+        }
+        if (i2 < numElements)
+        {
+            sum = pBits[i2] + carry;
+            bits[i2] = (uint32_t)(sum & 0x00000000FFFFFFFFull);
+        }
+    }
+
+    while (bits.size() > 0 && bits.back() == 0)
+    {
+        bits.pop_back();
+    }
+}
+
+static UIntegerAP32 CreateNumber(std::mt19937& mte, int32_t numWords)
+{
+    UIntegerAP32 number(32 * numWords);
+    auto& bits = number.GetBits();
+    for (auto& block : bits)
+    {
+        block = static_cast<uint32_t>(mte());
+    }
+    bits.back() |= 0x80000000u;
+    return number;
+}
+
+// Return the average time in microseconds of 'function'.
+template <typename Function>
+static double Measure(Function function)
+{
+    Timer timer;
+    int64_t numCalls = 0;
+    double seconds;
+    do
+    {
+        function();
+        ++numCalls;
+        seconds = timer.GetSeconds();
+    } while (seconds < minSeconds);
+    return 1.0e6 * seconds / static_cast<double>(numCalls);
+}
+
+static void ReportMul(char const* name, int32_t productWords)
+{
+    std::mt19937 mte(productWords);
+    int32_t const numWords = std::max(productWords / 2, 1);
+    UIntegerAP32 n0 = CreateNumber(mte, numWords);
+    UIntegerAP32 n1 = CreateNumber(mte, numWords);
+    UIntegerAP32 product;
+    double mulTime = Measure([&]() { product.Mul(n0, n1); });
+
+    std::cout << std::left << std::setw(34) << name << std::right
+        << std::setw(9) << productWords
+        << std::fixed << std::setprecision(2) << std::setw(15) << mulTime;
+
+    if (productWords <= maxPreviousWords)
+    {
+        std::vector<uint32_t> previous;
+        double previousTime = Measure([&]() { MulPrevious(n0.GetBits(), n1.GetBits(), previous); });
+        std::cout << std::setw(15) << previousTime
+            << std::setw(10) << previousTime / mulTime
+            << std::setw(7) << (previous == product.GetBits() ? "yes" : "NO");
+    }
+    else
+    {
+        std::cout << std::setw(15) << "-" << std::setw(10) << "-"
+            << std::setw(7) << "-";
+    }
+    std::cout << std::endl;
+}
+
+template <typename Query>
+static double MeasureCircumsphere(Query const& query, std::vector<int>& signs)
+{
+    int const numQueries = static_cast<int>(signs.size());
+    double time = Measure([&]()
+    {
+        for (int i = 0; i < numQueries; ++i)
+        {
+            signs[i] = query.ToCircumsphere(i + 4, i, i + 1, i + 2, i + 3);
+        }
+    });
+    return 1.0e6 * numQueries / time;
+}
+
+template <typename Rational>
+static double MeasureCircumsphere(std::vector<Vector3<double>> const& vertices,
+    std::vector<int>& signs)
+{
+    std::vector<Vector3<Rational>> rvertices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            rvertices[i][j] = vertices[i][j];
+        }
+    }
+
+    PrimalQuery3<Rational> query(static_cast<int>(rvertices.size()), rvertices.data());
+    return MeasureCircumsphere(query, signs);
+}
+
+static void ReportCircumsphere(char const* name, int maxExponent)
+{
+    int const numVertices = 256;
+    std::mt19937 mte;
+    std::uniform_real_distribution<double> rnd(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-maxExponent, maxExponent);
+    std::vector<Vector3<double>> vertices(numVertices);
+    for (auto& vertex : vertices)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            vertex[j] = std::ldexp(rnd(mte), exponent(mte));
+        }
+    }
+
+    int const numQueries = numVertices - 4;
+    std::vector<int> signs(numQueries), apSigns(numQueries);
+    std::vector<int> fpSigns(numQueries), rationalSigns(numQueries);
+    BSPrimalQuery3<double> query(numVertices, vertices.data());
+    double termRate = MeasureCircumsphere(query, signs);
+    double apRate = MeasureCircumsphere<BSNumber<UIntegerAP32>>(vertices, apSigns);
+    double fpRate = MeasureCircumsphere<BSNumber<UIntegerFP32<329>>>(vertices, fpSigns);
+    double rationalRate = MeasureCircumsphere<BSRational<UIntegerAP32>>(vertices, rationalSigns);
+    bool equal = (signs == apSigns && signs == fpSigns && signs == rationalSigns);
+
+    std::cout << std::left << std::setw(34) << name << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(12) << apRate << std::setw(12) << fpRate
+        << std::setw(12) << rationalRate << std::setw(12) << termRate
+        << std::setw(7) << (equal ? "yes" : "NO") << std::endl;
+}
+
+int main(int, char const*[])
+{
+    std::cout << "Mul (time in microseconds)" << std::endl;
+    std::cout << "query                                 words            Mul"
+        << "       previous   speedup  equal" << std::endl;
+    ReportMul("ToLine, float, BSNumber", 18);
+    ReportMul("ToPlane, float, BSNumber", 27);
+    ReportMul("ToCircumcircle, float, BSNumber", 35);
+    ReportMul("ToCircumsphere, float, BSNumber", 44);
+    ReportMul("ToLine, double, BSNumber", 132);
+    ReportMul("ToPlane, double, BSNumber", 197);
+    ReportMul("ToCircumcircle, double, BSNumber", 263);
+    ReportMul("ToCircumsphere, double, BSNumber", 329);
+    ReportMul("ToLine, float, BSRational", 214);
+    ReportMul("ToLine, double, BSRational", 1587);
+    ReportMul("ToPlane, float, BSRational", 2882);
+    ReportMul("ToCircumcircle, float, BSRational", 7008);
+    ReportMul("ToPlane, double, BSRational", 21688);
+    ReportMul("ToCircumcircle, double, BSRational", 52859);
+    ReportMul("ToCircumsphere, float, BSRational", 298037);
+    ReportMul("ToCircumsphere, double, BSRational", 2254442);
+
+    std::cout << std::endl << "ToCircumsphere (queries per second)" << std::endl;
+    std::cout << std::left << std::setw(34) << "inputs" << std::right
+        << std::setw(12) << "BSNumber" << std::setw(12) << "BSNumber"
+        << std::setw(12) << "BSRational" << std::setw(12) << "BSPrimal"
+        << std::endl;
+    std::cout << std::setw(34) << "" << std::setw(12) << "AP32"
+        << std::setw(12) << "FP32<329>" << std::setw(12) << "AP32"
+        << std::setw(12) << "Query3" << std::setw(7) << "equal" << std::endl;
+    ReportCircumsphere("double, exponents in [-1,0]", 0);
+    ReportCircumsphere("double, exponents in [-64,64]", 64);
+    ReportCircumsphere("double, exponents in [-512,512]", 512);
+    return 0;
+}
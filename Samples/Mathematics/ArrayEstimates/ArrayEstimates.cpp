@@ -0,0 +1,169 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/22)
+
+#include <LowLevel/GteTimer.h>
+#include <Mathematics/GteASinEstimate.h>
+#include <Mathematics/GteATanEstimate.h>
+#include <Mathematics/GteCosEstimate.h>
+#include <Mathematics/GteExpEstimate.h>
+#include <Mathematics/GteInvSqrtEstimate.h>
+#include <Mathematics/GteLogEstimate.h>
+#include <Mathematics/GteSinEstimate.h>
+#include <Mathematics/GteSqrtEstimate.h>
+#include <Mathematics/GteTanEstimate.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace gte;
+
+// Compare the accuracy and throughput of the polynomial estimates to the
+// standard library functions for 'float' inputs.  For each function the
+// table lists the maximum error of the estimate relative to the 'double'
+// standard function (absolute or relative error as indicated) and the
+// throughput in millions of evaluations per second of the 'float' standard
+// function, of the scalar estimate in a loop and of the array estimate.
+// The scalar and array estimates produce the same results except for
+// TanEstimate at large |x|; see GteTanEstimate.h.
+//
+// The array estimates are organized for compiler auto-vectorization; see
+// GteArrayEstimate.h for the compiler options that allow all of them to be
+// vectorized.
+
+static size_t const numElements = 1 << 16;
+static int const numPasses = 256;
+
+template <typename Evaluate>
+static double Measure(std::vector<float> const& x, std::vector<float>& y,
+    Evaluate evaluate)
+{
+    Timer timer;
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        evaluate(x.data(), y.data());
+    }
+    double seconds = timer.GetSeconds();
+    return static_cast<double>(numElements) * numPasses / (1.0e6 * seconds);
+}
+
+template <typename Reference, typename Standard, typename Scalar,
+    typename Array>
+static void Report(char const* name, float xmin, float xmax, bool relative,
+    Reference reference, Standard standard, Scalar scalar, Array array)
+{
+    std::mt19937 mte;
+    std::uniform_real_distribution<float> rnd(xmin, xmax);
+    std::vector<float> x(numElements), y(numElements);
+    for (auto& value : x)
+    {
+        value = rnd(mte);
+    }
+
+    array(numElements, x.data(), y.data());
+    double maxError = 0.0;
+    for (size_t i = 0; i < numElements; ++i)
+    {
+        double exact = reference(static_cast<double>(x[i]));
+        double error = std::abs(static_cast<double>(y[i]) - exact);
+        if (relative)
+        {
+            error /= std::abs(exact);
+        }
+        maxError = std::max(maxError, error);
+    }
+
+    double standardRate = Measure(x, y, [standard](float const* input, float* output)
+    {
+        for (size_t i = 0; i < numElements; ++i)
+        {
+            output[i] = standard(input[i]);
+        }
+    });
+
+    double scalarRate = Measure(x, y, [scalar](float const* input, float* output)
+    {
+        for (size_t i = 0; i < numElements; ++i)
+        {
+            output[i] = scalar(input[i]);
+        }
+    });
+
+    double arrayRate = Measure(x, y, [array](float const* input, float* output)
+    {
+        array(numElements, input, output);
+    });
+
+    std::cout << std::left << std::setw(12) << name << std::right
+        << std::setw(5) << (relative ? "rel" : "abs")
+        << std::scientific << std::setprecision(2) << std::setw(11) << maxError
+        << std::fixed << std::setprecision(1)
+        << std::setw(11) << standardRate
+        << std::setw(11) << scalarRate
+        << std::setw(11) << arrayRate << std::endl;
+}
+
+int main(int, char const*[])
+{
+    std::cout << "throughput in millions of evaluations per second" << std::endl;
+    std::cout << "function      err  maxerror        std     scalar      array" << std::endl;
+
+    Report("sin<11>", -100.0f, 100.0f, false,
+        [](double x) { return std::sin(x); },
+        [](float x) { return std::sin(x); },
+        [](float x) { return SinEstimate<float>::DegreeRR<11>(x); },
+        [](size_t n, float const* x, float* y) { SinEstimate<float>::DegreeRR<11>(n, x, y); });
+
+    Report("cos<10>", -100.0f, 100.0f, false,
+        [](double x) { return std::cos(x); },
+        [](float x) { return std::cos(x); },
+        [](float x) { return CosEstimate<float>::DegreeRR<10>(x); },
+        [](size_t n, float const* x, float* y) { CosEstimate<float>::DegreeRR<10>(n, x, y); });
+
+    Report("tan<13>", -1.5f, 1.5f, true,
+        [](double x) { return std::tan(x); },
+        [](float x) { return std::tan(x); },
+        [](float x) { return TanEstimate<float>::DegreeRR<13>(x); },
+        [](size_t n, float const* x, float* y) { TanEstimate<float>::DegreeRR<13>(n, x, y); });
+
+    Report("atan<13>", -100.0f, 100.0f, false,
+        [](double x) { return std::atan(x); },
+        [](float x) { return std::atan(x); },
+        [](float x) { return ATanEstimate<float>::DegreeRR<13>(x); },
+        [](size_t n, float const* x, float* y) { ATanEstimate<float>::DegreeRR<13>(n, x, y); });
+
+    Report("asin<8>", 0.0f, 1.0f, false,
+        [](double x) { return std::asin(x); },
+        [](float x) { return std::asin(x); },
+        [](float x) { return ASinEstimate<float>::Degree<8>(x); },
+        [](size_t n, float const* x, float* y) { ASinEstimate<float>::Degree<8>(n, x, y); });
+
+    Report("exp<7>", -80.0f, 80.0f, true,
+        [](double x) { return std::exp(x); },
+        [](float x) { return std::exp(x); },
+        [](float x) { return ExpEstimate<float>::DegreeRR<7>(x); },
+        [](size_t n, float const* x, float* y) { ExpEstimate<float>::DegreeRR<7>(n, x, y); });
+
+    Report("log<8>", 1.0e-30f, 1.0e+30f, false,
+        [](double x) { return std::log(x); },
+        [](float x) { return std::log(x); },
+        [](float x) { return LogEstimate<float>::DegreeRR<8>(x); },
+        [](size_t n, float const* x, float* y) { LogEstimate<float>::DegreeRR<8>(n, x, y); });
+
+    Report("sqrt<8>", 1.0e-30f, 1.0e+30f, true,
+        [](double x) { return std::sqrt(x); },
+        [](float x) { return std::sqrt(x); },
+        [](float x) { return SqrtEstimate<float>::DegreeRR<8>(x); },
+        [](size_t n, float const* x, float* y) { SqrtEstimate<float>::DegreeRR<8>(n, x, y); });
+
+    Report("invsqrt<8>", 1.0e-30f, 1.0e+30f, true,
+        [](double x) { return 1.0 / std::sqrt(x); },
+        [](float x) { return 1.0f / std::sqrt(x); },
+        [](float x) { return InvSqrtEstimate<float>::DegreeRR<8>(x); },
+        [](size_t n, float const* x, float* y) { InvSqrtEstimate<float>::DegreeRR<8>(n, x, y); });
+
+    return 0;
+}
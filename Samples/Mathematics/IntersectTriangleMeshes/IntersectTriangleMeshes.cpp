@@ -0,0 +1,196 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/03)
+
+#include <LowLevel/GteTimer.h>
+#include <Mathematics/GteMatrix3x3.h>
+#include <Mathematics/GteRotation.h>
+#include <Mathematics/GteTriangleMeshIntersection3.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+using namespace gte;
+
+// Compare the BVH-accelerated TriangleMeshIntersection3 to the brute-force
+// comparison of all pairs of triangles, the CPU counterpart of the shader
+// in the AllPairsTriangles sample.  The meshes are the same: a closed
+// cylinder and a torus that is rotated about the origin.
+
+static void CreateCylinder(int numAxisSamples, int numRadialSamples, float radius,
+    float height, std::vector<Vector3<float>>& vertices, std::vector<int>& indices)
+{
+    // The tube, followed by the two disk caps.
+    vertices.clear();
+    indices.clear();
+    for (int a = 0; a < numAxisSamples; ++a)
+    {
+        float z = height * (-0.5f + (float)a / (float)(numAxisSamples - 1));
+        for (int r = 0; r < numRadialSamples; ++r)
+        {
+            float angle = (float)GTE_C_TWO_PI * (float)r / (float)numRadialSamples;
+            vertices.push_back({ radius * std::cos(angle), radius * std::sin(angle), z });
+        }
+    }
+    for (int a = 0; a + 1 < numAxisSamples; ++a)
+    {
+        int i0 = a * numRadialSamples, i1 = i0 + numRadialSamples;
+        for (int r0 = 0, r1 = 1; r0 < numRadialSamples; ++r0, r1 = (r1 + 1) % numRadialSamples)
+        {
+            indices.insert(indices.end(), { i0 + r0, i0 + r1, i1 + r1 });
+            indices.insert(indices.end(), { i0 + r0, i1 + r1, i1 + r0 });
+        }
+    }
+
+    int const c0 = static_cast<int>(vertices.size());
+    vertices.push_back({ 0.0f, 0.0f, -0.5f * height });
+    vertices.push_back({ 0.0f, 0.0f, +0.5f * height });
+    int const top = (numAxisSamples - 1) * numRadialSamples;
+    for (int r0 = 0, r1 = 1; r0 < numRadialSamples; ++r0, r1 = (r1 + 1) % numRadialSamples)
+    {
+        indices.insert(indices.end(), { c0, r1, r0 });
+        indices.insert(indices.end(), { c0 + 1, top + r0, top + r1 });
+    }
+}
+
+static void CreateTorus(int numCircleSamples, int numRadialSamples, float outerRadius,
+    float innerRadius, std::vector<Vector3<float>>& vertices, std::vector<int>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    for (int c = 0; c < numCircleSamples; ++c)
+    {
+        float theta = (float)GTE_C_TWO_PI * (float)c / (float)numCircleSamples;
+        float cs = std::cos(theta), sn = std::sin(theta);
+        for (int r = 0; r < numRadialSamples; ++r)
+        {
+            float phi = (float)GTE_C_TWO_PI * (float)r / (float)numRadialSamples;
+            float radial = outerRadius + innerRadius * std::cos(phi);
+            vertices.push_back({ radial * cs, radial * sn, innerRadius * std::sin(phi) });
+        }
+    }
+    for (int c0 = 0, c1 = 1; c0 < numCircleSamples; ++c0, c1 = (c1 + 1) % numCircleSamples)
+    {
+        for (int r0 = 0, r1 = 1; r0 < numRadialSamples; ++r0, r1 = (r1 + 1) % numRadialSamples)
+        {
+            int i00 = c0 * numRadialSamples + r0, i01 = c0 * numRadialSamples + r1;
+            int i10 = c1 * numRadialSamples + r0, i11 = c1 * numRadialSamples + r1;
+            indices.insert(indices.end(), { i00, i10, i11 });
+            indices.insert(indices.end(), { i00, i11, i01 });
+        }
+    }
+}
+
+static size_t BruteForce(std::vector<Vector3<float>> const& vertices0, std::vector<int> const& indices0,
+    std::vector<Vector3<float>> const& vertices1, std::vector<int> const& indices1)
+{
+    TIQuery<float, Triangle3<float>, Triangle3<float>> query;
+    size_t const numTriangles0 = indices0.size() / 3, numTriangles1 = indices1.size() / 3;
+    size_t numIntersecting = 0;
+    for (size_t t0 = 0; t0 < numTriangles0; ++t0)
+    {
+        Triangle3<float> triangle0(vertices0[indices0[3 * t0]],
+            vertices0[indices0[3 * t0 + 1]], vertices0[indices0[3 * t0 + 2]]);
+        for (size_t t1 = 0; t1 < numTriangles1; ++t1)
+        {
+            Triangle3<float> triangle1(vertices1[indices1[3 * t1]],
+                vertices1[indices1[3 * t1 + 1]], vertices1[indices1[3 * t1 + 2]]);
+            if (query(triangle0, triangle1).intersect)
+            {
+                ++numIntersecting;
+            }
+        }
+    }
+    return numIntersecting;
+}
+
+int main(int, char const*[])
+{
+    unsigned int const numThreads = std::max(1u, std::thread::hardware_concurrency());
+    int const numFrames = 16;
+    std::mt19937 mte;
+    std::uniform_real_distribution<float> rnd(-1.0f, 1.0f);
+
+    std::cout << "samples  tris0  tris1  brute(ms)  bvh1(ms)  bvh" << numThreads
+        << "(ms)  pairs" << std::endl;
+
+    for (int count = 24; count <= 192; count *= 2)
+    {
+        std::vector<Vector3<float>> vertices0, vertices1, rotated1;
+        std::vector<int> indices0, indices1;
+        CreateCylinder(count, count, 1.0f, 8.0f, vertices0, indices0);
+        CreateTorus(count, count, 2.0f, 0.5f, vertices1, indices1);
+        rotated1.resize(vertices1.size());
+
+        TriangleMeshIntersection3<float> bvh1(1), bvhN(numThreads);
+        bvh1.SetMesh0(vertices0, indices0);
+        bvh1.SetMesh1(vertices1, indices1);
+        bvhN.SetMesh0(vertices0, indices0);
+        bvhN.SetMesh1(vertices1, indices1);
+
+        // The brute-force comparison is quadratic, so it is timed only for
+        // the smaller meshes.
+        bool const doBruteForce = (count <= 48);
+        int64_t bruteTime = 0, bvh1Time = 0, bvhNTime = 0;
+        size_t numPairs = 0;
+        bool mismatch = false;
+        std::vector<TriangleMeshIntersection3<float>::Intersection> intersections;
+        Timer timer;
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            Vector3<float> axis{ rnd(mte), rnd(mte), rnd(mte) };
+            Normalize(axis);
+            Matrix3x3<float> rotate = Rotation<3, float>(AxisAngle<3, float>(axis, (float)GTE_C_PI * rnd(mte)));
+            for (size_t i = 0; i < vertices1.size(); ++i)
+            {
+                rotated1[i] = rotate * vertices1[i];
+            }
+
+            size_t numBrute = 0;
+            if (doBruteForce)
+            {
+                timer.Reset();
+                numBrute = BruteForce(vertices0, indices0, rotated1, indices1);
+                bruteTime += timer.GetMicroseconds();
+            }
+
+            // The refit is part of the per-frame cost.
+            timer.Reset();
+            bvh1.UpdateMesh1(rotated1);
+            bvh1(intersections);
+            bvh1Time += timer.GetMicroseconds();
+            size_t num1 = intersections.size();
+
+            timer.Reset();
+            bvhN.UpdateMesh1(rotated1);
+            bvhN(intersections);
+            bvhNTime += timer.GetMicroseconds();
+
+            numPairs += intersections.size();
+            if (num1 != intersections.size() || (doBruteForce && numBrute != num1))
+            {
+                mismatch = true;
+            }
+        }
+
+        double const scale = 0.001 / numFrames;
+        std::cout << std::setw(7) << count
+            << std::setw(7) << indices0.size() / 3
+            << std::setw(7) << indices1.size() / 3 << std::fixed << std::setprecision(3);
+        if (doBruteForce)
+        {
+            std::cout << std::setw(11) << bruteTime * scale;
+        }
+        else
+        {
+            std::cout << std::setw(11) << "-";
+        }
+        std::cout << std::setw(10) << bvh1Time * scale
+            << std::setw(10) << bvhNTime * scale
+            << std::setw(7) << numPairs / numFrames
+            << (mismatch ? "  MISMATCH" : "") << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/23)
+
+#include <LowLevel/GteTimer.h>
+#include <Mathematics/GteMatrix4x4.h>
+#include <Mathematics/GteQuaternion.h>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace gte;
+
+// Compare the throughput of the SIMD4 fast paths for Vector4<float>,
+// Matrix4x4<float> and Quaternion<float> to the generic std::array
+// implementations, which are called by explicit template arguments.  For
+// each operation the table lists the millions of operations per second of
+// the generic and the fast path and whether the results are bit-identical.
+// The backend is SSE2 when the compiler targets it and scalar otherwise
+// (or when GTE_DISABLE_SIMD is defined); the batch transform uses AVX2 when
+// the CPU supports it.  See GteSIMD4.h.
+
+static size_t const numElements = 1 << 12;
+static int const numPasses = 4096;
+
+template <typename T>
+static bool Same(std::vector<T> const& v0, std::vector<T> const& v1)
+{
+    return std::memcmp(v0.data(), v1.data(), v0.size() * sizeof(T)) == 0;
+}
+
+template <typename Output, typename Evaluate>
+static double Measure(std::vector<Output>& output, Evaluate evaluate)
+{
+    Timer timer;
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        evaluate(output);
+    }
+    double seconds = timer.GetSeconds();
+    return static_cast<double>(numElements) * numPasses / (1.0e6 * seconds);
+}
+
+template <typename Output, typename Generic, typename Fast>
+static void Report(char const* name, Generic generic, Fast fast)
+{
+    std::vector<Output> output0(numElements), output1(numElements);
+    double genericRate = Measure(output0, generic);
+    double fastRate = Measure(output1, fast);
+
+    std::cout << std::left << std::setw(16) << name << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(11) << genericRate
+        << std::setw(11) << fastRate
+        << std::setw(11) << (Same(output0, output1) ? "yes" : "no")
+        << std::endl;
+}
+
+int main(int, char const*[])
+{
+    std::mt19937 mte;
+    std::uniform_real_distribution<float> rnd(-1.0f, 1.0f);
+    std::vector<Vector4<float>> V(numElements), W(numElements);
+    std::vector<Matrix4x4<float>> A(numElements), B(numElements);
+    std::vector<Quaternion<float>> Q(numElements), R(numElements);
+    for (size_t i = 0; i < numElements; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            V[i][j] = rnd(mte);
+            W[i][j] = rnd(mte);
+            Q[i][j] = rnd(mte);
+            R[i][j] = rnd(mte);
+        }
+        for (int j = 0; j < 16; ++j)
+        {
+            A[i][j] = rnd(mte);
+            B[i][j] = rnd(mte);
+        }
+        Normalize(Q[i]);
+    }
+    Matrix4x4<float> const& M = A[0];
+
+    std::cout << "SIMD4 backend: "
+#if defined(GTE_SIMD4_SSE2)
+        << "SSE2"
+#else
+        << "scalar"
+#endif
+        << ", AVX2 batch: " << (SIMD4::SupportsAVX2() ? "yes" : "no")
+        << std::endl;
+    std::cout << "throughput in millions of operations per second" << std::endl;
+    std::cout << "operation           generic       fast  identical" << std::endl;
+
+    Report<Vector4<float>>("V+W",
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = operator+<4, float>(V[i], W[i]);
+            }
+        },
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = V[i] + W[i];
+            }
+        });
+
+    Report<float>("Dot(V,W)",
+        [&](std::vector<float>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = Dot<4, float>(V[i], W[i]);
+            }
+        },
+        [&](std::vector<float>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = Dot(V[i], W[i]);
+            }
+        });
+
+    Report<Vector4<float>>("M*V",
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = operator*<4, 4, float>(A[i], V[i]);
+            }
+        },
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = A[i] * V[i];
+            }
+        });
+
+    Report<Vector4<float>>("V*M",
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = operator*<4, 4, float>(V[i], A[i]);
+            }
+        },
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = V[i] * A[i];
+            }
+        });
+
+    Report<Vector4<float>>("M*V[i] (batch)",
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = operator*<4, 4, float>(M, V[i]);
+            }
+        },
+        [&](std::vector<Vector4<float>>& out)
+        {
+            Multiply(M, numElements, V.data(), out.data());
+        });
+
+    Report<Matrix4x4<float>>("A*B",
+        [&](std::vector<Matrix4x4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = MultiplyAB<4, 4, 4, float>(A[i], B[i]);
+            }
+        },
+        [&](std::vector<Matrix4x4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = A[i] * B[i];
+            }
+        });
+
+    Report<Quaternion<float>>("Q*R",
+        [&](std::vector<Quaternion<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = operator*<float>(Q[i], R[i]);
+            }
+        },
+        [&](std::vector<Quaternion<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = Q[i] * R[i];
+            }
+        });
+
+    Report<Vector4<float>>("Rotate(Q,V)",
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                Quaternion<float> input(V[i][0], V[i][1], V[i][2], 0.0f);
+                Quaternion<float> output = operator*<float>(
+                    operator*<float>(Q[i], input), Conjugate(Q[i]));
+                out[i] = { output[0], output[1], output[2], 0.0f };
+            }
+        },
+        [&](std::vector<Vector4<float>>& out)
+        {
+            for (size_t i = 0; i < numElements; ++i)
+            {
+                out[i] = Rotate(Q[i], V[i]);
+            }
+        });
+
+    return 0;
+}
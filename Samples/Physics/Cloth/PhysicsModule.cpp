@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.2 (2019/09/07)
 
 #include "PhysicsModule.h"
 #include <Mathematics/GteMath.h>
@@ -22,6 +22,9 @@ PhysicsModule::PhysicsModule(int numRows, int numCols, float step,
     mAmplitude(amplitude),
     mPhases(mNumParticles)
 {
+    // Only the external forces are customized, so use the spring kernel.
+    SetBatched(true);
+
     std::mt19937 mte;
     std::uniform_real_distribution<float> rnd(0.0f, (float)GTE_C_PI);
     for (int row = 0; row < mNumRows; ++row)
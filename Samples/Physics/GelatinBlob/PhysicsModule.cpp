@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.1.0 (2016/06/28)
+// File Version: 3.1.1 (2019/09/07)
 
 #include "PhysicsModule.h"
 
@@ -12,6 +12,7 @@ PhysicsModule::PhysicsModule(int numParticles, int numSprings, float step, float
     MassSpringArbitrary<3, float>(numParticles, numSprings, step),
     mViscosity(viscosity)
 {
+    SetBatched(true);
 }
 
 Vector3<float> PhysicsModule::ExternalAcceleration(int i, float,
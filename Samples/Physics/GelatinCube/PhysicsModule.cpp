@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.3.0 (2016/07/10)
+// File Version: 3.3.1 (2019/09/07)
 
 #include "PhysicsModule.h"
 
@@ -12,6 +12,8 @@ PhysicsModule::PhysicsModule (int numSlices, int numRows, int numCols, float ste
     MassSpringVolume<3, float>(numSlices, numRows, numCols, step),
     mViscosity(viscosity)
 {
+    // The module adds viscosity through ExternalAcceleration only.
+    SetBatched(true);
 }
 
 Vector3<float> PhysicsModule::ExternalAcceleration(int i, float,
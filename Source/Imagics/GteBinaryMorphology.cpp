@@ -0,0 +1,503 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/10)
+
+#include <GTEnginePCH.h>
+#include <LowLevel/GteLogger.h>
+#include <Imagics/GteBinaryMorphology.h>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include <utility>
+using namespace gte;
+
+BinaryMorphology::BinaryMorphology(unsigned int numThreads)
+    :
+    mNumThreads(numThreads > 0 ? numThreads : 1)
+{
+}
+
+template <typename Function>
+void BinaryMorphology::Execute(int numItems, Function const& function)
+{
+    unsigned int numThreads = mNumThreads;
+    if (numItems < static_cast<int>(numThreads))
+    {
+        numThreads = 1;
+    }
+
+    if (numThreads > 1)
+    {
+        int const numPerThread = numItems / static_cast<int>(numThreads);
+        std::vector<std::thread> process(numThreads);
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            int imin = static_cast<int>(t) * numPerThread;
+            int imax = (t + 1 < numThreads ? imin + numPerThread : numItems);
+            process[t] = std::thread([&function, t, imin, imax]()
+            {
+                function(t, imin, imax);
+            });
+        }
+
+        for (auto& p : process)
+        {
+            p.join();
+        }
+    }
+    else
+    {
+        function(0, 0, numItems);
+    }
+}
+
+void BinaryMorphology::Pack(int dim0, int dim1, int dim2, int const* image,
+    PackedImage& packed)
+{
+    packed.dim0 = dim0;
+    packed.dim1 = dim1;
+    packed.dim2 = dim2;
+    packed.wordsPerRow = (dim0 + 63) / 64;
+    int const numRows = dim1 * dim2;
+    packed.words.resize(static_cast<size_t>(numRows) * packed.wordsPerRow);
+
+    Execute(numRows, [dim0, image, &packed](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            int const* pixel = image + static_cast<size_t>(r) * dim0;
+            uint64_t* word = packed.words.data() + static_cast<size_t>(r) * packed.wordsPerRow;
+            for (int k = 0, x0 = 0; k < packed.wordsPerRow; ++k, x0 += 64)
+            {
+                int numBits = std::min(64, dim0 - x0);
+                uint64_t bits = 0;
+                for (int b = 0; b < numBits; ++b)
+                {
+                    bits |= static_cast<uint64_t>(pixel[x0 + b] != 0) << b;
+                }
+                word[k] = bits;
+            }
+        }
+    });
+}
+
+void BinaryMorphology::Unpack(PackedImage const& packed, int* image)
+{
+    int const dim0 = packed.dim0;
+    Execute(packed.dim1 * packed.dim2, [dim0, image, &packed](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            int* pixel = image + static_cast<size_t>(r) * dim0;
+            uint64_t const* word = packed.words.data() + static_cast<size_t>(r) * packed.wordsPerRow;
+            for (int k = 0, x0 = 0; k < packed.wordsPerRow; ++k, x0 += 64)
+            {
+                int numBits = std::min(64, dim0 - x0);
+                uint64_t bits = word[k];
+                for (int b = 0; b < numBits; ++b)
+                {
+                    pixel[x0 + b] = static_cast<int>((bits >> b) & 1);
+                }
+            }
+        }
+    });
+}
+
+void BinaryMorphology::Apply(int dim0, int dim1, int dim2, int const* input,
+    std::function<void(PackedImage const&, PackedImage&)> const& operation,
+    int* output)
+{
+    PackedImage packedInput, packedOutput;
+    Pack(dim0, dim1, dim2, input, packedInput);
+    operation(packedInput, packedOutput);
+    Unpack(packedOutput, output);
+}
+
+void BinaryMorphology::Dilate(PackedImage const& input,
+    std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+    PackedImage& output)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    if (input.words.empty())
+    {
+        // The rows have no words, so there is no last word to mask.
+        output = input;
+        return;
+    }
+    DilateBox(input, boxMin, boxMax, false, output);
+}
+
+void BinaryMorphology::Erode(PackedImage const& input, bool zeroExterior,
+    std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+    PackedImage& output)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    if (input.words.empty())
+    {
+        output = input;
+        return;
+    }
+
+    PackedImage complement = input;
+    Complement(complement);
+    std::array<int, 3> reflectMin = { -boxMax[0], -boxMax[1], -boxMax[2] };
+    std::array<int, 3> reflectMax = { -boxMin[0], -boxMin[1], -boxMin[2] };
+    DilateBox(complement, reflectMin, reflectMax, zeroExterior, output);
+    Complement(output);
+}
+
+void BinaryMorphology::Dilate(PackedImage const& input, int numOffsets,
+    std::array<int, 3> const* offsets, PackedImage& output)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    if (input.words.empty())
+    {
+        output = input;
+        return;
+    }
+
+    DilateOffsets(input, numOffsets, offsets, false, output);
+}
+
+void BinaryMorphology::Erode(PackedImage const& input, bool zeroExterior,
+    int numOffsets, std::array<int, 3> const* offsets, PackedImage& output)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    if (input.words.empty())
+    {
+        output = input;
+        return;
+    }
+
+    PackedImage complement = input;
+    Complement(complement);
+    std::vector<std::array<int, 3>> reflect(numOffsets);
+    for (int j = 0; j < numOffsets; ++j)
+    {
+        reflect[j] = { -offsets[j][0], -offsets[j][1], -offsets[j][2] };
+    }
+    DilateOffsets(complement, numOffsets, reflect.data(), zeroExterior, output);
+    Complement(output);
+}
+
+void BinaryMorphology::DilateBox(PackedImage const& input,
+    std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+    bool exterior, PackedImage& output)
+{
+    LogAssert(boxMin[0] <= boxMax[0] && boxMin[1] <= boxMax[1]
+        && boxMin[2] <= boxMax[2], "Invalid box.");
+
+    PackedImage temp;
+    DilateX(input, boxMin[0], boxMax[0], exterior, output);
+    DilateYZ(1, output, boxMin[1], boxMax[1], exterior, temp);
+    DilateYZ(2, temp, boxMin[2], boxMax[2], exterior, output);
+}
+
+void BinaryMorphology::DilateOffsets(PackedImage const& input,
+    int numOffsets, std::array<int, 3> const* offsets, bool exterior,
+    PackedImage& output)
+{
+    // Group the dx-values of the offsets by (dy,dz).  The origin is always
+    // in the structuring element.
+    std::map<std::pair<int, int>, std::vector<int>> rowOffsets;
+    rowOffsets[std::make_pair(0, 0)].push_back(0);
+    for (int j = 0; j < numOffsets; ++j)
+    {
+        rowOffsets[std::make_pair(offsets[j][1], offsets[j][2])].push_back(offsets[j][0]);
+    }
+
+    // Decompose each group into maximal runs of consecutive dx-values.  The
+    // input is dilated along the x-axis once for each distinct run.
+    struct Term { int dy, dz, run; };
+    std::vector<Term> terms;
+    std::vector<std::pair<int, int>> runs;
+    for (auto& element : rowOffsets)
+    {
+        std::vector<int>& dx = element.second;
+        std::sort(dx.begin(), dx.end());
+        dx.erase(std::unique(dx.begin(), dx.end()), dx.end());
+        for (size_t i0 = 0; i0 < dx.size(); )
+        {
+            size_t i1 = i0;
+            while (i1 + 1 < dx.size() && dx[i1 + 1] == dx[i1] + 1)
+            {
+                ++i1;
+            }
+
+            std::pair<int, int> run(dx[i0], dx[i1]);
+            auto iter = std::find(runs.begin(), runs.end(), run);
+            Term term = { element.first.first, element.first.second,
+                static_cast<int>(iter - runs.begin()) };
+            if (iter == runs.end())
+            {
+                runs.push_back(run);
+            }
+            terms.push_back(term);
+            i0 = i1 + 1;
+        }
+    }
+
+    std::vector<PackedImage> dilated(runs.size());
+    std::vector<PackedImage const*> source(runs.size());
+    for (size_t k = 0; k < runs.size(); ++k)
+    {
+        if (runs[k].first == 0 && runs[k].second == 0)
+        {
+            source[k] = &input;
+        }
+        else
+        {
+            DilateX(input, runs[k].first, runs[k].second, exterior, dilated[k]);
+            source[k] = &dilated[k];
+        }
+    }
+
+    // Row (y,z) of the output is the OR of the rows (y-dy,z-dz) of the
+    // x-dilated images.
+    int const dim1 = input.dim1, dim2 = input.dim2, wordsPerRow = input.wordsPerRow;
+    uint64_t const exteriorWord = (exterior ? ~0ull : 0ull);
+    uint64_t const lastMask = (input.dim0 % 64 == 0 ? ~0ull :
+        (1ull << (input.dim0 % 64)) - 1);
+    output.dim0 = input.dim0;
+    output.dim1 = dim1;
+    output.dim2 = dim2;
+    output.wordsPerRow = wordsPerRow;
+    output.words.resize(input.words.size());
+
+    Execute(dim1 * dim2, [&](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            int y = r % dim1, z = r / dim1;
+            uint64_t* target = output.words.data() + static_cast<size_t>(r) * wordsPerRow;
+            std::fill(target, target + wordsPerRow, 0ull);
+            for (auto const& term : terms)
+            {
+                int ys = y - term.dy, zs = z - term.dz;
+                if (0 <= ys && ys < dim1 && 0 <= zs && zs < dim2)
+                {
+                    uint64_t const* row = source[term.run]->words.data() +
+                        (static_cast<size_t>(ys) + static_cast<size_t>(dim1) * zs) * wordsPerRow;
+                    for (int k = 0; k < wordsPerRow; ++k)
+                    {
+                        target[k] |= row[k];
+                    }
+                }
+                else
+                {
+                    for (int k = 0; k < wordsPerRow; ++k)
+                    {
+                        target[k] |= exteriorWord;
+                    }
+                }
+            }
+            target[wordsPerRow - 1] &= lastMask;
+        }
+    });
+}
+
+void BinaryMorphology::DilateX(PackedImage const& input, int lo, int hi,
+    bool exterior, PackedImage& output)
+{
+    output.dim0 = input.dim0;
+    output.dim1 = input.dim1;
+    output.dim2 = input.dim2;
+    output.wordsPerRow = input.wordsPerRow;
+    if (lo == 0 && hi == 0)
+    {
+        output.words = input.words;
+        return;
+    }
+    output.words.resize(input.words.size());
+
+    // Output pixel x is the OR of the input pixels in the window
+    // [x-hi,x-lo] of length L.  Let D(k,s) be the OR of the pixels in
+    // [s,s+k-1], so D(2k,s) = D(k,s) | D(k,s+k).  For the largest power of
+    // two p <= L, the window is the union of [x-hi,x-hi+p-1] and
+    // [x-lo-p+1,x-lo].  The row is copied to a buffer that is padded with
+    // exterior words so that all the shifted reads are valid.
+    int const length = hi - lo + 1;
+    int power = 1;
+    while (2 * power <= length)
+    {
+        power *= 2;
+    }
+
+    int const wordsPerRow = input.wordsPerRow;
+    int const numPadWords = (std::abs(lo) + std::abs(hi) + length + 63) / 64 + 1;
+    int const numBufferWords = wordsPerRow + 2 * numPadWords;
+    int64_t const origin = 64 * static_cast<int64_t>(numPadWords);
+    uint64_t const exteriorWord = (exterior ? ~0ull : 0ull);
+    uint64_t const lastMask = (input.dim0 % 64 == 0 ? ~0ull :
+        (1ull << (input.dim0 % 64)) - 1);
+
+    Execute(input.dim1 * input.dim2, [&](unsigned int, int rmin, int rmax)
+    {
+        std::vector<uint64_t> buffer(numBufferWords), shifted(numBufferWords);
+
+        // Read the 64 bits starting at bit 'position' of the buffer.
+        auto Read = [numBufferWords, exteriorWord](uint64_t const* words, int64_t position)
+        {
+            int64_t i = position >> 6;
+            int offset = static_cast<int>(position & 63);
+            uint64_t word0 = (i < numBufferWords ? words[i] : exteriorWord);
+            if (offset == 0)
+            {
+                return word0;
+            }
+            uint64_t word1 = (i + 1 < numBufferWords ? words[i + 1] : exteriorWord);
+            return (word0 >> offset) | (word1 << (64 - offset));
+        };
+
+        for (int r = rmin; r < rmax; ++r)
+        {
+            uint64_t const* source = input.words.data() + static_cast<size_t>(r) * wordsPerRow;
+            std::fill(buffer.begin(), buffer.end(), exteriorWord);
+            std::copy(source, source + wordsPerRow, buffer.begin() + numPadWords);
+            buffer[numPadWords + wordsPerRow - 1] |= (exteriorWord & ~lastMask);
+
+            for (int k = 1; k < power; k *= 2)
+            {
+                for (int i = 0; i < numBufferWords; ++i)
+                {
+                    shifted[i] = buffer[i] | Read(buffer.data(), 64 * static_cast<int64_t>(i) + k);
+                }
+                std::swap(buffer, shifted);
+            }
+
+            uint64_t* target = output.words.data() + static_cast<size_t>(r) * wordsPerRow;
+            for (int k = 0; k < wordsPerRow; ++k)
+            {
+                int64_t x = origin + 64 * static_cast<int64_t>(k);
+                target[k] = Read(buffer.data(), x - hi) | Read(buffer.data(), x - lo - power + 1);
+            }
+            target[wordsPerRow - 1] &= lastMask;
+        }
+    });
+}
+
+void BinaryMorphology::DilateYZ(int axis, PackedImage const& input, int lo,
+    int hi, bool exterior, PackedImage& output)
+{
+    output.dim0 = input.dim0;
+    output.dim1 = input.dim1;
+    output.dim2 = input.dim2;
+    output.wordsPerRow = input.wordsPerRow;
+    if (lo == 0 && hi == 0)
+    {
+        output.words = input.words;
+        return;
+    }
+    output.words.resize(input.words.size());
+
+    // The lines along the axis are processed in groups of at most
+    // chunkSize words.  Output row q is the OR of the input rows in the
+    // window [q-hi,q-lo].  The extended sequence of rows s = j - hi for
+    // 0 <= j < n+L-1 is partitioned into blocks of L rows.  For each block,
+    // prefix[j] is the OR of the rows from the start of the block to j and
+    // suffix[j] is the OR of the rows from j to the end of the block, so the
+    // window is the union of suffix[q] and prefix[q+L-1].
+    int const length = hi - lo + 1;
+    int const n = (axis == 1 ? input.dim1 : input.dim2);
+    int const numExtended = n + length - 1;
+    int const numLines = (axis == 1 ? input.dim2 : input.dim1);
+    size_t const rowStride = (axis == 1 ? 1 : static_cast<size_t>(input.dim1));
+    int const wordsPerRow = input.wordsPerRow;
+    int const chunkSize = 8;
+    int const numChunks = (wordsPerRow + chunkSize - 1) / chunkSize;
+    uint64_t const exteriorWord = (exterior ? ~0ull : 0ull);
+    uint64_t const lastMask = (input.dim0 % 64 == 0 ? ~0ull :
+        (1ull << (input.dim0 % 64)) - 1);
+
+    Execute(numLines * numChunks, [&](unsigned int, int imin, int imax)
+    {
+        std::vector<uint64_t> prefix(static_cast<size_t>(numExtended) * chunkSize);
+        std::vector<uint64_t> suffix(static_cast<size_t>(numExtended) * chunkSize);
+        for (int item = imin; item < imax; ++item)
+        {
+            int line = item / numChunks;
+            int k0 = (item % numChunks) * chunkSize;
+            int width = std::min(chunkSize, wordsPerRow - k0);
+            size_t base = (axis == 1 ? static_cast<size_t>(input.dim1) * line : static_cast<size_t>(line));
+
+            for (int j = 0; j < numExtended; ++j)
+            {
+                int s = j - hi;
+                uint64_t* target = &prefix[static_cast<size_t>(j) * width];
+                if (0 <= s && s < n)
+                {
+                    uint64_t const* row = input.words.data() +
+                        (base + rowStride * s) * wordsPerRow + k0;
+                    std::copy(row, row + width, target);
+                }
+                else
+                {
+                    std::fill(target, target + width, exteriorWord);
+                }
+            }
+            std::copy(prefix.begin(), prefix.begin() + static_cast<size_t>(numExtended) * width,
+                suffix.begin());
+
+            for (int j0 = 0; j0 < numExtended; j0 += length)
+            {
+                int j1 = std::min(j0 + length, numExtended);
+                for (int j = j0 + 1; j < j1; ++j)
+                {
+                    uint64_t* current = &prefix[static_cast<size_t>(j) * width];
+                    uint64_t const* previous = current - width;
+                    for (int k = 0; k < width; ++k)
+                    {
+                        current[k] |= previous[k];
+                    }
+                }
+                for (int j = j1 - 2; j >= j0; --j)
+                {
+                    uint64_t* current = &suffix[static_cast<size_t>(j) * width];
+                    uint64_t const* next = current + width;
+                    for (int k = 0; k < width; ++k)
+                    {
+                        current[k] |= next[k];
+                    }
+                }
+            }
+
+            for (int q = 0; q < n; ++q)
+            {
+                uint64_t* target = output.words.data() + (base + rowStride * q) * wordsPerRow + k0;
+                uint64_t const* s0 = &suffix[static_cast<size_t>(q) * width];
+                uint64_t const* s1 = &prefix[static_cast<size_t>(q + length - 1) * width];
+                for (int k = 0; k < width; ++k)
+                {
+                    target[k] = s0[k] | s1[k];
+                }
+                if (k0 + width == wordsPerRow)
+                {
+                    target[width - 1] &= lastMask;
+                }
+            }
+        }
+    });
+}
+
+void BinaryMorphology::Complement(PackedImage& image)
+{
+    int const wordsPerRow = image.wordsPerRow;
+    uint64_t const lastMask = (image.dim0 % 64 == 0 ? ~0ull :
+        (1ull << (image.dim0 % 64)) - 1);
+    Execute(image.dim1 * image.dim2, [&image, wordsPerRow, lastMask](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            uint64_t* word = image.words.data() + static_cast<size_t>(r) * wordsPerRow;
+            for (int k = 0; k < wordsPerRow; ++k)
+            {
+                word[k] = ~word[k];
+            }
+            word[wordsPerRow - 1] &= lastMask;
+        }
+    });
+}
@@ -0,0 +1,505 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/12)
+
+#include <GTEnginePCH.h>
+#include <Imagics/GteBrickFile.h>
+#include <algorithm>
+#include <cstring>
+using namespace gte;
+
+namespace
+{
+    char const gsMagic[8] = { 'G', 'T', 'E', 'B', 'R', 'I', 'C', 'K' };
+    uint32_t const gsVersion = 1;
+    uint64_t const gsHeaderBytes = 64;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        int32_t dims[3], brickDims[3];
+        uint32_t pixelSize, compressed, reserved0;
+        uint64_t tableOffset, reserved1;
+    };
+    static_assert(sizeof(Header) == gsHeaderBytes, "Unexpected header size.");
+}
+
+BrickFile::~BrickFile()
+{
+    Close();
+}
+
+BrickFile::BrickFile()
+    :
+    mWritable(false),
+    mCompressed(false),
+    mModified(false),
+    mDims{ { 0, 0, 0 } },
+    mBrickDims{ { 0, 0, 0 } },
+    mNumBricks{ { 0, 0, 0 } },
+    mPixelSize(0),
+    mBrickBytes(0),
+    mEnd(0)
+{
+}
+
+bool BrickFile::Create(std::string const& filename, std::array<int, 3> const& dims,
+    std::array<int, 3> const& brickDims, int pixelSize, bool compressed)
+{
+    Close();
+    for (int i = 0; i < 3; ++i)
+    {
+        if (dims[i] <= 0 || brickDims[i] <= 0)
+        {
+            return false;
+        }
+    }
+    if (pixelSize <= 0)
+    {
+        return false;
+    }
+
+    mStream.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mStream.is_open())
+    {
+        return false;
+    }
+
+    Initialize(dims, brickDims, pixelSize, compressed);
+    mWritable = true;
+    mModified = true;
+    mEnd = gsHeaderBytes;
+
+    // The header is written again by Close() when the table offset is
+    // known.
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    mStream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    return mStream.good();
+}
+
+bool BrickFile::Open(std::string const& filename, bool writable)
+{
+    Close();
+    std::ios::openmode mode = std::ios::in | std::ios::binary;
+    if (writable)
+    {
+        mode |= std::ios::out;
+    }
+    mStream.open(filename, mode);
+    if (!mStream.is_open())
+    {
+        return false;
+    }
+
+    Header header;
+    mStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    bool valid = mStream.good()
+        && std::memcmp(header.magic, gsMagic, sizeof(gsMagic)) == 0
+        && header.version == gsVersion
+        && header.pixelSize > 0
+        && header.tableOffset >= gsHeaderBytes;
+    for (int i = 0; i < 3 && valid; ++i)
+    {
+        valid = (header.dims[i] > 0 && header.brickDims[i] > 0);
+    }
+    if (!valid)
+    {
+        mStream.close();
+        return false;
+    }
+
+    Initialize({ { header.dims[0], header.dims[1], header.dims[2] } },
+        { { header.brickDims[0], header.brickDims[1], header.brickDims[2] } },
+        static_cast<int>(header.pixelSize), header.compressed != 0);
+
+    mStream.seekg(static_cast<std::streamoff>(header.tableOffset));
+    mStream.read(reinterpret_cast<char*>(mTable.data()), mTable.size() * sizeof(Entry));
+    valid = mStream.good();
+    for (auto const& entry : mTable)
+    {
+        if (entry.size > mBrickBytes || entry.offset + entry.size > header.tableOffset)
+        {
+            valid = false;
+            break;
+        }
+    }
+    if (!valid)
+    {
+        mStream.close();
+        mTable.clear();
+        return false;
+    }
+
+    // Bricks that are written are appended starting at the table, which is
+    // written again by Close().  The extent of a brick extends to the next
+    // brick in the file.
+    mWritable = writable;
+    mModified = false;
+    mEnd = header.tableOffset;
+    std::vector<size_t> used;
+    for (size_t brick = 0; brick < mTable.size(); ++brick)
+    {
+        if (mTable[brick].size > 0)
+        {
+            used.push_back(brick);
+        }
+    }
+    std::sort(used.begin(), used.end(), [this](size_t b0, size_t b1)
+    {
+        return mTable[b0].offset < mTable[b1].offset;
+    });
+    for (size_t k = 0; k < used.size(); ++k)
+    {
+        uint64_t next = (k + 1 < used.size() ? mTable[used[k + 1]].offset : mEnd);
+        mCapacity[used[k]] = std::max(next - mTable[used[k]].offset, mTable[used[k]].size);
+    }
+    return true;
+}
+
+bool BrickFile::Close()
+{
+    bool success = true;
+    if (mStream.is_open())
+    {
+        if (mWritable && mModified)
+        {
+            mStream.seekp(static_cast<std::streamoff>(mEnd));
+            mStream.write(reinterpret_cast<char const*>(mTable.data()), mTable.size() * sizeof(Entry));
+
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, gsMagic, sizeof(gsMagic));
+            header.version = gsVersion;
+            for (int i = 0; i < 3; ++i)
+            {
+                header.dims[i] = mDims[i];
+                header.brickDims[i] = mBrickDims[i];
+            }
+            header.pixelSize = static_cast<uint32_t>(mPixelSize);
+            header.compressed = (mCompressed ? 1 : 0);
+            header.tableOffset = mEnd;
+            mStream.seekp(0);
+            mStream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            success = mStream.good();
+        }
+        mStream.close();
+    }
+
+    mWritable = false;
+    mModified = false;
+    mTable.clear();
+    mCapacity.clear();
+    mFree.clear();
+    mBuffer.clear();
+    return success;
+}
+
+bool BrickFile::ReadBrick(size_t brick, void* data)
+{
+    if (!mStream.is_open() || brick >= mTable.size())
+    {
+        return false;
+    }
+
+    Entry const& entry = mTable[brick];
+    if (entry.size == 0)
+    {
+        std::memset(data, 0, mBrickBytes);
+        return true;
+    }
+
+    mStream.seekg(static_cast<std::streamoff>(entry.offset));
+    if (entry.size == mBrickBytes)
+    {
+        mStream.read(static_cast<char*>(data), mBrickBytes);
+        return mStream.good();
+    }
+
+    mBuffer.resize(static_cast<size_t>(entry.size));
+    mStream.read(reinterpret_cast<char*>(mBuffer.data()), mBuffer.size());
+    return mStream.good() && Decompress(mBuffer.data(), mBuffer.size(),
+        static_cast<uint8_t*>(data), mBrickBytes);
+}
+
+bool BrickFile::WriteBrick(size_t brick, void const* data)
+{
+    if (!mStream.is_open() || !mWritable || brick >= mTable.size())
+    {
+        return false;
+    }
+
+    Entry& entry = mTable[brick];
+    uint64_t& capacity = mCapacity[brick];
+    mModified = true;
+
+    uint8_t const* bytes = static_cast<uint8_t const*>(data);
+    if (std::all_of(bytes, bytes + mBrickBytes, [](uint8_t b) { return b == 0; }))
+    {
+        // Zero bricks are not stored.
+        Release(brick);
+        return true;
+    }
+
+    uint64_t size = mBrickBytes;
+    if (mCompressed)
+    {
+        size_t numCompressed = Compress(bytes, mBrickBytes, mBuffer);
+        if (numCompressed < mBrickBytes)
+        {
+            bytes = mBuffer.data();
+            size = numCompressed;
+        }
+    }
+
+    // The brick replaces the previous version when it fits in its extent.
+    // Otherwise, a new extent is allocated.  The first extent of a brick
+    // has the size of the brick.  When the brick no longer fits, its new
+    // extent has the uncompressed size, so that it is moved at most once.
+    if (size > capacity)
+    {
+        bool moved = (capacity > 0);
+        Release(brick);
+        capacity = (moved ? static_cast<uint64_t>(mBrickBytes) : size);
+        entry.offset = Allocate(capacity);
+    }
+    entry.size = size;
+    mStream.seekp(static_cast<std::streamoff>(entry.offset));
+    mStream.write(reinterpret_cast<char const*>(bytes), static_cast<std::streamsize>(size));
+    return mStream.good();
+}
+
+void BrickFile::Initialize(std::array<int, 3> const& dims,
+    std::array<int, 3> const& brickDims, int pixelSize, bool compressed)
+{
+    mDims = dims;
+    mBrickDims = brickDims;
+    mPixelSize = pixelSize;
+    mCompressed = compressed;
+    mBrickBytes = static_cast<size_t>(pixelSize);
+    size_t numBricks = 1;
+    for (int i = 0; i < 3; ++i)
+    {
+        mNumBricks[i] = (dims[i] + brickDims[i] - 1) / brickDims[i];
+        mBrickBytes *= static_cast<size_t>(brickDims[i]);
+        numBricks *= static_cast<size_t>(mNumBricks[i]);
+    }
+    mTable.assign(numBricks, Entry{ 0, 0 });
+    mCapacity.assign(numBricks, 0);
+}
+
+void BrickFile::Release(size_t brick)
+{
+    if (mCapacity[brick] > 0)
+    {
+        mFree.push_back({ mTable[brick].offset, mCapacity[brick] });
+    }
+    mTable[brick] = { 0, 0 };
+    mCapacity[brick] = 0;
+}
+
+uint64_t BrickFile::Allocate(uint64_t size)
+{
+    for (auto& extent : mFree)
+    {
+        if (extent.size >= size)
+        {
+            uint64_t offset = extent.offset;
+            extent.offset += size;
+            extent.size -= size;
+            if (extent.size == 0)
+            {
+                extent = mFree.back();
+                mFree.pop_back();
+            }
+            return offset;
+        }
+    }
+
+    uint64_t offset = mEnd;
+    mEnd += size;
+    return offset;
+}
+
+// The LZ4 block format is a sequence of (literals, match) pairs.  Each pair
+// starts with a token byte whose high nibble is the number of literals and
+// whose low nibble is the match length minus 4.  A nibble of 15 is followed
+// by bytes that are added to it, up to and including the first byte that is
+// not 255.  The literals follow the literal length, and the match is stored
+// as a 2-byte little-endian offset back from the current output position,
+// followed by the extra match length bytes.  The last pair has literals
+// only; the last 5 bytes of the data are always literals and the last match
+// starts at least 12 bytes before the end.
+size_t BrickFile::Compress(uint8_t const* input, size_t numInputBytes,
+    std::vector<uint8_t>& output)
+{
+    size_t const minMatch = 4, lastLiterals = 5, matchLimit = 12;
+    size_t const hashBits = 16, maxOffset = 65535;
+
+    auto writeLength = [&output](size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            output.push_back(255);
+        }
+        output.push_back(static_cast<uint8_t>(length));
+    };
+
+    auto read32 = [input](size_t i)
+    {
+        uint32_t value;
+        std::memcpy(&value, input + i, sizeof(value));
+        return value;
+    };
+
+    output.clear();
+    output.reserve(numInputBytes + numInputBytes / 255 + 16);
+    std::vector<int64_t> table(static_cast<size_t>(1) << hashBits, -1);
+    size_t anchor = 0;
+    if (numInputBytes > matchLimit)
+    {
+        size_t const limit = numInputBytes - matchLimit;
+        for (size_t i = 0; i < limit; /**/)
+        {
+            uint32_t sequence = read32(i);
+            size_t h = static_cast<size_t>((sequence * 2654435761u) >> (32 - hashBits));
+            int64_t candidate = table[h];
+            table[h] = static_cast<int64_t>(i);
+            if (candidate < 0 || i - static_cast<size_t>(candidate) > maxOffset
+                || read32(static_cast<size_t>(candidate)) != sequence)
+            {
+                ++i;
+                continue;
+            }
+
+            size_t match = static_cast<size_t>(candidate);
+            size_t length = minMatch;
+            size_t const maxLength = numInputBytes - lastLiterals - i;
+            while (length < maxLength && input[match + length] == input[i + length])
+            {
+                ++length;
+            }
+
+            size_t numLiterals = i - anchor;
+            size_t extraLength = length - minMatch;
+            uint8_t token = static_cast<uint8_t>((std::min<size_t>(numLiterals, 15) << 4)
+                | std::min<size_t>(extraLength, 15));
+            output.push_back(token);
+            if (numLiterals >= 15)
+            {
+                writeLength(numLiterals - 15);
+            }
+            output.insert(output.end(), input + anchor, input + i);
+            size_t offset = i - match;
+            output.push_back(static_cast<uint8_t>(offset & 0xFF));
+            output.push_back(static_cast<uint8_t>(offset >> 8));
+            if (extraLength >= 15)
+            {
+                writeLength(extraLength - 15);
+            }
+
+            i += length;
+            anchor = i;
+        }
+    }
+
+    size_t numLiterals = numInputBytes - anchor;
+    output.push_back(static_cast<uint8_t>(std::min<size_t>(numLiterals, 15) << 4));
+    if (numLiterals >= 15)
+    {
+        writeLength(numLiterals - 15);
+    }
+    output.insert(output.end(), input + anchor, input + numInputBytes);
+    return output.size();
+}
+
+bool BrickFile::Decompress(uint8_t const* input, size_t numInputBytes,
+    uint8_t* output, size_t numOutputBytes)
+{
+    size_t i = 0, o = 0;
+
+    auto readLength = [input, numInputBytes, &i](size_t& length)
+    {
+        uint8_t value;
+        do
+        {
+            if (i >= numInputBytes)
+            {
+                return false;
+            }
+            value = input[i++];
+            length += value;
+        } while (value == 255);
+        return true;
+    };
+
+    for (;;)
+    {
+        if (i >= numInputBytes)
+        {
+            return false;
+        }
+
+        uint8_t token = input[i++];
+        size_t numLiterals = token >> 4;
+        if (numLiterals == 15 && !readLength(numLiterals))
+        {
+            return false;
+        }
+        if (numLiterals > numInputBytes - i || numLiterals > numOutputBytes - o)
+        {
+            return false;
+        }
+        std::memcpy(output + o, input + i, numLiterals);
+        i += numLiterals;
+        o += numLiterals;
+
+        if (i == numInputBytes)
+        {
+            // The last sequence has no match.
+            return o == numOutputBytes;
+        }
+
+        if (numInputBytes - i < 2)
+        {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(input[i]) | (static_cast<size_t>(input[i + 1]) << 8);
+        i += 2;
+        if (offset == 0 || offset > o)
+        {
+            return false;
+        }
+
+        size_t length = token & 15;
+        if (length == 15 && !readLength(length))
+        {
+            return false;
+        }
+        length += 4;
+        if (length > numOutputBytes - o)
+        {
+            return false;
+        }
+
+        // A match that overlaps the output repeats the last 'offset' bytes,
+        // so it is copied in order.
+        uint8_t const* source = output + o - offset;
+        if (offset >= length)
+        {
+            std::memcpy(output + o, source, length);
+        }
+        else
+        {
+            for (size_t k = 0; k < length; ++k)
+            {
+                output[o + k] = source[k];
+            }
+        }
+        o += length;
+    }
+}
@@ -0,0 +1,363 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/08)
+
+#include <GTEnginePCH.h>
+#include <Imagics/GteComponentLabeler.h>
+#include <algorithm>
+#include <thread>
+using namespace gte;
+
+ComponentLabeler::ComponentLabeler(unsigned int numThreads)
+    :
+    mNumThreads(numThreads > 0 ? numThreads : 1),
+    mDim0(0),
+    mDim1(0),
+    mDim2(0),
+    mNumRows(0),
+    mConnectivity(0),
+    mNumComponents(0)
+{
+}
+
+template <typename Function>
+void ComponentLabeler::Execute(int numItems, Function const& function)
+{
+    unsigned int numThreads = mNumThreads;
+    if (numItems < static_cast<int>(numThreads))
+    {
+        numThreads = 1;
+    }
+
+    if (numThreads > 1)
+    {
+        int const numPerThread = numItems / static_cast<int>(numThreads);
+        std::vector<std::thread> process(numThreads);
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            int imin = static_cast<int>(t) * numPerThread;
+            int imax = (t + 1 < numThreads ? imin + numPerThread : numItems);
+            process[t] = std::thread([&function, t, imin, imax]()
+            {
+                function(t, imin, imax);
+            });
+        }
+
+        for (auto& p : process)
+        {
+            p.join();
+        }
+    }
+    else
+    {
+        function(0, 0, numItems);
+    }
+}
+
+int ComponentLabeler::Execute(int dim0, int dim1, int dim2, int connectivity,
+    int const* mask, int* labels)
+{
+    // The adjacent preceding rows (y-dy, z-dz) and the slack for the
+    // x-interval overlap test.
+    struct Neighbor { int dy, dz, slack; };
+    static Neighbor const neighbors4[] = { { 1, 0, 0 } };
+    static Neighbor const neighbors8[] = { { 1, 0, 1 } };
+    static Neighbor const neighbors6[] = { { 1, 0, 0 }, { 0, 1, 0 } };
+    static Neighbor const neighbors18[] =
+        { { 1, 0, 1 }, { 0, 1, 1 }, { 1, 1, 0 }, { -1, 1, 0 } };
+    static Neighbor const neighbors26[] =
+        { { 1, 0, 1 }, { 0, 1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } };
+
+    Neighbor const* neighbors = nullptr;
+    int numNeighbors = 0;
+    if (dim2 == 1 && connectivity == 4)
+    {
+        neighbors = neighbors4;
+        numNeighbors = 1;
+    }
+    else if (dim2 == 1 && connectivity == 8)
+    {
+        neighbors = neighbors8;
+        numNeighbors = 1;
+    }
+    else if (connectivity == 6)
+    {
+        neighbors = neighbors6;
+        numNeighbors = 2;
+    }
+    else if (connectivity == 18)
+    {
+        neighbors = neighbors18;
+        numNeighbors = 4;
+    }
+    else if (connectivity == 26)
+    {
+        neighbors = neighbors26;
+        numNeighbors = 4;
+    }
+
+    mNumComponents = 0;
+    if (!neighbors || dim0 <= 0 || dim1 <= 0 || dim2 <= 0 || !mask || !labels)
+    {
+        mDim0 = mDim1 = mDim2 = mNumRows = mConnectivity = 0;
+        mRunStart.assign(1, 0);
+        return 0;
+    }
+
+    mDim0 = dim0;
+    mDim1 = dim1;
+    mDim2 = dim2;
+    mNumRows = dim1 * dim2;
+    mConnectivity = connectivity;
+
+    CreateRuns(mask);
+
+    // Union-find within blocks of rows in parallel.  The roots are always
+    // the runs with smallest index, so the links never leave a block.
+    mRunParent.resize(mRunX0.size());
+    for (size_t k = 0; k < mRunParent.size(); ++k)
+    {
+        mRunParent[k] = static_cast<int>(k);
+    }
+
+    std::vector<int> blockStart(mNumThreads + 1, mNumRows);
+    Execute(mNumRows, [this, neighbors, numNeighbors, &blockStart](unsigned int t, int rmin, int rmax)
+    {
+        blockStart[t] = rmin;
+        for (int r = rmin; r < rmax; ++r)
+        {
+            for (int j = 0; j < numNeighbors; ++j)
+            {
+                Neighbor const& nbr = neighbors[j];
+                MergeRows(r, nbr.dy, nbr.dz, nbr.slack, rmin, rmax);
+            }
+        }
+    });
+
+    // Merge the pairs of rows that cross block boundaries.  The adjacent
+    // rows precede a row by at most dim1+1 rows.
+    for (unsigned int t = 1; t < mNumThreads; ++t)
+    {
+        int rmin = blockStart[t];
+        int rmax = std::min(std::min(blockStart[t + 1], mNumRows), rmin + mDim1 + 1);
+        for (int r = rmin; r < rmax; ++r)
+        {
+            for (int j = 0; j < numNeighbors; ++j)
+            {
+                Neighbor const& nbr = neighbors[j];
+                MergeRows(r, nbr.dy, nbr.dz, nbr.slack, 0, rmin);
+            }
+        }
+    }
+
+    mNumComponents = AssignLabels();
+
+    // Write the label image.
+    Execute(mNumRows, [this, labels](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            int* row = labels + static_cast<size_t>(r) * static_cast<size_t>(mDim0);
+            std::fill(row, row + mDim0, 0);
+            for (int k = mRunStart[r]; k < mRunStart[r + 1]; ++k)
+            {
+                std::fill(row + mRunX0[k], row + mRunX1[k] + 1, mRunParent[k]);
+            }
+        }
+    });
+
+    return mNumComponents;
+}
+
+void ComponentLabeler::GetComponents(std::vector<Component>& components) const
+{
+    Component initial;
+    initial.numElements = 0;
+    initial.minimum = { mDim0, mDim1, mDim2 };
+    initial.maximum = { -1, -1, -1 };
+    components.assign(mNumComponents + 1, initial);
+    for (int r = 0; r < mNumRows; ++r)
+    {
+        int y = r % mDim1, z = r / mDim1;
+        for (int k = mRunStart[r]; k < mRunStart[r + 1]; ++k)
+        {
+            Component& component = components[mRunParent[k]];
+            component.numElements += static_cast<size_t>(mRunX1[k] - mRunX0[k] + 1);
+            component.minimum[0] = std::min(component.minimum[0], mRunX0[k]);
+            component.minimum[1] = std::min(component.minimum[1], y);
+            component.minimum[2] = std::min(component.minimum[2], z);
+            component.maximum[0] = std::max(component.maximum[0], mRunX1[k]);
+            component.maximum[1] = std::max(component.maximum[1], y);
+            component.maximum[2] = std::max(component.maximum[2], z);
+        }
+    }
+    components[0].minimum = { 0, 0, 0 };
+    components[0].maximum = { 0, 0, 0 };
+}
+
+void ComponentLabeler::GetComponents(std::vector<std::vector<size_t>>& components) const
+{
+    std::vector<size_t> numElements(mNumComponents + 1, 0);
+    for (size_t k = 0; k < mRunX0.size(); ++k)
+    {
+        numElements[mRunParent[k]] += static_cast<size_t>(mRunX1[k] - mRunX0[k] + 1);
+    }
+
+    components.clear();
+    if (mNumComponents > 0)
+    {
+        components.resize(mNumComponents + 1);
+        for (int label = 1; label <= mNumComponents; ++label)
+        {
+            components[label].reserve(numElements[label]);
+        }
+
+        for (int r = 0; r < mNumRows; ++r)
+        {
+            size_t base = static_cast<size_t>(r) * static_cast<size_t>(mDim0);
+            for (int k = mRunStart[r]; k < mRunStart[r + 1]; ++k)
+            {
+                std::vector<size_t>& component = components[mRunParent[k]];
+                for (int x = mRunX0[k]; x <= mRunX1[k]; ++x)
+                {
+                    component.push_back(base + x);
+                }
+            }
+        }
+    }
+}
+
+void ComponentLabeler::CreateRuns(int const* mask)
+{
+    // Count the runs of each row, compute the offsets of the rows in the
+    // run arrays, and then store the runs.
+    mRunStart.assign(mNumRows + 1, 0);
+    Execute(mNumRows, [this, mask](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            int const* row = mask + static_cast<size_t>(r) * static_cast<size_t>(mDim0);
+            int numRuns = 0;
+            bool inside = false;
+            for (int x = 0; x < mDim0; ++x)
+            {
+                bool foreground = (row[x] != 0);
+                numRuns += (foreground && !inside ? 1 : 0);
+                inside = foreground;
+            }
+            mRunStart[r + 1] = numRuns;
+        }
+    });
+
+    for (int r = 0; r < mNumRows; ++r)
+    {
+        mRunStart[r + 1] += mRunStart[r];
+    }
+
+    mRunX0.resize(mRunStart[mNumRows]);
+    mRunX1.resize(mRunStart[mNumRows]);
+    Execute(mNumRows, [this, mask](unsigned int, int rmin, int rmax)
+    {
+        for (int r = rmin; r < rmax; ++r)
+        {
+            int const* row = mask + static_cast<size_t>(r) * static_cast<size_t>(mDim0);
+            int k = mRunStart[r];
+            int x = 0;
+            while (x < mDim0)
+            {
+                if (row[x] != 0)
+                {
+                    mRunX0[k] = x;
+                    while (x + 1 < mDim0 && row[x + 1] != 0)
+                    {
+                        ++x;
+                    }
+                    mRunX1[k++] = x;
+                }
+                ++x;
+            }
+        }
+    });
+}
+
+void ComponentLabeler::MergeRows(int r, int dy, int dz, int slack, int rowMin,
+    int rowMax)
+{
+    int y = r % mDim1 - dy, z = r / mDim1 - dz;
+    if (y < 0 || y >= mDim1 || z < 0)
+    {
+        return;
+    }
+
+    int rAdj = y + mDim1 * z;
+    if (rAdj < rowMin || rAdj >= rowMax)
+    {
+        return;
+    }
+
+    int i = mRunStart[r], iMax = mRunStart[r + 1];
+    int j = mRunStart[rAdj], jMax = mRunStart[rAdj + 1];
+    while (i < iMax && j < jMax)
+    {
+        if (mRunX1[j] + slack < mRunX0[i])
+        {
+            ++j;
+        }
+        else if (mRunX1[i] + slack < mRunX0[j])
+        {
+            ++i;
+        }
+        else
+        {
+            Union(i, j);
+            if (mRunX1[i] < mRunX1[j])
+            {
+                ++i;
+            }
+            else
+            {
+                ++j;
+            }
+        }
+    }
+}
+
+int ComponentLabeler::Find(int run)
+{
+    while (mRunParent[run] != run)
+    {
+        mRunParent[run] = mRunParent[mRunParent[run]];
+        run = mRunParent[run];
+    }
+    return run;
+}
+
+void ComponentLabeler::Union(int run0, int run1)
+{
+    int root0 = Find(run0), root1 = Find(run1);
+    if (root0 < root1)
+    {
+        mRunParent[root1] = root0;
+    }
+    else if (root1 < root0)
+    {
+        mRunParent[root0] = root1;
+    }
+}
+
+int ComponentLabeler::AssignLabels()
+{
+    // The parent of a run precedes the run, so a single pass in increasing
+    // order replaces the parents by labels.  When run k is visited, its
+    // parent p < k already stores the label of the component.
+    int numComponents = 0;
+    for (size_t k = 0; k < mRunParent.size(); ++k)
+    {
+        int p = mRunParent[k];
+        mRunParent[k] = (p == static_cast<int>(k) ? ++numComponents : mRunParent[p]);
+    }
+    return numComponents;
+}
@@ -0,0 +1,294 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/09)
+
+#include <GTEnginePCH.h>
+#include <Imagics/GteDistanceTransform.h>
+#include <algorithm>
+#include <limits>
+#include <thread>
+using namespace gte;
+
+DistanceTransform::DistanceTransform(unsigned int numThreads)
+    :
+    mNumThreads(numThreads > 0 ? numThreads : 1),
+    mScratch(mNumThreads)
+{
+    mDim[0] = 0;
+    mDim[1] = 0;
+    mDim[2] = 0;
+}
+
+template <typename Function>
+void DistanceTransform::Execute(int numItems, Function const& function)
+{
+    unsigned int numThreads = mNumThreads;
+    if (numItems < static_cast<int>(numThreads))
+    {
+        numThreads = 1;
+    }
+
+    if (numThreads > 1)
+    {
+        int const numPerThread = numItems / static_cast<int>(numThreads);
+        std::vector<std::thread> process(numThreads);
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            int imin = static_cast<int>(t) * numPerThread;
+            int imax = (t + 1 < numThreads ? imin + numPerThread : numItems);
+            process[t] = std::thread([&function, t, imin, imax]()
+            {
+                function(t, imin, imax);
+            });
+        }
+
+        for (auto& p : process)
+        {
+            p.join();
+        }
+    }
+    else
+    {
+        function(0, 0, numItems);
+    }
+}
+
+bool DistanceTransform::Execute(int dim0, int dim1, int dim2,
+    int const* mask, bool isSigned, int* sqrDistance, int* nearest)
+{
+    if (dim0 <= 0 || dim1 <= 0 || dim2 <= 0 || !mask || !sqrDistance)
+    {
+        return false;
+    }
+
+    int64_t const maxValue = static_cast<int64_t>(std::numeric_limits<int>::max());
+    int64_t d0 = dim0, d1 = dim1, d2 = dim2;
+    if (d0 * d0 + d1 * d1 + d2 * d2 >= maxValue || d0 * d1 * d2 > maxValue)
+    {
+        return false;
+    }
+
+    mDim[0] = dim0;
+    mDim[1] = dim1;
+    mDim[2] = dim2;
+    int const numPixels = dim0 * dim1 * dim2;
+    if (!nearest)
+    {
+        mNearest.resize(numPixels);
+        nearest = mNearest.data();
+    }
+
+    // The object pixels are assigned the distances to the background.
+    Transform(mask, false, sqrDistance, nearest);
+
+    if (isSigned)
+    {
+        // The background pixels are assigned the negated distances to the
+        // object.
+        mOtherSqrDistance.resize(numPixels);
+        mOtherNearest.resize(numPixels);
+        Transform(mask, true, mOtherSqrDistance.data(), mOtherNearest.data());
+        Execute(numPixels, [this, mask, sqrDistance, nearest](unsigned int, int imin, int imax)
+        {
+            for (int i = imin; i < imax; ++i)
+            {
+                if (mask[i] == 0)
+                {
+                    sqrDistance[i] = -mOtherSqrDistance[i];
+                    nearest[i] = mOtherNearest[i];
+                }
+            }
+        });
+    }
+    return true;
+}
+
+void DistanceTransform::Transform(int const* mask, bool featureValue,
+    int* sqrDistance, int* nearest)
+{
+    int const numPixels = mDim[0] * mDim[1] * mDim[2];
+    Execute(numPixels, [mask, featureValue, sqrDistance, nearest](unsigned int, int imin, int imax)
+    {
+        int const infinity = std::numeric_limits<int>::max();
+        for (int i = imin; i < imax; ++i)
+        {
+            if ((mask[i] != 0) == featureValue)
+            {
+                sqrDistance[i] = 0;
+                nearest[i] = i;
+            }
+            else
+            {
+                sqrDistance[i] = infinity;
+                nearest[i] = -1;
+            }
+        }
+    });
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (axis == 0 || mDim[axis] > 1)
+        {
+            TransformLines(axis, sqrDistance, nearest);
+        }
+    }
+}
+
+void DistanceTransform::TransformLines(int axis, int* sqrDistance,
+    int* nearest)
+{
+    int const n = mDim[axis];
+    for (auto& scratch : mScratch)
+    {
+        scratch.f.resize(n);
+        scratch.index.resize(n);
+        scratch.site.resize(n);
+        scratch.start.resize(n);
+    }
+
+    if (axis == 0)
+    {
+        // The lines are the rows, which are contiguous in memory.
+        Execute(mDim[1] * mDim[2], [this, n, sqrDistance, nearest](unsigned int t, int rmin, int rmax)
+        {
+            for (int r = rmin; r < rmax; ++r)
+            {
+                size_t base = static_cast<size_t>(r) * static_cast<size_t>(n);
+                TransformLine(n, 1, sqrDistance + base, nearest + base, mScratch[t]);
+            }
+        });
+        return;
+    }
+
+    // The lines along the y-axis (z-axis) with the same z (y) and with
+    // consecutive x are processed in groups of blockSize lines.  A group is
+    // copied to the scratch arrays so that the strided image memory is
+    // accessed one cache line at a time rather than one pixel at a time.
+    int const blockSize = 16;
+    int const numBlocks0 = (mDim[0] + blockSize - 1) / blockSize;
+    int const numOuter = (axis == 1 ? mDim[2] : mDim[1]);
+    size_t const dim0 = static_cast<size_t>(mDim[0]);
+    size_t const stride = (axis == 1 ? dim0 : dim0 * static_cast<size_t>(mDim[1]));
+    size_t const outerStride = (axis == 1 ? dim0 * static_cast<size_t>(mDim[1]) : dim0);
+    for (auto& scratch : mScratch)
+    {
+        scratch.blockSqrDistance.resize(static_cast<size_t>(n) * blockSize);
+        scratch.blockNearest.resize(static_cast<size_t>(n) * blockSize);
+    }
+
+    Execute(numBlocks0 * numOuter, [this, n, blockSize, numBlocks0, stride, outerStride, sqrDistance, nearest](unsigned int t, int gmin, int gmax)
+    {
+        Scratch& scratch = mScratch[t];
+        int* blockSqrDistance = scratch.blockSqrDistance.data();
+        int* blockNearest = scratch.blockNearest.data();
+        for (int g = gmin; g < gmax; ++g)
+        {
+            int x0 = (g % numBlocks0) * blockSize;
+            int width = std::min(blockSize, mDim[0] - x0);
+            size_t base = static_cast<size_t>(x0) + outerStride * static_cast<size_t>(g / numBlocks0);
+
+            for (int u = 0; u < n; ++u)
+            {
+                size_t i = base + stride * static_cast<size_t>(u);
+                std::copy(sqrDistance + i, sqrDistance + i + width, blockSqrDistance + u * width);
+                std::copy(nearest + i, nearest + i + width, blockNearest + u * width);
+            }
+
+            for (int k = 0; k < width; ++k)
+            {
+                TransformLine(n, static_cast<size_t>(width), blockSqrDistance + k,
+                    blockNearest + k, scratch);
+            }
+
+            for (int u = 0; u < n; ++u)
+            {
+                size_t i = base + stride * static_cast<size_t>(u);
+                std::copy(blockSqrDistance + u * width, blockSqrDistance + (u + 1) * width, sqrDistance + i);
+                std::copy(blockNearest + u * width, blockNearest + (u + 1) * width, nearest + i);
+            }
+        }
+    });
+}
+
+void DistanceTransform::TransformLine(int n, size_t stride, int* sqrDistance,
+    int* nearest, Scratch& scratch)
+{
+    int const infinity = std::numeric_limits<int>::max();
+    int64_t* f = scratch.f.data();
+    int* index = scratch.index.data();
+    int* site = scratch.site.data();
+    int* start = scratch.start.data();
+
+    // Compute the lower envelope of the parabolas (u-v)^2 + f(v) for the
+    // sites v with finite f(v).  Parabola site[q] is the minimum for
+    // start[q] <= u < start[q+1].
+    int q = -1;
+    for (int u = 0; u < n; ++u)
+    {
+        size_t i = stride * static_cast<size_t>(u);
+        if (sqrDistance[i] == infinity)
+        {
+            continue;
+        }
+
+        int64_t fu = static_cast<int64_t>(sqrDistance[i]);
+        f[u] = fu;
+        index[u] = nearest[i];
+        while (q >= 0)
+        {
+            int64_t v = site[q], w = start[q];
+            if ((w - v) * (w - v) + f[v] > (w - u) * (w - u) + fu)
+            {
+                --q;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (q < 0)
+        {
+            q = 0;
+            site[0] = u;
+            start[0] = 0;
+        }
+        else
+        {
+            // The parabola of site v < u is the minimum for all
+            // w <= (u^2 - v^2 + f(u) - f(v)) / (2*(u - v)).
+            int64_t v = site[q];
+            int64_t numer = static_cast<int64_t>(u) * u - v * v + fu - f[v];
+            int64_t denom = 2 * (u - v);
+            int64_t sep = (numer >= 0 ? numer / denom : -((denom - 1 - numer) / denom));
+            if (sep + 1 < n)
+            {
+                ++q;
+                site[q] = u;
+                start[q] = static_cast<int>(sep + 1);
+            }
+        }
+    }
+
+    if (q < 0)
+    {
+        // The line has no sites, so its values remain infinite.
+        return;
+    }
+
+    for (int u = n - 1; u >= 0; --u)
+    {
+        size_t i = stride * static_cast<size_t>(u);
+        int64_t v = site[q];
+        int64_t d = (u - v) * (u - v) + f[v];
+        sqrDistance[i] = static_cast<int>(std::min(d, static_cast<int64_t>(infinity)));
+        nearest[i] = index[v];
+        if (u == start[q])
+        {
+            --q;
+        }
+    }
+}
@@ -3,96 +3,169 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.2 (2019/09/14)
 
 #include <GTEnginePCH.h>
+#include <LowLevel/GteLogger.h>
+#include <LowLevel/GteParallelFor.h>
 #include <Imagics/GteHistogram.h>
-#include <Imagics/GteImage2.h>
 #include <algorithm>
+#include <array>
 using namespace gte;
 
-Histogram::Histogram(int numBuckets, int numSamples, int const* samples, bool noRescaling)
-    :
-    mBuckets(numBuckets),
-    mExcessLess(0),
-    mExcessGreater(0)
+template <typename Real>
+void Histogram::Initialize(int numSamples, Real const* samples)
 {
-    if (numBuckets <= 0 || numSamples <= 0 || !samples)
+    // Compute the extremes.  Each thread computes the extremes of numLanes
+    // interleaved subsequences, which the compiler vectorizes.
+    std::vector<std::array<Real, 2>> extremes(mNumThreads, { samples[0], samples[0] });
+    ParallelFor(mNumThreads, numSamples, [samples, &extremes](unsigned int t, int imin, int imax)
+    {
+        int const numLanes = 16;
+        std::array<Real, numLanes> minLane, maxLane;
+        minLane.fill(samples[imin]);
+        maxLane.fill(samples[imin]);
+        int i = imin;
+        for (/**/; i + numLanes <= imax; i += numLanes)
+        {
+            Real const* lane = samples + i;
+            for (int j = 0; j < numLanes; ++j)
+            {
+                Real value = lane[j];
+                minLane[j] = (value < minLane[j] ? value : minLane[j]);
+                maxLane[j] = (maxLane[j] < value ? value : maxLane[j]);
+            }
+        }
+        Real minValue = *std::min_element(minLane.begin(), minLane.end());
+        Real maxValue = *std::max_element(maxLane.begin(), maxLane.end());
+        for (/**/; i < imax; ++i)
+        {
+            minValue = std::min(minValue, samples[i]);
+            maxValue = std::max(maxValue, samples[i]);
+        }
+        extremes[t] = { minValue, maxValue };
+    });
+
+    Real minValue = extremes[0][0], maxValue = extremes[0][1];
+    for (auto const& e : extremes)
+    {
+        minValue = std::min(minValue, e[0]);
+        maxValue = std::max(maxValue, e[1]);
+    }
+
+    // Map to the buckets.  When the image is constant, all the samples are
+    // in bucket 0.
+    mMinValue = static_cast<double>(minValue);
+    mMaxValue = static_cast<double>(maxValue);
+    if (minValue < maxValue)
+    {
+        double numer = static_cast<double>(mBuckets.size() - 1);
+        double denom = static_cast<double>(maxValue) - static_cast<double>(minValue);
+        mMultiplier = numer / denom;
+    }
+    Count(numSamples, samples, 1);
+}
+
+template <typename Real>
+void Histogram::Count(int numSamples, Real const* samples, int sign)
+{
+    if (numSamples <= 0 || !samples)
     {
-        LogError("Invalid inputs.");
         return;
     }
 
-    std::fill(mBuckets.begin(), mBuckets.end(), 0);
+    // Each thread has numCopies subhistograms of numBuckets+2 elements.
+    // Element 0 counts the samples smaller than the buckets and element
+    // numBuckets+1 counts the larger samples (and NaNs).  Sample i of a
+    // block is counted in subhistogram i % numCopies.  The sample is
+    // compared to the window before the bucket index is clamped, so a
+    // sample larger than mMaxValue is excess even when it maps into the
+    // last bucket.
+    int const numBuckets = static_cast<int>(mBuckets.size());
+    size_t const size = static_cast<size_t>(numBuckets) + 2;
+    int const numCopies = 4, blockSize = 256;
+    double const minValue = mMinValue, maxValue = mMaxValue;
+    double const multiplier = mMultiplier;
+    double const maxIndex = static_cast<double>(numBuckets - 1);
 
-    int i, value;
+    auto getIndex = [minValue, maxValue, multiplier, maxIndex, numBuckets](Real sample)
+    {
+        double value = static_cast<double>(sample);
+        double u = std::max(0.0, std::min(maxIndex, (value - minValue) * multiplier));
+        return (value < minValue ? 0 :
+            (value <= maxValue ? 1 + static_cast<int>(u) : numBuckets + 1));
+    };
 
-    if (noRescaling)
+    std::vector<std::vector<int>> counts(mNumThreads);
+    ParallelFor(mNumThreads, numSamples, [&](unsigned int t, int imin, int imax)
     {
-        // Map to the buckets, also counting out-of-range pixels.
-        for (i = 0; i < numSamples; ++i)
+        std::vector<int>& count = counts[t];
+        count.assign(numCopies * size, 0);
+        std::array<int, blockSize> index;
+        for (int i0 = imin; i0 < imax; i0 += blockSize)
         {
-            value = samples[i];
-            if (0 <= value)
+            int const numBlock = std::min(blockSize, imax - i0);
+            Real const* block = samples + i0;
+            if (numBlock == blockSize)
             {
-                if (value < numBuckets)
+                // The loop has a constant number of iterations, so the
+                // compiler vectorizes it.
+                for (int i = 0; i < blockSize; ++i)
                 {
-                    ++mBuckets[value];
-                }
-                else
-                {
-                    ++mExcessGreater;
+                    index[i] = getIndex(block[i]);
                 }
             }
             else
             {
-                ++mExcessLess;
+                for (int i = 0; i < numBlock; ++i)
+                {
+                    index[i] = getIndex(block[i]);
+                }
             }
-        }
-    }
-    else
-    {
-        // Compute the extremes.
-        int minValue = samples[0], maxValue = minValue;
-        for (i = 1; i < numSamples; ++i)
-        {
-            value = samples[i];
-            if (value < minValue)
+
+            int i = 0;
+            for (/**/; i + numCopies <= numBlock; i += numCopies)
             {
-                minValue = value;
+                ++count[index[i]];
+                ++count[size + index[i + 1]];
+                ++count[2 * size + index[i + 2]];
+                ++count[3 * size + index[i + 3]];
             }
-            else if (value > maxValue)
+            for (/**/; i < numBlock; ++i)
             {
-                maxValue = value;
+                ++count[index[i]];
             }
         }
+    });
 
-        // Map to the buckets.
-        if (minValue < maxValue)
+    for (auto const& count : counts)
+    {
+        if (count.size() > 0)
         {
-            // The image is not constant.
-            double numer = static_cast<double>(numBuckets - 1);
-            double denom = static_cast<double>(maxValue - minValue);
-            double mult = numer / denom;
-            for (i = 0; i < numSamples; ++i)
+            for (int c = 0; c < numCopies; ++c)
             {
-                int index = static_cast<int>(mult * static_cast<double>(samples[i] - minValue));
-                ++mBuckets[index];
+                int const* source = &count[c * size];
+                mExcessLess += sign * source[0];
+                for (int b = 0; b < numBuckets; ++b)
+                {
+                    mBuckets[b] += sign * source[b + 1];
+                }
+                mExcessGreater += sign * source[numBuckets + 1];
             }
         }
-        else
-        {
-            // The image is constant.
-            mBuckets[0] = numSamples;
-        }
     }
 }
 
-Histogram::Histogram(int numBuckets, int numSamples, float const* samples)
+Histogram::Histogram(int numBuckets, int numSamples, int const* samples, bool noRescaling,
+    unsigned int numThreads)
     :
     mBuckets(numBuckets),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue(static_cast<double>(numBuckets - 1)),
+    mMultiplier(1.0),
+    mNumThreads(numThreads > 0 ? numThreads : 1)
 {
     if (numBuckets <= 0 || numSamples <= 0 || !samples)
     {
@@ -100,48 +173,27 @@ Histogram::Histogram(int numBuckets, int numSamples, float const* samples)
         return;
     }
 
-    std::fill(mBuckets.begin(), mBuckets.end(), 0);
-
-    // Compute the extremes.
-    float minValue = samples[0], maxValue = minValue;
-    for (int i = 1; i < numSamples; ++i)
-    {
-        float value = samples[i];
-        if (value < minValue)
-        {
-            minValue = value;
-        }
-        else if (value > maxValue)
-        {
-            maxValue = value;
-        }
-    }
-
-    // Map to the buckets.
-    if (minValue < maxValue)
+    if (noRescaling)
     {
-        // The image is not constant.
-        double numer = static_cast<double>(numBuckets - 1);
-        double denom = static_cast<double>(maxValue - minValue);
-        double mult = numer / denom;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            int index = static_cast<int>(mult * static_cast<double>(samples[i] - minValue));
-            ++mBuckets[index];
-        }
+        // Map to the buckets, also counting out-of-range pixels.
+        Count(numSamples, samples, 1);
     }
     else
     {
-        // The image is constant.
-        mBuckets[0] = numSamples;
+        Initialize(numSamples, samples);
     }
 }
 
-Histogram::Histogram(int numBuckets, int numSamples, double const* samples)
+Histogram::Histogram(int numBuckets, int numSamples, float const* samples,
+    unsigned int numThreads)
     :
     mBuckets(numBuckets),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue(static_cast<double>(numBuckets - 1)),
+    mMultiplier(1.0),
+    mNumThreads(numThreads > 0 ? numThreads : 1)
 {
     if (numBuckets <= 0 || numSamples <= 0 || !samples)
     {
@@ -149,56 +201,64 @@ Histogram::Histogram(int numBuckets, int numSamples, double const* samples)
         return;
     }
 
-    std::fill(mBuckets.begin(), mBuckets.end(), 0);
+    Initialize(numSamples, samples);
+}
 
-    // Compute the extremes.
-    double minValue = samples[0], maxValue = minValue;
-    for (int i = 1; i < numSamples; ++i)
+Histogram::Histogram(int numBuckets, int numSamples, double const* samples,
+    unsigned int numThreads)
+    :
+    mBuckets(numBuckets),
+    mExcessLess(0),
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue(static_cast<double>(numBuckets - 1)),
+    mMultiplier(1.0),
+    mNumThreads(numThreads > 0 ? numThreads : 1)
+{
+    if (numBuckets <= 0 || numSamples <= 0 || !samples)
     {
-        double value = samples[i];
-        if (value < minValue)
-        {
-            minValue = value;
-        }
-        else if (value > maxValue)
-        {
-            maxValue = value;
-        }
+        LogError("Invalid inputs.");
+        return;
     }
 
-    // Map to the buckets.
-    if (minValue < maxValue)
-    {
-        // The image is not constant.
-        double numer = static_cast<double>(numBuckets - 1);
-        double denom = maxValue - minValue;
-        double mult = numer/denom;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            int index = static_cast<int>(mult * (samples[i] - minValue));
-            ++mBuckets[index];
-        }
-    }
-    else
+    Initialize(numSamples, samples);
+}
+
+Histogram::Histogram(int numBuckets, double minValue, double maxValue,
+    unsigned int numThreads)
+    :
+    mBuckets(numBuckets),
+    mExcessLess(0),
+    mExcessGreater(0),
+    mMinValue(minValue),
+    mMaxValue(maxValue),
+    mMultiplier(1.0),
+    mNumThreads(numThreads > 0 ? numThreads : 1)
+{
+    if (numBuckets <= 0 || !(minValue < maxValue))
     {
-        // The image is constant.
-        mBuckets[0] = numSamples;
+        LogError("Invalid inputs.");
+        return;
     }
+
+    mMultiplier = static_cast<double>(numBuckets - 1) / (maxValue - minValue);
 }
 
 Histogram::Histogram(int numBuckets)
     :
     mBuckets(numBuckets),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue(static_cast<double>(numBuckets - 1)),
+    mMultiplier(1.0),
+    mNumThreads(1)
 {
     if (numBuckets <= 0)
     {
         LogError("Invalid inputs.");
         return;
     }
-
-    std::fill(mBuckets.begin(), mBuckets.end(), 0);
 }
 
 void Histogram::InsertCheck(int value)
@@ -220,6 +280,36 @@ void Histogram::InsertCheck(int value)
     }
 }
 
+void Histogram::Insert(int numSamples, int const* samples)
+{
+    Count(numSamples, samples, 1);
+}
+
+void Histogram::Insert(int numSamples, float const* samples)
+{
+    Count(numSamples, samples, 1);
+}
+
+void Histogram::Insert(int numSamples, double const* samples)
+{
+    Count(numSamples, samples, 1);
+}
+
+void Histogram::Remove(int numSamples, int const* samples)
+{
+    Count(numSamples, samples, -1);
+}
+
+void Histogram::Remove(int numSamples, float const* samples)
+{
+    Count(numSamples, samples, -1);
+}
+
+void Histogram::Remove(int numSamples, double const* samples)
+{
+    Count(numSamples, samples, -1);
+}
+
 int Histogram::GetLowerTail(double tailAmount)
 {
     int const numBuckets = static_cast<int>(mBuckets.size());
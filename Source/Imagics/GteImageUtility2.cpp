@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.1 (2018/10/05)
+// File Version: 3.0.5 (2019/09/10)
 
 #include <GTEnginePCH.h>
 #include <Imagics/GteImageUtility2.h>
@@ -12,177 +12,210 @@
 using namespace gte;
 
 void ImageUtility2::GetComponents4(Image2<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
 {
-    std::array<int, 4> neighbors;
-    image.GetNeighborhood(neighbors);
-    GetComponents(4, &neighbors[0], image, components);
+    GetComponents(4, image, components, numThreads);
+}
+
+int ImageUtility2::GetComponents4(Image2<int> const& image, Image2<int>& labels,
+    std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
+{
+    return GetComponents(4, image, labels, components, numThreads);
 }
 
 void ImageUtility2::GetComponents8(Image2<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
 {
-    std::array<int, 8> neighbors;
-    image.GetNeighborhood(neighbors);
-    GetComponents(8, &neighbors[0], image, components);
+    GetComponents(8, image, components, numThreads);
 }
 
-void ImageUtility2::Dilate4(Image2<int> const& input, Image2<int>& output)
+int ImageUtility2::GetComponents8(Image2<int> const& image, Image2<int>& labels,
+    std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
+{
+    return GetComponents(8, image, labels, components, numThreads);
+}
+
+void ImageUtility2::Dilate4(Image2<int> const& input, Image2<int>& output,
+    unsigned int numThreads)
 {
     std::array<std::array<int, 2>, 4> neighbors;
     input.GetNeighborhood(neighbors);
-    Dilate(input, 4, &neighbors[0], output);
+    Dilate(input, 4, &neighbors[0], output, numThreads);
 }
 
-void ImageUtility2::Dilate8(Image2<int> const& input, Image2<int>& output)
+void ImageUtility2::Dilate8(Image2<int> const& input, Image2<int>& output,
+    unsigned int numThreads)
 {
     std::array<std::array<int, 2>, 8> neighbors;
     input.GetNeighborhood(neighbors);
-    Dilate(input, 8, &neighbors[0], output);
+    Dilate(input, 8, &neighbors[0], output, numThreads);
 }
 
 void ImageUtility2::Dilate(Image2<int> const& input, int numNeighbors,
-    std::array<int, 2> const* neighbors, Image2<int>& output)
+    std::array<int, 2> const* neighbors, Image2<int>& output,
+    unsigned int numThreads)
 {
     // If the assertion is triggered, the function will run but the output
     // will not be correct.
     LogAssert(&output != &input, "Input and output must be different.");
 
-    output = input;
-
     // If the pixel at (x,y) is 1, then the pixels at (x+dx,y+dy) are set to 1
-    // where (dx,dy) is in the 'neighbors' array.  Boundary testing is used to
-    // avoid accessing out-of-range pixels.
-    int const dim0 = input.GetDimension(0);
-    int const dim1 = input.GetDimension(1);
-    for (int y = 0; y < dim1; ++y)
+    // where (dx,dy) is in the 'neighbors' array.  Pixels outside the image
+    // are ignored.
+    std::vector<std::array<int, 3>> offsets(numNeighbors);
+    for (int j = 0; j < numNeighbors; ++j)
     {
-        for (int x = 0; x < dim0; ++x)
-        {
-            if (input(x, y) == 1)
-            {
-                for (int j = 0; j < numNeighbors; ++j)
-                {
-                    int xNbr = x + neighbors[j][0];
-                    int yNbr = y + neighbors[j][1];
-                    if (0 <= xNbr && xNbr < dim0 && 0 <= yNbr && yNbr < dim1)
-                    {
-                        output(xNbr, yNbr) = 1;
-                    }
-                }
-            }
-        }
+        offsets[j] = { neighbors[j][0], neighbors[j][1], 0 };
     }
+
+    BinaryMorphology morphology(numThreads);
+    output.Reconstruct(input.GetDimension(0), input.GetDimension(1));
+    morphology.Apply(input.GetDimension(0), input.GetDimension(1), 1,
+        input.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
+        {
+            morphology.Dilate(packedInput, numNeighbors, offsets.data(),
+                packedOutput);
+        },
+        output.GetPixels().data());
+}
+
+void ImageUtility2::DilateBox(Image2<int> const& input,
+    std::array<int, 2> const& boxMin, std::array<int, 2> const& boxMax,
+    Image2<int>& output, unsigned int numThreads)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+
+    BinaryMorphology morphology(numThreads);
+    output.Reconstruct(input.GetDimension(0), input.GetDimension(1));
+    morphology.Apply(input.GetDimension(0), input.GetDimension(1), 1,
+        input.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
+        {
+            morphology.Dilate(packedInput, { boxMin[0], boxMin[1], 0 },
+                { boxMax[0], boxMax[1], 0 }, packedOutput);
+        },
+        output.GetPixels().data());
 }
 
 void ImageUtility2::Erode4(Image2<int> const& input, bool zeroExterior,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     std::array<std::array<int, 2>, 4> neighbors;
     input.GetNeighborhood(neighbors);
-    Erode(input, zeroExterior, 4, &neighbors[0], output);
+    Erode(input, zeroExterior, 4, &neighbors[0], output, numThreads);
 }
 
 void ImageUtility2::Erode8(Image2<int> const& input, bool zeroExterior,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     std::array<std::array<int, 2>, 8> neighbors;
     input.GetNeighborhood(neighbors);
-    Erode(input, zeroExterior, 8, &neighbors[0], output);
+    Erode(input, zeroExterior, 8, &neighbors[0], output, numThreads);
 }
 
 void ImageUtility2::Erode(Image2<int> const& input, bool zeroExterior,
     int numNeighbors, std::array<int, 2> const* neighbors,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     // If the assertion is triggered, the function will run but the output
     // will not be correct.
     LogAssert(&output != &input, "Input and output must be different.");
 
-    output = input;
-
     // If the pixel at (x,y) is 1, it is changed to 0 when at least one
     // neighbor (x+dx,y+dy) is 0, where (dx,dy) is in the 'neighbors'
     // array.
-    int const dim0 = input.GetDimension(0);
-    int const dim1 = input.GetDimension(1);
-    for (int y = 0; y < dim1; ++y)
+    std::vector<std::array<int, 3>> offsets(numNeighbors);
+    for (int j = 0; j < numNeighbors; ++j)
     {
-        for (int x = 0; x < dim0; ++x)
-        {
-            if (input(x, y) == 1)
-            {
-                for (int j = 0; j < numNeighbors; ++j)
-                {
-                    int xNbr = x + neighbors[j][0];
-                    int yNbr = y + neighbors[j][1];
-                    if (0 <= xNbr && xNbr < dim0 && 0 <= yNbr && yNbr < dim1)
-                    {
-                        if (input(xNbr, yNbr) == 0)
-                        {
-                            output(x, y) = 0;
-                            break;
-                        }
-                    }
-                    else if (zeroExterior)
-                    {
-                        output(x, y) = 0;
-                        break;
-                    }
-                }
-            }
-        }
+        offsets[j] = { neighbors[j][0], neighbors[j][1], 0 };
     }
+
+    BinaryMorphology morphology(numThreads);
+    output.Reconstruct(input.GetDimension(0), input.GetDimension(1));
+    morphology.Apply(input.GetDimension(0), input.GetDimension(1), 1,
+        input.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
+        {
+            morphology.Erode(packedInput, zeroExterior, numNeighbors,
+                offsets.data(), packedOutput);
+        },
+        output.GetPixels().data());
+}
+
+void ImageUtility2::ErodeBox(Image2<int> const& input, bool zeroExterior,
+    std::array<int, 2> const& boxMin, std::array<int, 2> const& boxMax,
+    Image2<int>& output, unsigned int numThreads)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+
+    BinaryMorphology morphology(numThreads);
+    output.Reconstruct(input.GetDimension(0), input.GetDimension(1));
+    morphology.Apply(input.GetDimension(0), input.GetDimension(1), 1,
+        input.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
+        {
+            morphology.Erode(packedInput, zeroExterior,
+                { boxMin[0], boxMin[1], 0 }, { boxMax[0], boxMax[1], 0 },
+                packedOutput);
+        },
+        output.GetPixels().data());
 }
 
 void ImageUtility2::Open4(Image2<int> const& input, bool zeroExterior,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     Image2<int> temp(input.GetDimension(0), input.GetDimension(1));
-    Erode4(input, zeroExterior, temp);
-    Dilate4(temp, output);
+    Erode4(input, zeroExterior, temp, numThreads);
+    Dilate4(temp, output, numThreads);
 }
 
 void ImageUtility2::Open8(Image2<int> const& input, bool zeroExterior,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     Image2<int> temp(input.GetDimension(0), input.GetDimension(1));
-    Erode8(input, zeroExterior, temp);
-    Dilate8(temp, output);
+    Erode8(input, zeroExterior, temp, numThreads);
+    Dilate8(temp, output, numThreads);
 }
 
 void ImageUtility2::Open(Image2<int> const& input, bool zeroExterior,
     int numNeighbors, std::array<int, 2> const* neighbors,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     Image2<int> temp(input.GetDimension(0), input.GetDimension(1));
-    Erode(input, zeroExterior, numNeighbors, neighbors, temp);
-    Dilate(temp, numNeighbors, neighbors, output);
+    Erode(input, zeroExterior, numNeighbors, neighbors, temp, numThreads);
+    Dilate(temp, numNeighbors, neighbors, output, numThreads);
 }
 
 void ImageUtility2::Close4(Image2<int> const& input, bool zeroExterior,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     Image2<int> temp(input.GetDimension(0), input.GetDimension(1));
-    Dilate4(input, temp);
-    Erode4(temp, zeroExterior, output);
+    Dilate4(input, temp, numThreads);
+    Erode4(temp, zeroExterior, output, numThreads);
 }
 
 void ImageUtility2::Close8(Image2<int> const& input, bool zeroExterior,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     Image2<int> temp(input.GetDimension(0), input.GetDimension(1));
-    Dilate8(input, temp);
-    Erode8(temp, zeroExterior, output);
+    Dilate8(input, temp, numThreads);
+    Erode8(temp, zeroExterior, output, numThreads);
 }
 
 void ImageUtility2::Close(Image2<int> const& input, bool zeroExterior,
     int numNeighbors, std::array<int, 2> const* neighbors,
-    Image2<int>& output)
+    Image2<int>& output, unsigned int numThreads)
 {
     Image2<int> temp(input.GetDimension(0), input.GetDimension(1));
-    Dilate(input, numNeighbors, neighbors, temp);
-    Erode(temp, zeroExterior, numNeighbors, neighbors, output);
+    Dilate(input, numNeighbors, neighbors, temp, numThreads);
+    Erode(temp, zeroExterior, numNeighbors, neighbors, output, numThreads);
 }
 
 bool ImageUtility2::ExtractBoundary(int x, int y, Image2<int>& image,
@@ -302,249 +335,25 @@ void ImageUtility2::GetL1Distance(Image2<int>& image, int& maxDistance,
 }
 
 void ImageUtility2::GetL2Distance(Image2<int> const& image,
-    float& maxDistance, int& xMax, int& yMax, Image2<float>& transform)
+    float& maxDistance, int& xMax, int& yMax, Image2<float>& transform,
+    unsigned int numThreads)
 {
-    // This program calculates the Euclidean distance transform of a binary
-    // input image.  The adaptive algorithm is guaranteed to give exact
-    // distances for all distances < 100.  Algorithm sent to me by John Gauch.
-    //
-    // From John Gauch at University of Kansas:
-    // The basic idea is similar to a EDT described recently in PAMI by
-    // Laymarie from McGill.  By keeping the dx and dy offset to the nearest
-    // edge (feature) point in the image, we can search to see which dx dy is
-    // closest to a given point by examining a set of neighbors.  The Laymarie
-    // method (and Borgfors) look at a fixed 3x3 or 5x5 neighborhood and call
-    // it a day.  What we did was calculate (painfully) what neighborhoods you
-    // need to look at to guarentee that the exact distance is obtained.  Thus,
-    // you will see in the code, that we L2Check the current distance and
-    // depending on what we have so far, we extend the search region.  Since
-    // our algorithm for L2Checking the exactness of each neighborhood is on
-    // the order N^4, we have only gone to N=100.  In theory, you could make
-    // this large enough to get all distances exact.  We have implemented the
-    // algorithm to get all distances < 100 to be exact. 
     int const dim0 = image.GetDimension(0);
     int const dim1 = image.GetDimension(1);
-    int const dim0m1 = dim0 - 1;
-    int const dim1m1 = dim1 - 1;
-    int x, y, distance;
-
-    // Create and initialize intermediate images.
-    Image2<int> xNear(dim0, dim1);
-    Image2<int> yNear(dim0, dim1);
-    Image2<int> dist(dim0, dim1);
-    for (y = 0; y < dim1; ++y)
-    {
-        for (x = 0; x < dim0; ++x)
-        {
-            if (image(x, y) != 0)
-            {
-                xNear(x, y) = 0;
-                yNear(x, y) = 0;
-                dist(x, y) = std::numeric_limits<int>::max();
-            }
-            else
-            {
-                xNear(x, y) = x;
-                yNear(x, y) = y;
-                dist(x, y) = 0;
-            }
-        }
-    }
-
-    int const K1 = 1;
-    int const K2 = 169;   // 13^2
-    int const K3 = 961;   // 31^2
-    int const K4 = 2401;  // 49^2
-    int const K5 = 5184;  // 72^2
-
-    // Pass in the ++ direction.
-    for (y = 0; y < dim1; ++y)
-    {
-        for (x = 0; x < dim0; ++x)
-        {
-            distance = dist(x, y);
-            if (distance > K1)
-            { 
-                L2Check(x, y, -1,  0, xNear, yNear, dist); 
-                L2Check(x, y, -1, -1, xNear, yNear, dist); 
-                L2Check(x, y,  0, -1, xNear, yNear, dist); 
-            }
-            if (distance > K2)
-            { 
-                L2Check(x, y, -2, -1, xNear, yNear, dist); 
-                L2Check(x, y, -1, -2, xNear, yNear, dist); 
-            }
-            if (distance > K3)
-            { 
-                L2Check(x, y, -3, -1, xNear, yNear, dist); 
-                L2Check(x, y, -3, -2, xNear, yNear, dist); 
-                L2Check(x, y, -2, -3, xNear, yNear, dist); 
-                L2Check(x, y, -1, -3, xNear, yNear, dist); 
-            }
-            if (distance > K4)
-            { 
-                L2Check(x, y, -4, -1, xNear, yNear, dist); 
-                L2Check(x, y, -4, -3, xNear, yNear, dist); 
-                L2Check(x, y, -3, -4, xNear, yNear, dist); 
-                L2Check(x, y, -1, -4, xNear, yNear, dist); 
-            }
-            if (distance > K5)
-            { 
-                L2Check(x, y, -5, -1, xNear, yNear, dist); 
-                L2Check(x, y, -5, -2, xNear, yNear, dist); 
-                L2Check(x, y, -5, -3, xNear, yNear, dist); 
-                L2Check(x, y, -5, -4, xNear, yNear, dist);
-                L2Check(x, y, -4, -5, xNear, yNear, dist); 
-                L2Check(x, y, -2, -5, xNear, yNear, dist); 
-                L2Check(x, y, -3, -5, xNear, yNear, dist); 
-                L2Check(x, y, -1, -5, xNear, yNear, dist); 
-            }
-        }
-    }
-
-    // Pass in -- direction.
-    for (y = dim1m1; y >= 0; --y)
-    {
-        for (x = dim0m1; x >= 0; --x)
-        {
-            distance = dist(x, y);
-            if (distance > K1)
-            { 
-                L2Check(x, y, 1, 0, xNear, yNear, dist); 
-                L2Check(x, y, 1, 1, xNear, yNear, dist); 
-                L2Check(x, y, 0, 1, xNear, yNear, dist); 
-            }
-            if (distance > K2)
-            { 
-                L2Check(x, y, 2, 1, xNear, yNear, dist); 
-                L2Check(x, y, 1, 2, xNear, yNear, dist); 
-            }
-            if (distance > K3)
-            { 
-                L2Check(x, y, 3, 1, xNear, yNear, dist); 
-                L2Check(x, y, 3, 2, xNear, yNear, dist); 
-                L2Check(x, y, 2, 3, xNear, yNear, dist); 
-                L2Check(x, y, 1, 3, xNear, yNear, dist); 
-            }
-            if (distance > K4)
-            { 
-                L2Check(x, y, 4, 1, xNear, yNear, dist); 
-                L2Check(x, y, 4, 3, xNear, yNear, dist); 
-                L2Check(x, y, 3, 4, xNear, yNear, dist); 
-                L2Check(x, y, 1, 4, xNear, yNear, dist); 
-            }
-            if (distance > K5)
-            { 
-                L2Check(x, y, 5, 1, xNear, yNear, dist); 
-                L2Check(x, y, 5, 2, xNear, yNear, dist); 
-                L2Check(x, y, 5, 3, xNear, yNear, dist); 
-                L2Check(x, y, 5, 4, xNear, yNear, dist);
-                L2Check(x, y, 4, 5, xNear, yNear, dist); 
-                L2Check(x, y, 2, 5, xNear, yNear, dist); 
-                L2Check(x, y, 3, 5, xNear, yNear, dist); 
-                L2Check(x, y, 1, 5, xNear, yNear, dist); 
-            }
-        }
-    }
-
-    // Pass in the +- direction.
-    for (y = dim1m1; y >= 0; --y)
-    {
-        for (x = 0; x < dim0; ++x)
-        {
-            distance = dist(x, y);
-            if (distance > K1)
-            { 
-                L2Check(x, y, -1, 0, xNear, yNear, dist); 
-                L2Check(x, y, -1, 1, xNear, yNear, dist); 
-                L2Check(x, y,  0, 1, xNear, yNear, dist); 
-            }
-            if (distance > K2)
-            { 
-                L2Check(x, y, -2, 1, xNear, yNear, dist); 
-                L2Check(x, y, -1, 2, xNear, yNear, dist); 
-            }
-            if (distance > K3)
-            { 
-                L2Check(x, y, -3, 1, xNear, yNear, dist); 
-                L2Check(x, y, -3, 2, xNear, yNear, dist); 
-                L2Check(x, y, -2, 3, xNear, yNear, dist); 
-                L2Check(x, y, -1, 3, xNear, yNear, dist); 
-            }
-            if (distance > K4)
-            { 
-                L2Check(x, y, -4, 1, xNear, yNear, dist); 
-                L2Check(x, y, -4, 3, xNear, yNear, dist); 
-                L2Check(x, y, -3, 4, xNear, yNear, dist); 
-                L2Check(x, y, -1, 4, xNear, yNear, dist); 
-            }
-            if (distance > K5)
-            { 
-                L2Check(x, y, -5, 1, xNear, yNear, dist); 
-                L2Check(x, y, -5, 2, xNear, yNear, dist); 
-                L2Check(x, y, -5, 3, xNear, yNear, dist); 
-                L2Check(x, y, -5, 4, xNear, yNear, dist);
-                L2Check(x, y, -4, 5, xNear, yNear, dist); 
-                L2Check(x, y, -2, 5, xNear, yNear, dist); 
-                L2Check(x, y, -3, 5, xNear, yNear, dist); 
-                L2Check(x, y, -1, 5, xNear, yNear, dist); 
-            }
-        }
-    }
-
-    // Pass in the -+ direction.
-    for (y = 0; y < dim1; ++y)
-    {
-        for (x = dim0m1; x >= 0; --x)
-        {
-            distance = dist(x, y);
-            if (distance > K1)
-            { 
-                L2Check(x, y, 1,  0, xNear, yNear, dist); 
-                L2Check(x, y, 1, -1, xNear, yNear, dist); 
-                L2Check(x, y, 0, -1, xNear, yNear, dist); 
-            }
-            if (distance > K2)
-            { 
-                L2Check(x, y, 2, -1, xNear, yNear, dist); 
-                L2Check(x, y, 1, -2, xNear, yNear, dist); 
-            }
-            if (distance > K3)
-            { 
-                L2Check(x, y, 3, -1, xNear, yNear, dist); 
-                L2Check(x, y, 3, -2, xNear, yNear, dist); 
-                L2Check(x, y, 2, -3, xNear, yNear, dist); 
-                L2Check(x, y, 1, -3, xNear, yNear, dist); 
-            }
-            if (distance > K4)
-            { 
-                L2Check(x, y, 4, -1, xNear, yNear, dist); 
-                L2Check(x, y, 4, -3, xNear, yNear, dist); 
-                L2Check(x, y, 3, -4, xNear, yNear, dist); 
-                L2Check(x, y, 1, -4, xNear, yNear, dist); 
-            }
-            if (distance > K5)
-            { 
-                L2Check(x, y, 5, -1, xNear, yNear, dist); 
-                L2Check(x, y, 5, -2, xNear, yNear, dist); 
-                L2Check(x, y, 5, -3, xNear, yNear, dist); 
-                L2Check(x, y, 5, -4, xNear, yNear, dist);
-                L2Check(x, y, 4, -5, xNear, yNear, dist); 
-                L2Check(x, y, 2, -5, xNear, yNear, dist); 
-                L2Check(x, y, 3, -5, xNear, yNear, dist); 
-                L2Check(x, y, 1, -5, xNear, yNear, dist); 
-            }
-        }
-    }
+    Image2<int> sqrDistance(dim0, dim1);
+    DistanceTransform distance(numThreads);
+    distance.Execute(dim0, dim1, 1, image.GetPixels().data(), false,
+        sqrDistance.GetPixels().data(), nullptr);
 
+    transform.Reconstruct(dim0, dim1);
     xMax = 0;
     yMax = 0;
     maxDistance = 0.0f;
-    for (y = 0; y < dim1; ++y)
+    for (int y = 0; y < dim1; ++y)
     {
-        for (x = 0; x < dim0; ++x)
+        for (int x = 0; x < dim0; ++x)
         {
-            float fdistance = std::sqrt((float)dist(x, y));
+            float fdistance = std::sqrt((float)sqrDistance(x, y));
             if (fdistance > maxDistance)
             {
                 maxDistance = fdistance;
@@ -556,6 +365,19 @@ void ImageUtility2::GetL2Distance(Image2<int> const& image,
     }
 }
 
+void ImageUtility2::GetSquaredL2Distance(Image2<int> const& image,
+    bool isSigned, Image2<int>& sqrDistance, Image2<int>& nearest,
+    unsigned int numThreads)
+{
+    int const dim0 = image.GetDimension(0);
+    int const dim1 = image.GetDimension(1);
+    sqrDistance.Reconstruct(dim0, dim1);
+    nearest.Reconstruct(dim0, dim1);
+    DistanceTransform distance(numThreads);
+    distance.Execute(dim0, dim1, 1, image.GetPixels().data(), isSigned,
+        sqrDistance.GetPixels().data(), nearest.GetPixels().data());
+}
+
 void ImageUtility2::GetSkeleton(Image2<int>& image)
 {
     int const dim0 = image.GetDimension(0);
@@ -922,95 +744,28 @@ void ImageUtility2::DrawEllipse(int xCenter, int yCenter, int xExtent, int yExte
     }
 }
 
-void ImageUtility2::GetComponents(int numNeighbors, int const* delta,
-    Image2<int>& image, std::vector<std::vector<size_t>>& components)
+void ImageUtility2::GetComponents(int connectivity, Image2<int>& image,
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
 {
-    size_t const numPixels = image.GetNumPixels();
-    std::vector<int> numElements(numPixels);
-    std::vector<size_t> vstack(numPixels);
-    size_t i, numComponents = 0;
-    int label = 2;
-    for (i = 0; i < numPixels; ++i)
-    {
-        if (image[i] == 1)
-        {
-            int top = -1;
-            vstack[++top] = i;
-
-            int& count = numElements[numComponents + 1];
-            count = 0;
-            while (top >= 0)
-            {
-                size_t v = vstack[top];
-                image[v] = -1;
-                int j;
-                for (j = 0; j < numNeighbors; ++j)
-                {
-                    size_t adj = v + delta[j];
-                    if (image[adj] == 1)
-                    {
-                        vstack[++top] = adj;
-                        break;
-                    }
-                }
-                if (j == numNeighbors)
-                {
-                    image[v] = label;
-                    ++count;
-                    --top;
-                }
-            }
-
-            ++numComponents;
-            ++label;
-        }
-    }
-
-    if (numComponents > 0)
-    {
-        components.resize(numComponents + 1);
-        for (i = 1; i <= numComponents; ++i)
-        {
-            components[i].resize(numElements[i]);
-            numElements[i] = 0;
-        }
-
-        for (i = 0; i < numPixels; ++i)
-        {
-            int value = image[i];
-            if (value != 0)
-            {
-                // Labels started at 2 to support the depth-first search,
-                // so they need to be decremented for the correct labels.
-                image[i] = --value;
-                components[value][numElements[value]] = i;
-                ++numElements[value];
-            }
-        }
-    }
+    // The labels are written in place.
+    ComponentLabeler labeler(numThreads);
+    int* pixels = image.GetPixels().data();
+    labeler.Execute(image.GetDimension(0), image.GetDimension(1), 1,
+        connectivity, pixels, pixels);
+    labeler.GetComponents(components);
 }
 
-void ImageUtility2::L2Check(int x, int y, int dx, int dy, Image2<int>& xNear,
-    Image2<int>& yNear, Image2<int>& dist)
-{
-    int const dim0 = dist.GetDimension(0);
-    int const dim1 = dist.GetDimension(1);
-    int xp = x + dx, yp = y + dy;
-    if (0 <= xp && xp < dim0 && 0 <= yp && yp < dim1)
-    {
-        if (dist(xp, yp) < dist(x, y))
-        {
-            int dx0 = xNear(xp, yp) - x;
-            int dy0 = yNear(xp, yp) - y;
-            int newDist = dx0*dx0 + dy0*dy0;
-            if (newDist < dist(x, y))
-            {
-                xNear(x, y) = xNear(xp, yp);
-                yNear(x, y) = yNear(xp, yp);
-                dist(x, y) = newDist;
-            }
-        }
-    }
+int ImageUtility2::GetComponents(int connectivity, Image2<int> const& image,
+    Image2<int>& labels, std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
+{
+    labels.Reconstruct(image.GetDimension(0), image.GetDimension(1));
+    ComponentLabeler labeler(numThreads);
+    int numComponents = labeler.Execute(image.GetDimension(0),
+        image.GetDimension(1), 1, connectivity, image.GetPixels().data(),
+        labels.GetPixels().data());
+    labeler.GetComponents(components);
+    return numComponents;
 }
 
 bool ImageUtility2::Interior2(Image2<int>& image, int x, int y)
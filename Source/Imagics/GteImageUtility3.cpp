@@ -3,57 +3,112 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.4 (2019/09/10)
 
 #include <GTEnginePCH.h>
 #include <Imagics/GteImageUtility3.h>
 using namespace gte;
 
 void ImageUtility3::GetComponents6(Image3<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
 {
-    std::array<int, 6> neighbors;
-    image.GetNeighborhood(neighbors);
-    GetComponents(6, &neighbors[0], image, components);
+    GetComponents(6, image, components, numThreads);
+}
+
+int ImageUtility3::GetComponents6(Image3<int> const& image, Image3<int>& labels,
+    std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
+{
+    return GetComponents(6, image, labels, components, numThreads);
 }
 
 void ImageUtility3::GetComponents18(Image3<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
+{
+    GetComponents(18, image, components, numThreads);
+}
+
+int ImageUtility3::GetComponents18(Image3<int> const& image, Image3<int>& labels,
+    std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
 {
-    std::array<int, 18> neighbors;
-    image.GetNeighborhood(neighbors);
-    GetComponents(18, &neighbors[0], image, components);
+    return GetComponents(18, image, labels, components, numThreads);
 }
 
 void ImageUtility3::GetComponents26(Image3<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
+{
+    GetComponents(26, image, components, numThreads);
+}
+
+int ImageUtility3::GetComponents26(Image3<int> const& image, Image3<int>& labels,
+    std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
 {
-    std::array<int, 26> neighbors;
-    image.GetNeighborhood(neighbors);
-    GetComponents(26, &neighbors[0], image, components);
+    return GetComponents(26, image, labels, components, numThreads);
 }
 
-void ImageUtility3::Dilate6(Image3<int> const& inImage, Image3<int>& outImage)
+void ImageUtility3::Dilate6(Image3<int> const& inImage,
+    Image3<int>& outImage, unsigned int numThreads)
 {
     std::array<std::array<int, 3>, 6> neighbors;
     inImage.GetNeighborhood(neighbors);
-    Dilate(6, &neighbors[0], inImage, outImage);
+    Dilate(6, &neighbors[0], inImage, outImage, numThreads);
 }
 
 void ImageUtility3::Dilate18(Image3<int> const& inImage,
-    Image3<int>& outImage)
+    Image3<int>& outImage, unsigned int numThreads)
 {
     std::array<std::array<int, 3>, 18> neighbors;
     inImage.GetNeighborhood(neighbors);
-    Dilate(18, &neighbors[0], inImage, outImage);
+    Dilate(18, &neighbors[0], inImage, outImage, numThreads);
 }
 
 void ImageUtility3::Dilate26(Image3<int> const& inImage,
-    Image3<int>& outImage)
+    Image3<int>& outImage, unsigned int numThreads)
 {
     std::array<std::array<int, 3>, 26> neighbors;
     inImage.GetNeighborhood(neighbors);
-    Dilate(26, &neighbors[0], inImage, outImage);
+    Dilate(26, &neighbors[0], inImage, outImage, numThreads);
+}
+
+void ImageUtility3::DilateBox(Image3<int> const& inImage,
+    std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+    Image3<int>& outImage, unsigned int numThreads)
+{
+    LogAssert(&outImage != &inImage, "Input and output must be different.");
+
+    BinaryMorphology morphology(numThreads);
+    outImage.Reconstruct(inImage.GetDimension(0), inImage.GetDimension(1),
+        inImage.GetDimension(2));
+    morphology.Apply(inImage.GetDimension(0), inImage.GetDimension(1),
+        inImage.GetDimension(2), inImage.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
+        {
+            morphology.Dilate(packedInput, boxMin, boxMax, packedOutput);
+        },
+        outImage.GetPixels().data());
+}
+
+void ImageUtility3::ErodeBox(Image3<int> const& inImage, bool zeroExterior,
+    std::array<int, 3> const& boxMin, std::array<int, 3> const& boxMax,
+    Image3<int>& outImage, unsigned int numThreads)
+{
+    LogAssert(&outImage != &inImage, "Input and output must be different.");
+
+    BinaryMorphology morphology(numThreads);
+    outImage.Reconstruct(inImage.GetDimension(0), inImage.GetDimension(1),
+        inImage.GetDimension(2));
+    morphology.Apply(inImage.GetDimension(0), inImage.GetDimension(1),
+        inImage.GetDimension(2), inImage.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
+        {
+            morphology.Erode(packedInput, zeroExterior, boxMin, boxMax,
+                packedOutput);
+        },
+        outImage.GetPixels().data());
 }
 
 void ImageUtility3::ComputeCDConvex(Image3<int>& image)
@@ -172,6 +227,20 @@ void ImageUtility3::ComputeCDConvex(Image3<int>& image)
     }
 }
 
+void ImageUtility3::GetSquaredL2Distance(Image3<int> const& image,
+    bool isSigned, Image3<int>& sqrDistance, Image3<int>& nearest,
+    unsigned int numThreads)
+{
+    int const dim0 = image.GetDimension(0);
+    int const dim1 = image.GetDimension(1);
+    int const dim2 = image.GetDimension(2);
+    sqrDistance.Reconstruct(dim0, dim1, dim2);
+    nearest.Reconstruct(dim0, dim1, dim2);
+    DistanceTransform distance(numThreads);
+    distance.Execute(dim0, dim1, dim2, image.GetPixels().data(), isSigned,
+        sqrDistance.GetPixels().data(), nearest.GetPixels().data());
+}
+
 void ImageUtility3::DrawLine(int x0, int y0, int z0, int x1, int y1, int z1,
     std::function<void(int, int, int)> const& callback)
 {
@@ -296,104 +365,52 @@ void ImageUtility3::DrawLine(int x0, int y0, int z0, int x1, int y1, int z1,
 }
 
 void ImageUtility3::Dilate(int numNeighbors, std::array<int, 3> const* delta,
-    Image3<int> const& inImage, Image3<int>& outImage)
+    Image3<int> const& inImage, Image3<int>& outImage, unsigned int numThreads)
 {
-    int const bound0M1 = inImage.GetDimension(0) - 1;
-    int const bound1M1 = inImage.GetDimension(1) - 1;
-    int const bound2M1 = inImage.GetDimension(2) - 1;
-    for (int i2 = 1; i2 < bound2M1; ++i2)
+    // The voxel at (x,y,z) is set to 1 when it or one of its neighbors
+    // (x+dx,y+dy,z+dz) is 1, where (dx,dy,dz) is in the 'delta' array.
+    // BinaryMorphology uses the offsets d for which the voxel at (x,y,z) is
+    // set to 1 when (x-dx,y-dy,z-dz) is 1, so the offsets are reflected.
+    std::vector<std::array<int, 3>> offsets(numNeighbors);
+    for (int j = 0; j < numNeighbors; ++j)
     {
-        for (int i1 = 1; i1 < bound1M1; ++i1)
-        {
-            for (int i0 = 1; i0 < bound0M1; ++i0)
-            {
-                if (inImage(i0, i1, i2) == 0)
-                {
-                    for (int n = 0; n < numNeighbors; ++n)
-                    {
-                        int d0 = delta[n][0];
-                        int d1 = delta[n][1];
-                        int d2 = delta[n][2];
-                        if (inImage(i0 + d0, i1 + d1, i2 + d2) == 1)
-                        {
-                            outImage(i0, i1, i2) = 1;
-                            break;
-                        }
-                    }
-                }
-                else
-                {
-                    outImage(i0, i1, i2) = 1;
-                }
-            }
-        }
+        offsets[j] = { -delta[j][0], -delta[j][1], -delta[j][2] };
     }
-}
 
-void ImageUtility3::GetComponents(int numNeighbors, int const* delta,
-    Image3<int>& image, std::vector<std::vector<size_t>>& components)
-{
-    size_t const numVoxels = image.GetNumPixels();
-    std::vector<int> numElements(numVoxels);
-    std::vector<size_t> vstack(numVoxels);
-    size_t i, numComponents = 0;
-    int label = 2;
-    for (i = 0; i < numVoxels; ++i)
-    {
-        if (image[i] == 1)
+    BinaryMorphology morphology(numThreads);
+    outImage.Reconstruct(inImage.GetDimension(0), inImage.GetDimension(1),
+        inImage.GetDimension(2));
+    morphology.Apply(inImage.GetDimension(0), inImage.GetDimension(1),
+        inImage.GetDimension(2), inImage.GetPixels().data(),
+        [&](BinaryMorphology::PackedImage const& packedInput,
+            BinaryMorphology::PackedImage& packedOutput)
         {
-            int top = -1;
-            vstack[++top] = i;
-
-            int& count = numElements[numComponents + 1];
-            count = 0;
-            while (top >= 0)
-            {
-                size_t v = vstack[top];
-                image[v] = -1;
-                int j;
-                for (j = 0; j < numNeighbors; ++j)
-                {
-                    size_t adj = v + delta[j];
-                    if (image[adj] == 1)
-                    {
-                        vstack[++top] = adj;
-                        break;
-                    }
-                }
-                if (j == numNeighbors)
-                {
-                    image[v] = label;
-                    ++count;
-                    --top;
-                }
-            }
-
-            ++numComponents;
-            ++label;
-        }
-    }
+            morphology.Dilate(packedInput, numNeighbors, offsets.data(),
+                packedOutput);
+        },
+        outImage.GetPixels().data());
+}
 
-    if (numComponents > 0)
-    {
-        components.resize(numComponents + 1);
-        for (i = 1; i <= numComponents; ++i)
-        {
-            components[i].resize(numElements[i]);
-            numElements[i] = 0;
-        }
+void ImageUtility3::GetComponents(int connectivity, Image3<int>& image,
+    std::vector<std::vector<size_t>>& components, unsigned int numThreads)
+{
+    // The labels are written in place.
+    ComponentLabeler labeler(numThreads);
+    int* pixels = image.GetPixels().data();
+    labeler.Execute(image.GetDimension(0), image.GetDimension(1), image.GetDimension(2),
+        connectivity, pixels, pixels);
+    labeler.GetComponents(components);
+}
 
-        for (i = 0; i < numVoxels; ++i)
-        {
-            int value = image[i];
-            if (value != 0)
-            {
-                // Labels started at 2 to support the depth-first search,
-                // so they need to be decremented for the correct labels.
-                image[i] = --value;
-                components[value][numElements[value]] = i;
-                ++numElements[value];
-            }
-        }
-    }
+int ImageUtility3::GetComponents(int connectivity, Image3<int> const& image,
+    Image3<int>& labels, std::vector<ComponentLabeler::Component>& components,
+    unsigned int numThreads)
+{
+    labels.Reconstruct(image.GetDimension(0), image.GetDimension(1), image.GetDimension(2));
+    ComponentLabeler labeler(numThreads);
+    int numComponents = labeler.Execute(image.GetDimension(0),
+        image.GetDimension(1), image.GetDimension(2), connectivity, image.GetPixels().data(),
+        labels.GetPixels().data());
+    labeler.GetComponents(components);
+    return numComponents;
 }
@@ -0,0 +1,131 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.1 (2019/09/14)
+
+#include <GTEnginePCH.h>
+#include <LowLevel/GteLogger.h>
+#include <LowLevel/GteParallelFor.h>
+#include <Imagics/GteJointHistogram.h>
+#include <algorithm>
+using namespace gte;
+
+template <typename Real>
+void JointHistogram::Count(int numSamples, Real const* samples0,
+    Real const* samples1, int sign)
+{
+    if (numSamples <= 0 || !samples0 || !samples1)
+    {
+        return;
+    }
+
+    // Each thread has a subhistogram with numBuckets[0]*numBuckets[1]+1
+    // elements; the last element counts the pairs outside the windows.
+    // The values are compared to the windows before the bucket indices are
+    // clamped.
+    int const numBuckets = static_cast<int>(mBuckets.size());
+    int const blockSize = 256;
+    int const bound0 = mNumBuckets[0], bound1 = mNumBuckets[1];
+    double const min0 = mMinValue[0], min1 = mMinValue[1];
+    double const max0 = mMaxValue[0], max1 = mMaxValue[1];
+    double const mult0 = mMultiplier[0], mult1 = mMultiplier[1];
+    double const maxIndex0 = static_cast<double>(bound0 - 1);
+    double const maxIndex1 = static_cast<double>(bound1 - 1);
+
+    std::vector<std::vector<int>> counts(mNumThreads);
+    ParallelFor(mNumThreads, numSamples, [&](unsigned int t, int imin, int imax)
+    {
+        std::vector<int>& count = counts[t];
+        count.assign(static_cast<size_t>(numBuckets) + 1, 0);
+        std::array<int, blockSize> index;
+        for (int i0 = imin; i0 < imax; i0 += blockSize)
+        {
+            int const numBlock = std::min(blockSize, imax - i0);
+            Real const* block0 = samples0 + i0;
+            Real const* block1 = samples1 + i0;
+            for (int i = 0; i < numBlock; ++i)
+            {
+                double value0 = static_cast<double>(block0[i]);
+                double value1 = static_cast<double>(block1[i]);
+                double u0 = std::max(0.0, std::min(maxIndex0, (value0 - min0) * mult0));
+                double u1 = std::max(0.0, std::min(maxIndex1, (value1 - min1) * mult1));
+                int k0 = static_cast<int>(u0), k1 = static_cast<int>(u1);
+                bool inside = (min0 <= value0 && value0 <= max0 && min1 <= value1 && value1 <= max1);
+                index[i] = (inside ? k0 + bound0 * k1 : numBuckets);
+            }
+
+            for (int i = 0; i < numBlock; ++i)
+            {
+                ++count[index[i]];
+            }
+        }
+    });
+
+    for (auto const& count : counts)
+    {
+        if (count.size() > 0)
+        {
+            for (int b = 0; b < numBuckets; ++b)
+            {
+                mBuckets[b] += sign * count[b];
+            }
+            mExcess += sign * count[numBuckets];
+        }
+    }
+}
+
+JointHistogram::JointHistogram(std::array<int, 2> const& numBuckets,
+    std::array<double, 2> const& minValue,
+    std::array<double, 2> const& maxValue, unsigned int numThreads)
+    :
+    mNumBuckets(numBuckets),
+    mExcess(0),
+    mMinValue(minValue),
+    mMaxValue(maxValue),
+    mMultiplier{ 1.0, 1.0 },
+    mNumThreads(numThreads > 0 ? numThreads : 1)
+{
+    for (int j = 0; j < 2; ++j)
+    {
+        if (numBuckets[j] <= 0 || !(minValue[j] < maxValue[j]))
+        {
+            LogError("Invalid inputs.");
+            mNumBuckets = { 0, 0 };
+            return;
+        }
+        mMultiplier[j] = static_cast<double>(numBuckets[j] - 1) / (maxValue[j] - minValue[j]);
+    }
+    mBuckets.resize(static_cast<size_t>(numBuckets[0]) * static_cast<size_t>(numBuckets[1]));
+}
+
+void JointHistogram::Insert(int numSamples, int const* samples0, int const* samples1)
+{
+    Count(numSamples, samples0, samples1, 1);
+}
+
+void JointHistogram::Insert(int numSamples, float const* samples0, float const* samples1)
+{
+    Count(numSamples, samples0, samples1, 1);
+}
+
+void JointHistogram::Insert(int numSamples, double const* samples0, double const* samples1)
+{
+    Count(numSamples, samples0, samples1, 1);
+}
+
+void JointHistogram::Remove(int numSamples, int const* samples0, int const* samples1)
+{
+    Count(numSamples, samples0, samples1, -1);
+}
+
+void JointHistogram::Remove(int numSamples, float const* samples0, float const* samples1)
+{
+    Count(numSamples, samples0, samples1, -1);
+}
+
+void JointHistogram::Remove(int numSamples, double const* samples0, double const* samples1)
+{
+    Count(numSamples, samples0, samples1, -1);
+}
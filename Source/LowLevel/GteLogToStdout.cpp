@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/16)
 
 #include <GTEnginePCH.h>
 #include <LowLevel/GteLogToStdout.h>
@@ -17,8 +17,13 @@ LogToStdout::LogToStdout(int flags)
 {
 }
 
+void LogToStdout::Flush()
+{
+    std::cout << std::flush;
+}
+
 void LogToStdout::Report(std::string const& message)
 {
-    std::cout << message.c_str() << std::flush;
+    std::cout << message.c_str();
 }
 
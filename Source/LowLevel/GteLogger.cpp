@@ -3,87 +3,519 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 3.0.0 (2016/06/19)
+// File Version: 3.0.1 (2019/09/16)
 
 #include <GTEnginePCH.h>
 #include <LowLevel/GteLogger.h>
+#include <LowLevel/GteConcurrentHashMap.h>
+#include <LowLevel/GteSPSCQueue.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
 using namespace gte;
 
 
+// The writer of asynchronous mode.  Each thread that logs has a buffer,
+// which it finds in a hash map by its thread identifier.  The writer thread
+// drains the buffers continuously while there are messages, and otherwise
+// every 10 milliseconds or when a flush is requested.  A buffer that has
+// not been used for MAX_IDLE_MILLISECONDS is retired and released, so the
+// buffers of threads that have exited do not accumulate; a thread whose
+// buffer was retired gets a new one when it logs again.
+class Logger::Writer
+{
+public:
+    // Construction and destruction.  The destructor stops the thread.
+    ~Writer();
+    Writer();
+
+    // Start or stop the writer thread.  Stop() reports all the queued
+    // messages before it returns.
+    void Start();
+    void Stop();
+
+    // Queue a message of the calling thread.  The return value is 'false'
+    // when the writer thread is not running, in which case the caller must
+    // report the message itself.
+    bool Push(int flag, char const* file, char const* function, int line,
+        std::string const& message);
+
+    // Wait for the writer thread to drain all the buffers.
+    void Flush();
+
+private:
+    enum { NUM_RECORDS = 1024, MAX_IDLE_MILLISECONDS = 1000 };
+
+    struct Record
+    {
+        Record() : flag(0), file(nullptr), function(nullptr), line(0) {}
+        int flag;
+        char const* file;
+        char const* function;
+        int line;
+        std::string message;
+    };
+
+    // The producer sets 'busy' while it pushes and 'used' after a push.
+    // The writer sets 'retired' before it releases the buffer; the stores
+    // and loads of 'busy' and 'retired' are paired as are those of 'busy'
+    // and mRunning.  The time of the last use seen by the writer is
+    // accessed only by the writer thread.
+    struct Buffer
+    {
+        Buffer(std::thread::id inId)
+            :
+            queue(NUM_RECORDS),
+            id(inId),
+            busy(false),
+            used(false),
+            retired(false),
+            lastUsed(std::chrono::steady_clock::now())
+        {
+        }
+
+        SPSCQueue<Record> queue;
+        std::thread::id id;
+        std::atomic<bool> busy, used, retired;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    // Get the buffer of the calling thread, creating it when the thread has
+    // none or its buffer was retired.
+    std::shared_ptr<Buffer> GetBuffer();
+
+    // The thread function.  Drain returns 'true' when it reported
+    // messages, in which case the thread does not wait before the next
+    // pass.  Retire releases the buffers that have been idle too long.
+    void Run();
+    bool Drain(std::vector<std::shared_ptr<Buffer>> const& buffers);
+    void Retire(std::vector<std::shared_ptr<Buffer>> const& buffers);
+
+    std::atomic<bool> mRunning;
+    ConcurrentHashMap<std::thread::id, std::shared_ptr<Buffer>> mBufferMap;
+
+    // The mutex guards the members that follow it.
+    std::mutex mMutex;
+    std::condition_variable mWake, mDrained;
+    std::vector<std::shared_ptr<Buffer>> mBuffers;
+    bool mStopping;
+    uint64_t mNumFlushRequests, mNumFlushesDone;
+
+    std::mutex mStartStopMutex;
+    std::thread mThread;
+};
+
+
 Logger::Logger(char const* file, char const* function, int line,
     std::string const& message)
+    :
+    mFile(file),
+    mFunction(function),
+    mLine(line),
+    mMessage(message)
+{
+}
+
+void Logger::Assertion()
+{
+    ReportNow(Listener::LISTEN_FOR_ASSERTION);
+}
+
+void Logger::Error()
+{
+    ReportNow(Listener::LISTEN_FOR_ERROR);
+}
+
+void Logger::Warning()
+{
+    ReportLater(Listener::LISTEN_FOR_WARNING);
+}
+
+void Logger::Information()
+{
+    ReportLater(Listener::LISTEN_FOR_INFORMATION);
+}
+
+bool Logger::Admit(int flag, char const* file, int line)
+{
+    if ((msFlags.load(std::memory_order_relaxed) & flag) == 0)
+    {
+        return false;
+    }
+
+    int maxPerSecond = msMaxPerSecond.load(std::memory_order_relaxed);
+    if (maxPerSecond <= 0)
+    {
+        return true;
+    }
+
+    uint64_t second = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count()) & 0xFFFFFFFFull;
+
+    uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(file)) * 31 + static_cast<uint64_t>(line);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    std::atomic<uint64_t>& slot = msRateSlots[static_cast<size_t>(h % NUM_RATE_SLOTS)];
+
+    uint64_t current = slot.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint64_t next;
+        if ((current >> 32) != second)
+        {
+            next = (second << 32) | 1;
+        }
+        else if ((current & 0xFFFFFFFFull) < static_cast<uint64_t>(maxPerSecond))
+        {
+            next = current + 1;
+        }
+        else
+        {
+            msNumSuppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (slot.compare_exchange_weak(current, next, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+}
+
+void Logger::SetRateLimit(int maxMessagesPerSecond)
+{
+    msMaxPerSecond.store(maxMessagesPerSecond > 0 ? maxMessagesPerSecond : 0);
+}
+
+int Logger::GetRateLimit()
+{
+    return msMaxPerSecond.load();
+}
+
+uint64_t Logger::GetNumSuppressed()
+{
+    return msNumSuppressed.load();
+}
+
+void Logger::SetAsynchronous(bool asynchronous)
+{
+    if (asynchronous)
+    {
+        GetWriter().Start();
+        msAsynchronous.store(true);
+    }
+    else if (msAsynchronous.load())
+    {
+        msAsynchronous.store(false);
+        GetWriter().Stop();
+    }
+}
+
+bool Logger::IsAsynchronous()
+{
+    return msAsynchronous.load();
+}
+
+void Logger::Flush()
+{
+    if (msAsynchronous.load())
+    {
+        GetWriter().Flush();
+    }
+}
+
+void Logger::Subscribe(Listener* listener)
+{
+    msMutex.lock();
+    msListeners.insert(listener);
+    msFlags.fetch_or(listener->GetFlags());
+    msMutex.unlock();
+}
+
+void Logger::Unsubscribe(Listener* listener)
+{
+    // Report the queued messages while the listener can receive them.
+    Flush();
+
+    msMutex.lock();
+    msListeners.erase(listener);
+    int flags = Listener::LISTEN_FOR_NOTHING;
+    for (auto element : msListeners)
+    {
+        flags |= element->GetFlags();
+    }
+    msFlags.store(flags);
+    msMutex.unlock();
+}
+
+std::string Logger::Format(char const* file, char const* function,
+    int line, std::string const& message)
 {
-    mMessage =
+    return
         "File: " + std::string(file) + "\n" +
         "Func: " + std::string(function) + "\n" +
         "Line: " + std::to_string(line) + "\n" +
         message + "\n\n";
 }
 
-void Logger::Assertion()
+void Logger::Report(int flag, std::string const& message)
 {
-    msMutex.lock();
     for (auto listener : msListeners)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_ASSERTION)
+        if (listener->GetFlags() & flag)
         {
-            listener->Assertion(mMessage);
+            switch (flag)
+            {
+            case Listener::LISTEN_FOR_ASSERTION:
+                listener->Assertion(message);
+                break;
+            case Listener::LISTEN_FOR_ERROR:
+                listener->Error(message);
+                break;
+            case Listener::LISTEN_FOR_WARNING:
+                listener->Warning(message);
+                break;
+            default:
+                listener->Information(message);
+                break;
+            }
         }
     }
-    msMutex.unlock();
 }
 
-void Logger::Error()
+void Logger::ReportNow(int flag)
 {
+    // The queued messages are reported first to preserve the order of the
+    // messages of the calling thread.
+    Flush();
+
+    std::string message = Format(mFile, mFunction, mLine, mMessage);
     msMutex.lock();
+    Report(flag, message);
     for (auto listener : msListeners)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_ERROR)
+        if (listener->GetFlags() & flag)
         {
-            listener->Error(mMessage);
+            listener->Flush();
         }
     }
     msMutex.unlock();
 }
 
-void Logger::Warning()
+void Logger::ReportLater(int flag)
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    if (!msAsynchronous.load(std::memory_order_relaxed)
+        || !GetWriter().Push(flag, mFile, mFunction, mLine, mMessage))
+    {
+        ReportNow(flag);
+    }
+}
+
+Logger::Writer& Logger::GetWriter()
+{
+    static Writer writer;
+    return writer;
+}
+
+
+
+// Logger::Writer
+
+Logger::Writer::~Writer()
+{
+    // Messages logged by later static destructors are reported by the
+    // calling thread rather than queued in the destroyed writer.
+    msAsynchronous.store(false);
+    Stop();
+}
+
+Logger::Writer::Writer()
+    :
+    mRunning(false),
+    mStopping(false),
+    mNumFlushRequests(0),
+    mNumFlushesDone(0)
+{
+}
+
+void Logger::Writer::Start()
+{
+    std::lock_guard<std::mutex> startStopLock(mStartStopMutex);
+    if (!mRunning.load())
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_WARNING)
+        mStopping = false;
+        mThread = std::thread([this]() { Run(); });
+        mRunning.store(true);
+    }
+}
+
+void Logger::Writer::Stop()
+{
+    std::lock_guard<std::mutex> startStopLock(mStartStopMutex);
+    if (mRunning.load())
+    {
+        // The store of the running flag and the loads of the busy flags pair
+        // with the store of the busy flag and the load of the running flag
+        // in Push():  either the producer sees that the writer is stopped or
+        // this thread waits for the producer to finish its push.  The writer
+        // thread is told to stop only after the pushes have finished, so its
+        // final pass reports them.
+        mRunning.store(false);
+        std::vector<std::shared_ptr<Buffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            buffers = mBuffers;
+        }
+        for (auto const& buffer : buffers)
         {
-            listener->Warning(mMessage);
+            while (buffer->busy.load())
+            {
+                std::this_thread::yield();
+            }
         }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWake.notify_one();
+        mThread.join();
     }
-    msMutex.unlock();
 }
 
-void Logger::Information()
+bool Logger::Writer::Push(int flag, char const* file, char const* function,
+    int line, std::string const& message)
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    std::shared_ptr<Buffer> buffer = GetBuffer();
+    Record record;
+    record.flag = flag;
+    record.file = file;
+    record.function = function;
+    record.line = line;
+    record.message = message;
+    for (;;)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_INFORMATION)
+        buffer->busy.store(true);
+        if (buffer->retired.load())
+        {
+            // The writer released the buffer after this thread found it.
+            buffer->busy.store(false);
+            buffer = GetBuffer();
+            continue;
+        }
+
+        bool running = mRunning.load();
+        bool pushed = (running && buffer->queue.Push(record));
+        buffer->used.store(true, std::memory_order_relaxed);
+        buffer->busy.store(false, std::memory_order_release);
+        if (pushed || !running)
         {
-            listener->Information(mMessage);
+            return pushed;
         }
+
+        // The buffer is full.  Only this thread waits for the writer.
+        Flush();
     }
-    msMutex.unlock();
 }
 
-void Logger::Subscribe(Listener* listener)
+std::shared_ptr<Logger::Writer::Buffer> Logger::Writer::GetBuffer()
 {
-    msMutex.lock();
-    msListeners.insert(listener);
-    msMutex.unlock();
+    std::shared_ptr<Buffer> buffer;
+    std::thread::id id = std::this_thread::get_id();
+    if (mBufferMap.Get(id, buffer) && !buffer->retired.load())
+    {
+        return buffer;
+    }
+
+    // The buffers are created and released under the mutex, so the map
+    // entry of a thread is replaced or removed by one thread at a time.  A
+    // thread identifier can be reused after a thread terminates, in which
+    // case the new thread inherits the buffer.
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mBufferMap.Get(id, buffer) || buffer->retired.load())
+    {
+        buffer = std::make_shared<Buffer>(id);
+        mBufferMap.Insert(id, buffer);
+        mBuffers.push_back(buffer);
+    }
+    return buffer;
 }
 
-void Logger::Unsubscribe(Listener* listener)
+void Logger::Writer::Flush()
+{
+    std::lock_guard<std::mutex> startStopLock(mStartStopMutex);
+    if (mRunning.load())
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        uint64_t ticket = ++mNumFlushRequests;
+        mWake.notify_one();
+        mDrained.wait(lock, [this, ticket]() { return mNumFlushesDone >= ticket; });
+    }
+}
+
+void Logger::Writer::Run()
+{
+    bool reported = false;
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        if (!reported)
+        {
+            mWake.wait_for(lock, std::chrono::milliseconds(10), [this]()
+            {
+                return mStopping || mNumFlushRequests > mNumFlushesDone;
+            });
+        }
+
+        bool stopping = mStopping;
+        uint64_t numFlushRequests = mNumFlushRequests;
+        std::vector<std::shared_ptr<Buffer>> buffers = mBuffers;
+        lock.unlock();
+        reported = Drain(buffers);
+        if (!stopping)
+        {
+            Retire(buffers);
+        }
+        lock.lock();
+
+        mNumFlushesDone = numFlushRequests;
+        mDrained.notify_all();
+        if (stopping && !reported)
+        {
+            break;
+        }
+    }
+}
+
+bool Logger::Writer::Drain(std::vector<std::shared_ptr<Buffer>> const& buffers)
 {
+    // The listeners are locked once for the batch and flushed after it.  At
+    // most NUM_RECORDS messages are taken from each buffer so that a thread
+    // that logs continuously cannot hold up the others.
+    bool reported = false;
+    Record record;
     msMutex.lock();
-    msListeners.erase(listener);
+    for (auto const& buffer : buffers)
+    {
+        for (int i = 0; i < NUM_RECORDS && buffer->queue.Pop(record); ++i)
+        {
+            Report(record.flag, Format(record.file, record.function, record.line, record.message));
+            reported = true;
+        }
+    }
+
+    if (reported)
+    {
+        for (auto listener : msListeners)
+        {
+            listener->Flush();
+        }
+    }
     msMutex.unlock();
+    return reported;
 }
 
 
@@ -125,6 +557,11 @@ void Logger::Listener::Information(std::string const& message)
     Report("\nGTE INFORMATION:\n" + message);
 }
 
+void Logger::Listener::Flush()
+{
+    // Stub for derived classes.
+}
+
 void Logger::Listener::Report(std::string const&)
 {
     // Stub for derived classes.
@@ -133,3 +570,43 @@ void Logger::Listener::Report(std::string const&)
 
 std::mutex Logger::msMutex;
 std::set<Logger::Listener*> Logger::msListeners;
+std::atomic<int> Logger::msFlags(Logger::Listener::LISTEN_FOR_NOTHING);
+std::atomic<int> Logger::msMaxPerSecond(0);
+std::array<std::atomic<uint64_t>, Logger::NUM_RATE_SLOTS> Logger::msRateSlots;
+std::atomic<uint64_t> Logger::msNumSuppressed(0);
+std::atomic<bool> Logger::msAsynchronous(false);
+
+void Logger::Writer::Retire(std::vector<std::shared_ptr<Buffer>> const& buffers)
+{
+    auto const now = std::chrono::steady_clock::now();
+    auto const maxIdle = std::chrono::milliseconds(MAX_IDLE_MILLISECONDS);
+    for (auto const& buffer : buffers)
+    {
+        if (buffer->used.exchange(false, std::memory_order_relaxed))
+        {
+            buffer->lastUsed = now;
+            continue;
+        }
+        if (now - buffer->lastUsed < maxIdle)
+        {
+            continue;
+        }
+
+        // Either the producer sees the retired flag and gets a new buffer,
+        // or this thread waits for its push to finish and reports it.
+        buffer->retired.store(true);
+        while (buffer->busy.load())
+        {
+            std::this_thread::yield();
+        }
+        Drain(std::vector<std::shared_ptr<Buffer>>(1, buffer));
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBuffers.erase(std::find(mBuffers.begin(), mBuffers.end(), buffer));
+        std::shared_ptr<Buffer> current;
+        if (mBufferMap.Get(buffer->id, current) && current == buffer)
+        {
+            mBufferMap.Remove(buffer->id, current);
+        }
+    }
+}
@@ -0,0 +1,199 @@
+// David Eberly, Geometric Tools, Redmond WA 98052
+// Copyright (c) 1998-2019
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 3.29.0 (2019/09/12)
+
+#include <GTEnginePCH.h>
+#include <LowLevel/GteMemoryMappedFile.h>
+#if defined(__MSWINDOWS__)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace gte;
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+MemoryMappedFile::MemoryMappedFile()
+    :
+#if defined(__MSWINDOWS__)
+    mFile(INVALID_HANDLE_VALUE),
+    mMapping(nullptr),
+#else
+    mFile(-1),
+#endif
+    mData(nullptr),
+    mSize(0),
+    mWritable(false)
+{
+}
+
+#if defined(__MSWINDOWS__)
+
+bool MemoryMappedFile::Open(std::string const& filename, bool writable)
+{
+    Close();
+    DWORD access = (writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ);
+    mFile = CreateFileA(filename.c_str(), access, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size))
+    {
+        Close();
+        return false;
+    }
+    mSize = static_cast<uint64_t>(size.QuadPart);
+    return Map(writable);
+}
+
+bool MemoryMappedFile::Create(std::string const& filename, uint64_t numBytes)
+{
+    Close();
+    mFile = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+        nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    // Extending the file fills it with zeros.
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(numBytes);
+    if (!SetFilePointerEx(mFile, size, nullptr, FILE_BEGIN) || !SetEndOfFile(mFile))
+    {
+        Close();
+        return false;
+    }
+    mSize = numBytes;
+    return Map(true);
+}
+
+bool MemoryMappedFile::Map(bool writable)
+{
+    if (mSize > 0)
+    {
+        DWORD protect = (writable ? PAGE_READWRITE : PAGE_READONLY);
+        mMapping = CreateFileMappingA(mFile, nullptr, protect, 0, 0, nullptr);
+        if (mMapping)
+        {
+            DWORD access = (writable ? FILE_MAP_WRITE : FILE_MAP_READ);
+            mData = static_cast<uint8_t*>(MapViewOfFile(mMapping, access, 0, 0, 0));
+            if (mData)
+            {
+                mWritable = writable;
+                return true;
+            }
+        }
+    }
+    Close();
+    return false;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+    }
+    mSize = 0;
+    mWritable = false;
+}
+
+#else
+
+bool MemoryMappedFile::Open(std::string const& filename, bool writable)
+{
+    Close();
+    mFile = open(filename.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (mFile < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(mFile, &status) != 0)
+    {
+        Close();
+        return false;
+    }
+    mSize = static_cast<uint64_t>(status.st_size);
+    return Map(writable);
+}
+
+bool MemoryMappedFile::Create(std::string const& filename, uint64_t numBytes)
+{
+    Close();
+    mFile = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (mFile < 0)
+    {
+        return false;
+    }
+
+    // Extending the file fills it with zeros.
+    if (ftruncate(mFile, static_cast<off_t>(numBytes)) != 0)
+    {
+        Close();
+        return false;
+    }
+    mSize = numBytes;
+    return Map(true);
+}
+
+bool MemoryMappedFile::Map(bool writable)
+{
+    if (mSize > 0)
+    {
+        int protect = (writable ? PROT_READ | PROT_WRITE : PROT_READ);
+        void* data = mmap(nullptr, static_cast<size_t>(mSize), protect, MAP_SHARED, mFile, 0);
+        if (data != MAP_FAILED)
+        {
+            mData = static_cast<uint8_t*>(data);
+            mWritable = writable;
+            return true;
+        }
+    }
+    Close();
+    return false;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (mData)
+    {
+        munmap(mData, static_cast<size_t>(mSize));
+        mData = nullptr;
+    }
+    if (mFile >= 0)
+    {
+        close(mFile);
+        mFile = -1;
+    }
+    mSize = 0;
+    mWritable = false;
+}
+
+#endif